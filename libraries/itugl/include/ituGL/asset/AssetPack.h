@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ituGL/asset/AssetPackFormat.h>
+#include <ituGL/asset/MemoryMappedFile.h>
+#include <string_view>
+#include <vector>
+
+// Asset pack file, memory mapped. See AssetPackFormat.h for the layout
+// The data of the entries is used in place, without copying it: spans point to the mapped file
+class AssetPack
+{
+public:
+    AssetPack();
+
+    // Map the pack and check its index. Returns false if it can't be opened, or if it is not valid
+    bool Open(const char* path);
+    void Close();
+
+    inline bool IsOpen() const { return m_file.IsOpen(); }
+
+    std::span<const AssetPackEntry> GetEntries() const;
+
+    // Find the entry with the name, with a binary search. Returns null if not found
+    const AssetPackEntry* FindEntry(std::string_view name) const;
+
+    // Find the entry with the name and the type. Returns null if not found
+    const AssetPackEntry* FindEntry(std::string_view name, AssetPackEntryType type) const;
+
+    std::string_view GetName(const AssetPackEntry& entry) const;
+
+    std::span<const std::byte> GetData(const AssetPackEntry& entry) const;
+
+    // Get the description and the level data of a Texture2D entry. Returns false if the levels are not valid
+    // Only block compressed formats are supported
+    bool GetTexture2D(const AssetPackEntry& entry, AssetPackTexture2D& texture2D, std::vector<std::span<const std::byte>>& levels) const;
+
+private:
+    // Check that all the names and data are inside the file
+    bool ValidateEntries() const;
+
+private:
+    MemoryMappedFile m_file;
+
+    AssetPackHeader m_header;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Layout of asset pack files, that keep many assets in a single file meant to be memory mapped
+// The file starts with the header, followed by the entries sorted by name, the names, and the data of the entries
+// Entry data is aligned to AssetPackHeader::DataAlignment bytes. All values are little endian
+struct AssetPackHeader
+{
+    static constexpr std::array<char, 4> Magic = { 'I', 'T', 'P', 'K' };
+    static constexpr std::uint32_t CurrentVersion = 1;
+    static constexpr std::uint32_t DataAlignment = 16;
+
+    std::array<char, 4> magic;
+    std::uint32_t version;
+    std::uint32_t entryCount;
+
+    // Size of the names block, after the entries. Names are not null terminated
+    std::uint32_t namesSize;
+};
+
+// Type of the data of an entry
+enum class AssetPackEntryType : std::uint32_t
+{
+    // AssetPackTexture2D followed by the levels
+    Texture2D = 1,
+
+    // Contents of a file, as they are on disk
+    File = 2,
+};
+
+struct AssetPackEntry
+{
+    // Name relative to the start of the names block. Usually, the path of the source file
+    std::uint32_t nameOffset;
+    std::uint32_t nameLength;
+
+    AssetPackEntryType type;
+    std::uint32_t reserved;
+
+    // Data relative to the start of the file
+    std::uint64_t dataOffset;
+    std::uint64_t dataSize;
+};
+
+// Start of the data of Texture2D entries. The levels follow, the biggest first, each one aligned to DataAlignment
+// Rows are stored in the order they are uploaded, already flipped if the source image needed it
+struct AssetPackTexture2D
+{
+    // Value of TextureObject::InternalFormat. Block compressed formats have the size of GetCompressedImageSize
+    std::uint32_t internalFormat;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t levelCount;
+};
+
+static_assert(sizeof(AssetPackHeader) == 16 && sizeof(AssetPackEntry) == 32 && sizeof(AssetPackTexture2D) == 16,
+    "Asset pack structs must not have padding, they are read directly from the file");
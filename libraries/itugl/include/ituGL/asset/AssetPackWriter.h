@@ -0,0 +1,39 @@
+#pragma once
+
+#include <ituGL/asset/AssetPackFormat.h>
+#include <span>
+#include <string>
+#include <vector>
+
+// Builds an asset pack file in memory and writes it. See AssetPackFormat.h for the layout
+class AssetPackWriter
+{
+public:
+    AssetPackWriter();
+
+    // Add an entry with a copy of the data. Returns false if there is already an entry with the same name
+    bool AddEntry(const std::string& name, AssetPackEntryType type, std::span<const std::byte> data);
+
+    // Add a Texture2D entry. Each level must have the size expected for the format and its dimensions
+    bool AddTexture2D(const std::string& name, std::uint32_t internalFormat, std::uint32_t width, std::uint32_t height,
+        std::span<const std::vector<std::byte>> levels);
+
+    // Add a File entry with the contents of the file, named by its path. Returns false if it can't be read
+    bool AddFile(const std::string& path);
+
+    // Write the pack, with the entries sorted by name. Returns false if the file can't be written
+    bool Write(const char* path) const;
+
+private:
+    struct Entry
+    {
+        std::string name;
+        AssetPackEntryType type;
+        std::vector<std::byte> data;
+    };
+
+    static std::uint64_t Align(std::uint64_t offset);
+
+private:
+    std::vector<Entry> m_entries;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <ituGL/texture/Texture2DObject.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/geometry/Model.h>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <span>
+#include <cstddef>
+
+class Texture2DLoader;
+class CompressedTexture2DLoader;
+class ShaderProgramCache;
+class ModelLoader;
+
+// Keeps a single instance of each texture, shader program and model, shared by everyone that loads it
+// Assets are identified by the canonical path of their files and the parameters that change the loaded result, so the
+// same file loaded with different parameters is a different asset
+// The registry keeps a reference to each asset until EvictUnused is called and nobody else is using it
+class AssetRegistry
+{
+public:
+    enum class AssetType
+    {
+        Texture2D,
+        ShaderProgram,
+        Model,
+        Count
+    };
+
+    // Assets of one type currently in the registry, and the GPU memory they use
+    struct MemoryUsage
+    {
+        unsigned int assetCount = 0;
+        std::size_t size = 0;
+    };
+
+public:
+    AssetRegistry();
+
+    // Load the texture with the loader settings: format, internal format, mipmaps and flip
+    // The loader stops keeping its own shared textures, so that they can be evicted
+    std::shared_ptr<Texture2DObject> LoadTexture2D(Texture2DLoader& loader, const char* path);
+
+    // Load a block compressed texture. Its format and mip levels come from the file, only the path identifies it
+    std::shared_ptr<Texture2DObject> LoadTexture2D(CompressedTexture2DLoader& loader, const char* path);
+
+    // Build the program with the cache, submitted asynchronously. Finish it with the cache before using it
+    std::shared_ptr<ShaderProgram> LoadShaderProgram(ShaderProgramCache& shaderProgramCache,
+        std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+        std::span<const char* const> defines = {});
+
+    // Load the model with the loader settings: reference material, vertex formats and optimization
+    // The loader stops keeping its own shared models, so that they can be evicted
+    std::shared_ptr<Model> LoadModel(ModelLoader& modelLoader, const char* path);
+
+    // Release the assets that are only referenced by the registry. Returns how many were released
+    // Models go before textures, so the textures of evicted materials are released in the same call
+    unsigned int EvictUnused();
+
+    // Release all the assets. The ones still in use stay alive with their users, but they are not shared anymore
+    void Clear();
+
+    // Count and GPU memory of the assets of a type. Queries OpenGL, so it is meant for statistics, not for every frame
+    // Program sizes are the sizes of their binaries, only known for linked programs that can be retrieved
+    MemoryUsage GetMemoryUsage(AssetType assetType) const;
+
+    // Number of loads that returned an asset already in the registry, and that had to load it
+    inline unsigned int GetHitCount() const { return m_hitCount; }
+    inline unsigned int GetMissCount() const { return m_missCount; }
+
+private:
+    // Path with the symbolic links, "." and ".." resolved. Files that don't exist get the normalized absolute path
+    static std::string GetCanonicalPath(const char* path);
+
+    // Find the asset with the key, or load it and add it to the map
+    template<typename T, typename F>
+    std::shared_ptr<T> FindOrLoad(std::unordered_map<std::string, std::shared_ptr<T>>& assets, const std::string& key, F load);
+
+    // Remove the assets of the map that are only referenced by the registry
+    template<typename T>
+    static unsigned int EvictUnused(std::unordered_map<std::string, std::shared_ptr<T>>& assets);
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<Texture2DObject>> m_textures;
+    std::unordered_map<std::string, std::shared_ptr<ShaderProgram>> m_shaderPrograms;
+    std::unordered_map<std::string, std::shared_ptr<Model>> m_models;
+
+    unsigned int m_hitCount;
+    unsigned int m_missCount;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/texture/PixelUnpackBufferObject.h>
+#include <glm/vec4.hpp>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+
+class ThreadPool;
+
+// Texture2DLoader that decodes the images in a thread pool, instead of blocking the caller
+// LoadShared returns a 1x1 placeholder texture right away. The decoded image is uploaded in Update through a
+// pixel unpack buffer, a few rows per frame, to a separate texture that replaces the placeholder when it is complete.
+// Parameters set on the placeholder are copied to the final texture
+class AsyncTexture2DLoader : public Texture2DLoader
+{
+public:
+    AsyncTexture2DLoader(ThreadPool& threadPool);
+    AsyncTexture2DLoader(ThreadPool& threadPool, TextureObject::Format format, TextureObject::InternalFormat internalFormat);
+
+    // Waits for the images that are still decoding
+    ~AsyncTexture2DLoader();
+
+    // Return the placeholder texture, and decode the image in the thread pool
+    // Textures in the asset pack are loaded without placeholder, the same as Texture2DLoader
+    // If there is a file watcher, modified files are also decoded in the thread pool
+    std::shared_ptr<Texture2DObject> LoadShared(const char* path) override;
+
+    // Upload the decoded images, up to the upload budget. Call once per frame, in the thread that owns the context
+    void Update();
+
+    // Images that are decoding or uploading
+    inline unsigned int GetPendingCount() const { return m_pendingCount; }
+
+    // Maximum bytes copied to textures in each Update. At least one row is copied, even if it is bigger
+    inline size_t GetUploadBudget() const { return m_uploadBudget; }
+    inline void SetUploadBudget(size_t uploadBudget) { m_uploadBudget = uploadBudget; }
+
+    // Color of the placeholder textures, with components in the range [0, 1]
+    inline const glm::vec4& GetPlaceholderColor() const { return m_placeholderColor; }
+    inline void SetPlaceholderColor(const glm::vec4& placeholderColor) { m_placeholderColor = placeholderColor; }
+
+private:
+    // Image decoded by a worker, waiting to be uploaded
+    struct PendingUpload
+    {
+        std::string path;
+        std::weak_ptr<Texture2DObject> texture2D;
+
+        // Settings of the loader when the image was requested
+        TextureObject::Format format;
+        TextureObject::InternalFormat internalFormat;
+        bool generateMipmap;
+
+        DecodedImage image;
+
+        // Texture that receives the rows, created when the first rows are copied. Texture objects can't be
+        // created in the worker threads, the OpenGL context is not current there
+        std::unique_ptr<Texture2DObject> stagingTexture2D;
+        int uploadedRows = 0;
+    };
+
+    // Decode the image in the thread pool, to be uploaded to the texture
+    void Submit(const std::string& path, const std::shared_ptr<Texture2DObject>& texture2D);
+
+    // Copy rows of the image to its staging texture, up to budget bytes. Returns the bytes copied
+    size_t UploadRows(PendingUpload& upload, size_t budget);
+
+    // Move the staging texture into the shared texture, keeping the parameters of the previous one
+    void FinishUpload(PendingUpload& upload, Texture2DObject& texture2D);
+
+private:
+    ThreadPool& m_threadPool;
+
+    // Images decoded by the workers, protected by the mutex
+    std::mutex m_decodedMutex;
+    std::deque<PendingUpload> m_decodedUploads;
+
+    // Images taken by the main thread, uploaded in order
+    std::deque<PendingUpload> m_uploads;
+
+    std::atomic<unsigned int> m_pendingCount;
+
+    size_t m_uploadBudget;
+
+    glm::vec4 m_placeholderColor;
+
+    // Orphaned before each copy, so that writing it does not wait for the previous copy to finish
+    PixelUnpackBufferObject m_pixelBuffer;
+};
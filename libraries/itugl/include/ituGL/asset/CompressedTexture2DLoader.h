@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ituGL/asset/AssetLoader.h>
+#include <ituGL/texture/Texture2DObject.h>
+#include <vector>
+
+// Asset loader for Texture2DObject with block compressed data (BC1, BC3, BC4, BC5, BC7), read from KTX2 or DDS files
+// The mip levels stored in the file are used as they are. Block compressed data can't be flipped on load, so the rows
+// must be stored top to bottom, the same way Texture2DLoader reads images without flipping them
+class CompressedTexture2DLoader : public AssetLoader<Texture2DObject>
+{
+public:
+    // Image read from a file. The levels point into the file data, the first one is the biggest
+    struct Image
+    {
+        TextureObject::InternalFormat internalFormat = TextureObject::InternalFormatInvalid;
+        int width = 0;
+        int height = 0;
+        std::vector<std::span<const std::byte>> levels;
+    };
+
+public:
+    CompressedTexture2DLoader();
+
+    // Files with .ktx2 or .dds extension
+    bool IsValid(const char* path) override;
+
+    // Load the texture from the path. The texture is left empty if the file can't be read, or its format is not supported
+    Texture2DObject Load(const char* path) override;
+
+    // Parse the image from the contents of a KTX2 or DDS file, identified by its header
+    // Returns false if the file is not valid, or if it is not in one of the supported block formats
+    static bool ReadImage(std::span<const std::byte> fileData, Image& image);
+
+    // Set all the levels of the image to the texture, that must be bound, and the filters for the levels available
+    static void SetImage(Texture2DObject& texture2D, const Image& image);
+
+private:
+    static bool ReadKTX2(std::span<const std::byte> fileData, Image& image);
+    static bool ReadDDS(std::span<const std::byte> fileData, Image& image);
+
+    // Check that the levels have the size expected for their format and dimensions
+    static bool ValidateLevels(const Image& image);
+
+    // Enough levels for any texture size that fits in an int. Bigger counts come from invalid files
+    static constexpr uint32_t s_maxLevelCount = 32;
+};
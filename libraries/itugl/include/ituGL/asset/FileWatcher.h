@@ -0,0 +1,68 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+// Watches files on disk and reports when they are modified, so that the assets loaded from them can be reloaded
+// On Linux, changes are notified by inotify. On other platforms, the modification times are checked on each update
+// Callbacks are only called from Update, in the thread that owns the OpenGL context
+class FileWatcher
+{
+public:
+    // Argument: path of the modified file, as it was passed to Watch
+    using Callback = std::function<void(const std::string&)>;
+
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    void operator = (const FileWatcher&) = delete;
+
+    // Call the callback each time the file is modified. A file can have several callbacks
+    void Watch(const std::string& path, Callback callback);
+
+    // Check for modified files and call their callbacks
+    void Update();
+
+private:
+    struct WatchedFile
+    {
+        // Path as passed to Watch
+        std::string path;
+
+        // Last modification time reported
+        std::filesystem::file_time_type modifiedTime;
+
+        std::vector<Callback> callbacks;
+    };
+
+    // Files are identified by their absolute path
+    static std::string GetKey(const std::filesystem::path& path);
+
+    // Add the file to the list if its modification time changed since the last check
+    void CheckModified(const std::string& key, std::vector<std::string>& modifiedKeys);
+
+#ifdef __linux__
+    // Start watching the directory of the file, if it was not watched yet
+    void WatchDirectory(const std::filesystem::path& directory);
+
+    // Read the pending inotify events and collect the watched files that changed
+    void ReadEvents(std::vector<std::string>& modifiedKeys);
+#endif
+
+private:
+    std::unordered_map<std::string, WatchedFile> m_watchedFiles;
+
+#ifdef __linux__
+    // Negative if inotify is not available. Then modification times are checked instead
+    int m_inotifyDescriptor;
+
+    // Directories are watched instead of files, because many editors save by replacing the file,
+    // and a watch on the replaced file would not report any more changes. Key: watch descriptor
+    std::unordered_map<int, std::filesystem::path> m_watchedDirectories;
+#endif
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+// Read-only view of a whole file, mapped in memory
+// Pages are read by the OS when they are accessed, and the page cache is shared with other processes mapping the file
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile();
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    void operator = (const MemoryMappedFile&) = delete;
+
+    MemoryMappedFile(MemoryMappedFile&& memoryMappedFile) noexcept;
+    MemoryMappedFile& operator = (MemoryMappedFile&& memoryMappedFile) noexcept;
+
+    // Map the file, closing the previous one. Returns false if it can't be opened. Empty files can't be mapped
+    bool Open(const char* path);
+    void Close();
+
+    inline bool IsOpen() const { return m_data != nullptr; }
+
+    // Contents of the file, valid until it is closed
+    inline std::span<const std::byte> GetData() const { return std::span<const std::byte>(m_data, m_size); }
+
+    // Ask the OS to start reading the whole file, so that it is read sequentially instead of page by page on first access
+    void Prefetch() const;
+
+private:
+    const std::byte* m_data;
+    std::size_t m_size;
+
+#ifdef _WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#endif
+};
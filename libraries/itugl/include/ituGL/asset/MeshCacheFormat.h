@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Layout of the mesh cache files written by ModelLoader, with the meshes of a model ready to be uploaded
+// The file starts with the header, followed by the tables of meshes, attributes, ranges and materials, the strings,
+// and the vertex and element data of the meshes, aligned to MeshCacheHeader::DataAlignment bytes
+// Values are stored in the native byte order, cache files are not meant to be copied to other machines
+struct MeshCacheHeader
+{
+    static constexpr std::array<char, 4> Magic = { 'I', 'T', 'M', 'C' };
+    static constexpr std::uint32_t CurrentVersion = 2;
+    static constexpr std::uint32_t DataAlignment = 16;
+
+    std::array<char, 4> magic;
+    std::uint32_t version;
+
+    // Hash of the contents of the source file and the import settings. The cache is discarded if they change
+    std::uint64_t sourceHash;
+
+    std::uint32_t meshCount;
+    std::uint32_t attributeCount;
+    std::uint32_t rangeCount;
+    std::uint32_t materialCount;
+
+    // Size of the strings block, after the tables. Strings are not null terminated
+    std::uint32_t stringsSize;
+    std::uint32_t reserved;
+};
+
+// One for each mesh of the source file
+struct MeshCacheMesh
+{
+    // Vertex attributes and drawcall ranges, indices in their tables
+    std::uint32_t firstAttribute;
+    std::uint32_t attributeCount;
+    std::uint32_t firstRange;
+    std::uint32_t rangeCount;
+
+    // Value of Data::Type of the element data
+    std::uint32_t elementType;
+    std::uint32_t materialIndex;
+
+    // Interleaved vertex data and element data, relative to the start of the file
+    std::uint64_t vertexDataOffset;
+    std::uint64_t vertexDataSize;
+    std::uint64_t elementDataOffset;
+    std::uint64_t elementDataSize;
+
+    // Bounds of the quantized positions. Offset 0 and scale 1 if they are not quantized
+    std::array<float, 3> positionOffset;
+    std::array<float, 3> positionScale;
+};
+
+// Vertex attribute, in the order they are interleaved in the vertex data
+struct MeshCacheAttribute
+{
+    // Value of Data::Type
+    std::uint16_t type;
+    std::uint8_t components;
+    std::uint8_t normalized;
+
+    // Value of VertexAttribute::Semantic
+    std::uint32_t semantic;
+};
+
+// Part of the element data drawn with one drawcall
+struct MeshCacheRange
+{
+    // Value of Drawcall::Primitive
+    std::uint32_t primitive;
+
+    // Range of the element data, in the same units that the submeshes use
+    std::uint32_t first;
+    std::uint32_t count;
+};
+
+// Material properties read from the source file. Only the ones in the mask are present
+struct MeshCacheMaterial
+{
+    // One bit for each ModelLoader::MaterialProperty
+    std::uint32_t propertyMask;
+
+    std::array<float, 3> ambientColor;
+    std::array<float, 3> diffuseColor;
+    std::array<float, 3> specularColor;
+    float specularExponent;
+
+    // Diffuse texture path relative to the source file, in the strings block
+    std::uint32_t diffuseTextureOffset;
+    std::uint32_t diffuseTextureLength;
+};
+
+static_assert(sizeof(MeshCacheHeader) == 40 && sizeof(MeshCacheMesh) == 80 && sizeof(MeshCacheAttribute) == 8 &&
+    sizeof(MeshCacheRange) == 12 && sizeof(MeshCacheMaterial) == 52,
+    "Mesh cache structs must not have padding, they are read directly from the file");
@@ -3,11 +3,21 @@
 #include <ituGL/asset/AssetLoader.h>
 #include <ituGL/geometry/Model.h>
 #include <ituGL/geometry/Mesh.h>
+#include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/geometry/MeshOptimizer.h>
+#include <ituGL/asset/MemoryMappedFile.h>
+#include <glm/vec3.hpp>
+#include <filesystem>
+#include <cstdint>
+#include <string>
 #include <vector>
+#include <span>
 
 struct aiMesh;
 struct aiMaterial;
-class VertexFormat;
+class ThreadPool;
+class AssetRegistry;
+class GeometryHeap;
 
 // Asset loader for Models. Contains a pointer to a reference material for loaded submeshes
 class ModelLoader : public AssetLoader<Model>
@@ -16,6 +26,9 @@ public:
     // Enum to read material properties from the file
     enum class MaterialProperty;
 
+    // Enum to choose how normals and tangents are stored
+    enum class NormalFormat;
+
 public:
     ModelLoader(std::shared_ptr<Material> referenceMaterial = nullptr);
 
@@ -25,9 +38,55 @@ public:
     bool GetCreateMaterials() const;
     void SetCreateMaterials(bool createMaterials);
 
+    // Format of the normals and tangents of the imported meshes. Float by default
+    NormalFormat GetNormalFormat() const;
+    void SetNormalFormat(NormalFormat normalFormat);
+
+    // Store the texture coordinates with 2 components as half floats. Disabled by default
+    bool GetQuantizeTexCoords() const;
+    void SetQuantizeTexCoords(bool quantizeTexCoords);
+
+    // Store the positions as 4 normalized unsigned shorts, relative to the bounds of each mesh. Disabled by default
+    // The shader gets them in [0, 1], and scales them with the PositionOffset and PositionScale material properties
+    // Each mesh gets its own copy of the material then
+    bool GetQuantizePositions() const;
+    void SetQuantizePositions(bool quantizePositions);
+
+    // Reorder the triangles and vertices of the imported meshes with MeshOptimizer, to reduce the vertex shader
+    // invocations and the overdraw. Disabled by default. Only triangle meshes are optimized
+    bool GetOptimizeMeshes() const;
+    void SetOptimizeMeshes(bool optimizeMeshes);
+
+    // Vertex cache statistics of the triangles of the last imported model, before and after the optimization
+    // They are not updated when the model is loaded from the cache
+    inline const MeshOptimizer::VertexCacheStatistics& GetImportedStatistics() const { return m_importedStatistics; }
+    inline const MeshOptimizer::VertexCacheStatistics& GetOptimizedStatistics() const { return m_optimizedStatistics; }
+
+    // Directory where the imported meshes are cached, ready to be uploaded. Empty disables the cache (default)
+    // The first load imports the file and writes the cache. Next loads map the cache instead, while the source file
+    // has the same contents, without importing it again
+    const std::filesystem::path& GetCacheDirectory() const;
+    void SetCacheDirectory(const std::filesystem::path& cacheDirectory);
+
+    // If set, the material textures are loaded through the registry, shared with other models and materials
+    // Otherwise, each material loads its own textures
+    inline AssetRegistry* GetAssetRegistry() const { return m_assetRegistry; }
+    inline void SetAssetRegistry(AssetRegistry* assetRegistry) { m_assetRegistry = assetRegistry; }
+
+    // If set, the vertex and element data of the meshes go to the heap, and their submeshes draw with the VAOs of the heap
+    // Otherwise, each mesh gets its own buffers and VAOs. The heap must outlive the loaded models
+    inline GeometryHeap* GetGeometryHeap() const { return m_geometryHeap; }
+    inline void SetGeometryHeap(GeometryHeap* geometryHeap) { m_geometryHeap = geometryHeap; }
+
     // Load the model from the path
     Model Load(const char* path) override;
 
+    // Load several models, importing and collecting their data in the worker threads of the pool
+    // Only the GL objects are created in this thread, for each model as soon as its data is ready
+    // Statistics are added for all the models. Don't change the settings of the loader while it runs
+    // If loading a model throws, the first exception is rethrown after all the tasks have finished
+    std::vector<Model> Load(std::span<const char* const> paths, ThreadPool& threadPool);
+
     // Maps a semantic to an attribute in the shader program used by the material
     bool SetMaterialAttribute(VertexAttribute::Semantic semantic, const char* attributeName);
 
@@ -35,14 +94,73 @@ public:
     bool SetMaterialProperty(MaterialProperty materialProperty, const char* uniformName);
 
 private:
+    // Mesh data ready to be uploaded, collected from the imported mesh or read from the cache
+    struct MeshData
+    {
+        VertexFormat vertexFormat;
+        std::span<const GLubyte> vertexData;
+        Data::Type elementType;
+        std::span<const GLubyte> elementData;
+        std::vector<Drawcall::Primitive> primitives;
+        std::vector<int> elementCounts;
+        unsigned int materialIndex;
+
+        // Bounds of the positions, if they are quantized
+        glm::vec3 positionOffset = glm::vec3(0.0f);
+        glm::vec3 positionScale = glm::vec3(1.0f);
+    };
+
+    // Material properties, collected from the imported material or read from the cache
+    struct MaterialData
+    {
+        // One bit for each MaterialProperty found
+        unsigned int propertyMask = 0;
+
+        glm::vec3 ambientColor = glm::vec3(0.0f);
+        glm::vec3 diffuseColor = glm::vec3(0.0f);
+        glm::vec3 specularColor = glm::vec3(0.0f);
+        float specularExponent = 0.0f;
+        std::string diffuseTexture;
+    };
+
+    // Everything read from a model file, or from its cache, before creating the GL objects
+    struct ModelData
+    {
+        bool loaded = false;
+        std::string baseFolder;
+        std::vector<MeshData> meshes;
+        std::vector<MaterialData> materials;
+
+        // Owners of the data referenced by the meshes: the collected buffers or the mapped cache
+        std::vector<std::vector<GLubyte>> buffers;
+        MemoryMappedFile cacheFile;
+
+        MeshOptimizer::VertexCacheStatistics importedStatistics;
+        MeshOptimizer::VertexCacheStatistics optimizedStatistics;
+    };
+
+private:
+    // Read the model data from the cache or the file. Doesn't use OpenGL nor modify the loader, so it can run in any thread
+    void ReadModelData(const char* path, ModelData& modelData) const;
+
+    // Build the model from the data read, if it was loaded
+    Model GenerateModel(const ModelData& modelData);
+
+    // Build the model from the mesh and material data
+    Model GenerateModel(std::span<const MeshData> meshes, std::span<const MaterialData> materials);
+
     // Generate a submesh from the loaded mesh data
-    void GenerateSubmesh(Mesh& mesh, const aiMesh& meshData);
+    void GenerateSubmesh(Mesh& mesh, const MeshData& meshData);
 
     // Generate a material from the loaded material data
-    std::shared_ptr<Material> GenerateMaterial(const aiMaterial& materialData);
+    std::shared_ptr<Material> GenerateMaterial(const MaterialData& materialData);
+
+    // Read the properties of the imported material
+    static void CollectMaterialData(const aiMaterial& material, MaterialData& materialData);
 
-    // Build the vertex data from the mesh data
-    static std::vector<GLubyte> CollectVertexData(const aiMesh& meshData, VertexFormat& vertexFormat, bool interleaved);
+    // Build the vertex data from the mesh data, in the formats selected. Quantized positions return their bounds
+    std::vector<GLubyte> CollectVertexData(const aiMesh& meshData, VertexFormat& vertexFormat, bool interleaved,
+        glm::vec3& positionOffset, glm::vec3& positionScale) const;
 
     // Build the element data from the mesh data
     static std::vector<GLubyte> CollectElementData(const aiMesh& meshData, Data::Type& elementType,
@@ -54,9 +172,37 @@ private:
     // Copy one buffer to another preserving the stride
     static void CopyBuffer(void* dstBuffer, size_t dstStride, const void* srcBuffer, size_t srcStride, size_t count, size_t size);
 
+    // Convert the mesh data of an attribute to the quantized type of the attribute, writing it with the stride
+    static void QuantizeBuffer(void* dstBuffer, size_t dstStride, const aiMesh& meshData, const VertexAttribute& attribute,
+        const glm::vec3& positionOffset, const glm::vec3& positionScale);
+
+    // Check if an attribute is stored in a different type than the imported one
+    static bool IsQuantized(const VertexAttribute& attribute);
+
+    // Reorder the triangles and vertices of a triangle mesh, adding the statistics before and after
+    // Positions are the imported ones, with the original vertex order
+    static void OptimizeMesh(std::vector<GLubyte>& vertexData, std::size_t vertexSize, std::vector<GLubyte>& elementData, Data::Type elementType,
+        std::span<const std::byte> positions, MeshOptimizer::VertexCacheStatistics& importedStatistics,
+        MeshOptimizer::VertexCacheStatistics& optimizedStatistics);
+
     // Get the type of primitive depending on the number of elements
     static Drawcall::Primitive GetPrimitiveType(int elementCount);
 
+    // Path of the cache file of a model, named after the hash of the source path
+    std::filesystem::path GetCachePath(const char* path) const;
+
+    // Hash of the contents of the source file, together with the import settings. Returns false if it can't be read
+    bool ComputeSourceHash(const char* path, std::uint64_t& sourceHash) const;
+
+    // Read the cache file contents. Returns false if they are invalid or don't match the source hash
+    // The vertex and element data of the meshes point to the cache contents
+    static bool ReadCache(std::span<const std::byte> data, std::uint64_t sourceHash,
+        std::vector<MeshData>& meshes, std::vector<MaterialData>& materials);
+
+    // Write the mesh and material data to the cache file
+    static bool WriteCache(const std::filesystem::path& cachePath, std::uint64_t sourceHash,
+        std::span<const MeshData> meshes, std::span<const MaterialData> materials);
+
 private:
     // Path to the base folder where we are loading the current model
     std::string m_baseFolder;
@@ -72,6 +218,25 @@ private:
 
     // Should create new materials for each submesh or use the reference material
     bool m_createMaterials;
+
+    // Formats of the vertex attributes
+    NormalFormat m_normalFormat;
+    bool m_quantizeTexCoords;
+    bool m_quantizePositions;
+
+    // Optimize the imported meshes
+    bool m_optimizeMeshes;
+
+    // Statistics of the last imported model
+    MeshOptimizer::VertexCacheStatistics m_importedStatistics;
+    MeshOptimizer::VertexCacheStatistics m_optimizedStatistics;
+
+    // Where the cache files are written, if not empty
+    std::filesystem::path m_cacheDirectory;
+
+    AssetRegistry* m_assetRegistry;
+
+    GeometryHeap* m_geometryHeap;
 };
 
 enum class ModelLoader::MaterialProperty
@@ -81,4 +246,18 @@ enum class ModelLoader::MaterialProperty
     SpecularColor,
     SpecularExponent,
     DiffuseTexture,
+    // Not read from the file: bounds of the quantized positions of each mesh (vec3)
+    PositionOffset,
+    PositionScale,
+};
+
+enum class ModelLoader::NormalFormat
+{
+    // 3 floats for normals, tangents and bitangents
+    Float,
+    // Normals and tangents as normalized 10_10_10_2. The bitangent sign is in the w of the tangent, without bitangents
+    Packed,
+    // Normals as 2 normalized shorts with octahedral encoding, decoded in the shader. Tangents as in Packed
+    // The attribute is in [-1, 1], DecodeOctahedral in utils.glsl takes it remapped with encoded * 0.5 + 0.5
+    Octahedral,
 };
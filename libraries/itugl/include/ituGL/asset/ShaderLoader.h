@@ -2,8 +2,21 @@
 
 #include <ituGL/asset/AssetLoader.h>
 #include <ituGL/shader/Shader.h>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
 #include <span>
+#include <string>
+#include <vector>
 
+class AssetPack;
+
+// Loads shaders from one or more source files, that are preprocessed before compiling:
+// - #include "path" is replaced by the file, relative to the including file. Each file is included once per shader
+// - Defines are inserted after the #version line
+// - #line directives keep the original line numbers, and errors are reported with the path of the file
+// Files are read from disk once, and kept in memory until they are modified
+// Files that are not on disk are read from the asset pack, if there is one
 class ShaderLoader : AssetLoader<Shader>
 {
 public:
@@ -17,13 +30,82 @@ public:
     using AssetLoader<Shader>::LoadInto;
 
     Shader Load(std::span<const char*> paths);
+
+    // Create and compile a shader from sources returned by ReadSources
+    Shader LoadSources(std::span<const std::string> sources);
+
+    // Same as Load and LoadSources, but the compilation is only submitted. The returned shader can be attached to
+    // a program right away, and CheckCompiled reports the result once it is needed
+    Shader LoadAsync(std::span<const char*> paths);
+    Shader LoadSourcesAsync(std::span<const std::string> sources);
+
     Shader* LoadNew(std::span<const char*> paths);
     bool LoadInto(Shader& shader, std::span<const char*> paths);
 
     static Shader Load(Shader::Type type, const char* path);
 
+    // Check the compile status of the shader, waiting for it if needed. Errors are printed
+    static bool CheckCompiled(const Shader& shader);
+
+    // Defines added to the source, after the #version line. Each one is "NAME" or "NAME VALUE"
+    inline std::span<const std::string> GetDefines() const { return m_defines; }
+    void SetDefines(std::span<const char* const> defines);
+
+    // Read and preprocess the sources of the paths, without compiling them
+    // If includedFiles is not null, it gets the paths of all the files read, including the paths passed
+    void ReadSources(std::span<const char*> paths, std::vector<std::string>& sources,
+        std::vector<std::string>* includedFiles = nullptr) const;
+
+    // Pack with File entries named by their normalized path. Files on disk are used first, so they can be edited
+    inline static const AssetPack* GetAssetPack() { return s_assetPack; }
+    inline static void SetAssetPack(const AssetPack* assetPack) { s_assetPack = assetPack; }
+
 private:
-    void Compile(Shader& shader);
+    // Source file read from disk, or from the asset pack
+    struct SourceFile
+    {
+        std::filesystem::file_time_type modifiedTime;
+        std::string source;
+
+        // Used in #line directives, to find the file in error messages
+        int sourceNumber;
+    };
+
+    // State kept while preprocessing all the files of a shader
+    struct PreprocessState
+    {
+        std::unordered_set<std::string> includedFiles;
+        bool versionFound = false;
+    };
+
+    Shader CreateShader(std::span<const std::string> sources) const;
 
+    // Append the preprocessed source of the file to the output, resolving includes recursively
+    void Preprocess(const std::filesystem::path& path, std::string& output, PreprocessState& state) const;
+
+    // Get the defines as source code
+    std::string GetDefinesSource() const;
+
+    // Get the file from the cache, reading it if it is not there or if it was modified. Null if it can't be read
+    static const SourceFile* GetSourceFile(const std::string& path);
+
+    // Get the file from the asset pack, if it is there. Null otherwise
+    static const SourceFile* GetPackedSourceFile(const std::string& path);
+
+    // Check if the file is on disk or in the asset pack
+    static bool SourceFileExists(const std::filesystem::path& path);
+
+    // Replace the source numbers in error messages with the paths of the files
+    static std::string ReplaceSourceNumbers(const std::string& errors);
+
+private:
     Shader::Type m_type;
+
+    std::vector<std::string> m_defines;
+
+    // Files read during this run, by normalized path, and their paths by source number
+    static std::unordered_map<std::string, SourceFile> s_sourceFiles;
+    static std::vector<std::string> s_sourceFilePaths;
+
+    static const AssetPack* s_assetPack;
 };
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <ituGL/shader/ShaderUniformCollection.h>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <span>
+
+class ShaderProgram;
+class ShaderProgramCache;
+class Material;
+
+// Variants of a shader program, specialized at compile time with defines instead of branching on uniforms
+// Each define takes an integer value in a range, and the combination of values (the key) selects the variant
+// Variants are built the first time they are needed, through the program binary cache
+class ShaderPermutationManager
+{
+public:
+    // Combination of define values, packed in bits
+    using Key = unsigned int;
+
+    // Called for each new variant material, to set its uniforms and register its program in the renderer
+    // Called again when the program is rebuilt after its sources are modified
+    using MaterialSetupFunction = std::function<void(Material&, Key)>;
+
+public:
+    ShaderPermutationManager(ShaderProgramCache& shaderProgramCache,
+        std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+        const ShaderUniformCollection::NameSet& filteredUniforms = ShaderUniformCollection::NameSet());
+
+    // Add a define with values from 0 to maxValue (1 for bool defines). Returns the index of the define
+    unsigned int AddDefine(const char* name, int maxValue = 1, int defaultValue = 0);
+
+    // Find a define by name. Returns -1 if it doesn't exist
+    int FindDefine(const char* name) const;
+
+    // Key with the default value of all the defines
+    inline Key GetDefaultKey() const { return m_defaultKey; }
+    void SetDefaultValue(unsigned int defineIndex, int value);
+
+    // Get and set the value of one define in a key
+    int GetDefineValue(Key key, unsigned int defineIndex) const;
+    Key SetDefineValue(Key key, unsigned int defineIndex, int value) const;
+
+    void SetMaterialSetupFunction(MaterialSetupFunction materialSetupFunction);
+
+    // Get the program of a variant, building it if needed
+    std::shared_ptr<ShaderProgram> GetShaderProgram(Key key);
+
+    // Get a material using the program of a variant. Created on first use, and prepared with the setup function
+    std::shared_ptr<Material> GetMaterial(Key key);
+
+    // Submit the build of a variant that will be needed later, without waiting for it
+    void Prebuild(Key key);
+
+private:
+    struct Define
+    {
+        std::string name;
+        int maxValue;
+        unsigned int shift;
+        unsigned int mask;
+    };
+
+    struct Variant
+    {
+        std::shared_ptr<ShaderProgram> shaderProgram;
+        std::shared_ptr<Material> material;
+
+        // The build was submitted, but the result was not checked yet
+        bool pending;
+    };
+
+    // Get the variant, submitting the build if it doesn't exist
+    Variant& GetVariant(Key key);
+
+private:
+    ShaderProgramCache& m_shaderProgramCache;
+
+    std::vector<const char*> m_vertexShaderPaths;
+    std::vector<const char*> m_fragmentShaderPaths;
+    ShaderUniformCollection::NameSet m_filteredUniforms;
+
+    std::vector<Define> m_defines;
+    unsigned int m_keyBitCount;
+    Key m_defaultKey;
+
+    MaterialSetupFunction m_materialSetupFunction;
+
+    std::unordered_map<Key, Variant> m_variants;
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/shader/Shader.h>
+#include <filesystem>
+#include <functional>
+#include <unordered_set>
+#include <optional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+class FileWatcher;
+
+// Builds shader programs from source paths, storing the linked binaries in a directory
+// Next time the same program is built, the binary is loaded instead of compiling and linking the shaders
+// Binaries are identified by the sources, the defines and the driver, so any change in them builds the program again
+class ShaderProgramCache
+{
+public:
+    ShaderProgramCache(const char* directory);
+
+    // If disabled, or if the driver doesn't support program binaries, programs are always built from source
+    inline bool IsEnabled() const { return m_enabled && m_driverSupported; }
+    inline void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+    // Build a program with vertex and fragment shaders, loaded from the paths with the defines
+    bool Build(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+        std::span<const char* const> defines = {});
+
+    // Submit the build of a program and return it right away. If it is not in the cache, the shaders compile and link
+    // in the background (in parallel, if the driver supports it), while the application does other work
+    // Call Finish before using the program
+    std::shared_ptr<ShaderProgram> BuildAsync(std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+        std::span<const char* const> defines = {});
+
+    // Check if a program submitted with BuildAsync can be finished without waiting
+    bool IsReady(const ShaderProgram& shaderProgram) const;
+
+    // Wait for a program submitted with BuildAsync, reporting the errors and storing its binary. Returns if it is linked
+    bool Finish(const ShaderProgram& shaderProgram);
+
+    // Finish all the submitted programs. Returns if all of them are linked
+    bool FinishAll();
+
+    // Rebuild the programs returned by BuildAsync when any of their source files is modified
+    // Programs are rebuilt in place, so the pointers stay valid, but their uniform locations can change
+    // If the modified sources fail to build, the previous program is kept
+    void SetFileWatcher(FileWatcher* fileWatcher);
+
+    // Called each time the program is rebuilt from modified sources, to query its uniform locations again
+    void AddReloadCallback(const ShaderProgram& shaderProgram, std::function<void()> callback);
+
+    // Number of programs loaded from the cache and built from source
+    inline unsigned int GetHitCount() const { return m_hitCount; }
+    inline unsigned int GetMissCount() const { return m_missCount; }
+
+private:
+    // Program with compilation and linking submitted, but not checked yet
+    struct PendingBuild
+    {
+        std::shared_ptr<ShaderProgram> shaderProgram;
+        std::uint64_t key;
+        Shader vertexShader;
+        Shader fragmentShader;
+    };
+
+    // Program returned by BuildAsync, with everything needed to build it again
+    struct WatchedProgram
+    {
+        std::weak_ptr<ShaderProgram> shaderProgram;
+        std::vector<std::string> vertexShaderPaths;
+        std::vector<std::string> fragmentShaderPaths;
+        std::vector<std::string> defines;
+
+        // All the source files, including the ones added with #include
+        std::vector<std::string> includedFiles;
+
+        std::vector<std::function<void()>> reloadCallbacks;
+    };
+
+    // Load the program from the cache, or submit its build. Returns the pending build in the second case
+    // If includedFiles is not null, it gets the paths of all the source files used
+    std::optional<PendingBuild> Submit(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths,
+        std::span<const char*> fragmentShaderPaths, std::span<const char* const> defines,
+        std::vector<std::string>* includedFiles = nullptr);
+
+    // Start watching the program files, to rebuild it when they are modified
+    void AddWatchedProgram(std::shared_ptr<ShaderProgram> shaderProgram, std::span<const char*> vertexShaderPaths,
+        std::span<const char*> fragmentShaderPaths, std::span<const char* const> defines, std::vector<std::string>&& includedFiles);
+    void WatchFiles(std::span<const std::string> paths);
+
+    // Rebuild the programs that use the modified file
+    void Reload(const std::string& path);
+
+    // Check the result of a pending build and store the binary
+    bool Complete(const ShaderProgram& shaderProgram, const PendingBuild& pendingBuild);
+
+    // Query the driver support and create the directory. Requires a valid context, so it is done on first use
+    void InitializeDriver();
+
+    std::uint64_t ComputeKey(std::span<const std::string> vertexSources, std::span<const std::string> fragmentSources) const;
+
+    std::filesystem::path GetBinaryPath(std::uint64_t key) const;
+
+    bool LoadBinary(ShaderProgram& shaderProgram, std::uint64_t key) const;
+    void SaveBinary(const ShaderProgram& shaderProgram, std::uint64_t key) const;
+
+    // FNV-1a hash, stable between runs
+    static std::uint64_t Hash(std::uint64_t hash, const void* data, std::size_t size);
+
+private:
+    std::filesystem::path m_directory;
+
+    bool m_enabled;
+
+    bool m_driverInitialized;
+    bool m_driverSupported;
+    std::uint64_t m_driverHash;
+
+    unsigned int m_hitCount;
+    unsigned int m_missCount;
+
+    std::vector<PendingBuild> m_pendingBuilds;
+
+    FileWatcher* m_fileWatcher;
+    std::vector<WatchedProgram> m_watchedPrograms;
+    std::unordered_set<std::string> m_watchedFiles;
+};
@@ -2,6 +2,10 @@
 
 #include <ituGL/asset/TextureLoader.h>
 #include <ituGL/texture/Texture2DObject.h>
+#include <memory>
+
+class FileWatcher;
+class AssetPack;
 
 // Asset loader for Texture2DObject
 class Texture2DLoader : public TextureLoader<Texture2DObject>
@@ -13,15 +17,64 @@ public:
     // Load the texture from the path
     Texture2DObject Load(const char* path) override;
 
+    // Load the shared texture, and watch the file if there is a file watcher
+    std::shared_ptr<Texture2DObject> LoadShared(const char* path) override;
+
+    // Load the image again into an existing texture, keeping its parameters. Returns false if the image can't be read
+    bool Reload(const char* path, Texture2DObject& texture2D) const;
+
     // Helper to easily load a shared texture
     static std::shared_ptr<Texture2DObject> LoadTextureShared(const char* path,
-        TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool generateMipmap = true);
+        TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool generateMipmap = true,
+        FileWatcher* fileWatcher = nullptr);
 
     inline bool GetFlipVertical() const { return m_flipVertical; }
     inline void SetFlipVertical(bool flipVertical) { m_flipVertical = flipVertical; }
 
+    // If set, textures loaded as shared are reloaded in place when their file is modified
+    inline FileWatcher* GetFileWatcher() const { return m_fileWatcher; }
+    inline void SetFileWatcher(FileWatcher* fileWatcher) { m_fileWatcher = fileWatcher; }
+
+    // If set, textures baked in the pack are uploaded from it, with the format and the mip levels of the pack
+    // The flip option is ignored for them, the images were flipped when baking if needed
+    inline const AssetPack* GetAssetPack() const { return m_assetPack; }
+    inline void SetAssetPack(const AssetPack* assetPack) { m_assetPack = assetPack; }
+
+protected:
+    // Pixels of an image file, with the components of the loader format. Data is null if the image can't be read
+    struct DecodedImage
+    {
+        int width = 0;
+        int height = 0;
+        std::unique_ptr<unsigned char[], void(*)(void*)> data{ nullptr, nullptr };
+    };
+
+    // Read the image file. It doesn't use the OpenGL context, and can be called from any thread
+    static DecodedImage DecodeImage(const char* path, int componentCount, bool flipVertical);
+
+    // Check if the texture is in the asset pack, in a format that the driver supports
+    bool IsPacked(const char* path) const;
+
+    // Copy the filter and wrap parameters, and the sampler, to another texture. Leaves the target bound
+    static void CopySamplingState(const Texture2DObject& source, Texture2DObject& target);
+
+private:
+    // Read the image and set it to the texture, generating the mipmap if needed. Leaves the texture bound
+    bool LoadImage(const char* path, Texture2DObject& texture2D) const;
+
+    // Set the levels from the asset pack to the texture. Leaves the texture bound
+    bool LoadPackedImage(const char* path, Texture2DObject& texture2D) const;
+
+    // Immutable storage can't be specified again, so an image read for such a texture goes to a new texture object
+    // Call it only once the image was read, so that a failed reload keeps the old image
+    static void ReplaceImmutableStorage(Texture2DObject& texture2D);
+
 private:
     // If true, the texture will be flipped vertically on load
     // This option exists because some systems define the vertical origin as "up", and others as "down"
     bool m_flipVertical;
+
+    FileWatcher* m_fileWatcher;
+
+    const AssetPack* m_assetPack;
 };
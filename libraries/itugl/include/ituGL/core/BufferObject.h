@@ -13,6 +13,10 @@ public:
         ArrayBuffer = GL_ARRAY_BUFFER,
         // Element Buffer Object
         ElementArrayBuffer = GL_ELEMENT_ARRAY_BUFFER,
+        // Pixel Buffer Object, source of texture uploads
+        PixelUnpackBuffer = GL_PIXEL_UNPACK_BUFFER,
+        // Parameters of indirect drawcalls, read by the GPU
+        DrawIndirectBuffer = GL_DRAW_INDIRECT_BUFFER,
         // TODO: There are more types, add them when they are supported
     };
 
@@ -58,11 +62,25 @@ public:
     // Modify the contents of the buffer, starting at offset
     void UpdateData(std::span<const std::byte> data, size_t offset = 0);
 
+    // Map a range of the buffer to client memory, with access flags like GL_MAP_WRITE_BIT
+    // The span is empty if it failed. The buffer can't be used by OpenGL until it is unmapped
+    std::span<std::byte> MapRange(size_t offset, size_t size, GLbitfield access);
+
+    // Unmap the buffer. Returns false if the contents got corrupted while mapped, and must be written again
+    bool Unmap();
+
+    // Size in bytes of the data allocated with AllocateData
+    inline size_t GetSize() const { return m_size; }
+
 protected:
     // Bind the specific target. Used by the Bind() method in derived classes
     void Bind(Target target) const;
     // Unbind the specific target. It is static because we dont need any objects to do it
     static void Unbind(Target target);
+
+private:
+    // Kept on allocation, querying it would require binding the buffer
+    size_t m_size;
 };
 
 // (C++) 5
@@ -20,6 +20,10 @@ public:
         UShort = GL_UNSIGNED_SHORT,
         Int = GL_INT,
         UInt = GL_UNSIGNED_INT,
+        UInt24_8 = GL_UNSIGNED_INT_24_8,
+        // Packed 4 components in 32 bits: 10 bits for x, y and z, and 2 bits for w
+        Int2_10_10_10_Rev = GL_INT_2_10_10_10_REV,
+        UInt2_10_10_10_Rev = GL_UNSIGNED_INT_2_10_10_10_REV,
         // And more...
     };
 
@@ -37,6 +41,9 @@ public:
     // Get size in bytes for each Type
     static unsigned int GetTypeSize(Type type);
 
+    // Packed types store all the components in a single value of GetTypeSize bytes
+    static bool IsPackedType(Type type);
+
     // Convert data to a span of bytes
     template <typename T>
     static std::span<std::byte> GetBytes(T& data);
@@ -2,6 +2,13 @@
 
 #include <ituGL/core/Color.h>
 #include <glad/glad.h>
+#include <functional>
+#include <vector>
+
+// KHR_parallel_shader_compile is not part of the loaded GL version, so its enum is defined here
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
 
 class Window;
 struct GLFWwindow;
@@ -26,6 +33,25 @@ public:
     // Set the window that OpenGL will use for rendering
     void SetCurrentWindow(Window &window);
 
+    // Check if the context supports an extension
+    bool IsExtensionSupported(const char* extension) const;
+
+    // If supported, shaders and programs compile in driver threads, and GL_COMPLETION_STATUS_KHR can be queried
+    inline bool IsParallelShaderCompileSupported() const { return m_parallelShaderCompileSupported; }
+
+    // If supported, several indexed drawcalls can be read from a buffer by glMultiDrawElementsIndirect
+    inline bool IsMultiDrawIndirectSupported() const { return m_multiDrawIndirectSupported; }
+
+    // If supported, buffers can have immutable storage that stays mapped while OpenGL uses it, see StreamingBuffer
+    inline bool IsBufferStorageSupported() const { return m_bufferStorageSupported; }
+
+    // If supported, objects are created and edited with direct state access, without binding them first
+    // Otherwise, they must be bound before calling the methods that change them
+    inline bool IsDirectStateAccessSupported() const { return m_directStateAccessSupported; }
+
+    // If supported, textures can have immutable storage, with all their levels allocated at once
+    inline bool IsTextureStorageSupported() const { return m_textureStorageSupported; }
+
     Window& GetCurrentWindow();
 
     // Set the dimensions of the viewport
@@ -54,12 +80,28 @@ public:
     // enable / disable v-sync
     void SetVSyncEnabled(bool enabled);
 
+    // Add a function to be called when the framebuffer of the window changes size, after updating the viewport
+    using FramebufferResizedCallback = std::function<void(GLsizei width, GLsizei height)>;
+    void AddFramebufferResizedCallback(const FramebufferResizedCallback& callback);
+
 private:
     // Has a context been loaded? We use the context of the current window
     bool m_contextLoaded;
 
+    bool m_parallelShaderCompileSupported;
+
+    bool m_multiDrawIndirectSupported;
+
+    bool m_bufferStorageSupported;
+
+    bool m_directStateAccessSupported;
+
+    bool m_textureStorageSupported;
+
     Window* m_window;
 
+    std::vector<FramebufferResizedCallback> m_framebufferResizedCallbacks;
+
 private:
     // Singleton instance
     static DeviceGL* m_instance;
@@ -28,6 +28,9 @@ public:
     // An object is only valid if its handle is not null
     inline bool IsValid() const { return m_handle != NullHandle; }
 
+    // Check if objects are created and edited with direct state access. If not, they must be bound to be edited
+    static bool HasDirectStateAccess();
+
     // Binding = Setting this object as the current one, so we can perform operations on it without passing it as an argument every time
     // Each type of object will use a different function to Bind, so we leave it as a pure virtual function
     virtual void Bind() const = 0;
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ituGL/core/Object.h>
+
+// OpenGL object that encapsulates a query, to get information from the GPU asynchronously
+class QueryObject : public Object
+{
+public:
+    // Query target: What the query will measure
+    enum Target : GLenum
+    {
+        // Time in nanoseconds between Begin and End
+        TimeElapsed = GL_TIME_ELAPSED,
+        // Number of samples that pass the depth test
+        SamplesPassed = GL_SAMPLES_PASSED,
+        // If any sample passes the depth test
+        AnySamplesPassed = GL_ANY_SAMPLES_PASSED,
+        // Number of primitives generated by the vertex (or geometry) shader
+        PrimitivesGenerated = GL_PRIMITIVES_GENERATED,
+    };
+
+public:
+    QueryObject();
+    virtual ~QueryObject();
+
+    // (C++) 8
+    // Move semantics
+    QueryObject(QueryObject&&) = default;
+    QueryObject& operator = (QueryObject&&) = default;
+
+    // Queries are not bound, they are active between Begin and End
+    void Bind() const override;
+
+    // Start and stop measuring. Only one query can be active for each target
+    void Begin(Target target);
+    void End();
+
+    // Check if the result of the last measure can be read without waiting for the GPU
+    bool IsResultAvailable() const;
+
+    // Get the result of the last measure. Waits for the GPU if it is not available yet
+    GLuint64 GetResult() const;
+
+private:
+    // Target of the active query, GL_NONE if it is not active
+    GLenum m_activeTarget;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <ituGL/core/BufferObject.h>
+#include <algorithm>
+#include <vector>
+#include <span>
+
+// Buffer for data that changes every frame, split in a ring of regions, one for each frame in flight
+// Each frame writes to its own region while the GPU reads the previous ones, and a fence tells when a region is free again
+// With buffer storage the whole buffer stays mapped, and writing is a plain copy to memory
+// Otherwise the data is kept in client memory and copied to the buffer on Flush
+class StreamingBuffer : public BufferObject
+{
+public:
+    // Part of the current region, returned by Allocate
+    struct Range
+    {
+        // Memory where the data is written. Empty if the region was full
+        std::span<std::byte> data;
+        // Position of the data in the buffer, to be used as offset in the draw functions
+        size_t offset = 0;
+    };
+
+public:
+    StreamingBuffer(Target target, size_t frameSize, unsigned int frameCount = 3);
+    ~StreamingBuffer();
+
+    inline Target GetTarget() const override { return m_target; }
+
+    // Bind and unbind the target given in the constructor
+    void Bind() const override;
+    void Unbind() const;
+
+    // If true, the buffer is persistently mapped and Flush does nothing
+    inline bool IsPersistent() const { return !m_mappedData.empty(); }
+
+    inline size_t GetFrameSize() const { return m_frameSize; }
+    inline unsigned int GetFrameCount() const { return static_cast<unsigned int>(m_fences.size()); }
+
+    // Bytes of the current region already allocated
+    inline size_t GetUsedSize() const { return m_usedSize; }
+
+    // Times the CPU had to wait for the GPU to release a region. If it keeps growing, more frames are needed
+    inline unsigned int GetWaitCount() const { return m_waitCount; }
+
+    // Get space in the current region. The first allocation of a frame waits until the GPU is done with the region
+    Range Allocate(size_t size, size_t alignment = 4);
+
+    // Allocate space for the data and copy it. Returns false if it doesn't fit in the current region
+    template<typename T>
+    bool Write(std::span<const T> data, size_t& offset);
+
+    // Make the data written since the last flush visible to the GPU. Call it before the draws that read the data
+    void Flush();
+
+    // Fence the commands that read the current region, and move to the next one
+    void EndFrame();
+
+private:
+#ifndef NDEBUG
+    bool IsBound() const override;
+#endif
+
+    // Wait until the GPU has finished the commands that read the current region
+    void WaitForCurrentFrame();
+
+private:
+    Target m_target;
+
+    size_t m_frameSize;
+
+    // Region being written, and the bytes used in it
+    unsigned int m_frameIndex;
+    size_t m_usedSize;
+
+    // Bytes of the region already copied to the buffer, only without persistent mapping
+    size_t m_flushedSize;
+
+    // Fence after the last commands that used each region. Null if it has not been used since
+    std::vector<GLsync> m_fences;
+
+    // Whole buffer, if it is persistently mapped
+    std::span<std::byte> m_mappedData;
+
+    // Data of the current region, if the buffer is not mapped
+    std::vector<std::byte> m_stagingData;
+
+    unsigned int m_waitCount;
+};
+
+template<typename T>
+bool StreamingBuffer::Write(std::span<const T> data, size_t& offset)
+{
+    Range range = Allocate(data.size_bytes(), alignof(T));
+    if (range.data.empty())
+    {
+        return false;
+    }
+    std::span<const std::byte> bytes = std::as_bytes(data);
+    std::copy(bytes.begin(), bytes.end(), range.data.begin());
+    offset = range.offset;
+    return true;
+}
@@ -23,6 +23,18 @@ public:
         TriangleStripAdjacency = GL_TRIANGLE_STRIP_ADJACENCY,
         Patches = GL_PATCHES
     };
+
+    // Parameters of an indexed drawcall, with the layout that glMultiDrawElementsIndirect reads from the buffer
+    struct IndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        // In elements, not in bytes
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
 public:
     Drawcall();
     Drawcall(Primitive primitive, GLsizei count, GLint first = 0);
@@ -38,6 +50,20 @@ public:
 
     void SetInstanceCount(GLuint instanceCount);
 
+    // Added to the elements before fetching the vertices, or to the first vertex without EBO
+    // Lets several meshes share the same buffers, each one with elements relative to its own vertices
+    inline GLint GetBaseVertex() const { return m_baseVertex; }
+    inline void SetBaseVertex(GLint baseVertex) { m_baseVertex = baseVertex; }
+
+    inline Primitive GetPrimitive() const { return m_primitive; }
+    inline GLint GetFirst() const { return m_first; }
+    inline GLsizei GetCount() const { return m_count; }
+    inline Data::Type GetEboType() const { return m_eboType; }
+    inline const InstancingParam& GetInstancing() const { return m_instancing; }
+
+    // Command to draw the same elements indirectly. Only for drawcalls with EBO
+    IndirectCommand GetIndirectCommand() const;
+
 private:
     // Type of primitive to be rendered
     Primitive m_primitive;
@@ -52,4 +78,7 @@ private:
     Data::Type m_eboType;
 
     InstancingParam m_instancing;
+
+    // Offset of the vertices in the VBO, in vertices
+    GLint m_baseVertex;
 };
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <ituGL/geometry/VertexBufferObject.h>
+#include <ituGL/geometry/ElementBufferObject.h>
+#include <ituGL/geometry/VertexArrayObject.h>
+#include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/shader/ShaderProgram.h>
+#include <ituGL/utils/FreeListAllocator.h>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <span>
+
+// Large vertex and element buffers shared by many meshes, with a VAO for each vertex format
+// Meshes get ranges of the buffers and draw them with a base vertex, so meshes with the same format bind the same VAO
+// Vertex data is interleaved. When the buffers of a format are full, a new page is added with another set
+class GeometryHeap
+{
+public:
+    class Allocation;
+
+    // Maps vertex attribute semantics with their location on a shader program, as in Mesh
+    using SemanticMap = std::unordered_map<VertexAttribute::Semantic, ShaderProgram::Location>;
+
+public:
+    // Sizes in bytes of the buffers of each page. Pages with data larger than that get the size of the data
+    GeometryHeap(size_t vertexPageSize = 16 << 20, size_t elementPageSize = 8 << 20);
+
+    GeometryHeap(const GeometryHeap&) = delete;
+    void operator = (const GeometryHeap&) = delete;
+
+    // Copy the data to the first page with the same format and attribute locations, and free space for it
+    // Elements are relative to the first vertex of the data. Without element data, the range is drawn as arrays
+    Allocation Allocate(const VertexFormat& vertexFormat, std::span<const GLubyte> vertexData,
+        std::span<const GLubyte> elementData, Data::Type elementType, const SemanticMap& locations = SemanticMap());
+
+    inline unsigned int GetPageCount() const { return static_cast<unsigned int>(m_pages.size()); }
+
+    // Bytes reserved in the buffers of all the pages, and the part of them that is allocated
+    size_t GetCapacity() const;
+    size_t GetAllocatedSize() const;
+
+private:
+    // Buffers and VAO of one vertex format. Vertices are allocated by vertex, elements by byte
+    struct Page
+    {
+        std::string formatKey;
+        size_t vertexSize;
+
+        VertexBufferObject vbo;
+        ElementBufferObject ebo;
+        VertexArrayObject vao;
+
+        FreeListAllocator vertexAllocator;
+        FreeListAllocator elementAllocator;
+    };
+
+    // Add a page for the format, with buffers of at least the default sizes
+    Page& AddPage(const std::string& formatKey, const VertexFormat& vertexFormat, const SemanticMap& locations,
+        size_t vertexDataSize, size_t elementDataSize);
+
+    // Get the vertex and element ranges in the page. Returns false, without allocating any, if one of them doesn't fit
+    static bool AllocateRanges(Page& page, size_t vertexCount, size_t elementDataSize, size_t elementAlignment,
+        size_t& vertexOffset, size_t& elementOffset);
+
+    // Return the ranges of the allocation to its page
+    void Free(const Allocation& allocation);
+
+    // Identifies the VAO setup: attribute types and their locations
+    static std::string GetFormatKey(const VertexFormat& vertexFormat, const SemanticMap& locations);
+
+private:
+    size_t m_vertexPageSize;
+    size_t m_elementPageSize;
+
+    // Pages are never removed, so their indices and VAOs stay valid
+    std::vector<std::unique_ptr<Page>> m_pages;
+};
+
+// Ranges of a page given to a mesh. They return to the heap when the allocation is destroyed, so the heap must outlive it
+class GeometryHeap::Allocation
+{
+public:
+    Allocation();
+    ~Allocation();
+
+    Allocation(const Allocation&) = delete;
+    void operator = (const Allocation&) = delete;
+
+    Allocation(Allocation&& allocation) noexcept;
+    Allocation& operator = (Allocation&& allocation) noexcept;
+
+    inline bool IsValid() const { return m_heap != nullptr; }
+
+    // VAO of the page, shared with the other allocations of the same format
+    const VertexArrayObject& GetVertexArray() const;
+
+    // Index of the first vertex in the page, to be added to the elements
+    inline GLint GetBaseVertex() const { return static_cast<GLint>(m_vertexOffset); }
+    inline GLsizei GetVertexCount() const { return static_cast<GLsizei>(m_vertexCount); }
+
+    // Bytes of the vertex buffer of the page used by the vertices
+    size_t GetVertexDataSize() const;
+
+    // Position in bytes of the element data in the element buffer of the page. Type None if there are no elements
+    inline GLint GetElementOffset() const { return static_cast<GLint>(m_elementOffset); }
+    inline GLsizei GetElementDataSize() const { return static_cast<GLsizei>(m_elementSize); }
+    inline Data::Type GetElementType() const { return m_elementType; }
+
+private:
+    friend class GeometryHeap;
+
+    GeometryHeap* m_heap;
+    unsigned int m_pageIndex;
+
+    size_t m_vertexOffset;
+    size_t m_vertexCount;
+    size_t m_elementOffset;
+    size_t m_elementSize;
+    Data::Type m_elementType;
+};
@@ -5,6 +5,7 @@
 #include <ituGL/geometry/VertexArrayObject.h>
 #include <ituGL/geometry/VertexAttribute.h>
 #include <ituGL/geometry/Drawcall.h>
+#include <ituGL/geometry/GeometryHeap.h>
 #include <ituGL/shader/ShaderProgram.h>
 #include <vector>
 #include <unordered_map>
@@ -124,6 +125,18 @@ public:
         TIterator instanceIt, const TIterator instanceItEnd,
         const SemanticMap& locations = SemanticMap());
 
+    // Adds interleaved vertex data and element data to a range of the geometry heap, instead of a new VBO and EBO
+    // Returns the index of the range, for the submeshes that draw it. The heap must outlive the mesh
+    unsigned int AddHeapData(GeometryHeap& heap, const VertexFormat& vertexFormat, std::span<const GLubyte> vertexData,
+        std::span<const GLubyte> elementData, Data::Type elementType, const SemanticMap& locations = SemanticMap());
+
+    // Adds a new submesh that draws part of a heap range, with the VAO of the heap and the range as base vertex
+    // first is in bytes for elements, as in the other submeshes, and in vertices without elements. Both relative to the range
+    unsigned int AddHeapSubmesh(unsigned int heapDataIndex, Drawcall::Primitive primitive, GLint first, GLsizei count);
+
+    inline unsigned int GetHeapDataCount() const { return static_cast<unsigned int>(m_heapData.size()); }
+    inline const GeometryHeap::Allocation& GetHeapData(unsigned int heapDataIndex) const { return m_heapData[heapDataIndex]; }
+
     inline unsigned int GetVertexBufferCount() const { return static_cast<unsigned int>(m_vbos.size()); }
     inline const VertexBufferObject& GetVertexBuffer(unsigned int vboIndex) const { return m_vbos[vboIndex]; }
 
@@ -134,7 +147,7 @@ public:
     inline const VertexArrayObject& GetVertexArray(unsigned int vaoIndex) const { return m_vaos[vaoIndex]; }
 
     inline unsigned int GetSubmeshCount() const { return static_cast<unsigned int>(m_submeshes.size()); }
-    inline const VertexArrayObject& GetSubmeshVertexArray(unsigned int submeshIndex) const { return m_vaos[m_submeshes[submeshIndex].vaoIndex]; }
+    const VertexArrayObject& GetSubmeshVertexArray(unsigned int submeshIndex) const;
     inline const Drawcall& GetSubmeshDrawcall(unsigned int submeshIndex) const { return m_submeshes[submeshIndex].drawcall; }
 
     // Draws a submesh
@@ -145,10 +158,12 @@ public:
 private:
 
     // Helper structure that contains a drawcall and its VAO to be bound
+    // Submeshes in the geometry heap use the VAO of their heap range instead
     struct Submesh
     {
         unsigned int vaoIndex;
         Drawcall drawcall;
+        int heapDataIndex = -1;
     };
 
 private:
@@ -163,7 +178,11 @@ private:
     inline Submesh& GetSubmesh(unsigned int submeshIndex) { return m_submeshes[submeshIndex]; }
 
     // Set a vertex attribute in a VAO, using the specified layout, and increases the location index according to the size of the attribute
-    void SetupVertexAttribute(VertexArrayObject& vao, const VertexAttribute::Layout& attributeLayout, GLuint& location, const SemanticMap& locations, bool instanced = false);
+    void SetupVertexAttribute(VertexArrayObject& vao, const VertexBufferObject& vbo, const VertexAttribute::Layout& attributeLayout,
+        GLuint& location, const SemanticMap& locations, bool instanced = false);
+
+    // Set the EBO of the VAO, binding them only if there is no direct state access
+    void SetElementBuffer(unsigned int vaoIndex, unsigned int eboIndex);
 
 private:
     // All the VBOs used in this mesh
@@ -177,6 +196,9 @@ private:
 
     // Submeshes contained in this mesh
     std::vector<Submesh> m_submeshes;
+
+    // Ranges of the geometry heap used in this mesh
+    std::vector<GeometryHeap::Allocation> m_heapData;
 };
 
 template<typename T>
@@ -184,9 +206,16 @@ unsigned int Mesh::AddVertexData(std::span<const T> vertices)
 {
     unsigned int vboIndex = GetVertexBufferCount();
     VertexBufferObject& vbo = m_vbos.emplace_back();
-    vbo.Bind();
+    bool bindBuffer = !Object::HasDirectStateAccess();
+    if (bindBuffer)
+    {
+        vbo.Bind();
+    }
     vbo.AllocateData<T>(vertices);
-    vbo.Unbind();
+    if (bindBuffer)
+    {
+        vbo.Unbind();
+    }
     return vboIndex;
 }
 
@@ -195,9 +224,16 @@ unsigned int Mesh::AddElementData(std::span<const T> elements)
 {
     unsigned int index = GetElementBufferCount();
     ElementBufferObject& ebo = m_ebos.emplace_back();
-    ebo.Bind();
+    bool bindBuffer = !Object::HasDirectStateAccess();
+    if (bindBuffer)
+    {
+        ebo.Bind();
+    }
     ebo.AllocateData(elements);
-    ebo.Unbind();
+    if (bindBuffer)
+    {
+        ebo.Unbind();
+    }
     return index;
 }
 
@@ -207,19 +243,27 @@ unsigned int Mesh::AddVertexArray(unsigned int vboIndex, TIterator& it, const TI
     unsigned int vaoIndex = AddVertexArray();
 
     VertexArrayObject& vao = GetVertexArray(vaoIndex);
-    vao.Bind();
+
+    // Without direct state access, the attributes are set on the bound VAO
+    bool bindVertexArray = !Object::HasDirectStateAccess();
+    if (bindVertexArray)
+    {
+        vao.Bind();
+    }
 
     GLuint location = 0;
     const VertexBufferObject& vbo = GetVertexBuffer(vboIndex);
-    vbo.Bind();
     while (it != itEnd)
     {
-        SetupVertexAttribute(vao, *it, location, locations);
+        SetupVertexAttribute(vao, vbo, *it, location, locations);
         it++;
     }
 
-    VertexBufferObject::Unbind();
-    VertexArrayObject::Unbind();
+    if (bindVertexArray)
+    {
+        VertexBufferObject::Unbind();
+        VertexArrayObject::Unbind();
+    }
 
     return vaoIndex;
 }
@@ -232,27 +276,33 @@ unsigned int Mesh::AddVertexArray(
     unsigned int vaoIndex = AddVertexArray();
 
     VertexArrayObject& vao = GetVertexArray(vaoIndex);
-    vao.Bind();
+
+    bool bindVertexArray = !Object::HasDirectStateAccess();
+    if (bindVertexArray)
+    {
+        vao.Bind();
+    }
 
     GLuint location = 0;
     const VertexBufferObject& vbo = GetVertexBuffer(vboIndex);
-    vbo.Bind();
     while (it != itEnd)
     {
-        SetupVertexAttribute(vao, *it, location, locations);
+        SetupVertexAttribute(vao, vbo, *it, location, locations);
         it++;
     }
 
     const auto& instanceVbo = GetVertexBuffer(instanceVboIndex);
-    instanceVbo.Bind();
     while (instanceIt != instanceItEnd)
     {
-        SetupVertexAttribute(vao, *instanceIt, location, locations, true);
+        SetupVertexAttribute(vao, instanceVbo, *instanceIt, location, locations, true);
         instanceIt++;
     }
 
-    VertexBufferObject::Unbind();
-    VertexArrayObject::Unbind();
+    if (bindVertexArray)
+    {
+        VertexBufferObject::Unbind();
+        VertexArrayObject::Unbind();
+    }
 
     return vaoIndex;
 }
@@ -262,8 +312,13 @@ unsigned int Mesh::AddVertexArray(std::span<unsigned int> vboIndices, TIterator&
 {
     unsigned int vaoIndex = AddVertexArray();
 
-    const VertexArrayObject& vao = GetVertexArray(vaoIndex);
-    vao.Bind();
+    VertexArrayObject& vao = GetVertexArray(vaoIndex);
+
+    bool bindVertexArray = !Object::HasDirectStateAccess();
+    if (bindVertexArray)
+    {
+        vao.Bind();
+    }
 
     GLuint location = 0;
     int i = 0;
@@ -273,16 +328,17 @@ unsigned int Mesh::AddVertexArray(std::span<unsigned int> vboIndices, TIterator&
         if (i < vboIndices.size() && vboIndex != vboIndices[i])
         {
             vboIndex = vboIndices[i];
-            VertexBufferObject& vbo = m_vbos[vboIndex];
-            vbo.Bind();
             i++;
         }
-        SetupVertexAttribute(vao, *it, location, locations);
+        SetupVertexAttribute(vao, m_vbos[vboIndex], *it, location, locations);
         it++;
     }
 
-    VertexBufferObject::Unbind();
-    VertexArrayObject::Unbind();
+    if (bindVertexArray)
+    {
+        VertexBufferObject::Unbind();
+        VertexArrayObject::Unbind();
+    }
 
     return vaoIndex;
 }
@@ -312,14 +368,7 @@ unsigned int Mesh::AddSubmesh(Drawcall::Primitive primitive, int firstElement, i
 {
     unsigned int vaoIndex = AddVertexArray(vboIndex, it, itEnd, locations);
 
-    VertexArrayObject& vao = GetVertexArray(vaoIndex);
-    vao.Bind();
-
-    const ElementBufferObject& ebo = GetElementBuffer(eboIndex);
-    ebo.Bind();
-
-    VertexArrayObject::Unbind();
-    ElementBufferObject::Unbind();
+    SetElementBuffer(vaoIndex, eboIndex);
 
     return AddSubmesh(vaoIndex, primitive, firstElement, elementCount, elementType);
 }
@@ -331,14 +380,7 @@ unsigned int Mesh::AddSubmesh(Drawcall::Primitive primitive, int firstElement, i
 {
     unsigned int vaoIndex = AddVertexArray(vboIndex, it, itEnd, instanceVboIndex, instanceIt, instanceItEnd, locations);
 
-    VertexArrayObject& vao = GetVertexArray(vaoIndex);
-    vao.Bind();
-
-    const ElementBufferObject& ebo = GetElementBuffer(eboIndex);
-    ebo.Bind();
-
-    VertexArrayObject::Unbind();
-    ElementBufferObject::Unbind();
+    SetElementBuffer(vaoIndex, eboIndex);
 
     return AddSubmesh(vaoIndex, primitive, firstElement, elementCount, elementType, instancing);
 }
@@ -350,14 +392,7 @@ unsigned int Mesh::AddSubmesh(Drawcall::Primitive primitive, int firstElement, i
 {
     unsigned int vaoIndex = AddVertexArray(vboIndices, it, itEnd, locations);
 
-    VertexArrayObject& vao = m_vaos[vaoIndex];
-    vao.Bind();
-
-    ElementBufferObject& ebo = m_ebos[eboIndex];
-    ebo.Bind();
-
-    VertexArrayObject::Unbind();
-    ElementBufferObject::Unbind();
+    SetElementBuffer(vaoIndex, eboIndex);
 
     return AddSubmesh(vaoIndex, primitive, firstElement, elementCount, elementType);
 }
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+// Reorders the triangles and vertices of indexed triangle lists, so that they make better use of the GPU
+// All the functions work on 32-bit indices. Positions are read as 3 floats at the start of each vertex
+class MeshOptimizer
+{
+public:
+    // Vertex shader invocations, measured with a FIFO cache of transformed vertices
+    struct VertexCacheStatistics
+    {
+        unsigned int triangleCount = 0;
+        unsigned int vertexCount = 0;
+        unsigned int transformedVertexCount = 0;
+
+        // Average cache miss ratio: vertices transformed per triangle. From 3 (no reuse) to around 0.5 for regular grids
+        inline float GetACMR() const { return triangleCount ? static_cast<float>(transformedVertexCount) / triangleCount : 0.0f; }
+
+        // Average transformed vertex ratio: times that each vertex is transformed. 1 is the best possible
+        inline float GetATVR() const { return vertexCount ? static_cast<float>(transformedVertexCount) / vertexCount : 0.0f; }
+
+        // Add the counts of another mesh
+        VertexCacheStatistics& operator += (const VertexCacheStatistics& statistics);
+    };
+
+public:
+    // Reorder the triangles to reuse the vertices recently transformed, with Forsyth's linear-speed algorithm
+    // Vertices are scored by their position in a simulated LRU cache and by their remaining triangles
+    static void OptimizeVertexCache(std::span<unsigned int> indices, unsigned int vertexCount);
+
+    // Reorder clusters of triangles, so that the ones facing outwards are drawn first and occlude the rest
+    // Call it after OptimizeVertexCache. The clusters are split where the order already restarts the vertex cache,
+    // and where their ACMR is below threshold times the original, so ACMR grows by the threshold at most
+    static void OptimizeOverdraw(std::span<unsigned int> indices, std::span<const std::byte> vertexData, std::size_t vertexStride,
+        float threshold = 1.05f);
+
+    // Move the vertices in the order they are first used by the triangles, updating the indices, so that vertex fetches
+    // are close in memory. Unused vertices are removed. Returns the number of vertices used, at the start of the data
+    static unsigned int OptimizeVertexFetch(std::span<unsigned int> indices, std::span<std::byte> vertexData, std::size_t vertexStride);
+
+    // Count the vertex shader invocations of the triangles, with a FIFO cache of the size
+    static VertexCacheStatistics AnalyzeVertexCache(std::span<const unsigned int> indices, unsigned int vertexCount,
+        unsigned int cacheSize = 16);
+};
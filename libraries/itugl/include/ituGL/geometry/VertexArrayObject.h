@@ -3,6 +3,8 @@
 #include <ituGL/core/Object.h>
 
 class VertexAttribute;
+class VertexBufferObject;
+class ElementBufferObject;
 
 // Vertex Array Object (VAO) is an OpenGL Object that stores all of the state needed to supply vertex data
 // Data is provided as a set of VertexAttributes
@@ -25,8 +27,17 @@ public:
     // Sets what VertexAttribute is assigned to location, and how to access the data:
     // offset: where to start looking in the buffer
     // stride: how far each element is from the previous one. Default value 0 will use the attribute size
+    // The VAO and the VBO with the data must be bound
     void SetAttribute(GLuint location, const VertexAttribute& attribute, GLint offset, GLsizei stride = 0, bool instanced = false);
 
+    // Same, with the data in vbo. With direct state access, none of them need to be bound
+    // Otherwise the VAO must be bound, and the VBO is bound here
+    void SetAttribute(GLuint location, const VertexAttribute& attribute, const VertexBufferObject& vbo,
+        GLint offset, GLsizei stride = 0, bool instanced = false);
+
+    // Set the EBO used by the drawcalls with elements. Without direct state access, the VAO must be bound
+    void SetElementBuffer(const ElementBufferObject& ebo);
+
 #ifndef NDEBUG
     // Check if there is any VertexArrayObject currently bound
     inline static bool IsAnyBound() { return s_boundHandle != Object::NullHandle; }
@@ -31,8 +31,8 @@ public:
     inline bool IsNormalized() const { return m_normalized; }
     inline Semantic GetSemantic() const { return m_semantic; }
 
-    // Gets the size of the attribute
-    inline int GetSize() const { return Data::GetTypeSize(m_type) * m_components; }
+    // Gets the size of the attribute. Packed types have all the components in one value
+    inline int GetSize() const { return Data::GetTypeSize(m_type) * (Data::IsPackedType(m_type) ? 1 : m_components); }
 
     // Gets how many location indices the attribute needs (usually 1)
     int GetLocationSize() const;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <ituGL/texture/Texture2DObject.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <vector>
+#include <span>
+
+class Camera;
+class Light;
+
+// Splits the view frustum of a camera in a grid of clusters (froxels) and builds the list of lights affecting each one
+// Light data, cluster ranges and light indices are stored in textures, so the deferred shader can shade each pixel once
+class LightClusterGrid
+{
+public:
+    // dimensions: number of tiles in X and Y (screen space) and number of depth slices (exponential)
+    // maxLights: maximum number of lights stored in the grid, the rest are ignored
+    LightClusterGrid(glm::uvec3 dimensions = glm::uvec3(16, 9, 24), unsigned int maxLights = 1024);
+
+    // Assign the lights to the clusters of the camera frustum and upload the result to the textures
+    // Only perspective projections are supported
+    void Build(const Camera& camera, std::span<const Light* const> lights);
+
+    // Number of clusters in X, Y and depth
+    inline const glm::uvec3& GetDimensions() const { return m_dimensions; }
+
+    // Scale and bias to get the depth slice from the view depth: slice = log(depth) * scale + bias
+    inline const glm::vec2& GetDepthSliceParams() const { return m_depthSliceParams; }
+
+    // Number of lights stored in the light data texture after the last build
+    inline unsigned int GetLightCount() const { return m_lightCount; }
+
+    // RGBA32F, one row per light: color * intensity, position, direction, attenuation
+    inline const Texture2DObject& GetLightDataTexture() const { return m_lightDataTexture; }
+
+    // RG32UI, one texel per cluster: offset and count in the light index texture
+    inline const Texture2DObject& GetClusterTexture() const { return m_clusterTexture; }
+
+    // R32UI, light indices of all clusters, wrapped in rows of fixed width
+    inline const Texture2DObject& GetLightIndexTexture() const { return m_lightIndexTexture; }
+
+private:
+    // Bounding sphere of a light in view space. Radius is negative for lights without range
+    struct LightBounds
+    {
+        glm::vec3 center;
+        float radius;
+    };
+
+    // Axis aligned bounding box of a cluster in view space
+    struct ClusterBounds
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // Recompute the bounds of all the clusters, only when the projection changes
+    void UpdateClusterBounds(const glm::mat4& projMatrix);
+
+    // Assign the lights to the clusters in the range of slices
+    // Cluster offsets are relative to the start of the indices vector
+    void AssignLights(unsigned int sliceBegin, unsigned int sliceEnd, std::vector<unsigned int>& indices);
+
+    // Upload the light data, the cluster ranges and the light indices to the textures
+    void UpdateTextures();
+
+    // Check if a light touches a cluster
+    static bool Intersects(const LightBounds& light, const ClusterBounds& cluster);
+
+private:
+    glm::uvec3 m_dimensions;
+
+    unsigned int m_maxLights;
+
+    unsigned int m_lightCount;
+
+    // Projection used to compute the cluster bounds
+    glm::mat4 m_projMatrix;
+
+    glm::vec2 m_depthSliceParams;
+
+    std::vector<ClusterBounds> m_clusterBounds;
+
+    std::vector<LightBounds> m_lightBounds;
+
+    // 4 texels per light, see GetLightDataTexture()
+    std::vector<glm::vec4> m_lightData;
+
+    // 2 values per cluster: offset and count
+    std::vector<unsigned int> m_clusterData;
+
+    std::vector<unsigned int> m_lightIndices;
+
+    Texture2DObject m_lightDataTexture;
+    Texture2DObject m_clusterTexture;
+    Texture2DObject m_lightIndexTexture;
+
+    // Width of the light index texture
+    static const int s_lightIndexTextureWidth;
+};
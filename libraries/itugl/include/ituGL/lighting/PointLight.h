@@ -7,7 +7,8 @@
 class PointLight : public Light
 {
 public:
-    PointLight();
+    // Lights that don't cast shadows don't allocate shadow maps and have no render info
+    explicit PointLight(bool castShadows = true);
 
     Type GetType() const override;
 
@@ -34,6 +35,7 @@ private:
 private:
     glm::vec3 m_position;
     glm::vec2 m_attenuation;
+    bool m_castShadows;
     glm::ivec2 m_depthTextureResolution = glm::ivec2(10000);
     std::array<LightRenderInfo, 6> m_lightRenderInfo;
 };
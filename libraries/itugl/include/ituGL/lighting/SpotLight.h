@@ -8,7 +8,8 @@
 class SpotLight : public Light
 {
 public:
-    SpotLight();
+    // Lights that don't cast shadows don't allocate a shadow map and have no render info
+    explicit SpotLight(bool castShadows = true);
 
     Type GetType() const override;
 
@@ -46,6 +47,7 @@ private:
     glm::vec3 m_position;
     glm::vec3 m_direction;
     glm::vec4 m_attenuation;
+    bool m_castShadows;
     glm::ivec2 m_depthTextureResolution = glm::ivec2(10000);
     LightRenderInfo m_lightRenderInfo;
 };
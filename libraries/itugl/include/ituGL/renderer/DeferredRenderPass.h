@@ -4,26 +4,116 @@
 
 #include <ituGL/shader/ShaderProgram.h>
 #include <ituGL/geometry/Mesh.h>
+#include <glm/mat4x4.hpp>
+#include <unordered_map>
 #include <memory>
+#include <vector>
 
 class Texture2DObject;
+class FramebufferObject;
 class Material;
+class Light;
+class LightClusterGrid;
+class ShaderPermutationManager;
 
 class DeferredRenderPass: public RenderPass
 {
 public:
-    DeferredRenderPass(std::shared_ptr<Material> material);
+    // If a light cluster grid is provided, lights without shadows are assigned to the clusters
+    // and shaded in the first fullscreen pass, instead of rendering one pass per light
+    // If a light volume material is provided, point and spot lights rendered in their own pass are limited to
+    // the pixels inside their volume, using the stencil buffer. The light volume material must write gl_FragDepth
+    // with the "DepthTexture" value when "CopyDepth" is set, and gl_FragCoord.z otherwise
+    // The pass renders at the scaled render dimensions, and sets the "RenderScale" uniform to the scaled ratio
+    DeferredRenderPass(std::shared_ptr<Material> material, std::shared_ptr<LightClusterGrid> lightClusterGrid = nullptr,
+        std::shared_ptr<Material> lightVolumeMaterial = nullptr, std::shared_ptr<const FramebufferObject> targetFramebuffer = nullptr);
+
+    // Render each pass with a variant of the material, specialized with defines instead of uniforms
+    // The material from the constructor is not used then. Variants are selected with these defines, if declared:
+    // - SHADOW_MAP: the light of the pass has a shadow map
+    // - LIGHT_INDIRECT, CLUSTERED_LIGHTS: first pass, that adds the indirect light and the clustered lights
+    void SetPermutations(std::shared_ptr<ShaderPermutationManager> permutations);
+
+    // If disabled, lights are rendered without shadows, even if they have shadow maps
+    inline bool IsShadowMapEnabled() const { return m_shadowMapEnabled; }
+    inline void SetShadowMapEnabled(bool enabled) { m_shadowMapEnabled = enabled; }
 
     void Render() override;
 
 private:
+    // Locations of the uniforms set by the pass, that can be different in each material variant
+    struct MaterialLocations
+    {
+        // Program the locations were queried from
+        Object::Handle shaderProgramHandle;
+
+        ShaderProgram::Location shadowMapEnabled;
+        ShaderProgram::Location lightSpaceMatrix;
+        ShaderProgram::Location lightDepthTexture;
+        ShaderProgram::Location renderScale;
+
+        ShaderProgram::Location clusteredLightsEnabled;
+        ShaderProgram::Location clusterDimensions;
+        ShaderProgram::Location clusterDepthParams;
+        ShaderProgram::Location clusterLightDataTexture;
+        ShaderProgram::Location clusterTexture;
+        ShaderProgram::Location clusterLightIndexTexture;
+    };
+
     void InitializeMeshes();
 
+    // Get the material for a pass. The light is the one that the pass will render, if any
+    std::shared_ptr<Material> GetPassMaterial(bool first, const Light* light) const;
+
+    // Get the uniform locations of a material, queried the first time
+    const MaterialLocations& GetMaterialLocations(const Material& material);
+
+    // Use the material and set the uniforms that are the same for all its passes
+    void UseMaterial(const Material& material, const MaterialLocations& locations, bool first);
+
+    // Set the cluster textures and uniforms, with the clusters already built for the current camera
+    void SetupClusteredLights(const ShaderProgram& shaderProgram, const MaterialLocations& locations);
+
+    // Copy the depth of the G-buffer to the current framebuffer, so that light volumes can be tested against it
+    void CopyDepth();
+
+    // Get the mesh and world matrix for the volume of a light. Returns null if the light has no bounded volume
+    const Mesh* GetLightVolume(const Light& light, glm::mat4& worldMatrix) const;
+
+    // Mark in the stencil buffer the pixels inside the light volume
+    void RenderLightVolumeStencil(const Mesh& mesh, const glm::mat4& worldMatrix);
+
+    // Set the render states for fullscreen passes, light volumes stencil and light volumes shading
+    void SetFullscreenRenderStates(bool first);
+    void SetLightVolumeStencilRenderStates();
+    void SetLightVolumeRenderStates();
+
+    // Restore the states changed by this pass
+    void ResetRenderStates();
+
+    static void CreateSphereMesh(Mesh& mesh, unsigned int slices, unsigned int stacks);
+    static void CreateConeMesh(Mesh& mesh, unsigned int segments);
+
 private:
-    Mesh m_fullscreenMesh;
+    Mesh m_sphereMesh;
+    Mesh m_coneMesh;
 
     std::shared_ptr<Material> m_material;
 
-    ShaderProgram::Location m_lightSpaceMatrixLocation;
-    ShaderProgram::Location m_lightDepthTextureLocation;
+    std::shared_ptr<ShaderPermutationManager> m_permutations;
+    int m_shadowMapDefine;
+    int m_lightIndirectDefine;
+    int m_clusteredLightsDefine;
+
+    bool m_shadowMapEnabled;
+
+    std::unordered_map<const Material*, MaterialLocations> m_materialLocations;
+
+    std::shared_ptr<LightClusterGrid> m_lightClusterGrid;
+
+    // Lights rendered in separate passes (with shadows) and lights in the clusters
+    std::vector<const Light*> m_passLights;
+    std::vector<const Light*> m_clusteredLights;
+
+    std::shared_ptr<Material> m_lightVolumeMaterial;
 };
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ituGL/core/QueryObject.h>
+#include <array>
+
+// Controls the render scale to keep the GPU time of the frame inside a budget
+// The GPU time is measured with timer queries, read a few frames later to avoid waiting for the GPU
+class DynamicResolution
+{
+public:
+    // targetFrameTime: GPU time budget, in milliseconds
+    // minScale, maxScale: range of the render scale, applied to width and height
+    DynamicResolution(float targetFrameTime = 16.0f, float minScale = 0.5f, float maxScale = 1.0f);
+
+    // Start and stop measuring the GPU time of the frame. EndFrame updates the scale with the latest measure available
+    void BeginFrame();
+    void EndFrame();
+
+    // Current render scale. If disabled, it is always the max scale
+    float GetScale() const { return m_enabled ? m_scale : m_maxScale; }
+
+    bool IsEnabled() const { return m_enabled; }
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+    float GetTargetFrameTime() const { return m_targetFrameTime; }
+    void SetTargetFrameTime(float targetFrameTime) { m_targetFrameTime = targetFrameTime; }
+
+    float GetMinScale() const { return m_minScale; }
+    float GetMaxScale() const { return m_maxScale; }
+    void SetScaleRange(float minScale, float maxScale);
+
+    // Last GPU time measured, in milliseconds
+    float GetGPUFrameTime() const { return m_gpuFrameTime; }
+
+private:
+    void UpdateScale(float gpuFrameTime);
+
+private:
+    // Enough queries in flight to never wait for the result
+    static const int s_queryCount = 4;
+
+    std::array<QueryObject, s_queryCount> m_queries;
+    std::array<bool, s_queryCount> m_queryPending;
+
+    // Query used in the current frame
+    int m_queryIndex;
+
+    // If the query is active in the current frame
+    bool m_queryActive;
+
+    bool m_enabled;
+
+    float m_targetFrameTime;
+
+    float m_minScale;
+    float m_maxScale;
+
+    float m_scale;
+
+    float m_gpuFrameTime;
+};
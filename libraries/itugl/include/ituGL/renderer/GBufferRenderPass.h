@@ -9,22 +9,63 @@
 class GBufferRenderPass : public RenderPass
 {
 public:
-    GBufferRenderPass(int width, int height, int drawcallCollectionIndex = 0);
+    // Layout of the render targets. The shaders writing and reading the G-buffer must use the same layout
+    enum class Layout
+    {
+        // Albedo RGBA8, normal RGBA16 (xyz * 0.5 + 0.5, w = flag), specular RGB8 (AO, roughness, metalness)
+        Standard = 0,
+        // Albedo RGBA8 (rgb, AO), normal RG16 (octahedral), specular RG8 (roughness, metalness + flag)
+        PackedNormal16 = 1,
+        // Albedo RGBA8 (rgb, AO), normal RGBA8 (octahedral, roughness, metalness + flag). No specular texture
+        PackedNormal8 = 2,
+    };
+
+public:
+    GBufferRenderPass(int width, int height, Layout layout = Layout::Standard, int drawcallCollectionIndex = 0);
 
     void Render() override;
 
+    Layout GetLayout() const { return m_layout; }
+
+    // Reallocate the render targets, keeping the same texture objects
+    void Resize(int width, int height);
+
+    void GetDimensions(int& width, int& height) const { width = m_width; height = m_height; }
+
+    // Render first the depth of the materials with a depth shader, then shade them with depth test EQUAL
+    bool IsDepthPrePassEnabled() const { return m_depthPrePassEnabled; }
+    void SetDepthPrePassEnabled(bool enabled) { m_depthPrePassEnabled = enabled; }
+
+    // Count in the stencil buffer the fragments written for each pixel, see OverdrawRenderPass
+    bool IsOverdrawCountEnabled() const { return m_overdrawCountEnabled; }
+    void SetOverdrawCountEnabled(bool enabled) { m_overdrawCountEnabled = enabled; }
+
+    // Framebuffer with the render targets. Depth texture includes stencil
+    const FramebufferObject& GetFramebuffer() const { return m_framebuffer; }
+
     const std::shared_ptr<Texture2DObject> GetDepthTexture() const { return m_depthTexture; }
     const std::shared_ptr<Texture2DObject> GetAlbedoTexture() const { return m_albedoTexture; }
     const std::shared_ptr<Texture2DObject> GetNormalTexture() const { return m_normalTexture; }
+    // Null with Layout::PackedNormal8
     const std::shared_ptr<Texture2DObject> GetSpecularTexture() const { return m_specularTexture; }
 
 private:
     void InitTextures(int width, int height);
     void InitFramebuffer();
 
+    void RenderDepthPrePass();
+
 private:
     int m_drawcallCollectionIndex;
 
+    Layout m_layout;
+
+    int m_width;
+    int m_height;
+
+    bool m_depthPrePassEnabled;
+    bool m_overdrawCountEnabled;
+
     std::shared_ptr<Texture2DObject> m_depthTexture;
     std::shared_ptr<Texture2DObject> m_albedoTexture;
     std::shared_ptr<Texture2DObject> m_normalTexture;
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <ituGL/renderer/RenderPass.h>
+
+#include <ituGL/shader/ShaderProgram.h>
+
+class Material;
+
+// Debug view of the overdraw counted in the stencil buffer by GBufferRenderPass::SetOverdrawCountEnabled
+// The stencil of the source framebuffer is copied to the target, that must have the same dimensions and a stencil buffer
+// The material is drawn once per count, with the "OverdrawCount" uniform. "MaxOverdrawCount" is set to the last count,
+// that also includes all the pixels with higher counts
+class OverdrawRenderPass : public RenderPass
+{
+public:
+    OverdrawRenderPass(std::shared_ptr<Material> material, const FramebufferObject& sourceFramebuffer,
+        std::shared_ptr<const FramebufferObject> targetFramebuffer = nullptr, int maxOverdrawCount = 16);
+
+    void Render() override;
+
+    bool IsEnabled() const { return m_enabled; }
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+private:
+    std::shared_ptr<Material> m_material;
+
+    const FramebufferObject& m_sourceFramebuffer;
+
+    int m_maxOverdrawCount;
+
+    bool m_enabled;
+};
@@ -1,15 +1,21 @@
 #pragma once
 
+#include <memory>
+
 class Renderer;
+class FramebufferObject;
 
 class RenderPass
 {
 public:
-    RenderPass();
+    // The target framebuffer is bound before rendering the pass. If null, the default framebuffer is used
+    RenderPass(std::shared_ptr<const FramebufferObject> targetFramebuffer = nullptr);
     virtual ~RenderPass();
 
     virtual void Render() = 0;
 
+    std::shared_ptr<const FramebufferObject> GetTargetFramebuffer() const { return m_targetFramebuffer; }
+
 protected:
     Renderer& GetRenderer();
     const Renderer& GetRenderer() const;
@@ -20,4 +26,6 @@ private:
 
 private:
     Renderer* m_renderer;
+
+    std::shared_ptr<const FramebufferObject> m_targetFramebuffer;
 };
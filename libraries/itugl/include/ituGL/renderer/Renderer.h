@@ -3,6 +3,7 @@
 #include <ituGL/core/DeviceGL.h>
 #include <ituGL/renderer/RenderPass.h>
 #include <ituGL/geometry/Drawcall.h>
+#include <glm/vec2.hpp>
 #include <glm/mat4x4.hpp>
 #include <vector>
 #include <unordered_map>
@@ -17,6 +18,8 @@ class Material;
 class VertexArrayObject;
 class Drawcall;
 class Model;
+class Mesh;
+class StreamingBuffer;
 
 class Renderer
 {
@@ -67,10 +70,47 @@ public:
 
     void AddModel(const Model& model, const glm::mat4& worldMatrix);
 
-    void PrepareDrawcall(const DrawcallInfo& drawcallInfo);
+    // Use the material, the transforms and the VAO of the drawcall. Override flags are passed to Material::Use
+    void PrepareDrawcall(const DrawcallInfo& drawcallInfo, int overrideFlags = 0);
+
+    // Drawcalls at the start of the span that can be drawn in the same batch as the first one
+    // They share material, world matrix and VAO, and draw elements of the same type and primitive without instancing
+    // Returns only the first drawcall if batching is disabled
+    std::span<const DrawcallInfo> GetBatch(std::span<const DrawcallInfo> drawcalls) const;
+
+    // Draw all the drawcalls of a batch with a single multi-draw call. The VAO and the program must be set already
+    void DrawBatch(std::span<const DrawcallInfo> batch);
+
+    // Submeshes that can be batched are drawn with a single call, glMultiDrawElementsIndirect if supported
+    inline bool GetBatchingEnabled() const { return m_batchingEnabled; }
+    inline void SetBatchingEnabled(bool enabled) { m_batchingEnabled = enabled; }
+
+    // Number of batches drawn in the last frame, and the drawcalls they contained
+    inline unsigned int GetBatchCount() const { return m_lastBatchCount; }
+    inline unsigned int GetBatchedDrawcallCount() const { return m_lastBatchedDrawcallCount; }
 
     void SetLightingRenderStates(bool firstPass);
 
+    // Dimensions of the render targets used by the passes that support dynamic resolution
+    void GetRenderDimensions(int& width, int& height) const;
+    void SetRenderDimensions(int width, int height);
+
+    // Fraction of the render dimensions used by the scaled passes, in the range (0, 1]
+    float GetRenderScale() const { return m_renderScale; }
+    void SetRenderScale(float renderScale);
+
+    // Render dimensions with the render scale applied
+    void GetScaledRenderDimensions(int& width, int& height) const;
+
+    // Ratio between the scaled and the full render dimensions, to convert texture coordinates in the shaders
+    glm::vec2 GetScaledRenderRatio() const;
+
+    // Set the viewport to the scaled or full render dimensions. Does nothing if they were not set
+    void SetRenderViewport(bool scaled);
+
+    // Triangle covering the entire screen, with the vertices directly in clip coordinates
+    const Mesh& GetFullscreenMesh();
+
     void Render();
 
     const glm::mat4& GetWorldMatrix(int worldMatrixIndex) const;
@@ -78,6 +118,9 @@ public:
 private:
     void Reset();
 
+    // Copy the commands of the batch to the indirect buffer. Returns false if there is no room left this frame
+    bool WriteIndirectCommands(std::span<const DrawcallInfo> batch, size_t& offset);
+
 private:
     DeviceGL& m_device;
 
@@ -95,4 +138,26 @@ private:
     std::unordered_map<std::shared_ptr<const ShaderProgram>, UpdateLightsFunction> m_updateLightsFunctions;
 
     std::vector<std::unique_ptr<RenderPass>> m_passes;
+
+    int m_renderWidth;
+    int m_renderHeight;
+    float m_renderScale;
+
+    std::shared_ptr<Mesh> m_fullscreenMesh;
+
+    bool m_batchingEnabled;
+
+    // Commands of the current batch, and the buffer where they are streamed. Created on the first multi-draw
+    std::vector<Drawcall::IndirectCommand> m_indirectCommands;
+    std::shared_ptr<StreamingBuffer> m_indirectBuffer;
+
+    // Per-draw arrays for glMultiDrawElementsBaseVertex, when indirect drawing is not supported
+    std::vector<GLsizei> m_batchCounts;
+    std::vector<const void*> m_batchIndices;
+    std::vector<GLint> m_batchBaseVertices;
+
+    unsigned int m_batchCount;
+    unsigned int m_batchedDrawcallCount;
+    unsigned int m_lastBatchCount;
+    unsigned int m_lastBatchedDrawcallCount;
 };
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ituGL/renderer/RenderPass.h>
+
+#include <ituGL/shader/ShaderProgram.h>
+
+class Material;
+
+// Fullscreen pass that draws the area rendered by the scaled passes at the full render dimensions
+// The material reads its source texture and filters it, using the "RenderScale" uniform to find the rendered area
+class UpscaleRenderPass : public RenderPass
+{
+public:
+    UpscaleRenderPass(std::shared_ptr<Material> material, std::shared_ptr<const FramebufferObject> targetFramebuffer = nullptr);
+
+    void Render() override;
+
+private:
+    std::shared_ptr<Material> m_material;
+};
@@ -39,6 +39,9 @@ public:
 
     using ShadowShaderSetupFunction = std::function<void(const ShaderProgram&, const Light&, const glm::mat4&, const glm::mat4&)>;
 
+    // Arguments: shader program, view projection matrix of the camera and world matrix
+    using DepthShaderSetupFunction = std::function<void(const ShaderProgram&, const glm::mat4&, const glm::mat4&)>;
+
 public:
     Material();
     // Initialize with the shader program, will extract all the properties. Skip the names in filtered uniforms
@@ -112,6 +115,14 @@ public:
 
     [[nodiscard]] bool CastsShadows() const;
 
+    // Set the shader to use when rendering only depth from the camera, like in a depth pre-pass
+    // It must produce exactly the same depth as the main shader (see "invariant" in GLSL)
+    void SetDepthShader(std::shared_ptr<ShaderProgram> depthShaderProgram, DepthShaderSetupFunction setupFunction);
+
+    void UseDepthShader(const glm::mat4& viewProjMatrix, const glm::mat4& worldMatrix) const;
+
+    [[nodiscard]] bool HasDepthShader() const;
+
     // Use the shader program, set all uniforms, set depth properties, stencil properties, and blending
     // You can skip depth, stencil or blending using the override flags
     void Use(OverrideFlags overrideFlags = OverrideFlags::NoOverride) const;
@@ -167,6 +178,10 @@ private:
     std::shared_ptr<ShaderProgram> m_shadowShaderProgram;
 
     ShadowShaderSetupFunction m_shadowShaderSetupFunction;
+
+    std::shared_ptr<ShaderProgram> m_depthShaderProgram;
+
+    DepthShaderSetupFunction m_depthShaderSetupFunction;
 };
 
 // Different conditions for depth and stencil tests
@@ -47,6 +47,14 @@ public:
     // Compile the shader source code
     bool Compile();
 
+    // Start compiling the shader source code, without checking the result
+    // The driver can keep compiling in the background until the status is queried
+    void SubmitCompile();
+
+    // Check if the compilation has finished, without waiting for it
+    // Always true if the driver can't report it, and then querying the status waits for the compilation
+    bool IsCompileComplete() const;
+
     // Check if the shader has been successfully compiled
     bool IsCompiled() const;
 
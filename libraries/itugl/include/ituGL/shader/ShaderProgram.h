@@ -17,6 +17,9 @@
 #include <glm/mat4x4.hpp>
 
 #include <span>
+#include <string_view>
+#include <vector>
+#include <cstdint>
 
 class Shader;
 class TextureObject;
@@ -29,6 +32,22 @@ public:
     // Declare the type used for uniform locations
     using Location = GLint;
 
+    // Hash of a uniform name, to find uniforms without comparing strings
+    using NameHash = std::uint32_t;
+
+    // Uniform found when the program is linked
+    struct UniformInfo
+    {
+        // Hash of the name. Arrays use the name without "[0]"
+        NameHash nameHash;
+        Location location;
+        GLenum type;
+        // Number of elements, 1 if it is not an array
+        GLint size;
+        // Offset in its uniform block, -1 in the default block
+        GLint offset;
+    };
+
 public:
     ShaderProgram();
     virtual ~ShaderProgram();
@@ -71,9 +90,31 @@ public:
         return Build(vertexShader, fragmentShader, tesselationControlShader, &tesselationEvaluationShader, &geometryShader);
     }
 
+    // Attach and link vertex and fragment shaders, without checking the result
+    // Shaders don't need to be compiled yet. The driver can keep compiling and linking until the status is queried
+    void SubmitBuild(const Shader& vertexShader, const Shader& fragmentShader);
+
+    // Check if the linking has finished, without waiting for it
+    // Always true if the driver can't report it, and then querying the status waits for the linking
+    bool IsLinkComplete() const;
+
     // Check if shaders have been linked to create a valid program
     bool IsLinked() const;
 
+    // Allow getting the binary of the program once it is linked. Must be set before Build
+    void SetBinaryRetrievable(bool retrievable);
+
+    // Get the binary of a linked program. The format is specific to the driver
+    bool GetBinary(GLenum& format, std::vector<char>& binary) const;
+
+    // Get the size in bytes of the binary, as an estimate of the program memory
+    // Returns 0 while the linking is not complete, or if the binary is not retrievable
+    size_t GetBinarySize() const;
+
+    // Link the program from a binary returned by GetBinary, instead of building it from shaders
+    // Fails if the driver doesn't accept the binary anymore (different driver or version)
+    bool LoadBinary(GLenum format, std::span<const char> binary);
+
     // Get a string with linking error messages
     // The max length of the string returned is determined by the capacity of the span
     void GetLinkingErrors(std::span<char> errors) const;
@@ -84,6 +125,37 @@ public:
     // Find a uniform location by name
     Location GetUniformLocation(const char *name) const;
 
+    // Find a uniform location by the hash of its name. -1 if the uniform doesn't exist
+    Location GetUniformLocation(NameHash nameHash) const;
+
+    // Find a uniform by the hash of its name. Null if the uniform doesn't exist
+    const UniformInfo* FindUniform(NameHash nameHash) const;
+
+    // Get all the uniforms, sorted by name hash
+    std::span<const UniformInfo> GetUniforms() const;
+
+    // FNV-1a hash of a name. Evaluated at compile time for constant names
+    static constexpr NameHash HashName(std::string_view name)
+    {
+        NameHash hash = 2166136261u;
+        for (char c : name)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    // Hash of a uniform name as stored in the table, with the "[0]" of arrays removed
+    static constexpr NameHash HashUniformName(std::string_view name)
+    {
+        if (name.ends_with("[0]"))
+        {
+            name.remove_suffix(3);
+        }
+        return HashName(name);
+    }
+
     // Get how many uniforms exist in this shader program
     unsigned int GetUniformCount() const;
 
@@ -122,12 +194,21 @@ private:
         const Shader* tesselationControlShader, const Shader* tesselationEvaluationShader,
         const Shader* geometryShader);
 
+    // Attach all shaders provided for the rasterization pipeline
+    void AttachShaders(const Shader& vertexShader, const Shader& fragmentShader,
+        const Shader* tesselationControlShader, const Shader* tesselationEvaluationShader,
+        const Shader* geometryShader);
+
     // Attach a shader to be linked
     void AttachShader(const Shader& shader);
 
     // Link currently attached shaders
     bool Link();
 
+    // Build the table of uniforms, if it is not built yet for the current link
+    // Deferred until it is needed, so that asynchronous links are not waited for
+    void ReflectUniforms() const;
+
     // Helper template method for getting uniforms
     template<typename T>
     void GetUniform(Location location, std::span<T> value) const;
@@ -139,6 +220,10 @@ private:
     void SetUniforms(Location location, const T* values, GLsizei count) const;
 
 private:
+    // Uniforms of the linked program, sorted by name hash
+    mutable std::vector<UniformInfo> m_uniforms;
+    mutable bool m_uniformsReflected;
+
 #ifndef NDEBUG
     inline bool IsUsed() const { return s_usedHandle == GetHandle(); }
     static Handle s_usedHandle;
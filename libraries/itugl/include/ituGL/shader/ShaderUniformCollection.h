@@ -4,7 +4,6 @@
 #include <ituGL/texture/TextureObject.h>
 #include <ituGL/core/Data.h>
 #include <vector>
-#include <unordered_map>
 #include <unordered_set>
 #include <string>
 #include <memory>
@@ -25,14 +24,21 @@ public:
     std::shared_ptr<const ShaderProgram> GetShaderProgram() const;
 
     // Reset the material with a different shader
+    // Values of uniforms with the same name and type in both shaders are kept
     void ChangeShader(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms = NameSet());
 
+    // Extract the uniforms again after the shader program is rebuilt, as their locations can change
+    void RefreshUniforms();
+
     // Get the vertex attribute location by name
     ShaderProgram::Location GetAttributeLocation(const char* name) const;
 
     // Get the shader uniform location by name
     ShaderProgram::Location GetUniformLocation(const char* name) const;
 
+    // Get the shader uniform location by the hash of the name, see ShaderProgram::HashName
+    ShaderProgram::Location GetUniformLocation(ShaderProgram::NameHash nameHash) const;
+
     // Get uniform value for different types, using the name or the uniform location
     template<typename T>
     T GetUniformValue(const char* name) const;
@@ -80,6 +86,8 @@ private:
     // Struct to store a data property
     struct DataUniform
     {
+        // Hash of the uniform name, to find it again when the shader changes
+        ShaderProgram::NameHash nameHash;
         // Uniform location
         ShaderProgram::Location location;
         // Data type
@@ -95,6 +103,8 @@ private:
     // Struct to store a texture property
     struct TextureUniform
     {
+        // Hash of the uniform name, to find it again when the shader changes
+        ShaderProgram::NameHash nameHash;
         // Uniform location
         ShaderProgram::Location location;
         // Texture subtype
@@ -172,17 +182,15 @@ protected:
     // The shader program
     std::shared_ptr<ShaderProgram> m_shaderProgram;
 
+    // Names skipped when extracting the uniforms
+    NameSet m_filteredUniforms;
+
 private:
-    // The list of data properties
+    // The list of data properties, sorted by location
     std::vector<DataUniform> m_dataUniforms;
-    // The list of texture properties
+    // The list of texture properties, sorted by location
     std::vector<TextureUniform> m_textureUniforms;
 
-    // Map to find data properties in the data list
-    std::unordered_map<ShaderProgram::Location, int> m_locationDataIndex;
-    // Map to find texture properties in the texture list
-    std::unordered_map<ShaderProgram::Location, int> m_locationTextureIndex;
-
     // Buffers that store the values for data properties
     std::vector<int> m_intDataValues;
     std::vector<unsigned int> m_uintDataValues;
@@ -365,7 +373,6 @@ void ShaderUniformCollection::GetDataValues(ShaderProgram::Location location, st
 template<typename T>
 void ShaderUniformCollection::AddUniform(const DataUniform& uniform)
 {
-    m_locationDataIndex.insert(std::make_pair(uniform.location, static_cast<int>(m_dataUniforms.size())));
     m_dataUniforms.push_back(uniform);
 
     std::vector<T>& values = GetDataValues<T>();
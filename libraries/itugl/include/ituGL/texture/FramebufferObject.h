@@ -26,6 +26,7 @@ public:
     static void Unbind();
     static void Unbind(Target target);
 
+    // The framebuffer must be bound to the target, unless it is edited with direct state access
     void SetTexture(Target target, Attachment attachment, const Texture2DObject& texture, int level = 0);
 
     void SetDrawBuffers(std::span<const Attachment> attachments);
@@ -46,6 +47,8 @@ enum class FramebufferObject::Target : GLenum
 enum class FramebufferObject::Attachment : GLenum
 {
     Depth = GL_DEPTH_ATTACHMENT,
+    Stencil = GL_STENCIL_ATTACHMENT,
+    DepthStencil = GL_DEPTH_STENCIL_ATTACHMENT,
     Color0 = GL_COLOR_ATTACHMENT0,
     Color1 = GL_COLOR_ATTACHMENT1,
     Color2 = GL_COLOR_ATTACHMENT2,
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <ituGL/core/BufferObject.h>
+
+// Pixel Buffer Object (PBO) used as the source of texture uploads
+// While it is bound, the data pointer in SetImage and SetSubImage is an offset in the buffer, and the copy to the
+// texture can be done by the driver without blocking the caller
+class PixelUnpackBufferObject : public BufferObjectBase<BufferObject::PixelUnpackBuffer>
+{
+public:
+    PixelUnpackBufferObject();
+};
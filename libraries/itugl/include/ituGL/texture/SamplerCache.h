@@ -0,0 +1,53 @@
+#pragma once
+
+#include <ituGL/texture/SamplerObject.h>
+#include <memory>
+#include <vector>
+#include <array>
+
+// Shares a SamplerObject between all the textures that are sampled the same way
+// Filtering settings that apply to all of them, like anisotropy, are changed here instead of in each texture
+class SamplerCache
+{
+public:
+    // Sampling state that identifies a sampler
+    struct Desc
+    {
+        GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        GLenum magFilter = GL_LINEAR;
+        GLenum wrapS = GL_REPEAT;
+        GLenum wrapT = GL_REPEAT;
+        GLenum wrapR = GL_REPEAT;
+        // Only used with GL_CLAMP_TO_BORDER
+        std::array<GLfloat, 4> borderColor = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        bool operator == (const Desc&) const = default;
+    };
+
+public:
+    SamplerCache();
+
+    SamplerCache(const SamplerCache&) = delete;
+    void operator = (const SamplerCache&) = delete;
+
+    // Get the sampler with this state, creating it the first time
+    std::shared_ptr<const SamplerObject> GetSampler(const Desc& desc);
+
+    // Anisotropy of the samplers with mipmapped linear filtering. Changes the existing ones too
+    inline GLfloat GetMaxAnisotropy() const { return m_maxAnisotropy; }
+    void SetMaxAnisotropy(GLfloat maxAnisotropy);
+
+    inline unsigned int GetSamplerCount() const { return static_cast<unsigned int>(m_samplers.size()); }
+
+    void Clear();
+
+private:
+    // Samplers that filter between the mipmaps are the ones that get anisotropy
+    static bool UsesAnisotropy(const Desc& desc);
+
+private:
+    GLfloat m_maxAnisotropy;
+
+    // There are only a few different samplers, a linear search is enough
+    std::vector<std::pair<Desc, std::shared_ptr<SamplerObject>>> m_samplers;
+};
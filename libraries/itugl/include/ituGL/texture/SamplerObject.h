@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ituGL/texture/TextureObject.h>
+
+// OpenGL object with the sampling state of textures: filters, wrap modes, LOD range and border color
+// While it is bound to a texture unit, it replaces the parameters of the texture bound to the same unit
+// Parameters are set without binding the sampler
+class SamplerObject : public Object
+{
+public:
+    SamplerObject();
+    virtual ~SamplerObject();
+
+    // (C++) 8
+    // Move semantics
+    SamplerObject(SamplerObject&&) = default;
+    SamplerObject& operator = (SamplerObject&&) = default;
+
+    // Samplers are bound to texture units, with Bind(textureUnit)
+    void Bind() const override;
+
+    // Use the sampler for the textures bound to the unit, until it is unbound
+    void Bind(GLuint textureUnit) const;
+    // Go back to the parameters of the texture in the unit
+    static void Unbind(GLuint textureUnit);
+
+    // Same parameters as the textures, except the level range and swizzle, that are kept in the texture
+    void GetParameter(TextureObject::ParameterFloat pname, GLfloat& param) const;
+    void SetParameter(TextureObject::ParameterFloat pname, GLfloat param);
+
+    void GetParameter(TextureObject::ParameterEnum pname, GLenum& param) const;
+    void SetParameter(TextureObject::ParameterEnum pname, GLenum param);
+
+    void GetParameter(TextureObject::ParameterColor pname, std::span<GLfloat, 4> params) const;
+    void SetParameter(TextureObject::ParameterColor pname, std::span<const GLfloat, 4> params);
+
+    // Number of samples taken along the axis of anisotropy, 1 to disable it. Clamped to the maximum supported
+    void SetMaxAnisotropy(GLfloat maxAnisotropy);
+
+    // Largest value for SetMaxAnisotropy. 1 if anisotropic filtering is not supported
+    static GLfloat GetMaxSupportedAnisotropy();
+};
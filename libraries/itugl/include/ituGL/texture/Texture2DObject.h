@@ -9,7 +9,22 @@ class Texture2DObject : public TextureObjectBase<TextureObject::Texture2D>
 public:
     Texture2DObject();
 
-    // Initialize the texture2D with a specific format
+    // The moved texture is left without handle and storage
+    Texture2DObject(Texture2DObject&& texture2D) noexcept;
+    Texture2DObject& operator = (Texture2DObject&& texture2D) noexcept;
+
+    // Allocate immutable storage for all the levels. Size and format can't change after, only the contents
+    // Unsized formats are replaced with GetSizedInternalFormat, and generic compressed formats are not allowed
+    // The level range is limited to the allocated ones, so a single level is complete with any filter
+    void SetStorage(GLsizei levelCount, GLsizei width, GLsizei height, InternalFormat internalFormat);
+
+    // Check if the storage was allocated with SetStorage. SetImage can't be used on it
+    inline bool HasImmutableStorage() const { return m_storageLevelCount > 0; }
+
+    // Number of levels of a full mip chain for the size, down to 1x1
+    static GLsizei GetMipmapLevelCount(GLsizei width, GLsizei height);
+
+    // Initialize the texture2D with a specific format. The texture must be bound, also with direct state access
     void SetImage(GLint level,
         GLsizei width, GLsizei height,
         Format format, InternalFormat internalFormat);
@@ -20,6 +35,31 @@ public:
         GLsizei width, GLsizei height,
         Format format, InternalFormat internalFormat,
         std::span<const T> data, Data::Type type = Data::Type::None);
+
+    // Initialize the texture2D with data in a block compressed format, like InternalFormatBC5
+    void SetCompressedImage(GLint level,
+        GLsizei width, GLsizei height,
+        InternalFormat internalFormat, std::span<const std::byte> data);
+
+    // Copy a region of the image from the PixelUnpackBufferObject that is bound, starting at bufferOffset bytes
+    // The image must have been initialized with SetImage
+    void SetSubImage(GLint level, GLint x, GLint y,
+        GLsizei width, GLsizei height,
+        Format format, Data::Type type, size_t bufferOffset = 0);
+
+    // Copy a region of the image from client memory. There must not be a PixelUnpackBufferObject bound
+    void SetSubImage(GLint level, GLint x, GLint y,
+        GLsizei width, GLsizei height,
+        Format format, Data::Type type, std::span<const std::byte> data);
+
+    // Copy a region of a block compressed level, aligned to the blocks. The storage must have the same format
+    void SetCompressedSubImage(GLint level, GLint x, GLint y,
+        GLsizei width, GLsizei height,
+        InternalFormat internalFormat, std::span<const std::byte> data);
+
+private:
+    // Levels allocated with SetStorage, 0 if the storage is mutable
+    GLsizei m_storageLevelCount;
 };
 
 // Set image with data in bytes
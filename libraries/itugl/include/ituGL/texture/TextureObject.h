@@ -1,8 +1,11 @@
 #pragma once
 
 #include <ituGL/core/Object.h>
+#include <memory>
 #include <span>
 
+class SamplerObject;
+
 // Abstract OpenGL object that encapsulates a Texture
 // There are different subtypes depending on the target
 class TextureObject : public Object
@@ -25,13 +28,14 @@ public:
     enum class ParameterColor : GLenum;
 
 public:
-    TextureObject();
+    // The target is only needed to create the texture with direct state access
+    TextureObject(Target target);
     virtual ~TextureObject();
 
     // (C++) 8
     // Move semantics
-    TextureObject(TextureObject&&) = default;
-    TextureObject& operator = (TextureObject&&) = default;
+    TextureObject(TextureObject&& texture) noexcept;
+    TextureObject& operator = (TextureObject&& texture) noexcept;
 
     // (C++) 3
     // Use the same Bind method from the base class
@@ -69,12 +73,32 @@ public:
     // Set value of the texture parameter of type color
     void SetParameter(ParameterColor pname, std::span<const GLfloat, 4> params);
 
+    // Sampler bound with the texture in ShaderProgram::SetTexture. Without one, the parameters of the texture are used
+    inline const std::shared_ptr<const SamplerObject>& GetSampler() const { return m_sampler; }
+    inline void SetSampler(std::shared_ptr<const SamplerObject> sampler) { m_sampler = std::move(sampler); }
+
+    // Get the size in bytes of all the mip levels allocated, from the sizes reported by the driver
+    size_t GetMemorySize() const;
+
     // Get number of componentes (1-4) of a specific texture format)
     static int GetComponentCount(Format format);
 
     // Get number of components of the data type of the texture (packed components count as 1)
     static int GetDataComponentCount(InternalFormat internalFormat);
 
+    // Get the sized format used for immutable storage. Unsized basic formats get 8 bits per component and 24 bits of depth
+    // Returns InternalFormatInvalid for the generic compressed formats, they can only be used with mutable storage
+    static InternalFormat GetSizedInternalFormat(InternalFormat internalFormat);
+
+    // Check if the internal format is compressed in blocks of 4x4 texels, with data prepared offline
+    static bool IsBlockCompressed(InternalFormat internalFormat);
+
+    // Get the size in bytes of an image with a block compressed format. Partial blocks count as full blocks
+    static size_t GetCompressedImageSize(InternalFormat internalFormat, GLsizei width, GLsizei height);
+
+    // Check if the driver can use a compressed internal format. Some block formats come from extensions
+    static bool IsCompressedFormatSupported(InternalFormat internalFormat);
+
     // Set active texture unit
     static void SetActiveTexture(GLint textureUnit);
 
@@ -92,6 +116,8 @@ protected:
     static bool IsValidFormat(Format format, InternalFormat internalFormat);
 #endif
 
+private:
+    std::shared_ptr<const SamplerObject> m_sampler;
 };
 
 // (C++) 5
@@ -101,7 +127,7 @@ template<TextureObject::Target T>
 class TextureObjectBase : public TextureObject
 {
 public:
-    inline TextureObjectBase() {}
+    inline TextureObjectBase() : TextureObject(T) {}
 
     // Return the templated enum value T
     inline Target GetTarget() const override { return T; }
@@ -151,6 +177,16 @@ void TextureObjectBase<T>::Unbind()
 
 // TextureObject enums
 
+// BC1 and BC3 come from EXT_texture_compression_s3tc, supported by desktop drivers but not part of the core profile
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
 enum TextureObject::Target : GLenum
 {
     Texture1D = GL_TEXTURE_1D,
@@ -175,6 +211,10 @@ enum TextureObject::Format : GLenum
     FormatBGR = GL_BGR,
     FormatRGBA = GL_RGBA,
     FormatBGRA = GL_BGRA,
+    FormatRInteger = GL_RED_INTEGER,
+    FormatRGInteger = GL_RG_INTEGER,
+    FormatRGBInteger = GL_RGB_INTEGER,
+    FormatRGBAInteger = GL_RGBA_INTEGER,
     FormatDepth = GL_DEPTH_COMPONENT,
     FormatDepthStencil = GL_DEPTH_STENCIL
 };
@@ -217,6 +257,11 @@ enum TextureObject::InternalFormat : GLint
     InternalFormatRG32F = GL_RG32F,
     InternalFormatRGB32F = GL_RGB32F,
     InternalFormatRGBA32F = GL_RGBA32F,
+    // 32-bit unsigned integer
+    InternalFormatR32UI = GL_R32UI,
+    InternalFormatRG32UI = GL_RG32UI,
+    InternalFormatRGB32UI = GL_RGB32UI,
+    InternalFormatRGBA32UI = GL_RGBA32UI,
     // sRGB
     InternalFormatSRGB8 = GL_SRGB8,
     InternalFormatSRGBA8 = GL_SRGB8_ALPHA8,
@@ -227,6 +272,15 @@ enum TextureObject::InternalFormat : GLint
     InternalFormatRGBACompressed = GL_COMPRESSED_RGBA,
     InternalFormatSRGBCompressed = GL_COMPRESSED_SRGB,
     InternalFormatSRGBACompressed = GL_COMPRESSED_SRGB_ALPHA,
+    // Block compressed
+    InternalFormatBC1 = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+    InternalFormatBC1SRGB = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,
+    InternalFormatBC3 = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+    InternalFormatBC3SRGB = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,
+    InternalFormatBC4 = GL_COMPRESSED_RED_RGTC1,
+    InternalFormatBC5 = GL_COMPRESSED_RG_RGTC2,
+    InternalFormatBC7 = GL_COMPRESSED_RGBA_BPTC_UNORM,
+    InternalFormatBC7SRGB = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,
     // Depth Stencil
     InternalFormatDepth = GL_DEPTH_COMPONENT,
     InternalFormatDepth16 = GL_DEPTH_COMPONENT16,
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <map>
+#include <cstddef>
+
+// Suballocates ranges of a fixed capacity, like the regions of a buffer. It only keeps the offsets, not the memory
+// Free ranges are sorted by offset and merged with their neighbours when released, allocations take the first that fits
+class FreeListAllocator
+{
+public:
+    FreeListAllocator(std::size_t capacity = 0);
+
+    inline std::size_t GetCapacity() const { return m_capacity; }
+
+    // Units not allocated, they can be split in several ranges
+    inline std::size_t GetFreeSize() const { return m_freeSize; }
+
+    // Get a range of the size, with the offset a multiple of the alignment. Returns false if no free range fits it
+    bool Allocate(std::size_t size, std::size_t alignment, std::size_t& offset);
+
+    // Release a range returned by Allocate, with the same size
+    void Free(std::size_t offset, std::size_t size);
+
+private:
+    std::size_t m_capacity;
+    std::size_t m_freeSize;
+
+    // Size of each free range, by offset
+    std::map<std::size_t, std::size_t> m_freeRanges;
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run the submitted tasks in order of submission
+// Tasks must not use the OpenGL context, it is only current in the main thread
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+public:
+    // With 0 threads, one less than the hardware threads is used, so that the main thread keeps its core
+    ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    void operator = (const ThreadPool&) = delete;
+
+    inline unsigned int GetThreadCount() const { return static_cast<unsigned int>(m_threads.size()); }
+
+    // Add the task to the queue. It runs in the first worker thread available
+    void Submit(Task task);
+
+    // Block until all the submitted tasks have finished
+    void Wait();
+
+private:
+    void WorkerLoop();
+
+private:
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+
+    // Signaled when a task is submitted, or when the pool is destroyed
+    std::condition_variable m_taskAvailable;
+
+    // Signaled when the last running task finishes
+    std::condition_variable m_tasksFinished;
+
+    std::queue<Task> m_tasks;
+
+    // Tasks taken from the queue that are still running
+    unsigned int m_runningTaskCount;
+
+    bool m_stopping;
+};
@@ -0,0 +1,120 @@
+#include <ituGL/asset/AssetPack.h>
+
+#include <ituGL/texture/TextureObject.h>
+#include <algorithm>
+#include <cstring>
+
+AssetPack::AssetPack() : m_header{}
+{
+}
+
+bool AssetPack::Open(const char* path)
+{
+    Close();
+
+    if (!m_file.Open(path))
+        return false;
+
+    std::span<const std::byte> data = m_file.GetData();
+    bool valid = data.size() >= sizeof(AssetPackHeader);
+    if (valid)
+    {
+        std::memcpy(&m_header, data.data(), sizeof(AssetPackHeader));
+        valid = m_header.magic == AssetPackHeader::Magic && m_header.version == AssetPackHeader::CurrentVersion && ValidateEntries();
+    }
+
+    if (!valid)
+    {
+        Close();
+        return false;
+    }
+
+    // Start reading the whole pack now, most of it is used when loading
+    m_file.Prefetch();
+    return true;
+}
+
+void AssetPack::Close()
+{
+    m_file.Close();
+    m_header = {};
+}
+
+std::span<const AssetPackEntry> AssetPack::GetEntries() const
+{
+    // The entries are right after the header, that has the same alignment, so they can be used in place
+    const std::byte* entries = m_file.GetData().data() + sizeof(AssetPackHeader);
+    return std::span<const AssetPackEntry>(reinterpret_cast<const AssetPackEntry*>(entries), m_header.entryCount);
+}
+
+const AssetPackEntry* AssetPack::FindEntry(std::string_view name) const
+{
+    std::span<const AssetPackEntry> entries = GetEntries();
+    auto itEntry = std::lower_bound(entries.begin(), entries.end(), name,
+        [&](const AssetPackEntry& entry, std::string_view name) { return GetName(entry) < name; });
+    return itEntry != entries.end() && GetName(*itEntry) == name ? &*itEntry : nullptr;
+}
+
+const AssetPackEntry* AssetPack::FindEntry(std::string_view name, AssetPackEntryType type) const
+{
+    const AssetPackEntry* entry = FindEntry(name);
+    return entry && entry->type == type ? entry : nullptr;
+}
+
+std::string_view AssetPack::GetName(const AssetPackEntry& entry) const
+{
+    const std::byte* names = m_file.GetData().data() + sizeof(AssetPackHeader) + m_header.entryCount * sizeof(AssetPackEntry);
+    return std::string_view(reinterpret_cast<const char*>(names + entry.nameOffset), entry.nameLength);
+}
+
+std::span<const std::byte> AssetPack::GetData(const AssetPackEntry& entry) const
+{
+    return m_file.GetData().subspan(static_cast<std::size_t>(entry.dataOffset), static_cast<std::size_t>(entry.dataSize));
+}
+
+bool AssetPack::GetTexture2D(const AssetPackEntry& entry, AssetPackTexture2D& texture2D, std::vector<std::span<const std::byte>>& levels) const
+{
+    std::span<const std::byte> data = GetData(entry);
+    if (entry.type != AssetPackEntryType::Texture2D || data.size() < sizeof(AssetPackTexture2D))
+        return false;
+
+    std::memcpy(&texture2D, data.data(), sizeof(AssetPackTexture2D));
+    TextureObject::InternalFormat internalFormat = static_cast<TextureObject::InternalFormat>(texture2D.internalFormat);
+    if (!TextureObject::IsBlockCompressed(internalFormat) || texture2D.width == 0 || texture2D.height == 0 || texture2D.levelCount > 32)
+        return false;
+
+    // Same layout as AssetPackWriter::AddTexture2D: each level aligned, relative to the start of the entry data
+    const std::size_t alignment = AssetPackHeader::DataAlignment;
+    std::size_t offset = sizeof(AssetPackTexture2D);
+    levels.resize(texture2D.levelCount);
+    for (std::uint32_t level = 0; level < texture2D.levelCount; ++level)
+    {
+        GLsizei width = std::max(static_cast<GLsizei>(texture2D.width >> level), 1);
+        GLsizei height = std::max(static_cast<GLsizei>(texture2D.height >> level), 1);
+        std::size_t levelSize = TextureObject::GetCompressedImageSize(internalFormat, width, height);
+
+        offset = (offset + alignment - 1) / alignment * alignment;
+        if (offset + levelSize > data.size())
+            return false;
+
+        levels[level] = data.subspan(offset, levelSize);
+        offset += levelSize;
+    }
+    return true;
+}
+
+bool AssetPack::ValidateEntries() const
+{
+    std::span<const std::byte> data = m_file.GetData();
+    std::uint64_t namesOffset = sizeof(AssetPackHeader) + static_cast<std::uint64_t>(m_header.entryCount) * sizeof(AssetPackEntry);
+    if (namesOffset + m_header.namesSize > data.size())
+        return false;
+
+    for (const AssetPackEntry& entry : GetEntries())
+    {
+        if (static_cast<std::uint64_t>(entry.nameOffset) + entry.nameLength > m_header.namesSize ||
+            entry.dataOffset > data.size() || entry.dataSize > data.size() - entry.dataOffset)
+            return false;
+    }
+    return true;
+}
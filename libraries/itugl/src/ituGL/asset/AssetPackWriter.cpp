@@ -0,0 +1,117 @@
+#include <ituGL/asset/AssetPackWriter.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+AssetPackWriter::AssetPackWriter()
+{
+}
+
+bool AssetPackWriter::AddEntry(const std::string& name, AssetPackEntryType type, std::span<const std::byte> data)
+{
+    auto itEntry = std::find_if(m_entries.begin(), m_entries.end(), [&](const Entry& entry) { return entry.name == name; });
+    if (itEntry != m_entries.end())
+        return false;
+
+    m_entries.push_back({ name, type, std::vector<std::byte>(data.begin(), data.end()) });
+    return true;
+}
+
+bool AssetPackWriter::AddTexture2D(const std::string& name, std::uint32_t internalFormat, std::uint32_t width, std::uint32_t height,
+    std::span<const std::vector<std::byte>> levels)
+{
+    AssetPackTexture2D texture2D;
+    texture2D.internalFormat = internalFormat;
+    texture2D.width = width;
+    texture2D.height = height;
+    texture2D.levelCount = static_cast<std::uint32_t>(levels.size());
+
+    // Level offsets are relative to the entry data, that is aligned too
+    std::vector<std::byte> data(sizeof(AssetPackTexture2D));
+    std::memcpy(data.data(), &texture2D, sizeof(AssetPackTexture2D));
+    for (const std::vector<std::byte>& level : levels)
+    {
+        data.resize(Align(data.size()));
+        data.insert(data.end(), level.begin(), level.end());
+    }
+
+    return AddEntry(name, AssetPackEntryType::Texture2D, data);
+}
+
+bool AssetPackWriter::AddFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+
+    std::vector<std::byte> data(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    return file && AddEntry(path, AssetPackEntryType::File, data);
+}
+
+bool AssetPackWriter::Write(const char* path) const
+{
+    // Sorted, so that the reader can find the entries with a binary search
+    std::vector<const Entry*> entries;
+    for (const Entry& entry : m_entries)
+    {
+        entries.push_back(&entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) { return a->name < b->name; });
+
+    AssetPackHeader header;
+    header.magic = AssetPackHeader::Magic;
+    header.version = AssetPackHeader::CurrentVersion;
+    header.entryCount = static_cast<std::uint32_t>(entries.size());
+    header.namesSize = 0;
+    for (const Entry* entry : entries)
+    {
+        header.namesSize += static_cast<std::uint32_t>(entry->name.size());
+    }
+
+    std::vector<AssetPackEntry> packEntries(entries.size());
+    std::uint32_t nameOffset = 0;
+    std::uint64_t dataOffset = Align(sizeof(AssetPackHeader) + packEntries.size() * sizeof(AssetPackEntry) + header.namesSize);
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        AssetPackEntry& packEntry = packEntries[i];
+        packEntry.nameOffset = nameOffset;
+        packEntry.nameLength = static_cast<std::uint32_t>(entries[i]->name.size());
+        packEntry.type = entries[i]->type;
+        packEntry.reserved = 0;
+        packEntry.dataOffset = dataOffset;
+        packEntry.dataSize = entries[i]->data.size();
+
+        nameOffset += packEntry.nameLength;
+        dataOffset = Align(dataOffset + packEntry.dataSize);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(packEntries.data()), packEntries.size() * sizeof(AssetPackEntry));
+    for (const Entry* entry : entries)
+    {
+        file.write(entry->name.data(), entry->name.size());
+    }
+
+    // Padding before each data block, up to its offset
+    const char padding[AssetPackHeader::DataAlignment] = {};
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        file.write(padding, packEntries[i].dataOffset - static_cast<std::uint64_t>(file.tellp()));
+        file.write(reinterpret_cast<const char*>(entries[i]->data.data()), entries[i]->data.size());
+    }
+
+    return file.good();
+}
+
+std::uint64_t AssetPackWriter::Align(std::uint64_t offset)
+{
+    const std::uint64_t alignment = AssetPackHeader::DataAlignment;
+    return (offset + alignment - 1) / alignment * alignment;
+}
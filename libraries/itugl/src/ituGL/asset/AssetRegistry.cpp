@@ -0,0 +1,194 @@
+#include <ituGL/asset/AssetRegistry.h>
+
+#include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/asset/CompressedTexture2DLoader.h>
+#include <ituGL/asset/ShaderProgramCache.h>
+#include <ituGL/asset/ModelLoader.h>
+#include <ituGL/geometry/Mesh.h>
+#include <filesystem>
+#include <cstdint>
+#include <cassert>
+
+AssetRegistry::AssetRegistry() : m_hitCount(0), m_missCount(0)
+{
+}
+
+std::shared_ptr<Texture2DObject> AssetRegistry::LoadTexture2D(Texture2DLoader& loader, const char* path)
+{
+    std::string key = GetCanonicalPath(path);
+    key += '|' + std::to_string(loader.GetFormat());
+    key += '|' + std::to_string(loader.GetInternalFormat());
+    key += loader.GetGenerateMipmap() ? "|mipmap" : "|";
+    key += loader.GetFlipVertical() ? "|flip" : "|";
+
+    return FindOrLoad(m_textures, key, [&]()
+        {
+            loader.SetKeepShared(false);
+            return loader.LoadShared(path);
+        });
+}
+
+std::shared_ptr<Texture2DObject> AssetRegistry::LoadTexture2D(CompressedTexture2DLoader& loader, const char* path)
+{
+    // Tagged, so that a file read by both loaders is not shared between them
+    std::string key = GetCanonicalPath(path) + "|compressed";
+
+    return FindOrLoad(m_textures, key, [&]()
+        {
+            loader.SetKeepShared(false);
+            return loader.LoadShared(path);
+        });
+}
+
+std::shared_ptr<ShaderProgram> AssetRegistry::LoadShaderProgram(ShaderProgramCache& shaderProgramCache,
+    std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+    std::span<const char* const> defines)
+{
+    // The stages are separated, the same files in a different stage are a different program
+    std::string key = "vs";
+    for (const char* path : vertexShaderPaths)
+    {
+        key += '|' + GetCanonicalPath(path);
+    }
+    key += "|fs";
+    for (const char* path : fragmentShaderPaths)
+    {
+        key += '|' + GetCanonicalPath(path);
+    }
+    key += "|defines";
+    for (const char* define : defines)
+    {
+        key += '|';
+        key += define;
+    }
+
+    return FindOrLoad(m_shaderPrograms, key, [&]()
+        {
+            return shaderProgramCache.BuildAsync(vertexShaderPaths, fragmentShaderPaths, defines);
+        });
+}
+
+std::shared_ptr<Model> AssetRegistry::LoadModel(ModelLoader& modelLoader, const char* path)
+{
+    // Loaders with different reference materials create different materials, even for the same file
+    std::string key = GetCanonicalPath(path);
+    key += '|' + std::to_string(reinterpret_cast<std::uintptr_t>(modelLoader.GetReferenceMaterial().get()));
+    key += modelLoader.GetCreateMaterials() ? "|materials" : "|";
+    key += '|' + std::to_string(static_cast<int>(modelLoader.GetNormalFormat()));
+    key += modelLoader.GetQuantizeTexCoords() ? "|texcoords" : "|";
+    key += modelLoader.GetQuantizePositions() ? "|positions" : "|";
+    key += modelLoader.GetOptimizeMeshes() ? "|optimize" : "|";
+
+    return FindOrLoad(m_models, key, [&]()
+        {
+            modelLoader.SetKeepShared(false);
+            return modelLoader.LoadShared(path);
+        });
+}
+
+unsigned int AssetRegistry::EvictUnused()
+{
+    unsigned int evictedCount = EvictUnused(m_models);
+    evictedCount += EvictUnused(m_shaderPrograms);
+    evictedCount += EvictUnused(m_textures);
+    return evictedCount;
+}
+
+void AssetRegistry::Clear()
+{
+    m_models.clear();
+    m_shaderPrograms.clear();
+    m_textures.clear();
+}
+
+AssetRegistry::MemoryUsage AssetRegistry::GetMemoryUsage(AssetType assetType) const
+{
+    MemoryUsage memoryUsage;
+    switch (assetType)
+    {
+    case AssetType::Texture2D:
+        memoryUsage.assetCount = static_cast<unsigned int>(m_textures.size());
+        for (const auto& texturePair : m_textures)
+        {
+            const Texture2DObject& texture = *texturePair.second;
+            texture.Bind();
+            memoryUsage.size += texture.GetMemorySize();
+        }
+        if (!m_textures.empty())
+        {
+            Texture2DObject::Unbind();
+        }
+        break;
+    case AssetType::ShaderProgram:
+        memoryUsage.assetCount = static_cast<unsigned int>(m_shaderPrograms.size());
+        for (const auto& shaderProgramPair : m_shaderPrograms)
+        {
+            memoryUsage.size += shaderProgramPair.second->GetBinarySize();
+        }
+        break;
+    case AssetType::Model:
+        memoryUsage.assetCount = static_cast<unsigned int>(m_models.size());
+        for (const auto& modelPair : m_models)
+        {
+            const Mesh& mesh = modelPair.second->GetMesh();
+            for (unsigned int i = 0; i < mesh.GetVertexBufferCount(); ++i)
+            {
+                memoryUsage.size += mesh.GetVertexBuffer(i).GetSize();
+            }
+            for (unsigned int i = 0; i < mesh.GetElementBufferCount(); ++i)
+            {
+                memoryUsage.size += mesh.GetElementBuffer(i).GetSize();
+            }
+
+            // Only the ranges of the shared buffers that belong to the mesh
+            for (unsigned int i = 0; i < mesh.GetHeapDataCount(); ++i)
+            {
+                const GeometryHeap::Allocation& heapData = mesh.GetHeapData(i);
+                memoryUsage.size += heapData.GetVertexDataSize() + heapData.GetElementDataSize();
+            }
+        }
+        break;
+    default:
+        assert(false);
+        break;
+    }
+    return memoryUsage;
+}
+
+std::string AssetRegistry::GetCanonicalPath(const char* path)
+{
+    std::error_code error;
+    std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, error);
+    if (error)
+    {
+        canonicalPath = std::filesystem::absolute(path, error).lexically_normal();
+    }
+    return canonicalPath.generic_string();
+}
+
+template<typename T, typename F>
+std::shared_ptr<T> AssetRegistry::FindOrLoad(std::unordered_map<std::string, std::shared_ptr<T>>& assets, const std::string& key, F load)
+{
+    auto itAsset = assets.find(key);
+    if (itAsset != assets.end())
+    {
+        ++m_hitCount;
+        return itAsset->second;
+    }
+
+    ++m_missCount;
+    std::shared_ptr<T> asset = load();
+
+    // Failed loads are not kept, so they are tried again next time
+    if (asset)
+    {
+        assets.emplace(key, asset);
+    }
+    return asset;
+}
+
+template<typename T>
+unsigned int AssetRegistry::EvictUnused(std::unordered_map<std::string, std::shared_ptr<T>>& assets)
+{
+    return static_cast<unsigned int>(std::erase_if(assets, [](const auto& assetPair) { return assetPair.second.use_count() == 1; }));
+}
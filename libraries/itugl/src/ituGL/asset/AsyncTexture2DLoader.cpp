@@ -0,0 +1,201 @@
+#include <ituGL/asset/AsyncTexture2DLoader.h>
+
+#include <ituGL/asset/FileWatcher.h>
+#include <ituGL/utils/ThreadPool.h>
+#include <ituGL/core/DeviceGL.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <iostream>
+
+AsyncTexture2DLoader::AsyncTexture2DLoader(ThreadPool& threadPool)
+    : m_threadPool(threadPool)
+    , m_pendingCount(0)
+    , m_uploadBudget(16 * 1024 * 1024)
+    , m_placeholderColor(0.5f, 0.5f, 0.5f, 1.0f)
+{
+}
+
+AsyncTexture2DLoader::AsyncTexture2DLoader(ThreadPool& threadPool, TextureObject::Format format, TextureObject::InternalFormat internalFormat)
+    : Texture2DLoader(format, internalFormat)
+    , m_threadPool(threadPool)
+    , m_pendingCount(0)
+    , m_uploadBudget(16 * 1024 * 1024)
+    , m_placeholderColor(0.5f, 0.5f, 0.5f, 1.0f)
+{
+}
+
+// The tasks submitted keep a reference to the loader
+AsyncTexture2DLoader::~AsyncTexture2DLoader()
+{
+    m_threadPool.Wait();
+}
+
+std::shared_ptr<Texture2DObject> AsyncTexture2DLoader::LoadShared(const char* path)
+{
+    if (!IsValid(path))
+        return nullptr;
+
+    // Baked textures don't need decoding, they are uploaded right away
+    if (IsPacked(path))
+        return Texture2DLoader::LoadShared(path);
+
+    // 1x1 texture with the placeholder color. With a single level, it is complete even with mipmap filters
+    std::array<unsigned char, 4> placeholderData;
+    for (int i = 0; i < 4; ++i)
+    {
+        placeholderData[i] = static_cast<unsigned char>(std::clamp(m_placeholderColor[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+    int componentCount = TextureObject::GetComponentCount(m_format);
+
+    std::shared_ptr<Texture2DObject> texture2D = std::make_shared<Texture2DObject>();
+    texture2D->Bind();
+    texture2D->SetImage<unsigned char>(0, 1, 1, m_format, m_internalFormat, std::span(placeholderData.data(), componentCount));
+    if (!m_generateMipmap)
+    {
+        texture2D->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
+    }
+    Texture2DObject::Unbind();
+
+    Submit(path, texture2D);
+
+    if (FileWatcher* fileWatcher = GetFileWatcher())
+    {
+        // The watcher is updated in the same thread, so it doesn't call back while the loader is being destroyed
+        std::weak_ptr<Texture2DObject> weakTexture2D = texture2D;
+        fileWatcher->Watch(path, [this, weakTexture2D](const std::string& path)
+            {
+                if (std::shared_ptr<Texture2DObject> texture2D = weakTexture2D.lock())
+                {
+                    Submit(path, texture2D);
+                }
+            });
+    }
+
+    return texture2D;
+}
+
+void AsyncTexture2DLoader::Submit(const std::string& path, const std::shared_ptr<Texture2DObject>& texture2D)
+{
+    // Settings are captured now, they can change before the image is uploaded
+    std::shared_ptr<PendingUpload> upload = std::make_shared<PendingUpload>();
+    upload->path = path;
+    upload->texture2D = texture2D;
+    upload->format = m_format;
+    upload->internalFormat = m_internalFormat;
+    upload->generateMipmap = m_generateMipmap;
+
+    bool flipVertical = GetFlipVertical();
+
+    ++m_pendingCount;
+    m_threadPool.Submit([this, upload, flipVertical]()
+        {
+            int componentCount = TextureObject::GetComponentCount(upload->format);
+            upload->image = DecodeImage(upload->path.c_str(), componentCount, flipVertical);
+
+            std::lock_guard<std::mutex> lock(m_decodedMutex);
+            m_decodedUploads.push_back(std::move(*upload));
+        });
+}
+
+void AsyncTexture2DLoader::Update()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_decodedMutex);
+        std::move(m_decodedUploads.begin(), m_decodedUploads.end(), std::back_inserter(m_uploads));
+        m_decodedUploads.clear();
+    }
+
+    size_t budget = m_uploadBudget;
+    while (!m_uploads.empty() && budget > 0)
+    {
+        PendingUpload& upload = m_uploads.front();
+
+        // Skip the images that failed, and the ones whose texture is not used anymore
+        std::shared_ptr<Texture2DObject> texture2D = upload.texture2D.lock();
+        if (!upload.image.data)
+        {
+            std::cout << "ERROR::TEXTURE::LOAD_FAILED\n" << upload.path << std::endl;
+        }
+        else if (texture2D)
+        {
+            budget -= std::min(budget, UploadRows(upload, budget));
+            if (upload.uploadedRows < upload.image.height)
+                break;
+
+            FinishUpload(upload, *texture2D);
+        }
+
+        m_uploads.pop_front();
+        --m_pendingCount;
+    }
+}
+
+size_t AsyncTexture2DLoader::UploadRows(PendingUpload& upload, size_t budget)
+{
+    const DecodedImage& image = upload.image;
+
+    // Allocate the full image before binding the pixel buffer, that would be used as the source otherwise
+    if (!upload.stagingTexture2D)
+    {
+        upload.stagingTexture2D = std::make_unique<Texture2DObject>();
+        upload.stagingTexture2D->Bind();
+        if (DeviceGL::GetInstance().IsTextureStorageSupported() && TextureObject::GetSizedInternalFormat(upload.internalFormat) != TextureObject::InternalFormatInvalid)
+        {
+            GLsizei levelCount = upload.generateMipmap ? Texture2DObject::GetMipmapLevelCount(image.width, image.height) : 1;
+            upload.stagingTexture2D->SetStorage(levelCount, image.width, image.height, upload.internalFormat);
+        }
+        else
+        {
+            upload.stagingTexture2D->SetImage(0, image.width, image.height, upload.format, upload.internalFormat);
+        }
+    }
+
+    size_t rowSize = static_cast<size_t>(image.width) * TextureObject::GetComponentCount(upload.format);
+    int rowCount = std::clamp(static_cast<int>(budget / rowSize), 1, image.height - upload.uploadedRows);
+    std::span<const std::byte> rows(reinterpret_cast<const std::byte*>(image.data.get() + upload.uploadedRows * rowSize), rowCount * rowSize);
+
+    m_pixelBuffer.Bind();
+    m_pixelBuffer.AllocateData(rows.size_bytes(), BufferObject::StreamDraw);
+    std::span<std::byte> mappedRows = m_pixelBuffer.MapRange(0, rows.size_bytes(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    bool copied = false;
+    if (!mappedRows.empty())
+    {
+        std::memcpy(mappedRows.data(), rows.data(), rows.size_bytes());
+        copied = m_pixelBuffer.Unmap();
+    }
+    if (!copied)
+    {
+        // Mapping failed or the mapped contents were lost, let the driver copy them
+        m_pixelBuffer.UpdateData(rows);
+    }
+
+    // Rows are tightly packed, and RGB rows are not always aligned to 4 bytes
+    upload.stagingTexture2D->Bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    upload.stagingTexture2D->SetSubImage(0, 0, upload.uploadedRows, image.width, rowCount, upload.format, Data::Type::UByte);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    PixelUnpackBufferObject::Unbind();
+    Texture2DObject::Unbind();
+
+    upload.uploadedRows += rowCount;
+    return rows.size_bytes();
+}
+
+void AsyncTexture2DLoader::FinishUpload(PendingUpload& upload, Texture2DObject& texture2D)
+{
+    Texture2DObject& stagingTexture2D = *upload.stagingTexture2D;
+
+    // The parameters and the sampler set on the placeholder are kept
+    CopySamplingState(texture2D, stagingTexture2D);
+    if (upload.generateMipmap)
+    {
+        stagingTexture2D.GenerateMipmap();
+    }
+    Texture2DObject::Unbind();
+
+    // The shared object keeps its address, so materials using it get the new image
+    texture2D = std::move(stagingTexture2D);
+}
@@ -0,0 +1,297 @@
+#include <ituGL/asset/CompressedTexture2DLoader.h>
+
+#include <ituGL/core/DeviceGL.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// Read a little endian value from the file data. Returns false if it is out of bounds
+template<typename T>
+static bool ReadValue(std::span<const std::byte> data, size_t offset, T& value)
+{
+    if (offset + sizeof(T) > data.size())
+        return false;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    return true;
+}
+
+// Get the level range from the file data. Returns false if it is out of bounds
+static bool GetLevelData(std::span<const std::byte> data, uint64_t offset, uint64_t size, std::span<const std::byte>& level)
+{
+    if (offset > data.size() || size > data.size() - offset)
+        return false;
+    level = data.subspan(static_cast<size_t>(offset), static_cast<size_t>(size));
+    return true;
+}
+
+// VkFormat values used in KTX2 files
+static TextureObject::InternalFormat GetInternalFormatFromVkFormat(uint32_t vkFormat)
+{
+    switch (vkFormat)
+    {
+    case 133: return TextureObject::InternalFormatBC1;     // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    case 134: return TextureObject::InternalFormatBC1SRGB; // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+    case 137: return TextureObject::InternalFormatBC3;     // VK_FORMAT_BC3_UNORM_BLOCK
+    case 138: return TextureObject::InternalFormatBC3SRGB; // VK_FORMAT_BC3_SRGB_BLOCK
+    case 139: return TextureObject::InternalFormatBC4;     // VK_FORMAT_BC4_UNORM_BLOCK
+    case 141: return TextureObject::InternalFormatBC5;     // VK_FORMAT_BC5_UNORM_BLOCK
+    case 145: return TextureObject::InternalFormatBC7;     // VK_FORMAT_BC7_UNORM_BLOCK
+    case 146: return TextureObject::InternalFormatBC7SRGB; // VK_FORMAT_BC7_SRGB_BLOCK
+    default: return TextureObject::InternalFormatInvalid;
+    }
+}
+
+// DXGI_FORMAT values used in the DX10 header of DDS files
+static TextureObject::InternalFormat GetInternalFormatFromDXGIFormat(uint32_t dxgiFormat)
+{
+    switch (dxgiFormat)
+    {
+    case 71: return TextureObject::InternalFormatBC1;     // DXGI_FORMAT_BC1_UNORM
+    case 72: return TextureObject::InternalFormatBC1SRGB; // DXGI_FORMAT_BC1_UNORM_SRGB
+    case 77: return TextureObject::InternalFormatBC3;     // DXGI_FORMAT_BC3_UNORM
+    case 78: return TextureObject::InternalFormatBC3SRGB; // DXGI_FORMAT_BC3_UNORM_SRGB
+    case 80: return TextureObject::InternalFormatBC4;     // DXGI_FORMAT_BC4_UNORM
+    case 83: return TextureObject::InternalFormatBC5;     // DXGI_FORMAT_BC5_UNORM
+    case 98: return TextureObject::InternalFormatBC7;     // DXGI_FORMAT_BC7_UNORM
+    case 99: return TextureObject::InternalFormatBC7SRGB; // DXGI_FORMAT_BC7_UNORM_SRGB
+    default: return TextureObject::InternalFormatInvalid;
+    }
+}
+
+static constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+{
+    return uint32_t(uint8_t(a)) | uint32_t(uint8_t(b)) << 8 | uint32_t(uint8_t(c)) << 16 | uint32_t(uint8_t(d)) << 24;
+}
+
+// Legacy DDS files identify the format with a FourCC code
+static TextureObject::InternalFormat GetInternalFormatFromFourCC(uint32_t fourCC)
+{
+    switch (fourCC)
+    {
+    case MakeFourCC('D', 'X', 'T', '1'): return TextureObject::InternalFormatBC1;
+    case MakeFourCC('D', 'X', 'T', '5'): return TextureObject::InternalFormatBC3;
+    case MakeFourCC('A', 'T', 'I', '1'):
+    case MakeFourCC('B', 'C', '4', 'U'): return TextureObject::InternalFormatBC4;
+    case MakeFourCC('A', 'T', 'I', '2'):
+    case MakeFourCC('B', 'C', '5', 'U'): return TextureObject::InternalFormatBC5;
+    default: return TextureObject::InternalFormatInvalid;
+    }
+}
+
+CompressedTexture2DLoader::CompressedTexture2DLoader()
+{
+}
+
+bool CompressedTexture2DLoader::IsValid(const char* path)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".ktx2" || extension == ".dds";
+}
+
+Texture2DObject CompressedTexture2DLoader::Load(const char* path)
+{
+    Texture2DObject texture2D;
+
+    std::vector<std::byte> fileData;
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (file.is_open())
+    {
+        fileData.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(fileData.data()), fileData.size());
+    }
+
+    Image image;
+    if (!file || !ReadImage(fileData, image))
+    {
+        std::cout << "ERROR::TEXTURE::INVALID_COMPRESSED_FILE\n" << path << std::endl;
+    }
+    else if (!TextureObject::IsCompressedFormatSupported(image.internalFormat))
+    {
+        std::cout << "ERROR::TEXTURE::COMPRESSED_FORMAT_NOT_SUPPORTED\n" << path << std::endl;
+    }
+    else
+    {
+        texture2D.Bind();
+        SetImage(texture2D, image);
+        Texture2DObject::Unbind();
+    }
+
+    return texture2D;
+}
+
+bool CompressedTexture2DLoader::ReadImage(std::span<const std::byte> fileData, Image& image)
+{
+    static const std::array<unsigned char, 12> ktx2Identifier = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    static const std::array<unsigned char, 4> ddsMagic = { 'D', 'D', 'S', ' ' };
+
+    image = Image();
+    bool read = false;
+    if (fileData.size() >= ktx2Identifier.size() && std::memcmp(fileData.data(), ktx2Identifier.data(), ktx2Identifier.size()) == 0)
+    {
+        read = ReadKTX2(fileData, image);
+    }
+    else if (fileData.size() >= ddsMagic.size() && std::memcmp(fileData.data(), ddsMagic.data(), ddsMagic.size()) == 0)
+    {
+        read = ReadDDS(fileData, image);
+    }
+    return read && ValidateLevels(image);
+}
+
+void CompressedTexture2DLoader::SetImage(Texture2DObject& texture2D, const Image& image)
+{
+    // With immutable storage, only the levels in the file are allocated. The texture must not have storage yet
+    assert(!texture2D.HasImmutableStorage());
+    bool immutableStorage = DeviceGL::GetInstance().IsTextureStorageSupported();
+    if (immutableStorage)
+    {
+        texture2D.SetStorage(static_cast<GLsizei>(image.levels.size()), image.width, image.height, image.internalFormat);
+    }
+
+    for (int level = 0; level < image.levels.size(); ++level)
+    {
+        int width = std::max(image.width >> level, 1);
+        int height = std::max(image.height >> level, 1);
+        if (immutableStorage)
+            texture2D.SetCompressedSubImage(level, 0, 0, width, height, image.internalFormat, image.levels[level]);
+        else
+            texture2D.SetCompressedImage(level, width, height, image.internalFormat, image.levels[level]);
+    }
+
+    // Files don't need to have the full mip chain. Without this, a partial chain would make a mutable texture incomplete
+    int maxLevel = static_cast<int>(image.levels.size()) - 1;
+    texture2D.SetParameter(TextureObject::ParameterInt::MaxLevel, maxLevel);
+    texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, maxLevel > 0 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    texture2D.SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+}
+
+bool CompressedTexture2DLoader::ReadKTX2(std::span<const std::byte> fileData, Image& image)
+{
+    // Header after the identifier, and the index of the level data
+    uint32_t vkFormat, pixelWidth, pixelHeight, pixelDepth, layerCount, faceCount, levelCount, supercompressionScheme;
+    if (!ReadValue(fileData, 12, vkFormat) ||
+        !ReadValue(fileData, 20, pixelWidth) ||
+        !ReadValue(fileData, 24, pixelHeight) ||
+        !ReadValue(fileData, 28, pixelDepth) ||
+        !ReadValue(fileData, 32, layerCount) ||
+        !ReadValue(fileData, 36, faceCount) ||
+        !ReadValue(fileData, 40, levelCount) ||
+        !ReadValue(fileData, 44, supercompressionScheme))
+        return false;
+
+    // Only plain 2D textures, without supercompression (Basis, Zstandard) that would need to be decoded first
+    if (pixelDepth > 1 || layerCount > 1 || faceCount != 1 || supercompressionScheme != 0)
+        return false;
+
+    image.internalFormat = GetInternalFormatFromVkFormat(vkFormat);
+    image.width = static_cast<int>(pixelWidth);
+    image.height = static_cast<int>(pixelHeight);
+
+    // A level count of 0 means that the mipmap should be generated. That is not possible with block formats
+    levelCount = std::max(levelCount, 1u);
+    if (levelCount > s_maxLevelCount)
+        return false;
+
+    const size_t levelIndexOffset = 80;
+    image.levels.resize(levelCount);
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        uint64_t byteOffset, byteLength;
+        size_t levelOffset = levelIndexOffset + level * 3 * sizeof(uint64_t);
+        if (!ReadValue(fileData, levelOffset, byteOffset) ||
+            !ReadValue(fileData, levelOffset + sizeof(uint64_t), byteLength) ||
+            !GetLevelData(fileData, byteOffset, byteLength, image.levels[level]))
+            return false;
+    }
+
+    return image.internalFormat != TextureObject::InternalFormatInvalid;
+}
+
+bool CompressedTexture2DLoader::ReadDDS(std::span<const std::byte> fileData, Image& image)
+{
+    // DDS_HEADER after the magic number, with the DDS_PIXELFORMAT at offset 76
+    uint32_t headerSize, height, width, mipMapCount, pixelFormatFlags, fourCC;
+    if (!ReadValue(fileData, 4, headerSize) ||
+        !ReadValue(fileData, 12, height) ||
+        !ReadValue(fileData, 16, width) ||
+        !ReadValue(fileData, 28, mipMapCount) ||
+        !ReadValue(fileData, 80, pixelFormatFlags) ||
+        !ReadValue(fileData, 84, fourCC))
+        return false;
+
+    const uint32_t DDPF_FOURCC = 0x4;
+    if (headerSize != 124 || !(pixelFormatFlags & DDPF_FOURCC))
+        return false;
+
+    size_t dataOffset = 4 + 124;
+    if (fourCC == MakeFourCC('D', 'X', '1', '0'))
+    {
+        // DDS_HEADER_DXT10 follows the header. Arrays and 3D textures are not supported
+        uint32_t dxgiFormat, resourceDimension, arraySize;
+        if (!ReadValue(fileData, dataOffset, dxgiFormat) ||
+            !ReadValue(fileData, dataOffset + 4, resourceDimension) ||
+            !ReadValue(fileData, dataOffset + 12, arraySize))
+            return false;
+
+        const uint32_t D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3;
+        if (resourceDimension != D3D10_RESOURCE_DIMENSION_TEXTURE2D || arraySize > 1)
+            return false;
+
+        image.internalFormat = GetInternalFormatFromDXGIFormat(dxgiFormat);
+        dataOffset += 20;
+    }
+    else
+    {
+        image.internalFormat = GetInternalFormatFromFourCC(fourCC);
+    }
+
+    if (image.internalFormat == TextureObject::InternalFormatInvalid)
+        return false;
+
+    image.width = static_cast<int>(width);
+    image.height = static_cast<int>(height);
+
+    // Levels are stored one after the other, the biggest first
+    uint32_t levelCount = std::max(mipMapCount, 1u);
+    if (levelCount > s_maxLevelCount)
+        return false;
+    image.levels.resize(levelCount);
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        size_t levelSize = TextureObject::GetCompressedImageSize(image.internalFormat, std::max(image.width >> level, 1), std::max(image.height >> level, 1));
+        if (!GetLevelData(fileData, dataOffset, levelSize, image.levels[level]))
+            return false;
+        dataOffset += levelSize;
+    }
+
+    return true;
+}
+
+bool CompressedTexture2DLoader::ValidateLevels(const Image& image)
+{
+    if (image.width <= 0 || image.height <= 0 || image.levels.empty())
+        return false;
+
+    // Levels beyond 1x1 are not valid
+    int maxLevelCount = 1;
+    while ((std::max(image.width, image.height) >> maxLevelCount) > 0)
+    {
+        ++maxLevelCount;
+    }
+    if (image.levels.size() > maxLevelCount)
+        return false;
+
+    for (int level = 0; level < image.levels.size(); ++level)
+    {
+        size_t levelSize = TextureObject::GetCompressedImageSize(image.internalFormat, std::max(image.width >> level, 1), std::max(image.height >> level, 1));
+        if (image.levels[level].size() != levelSize)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,164 @@
+#include <ituGL/asset/FileWatcher.h>
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+FileWatcher::FileWatcher()
+#ifdef __linux__
+    : m_inotifyDescriptor(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+#endif
+{
+#ifdef __linux__
+    // Without inotify, files are still checked by their modification time
+    if (m_inotifyDescriptor < 0)
+    {
+        std::cout << "ERROR::FILE_WATCHER::INOTIFY_INIT_FAILED\n" << std::strerror(errno) << std::endl;
+    }
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (m_inotifyDescriptor >= 0)
+    {
+        close(m_inotifyDescriptor);
+    }
+#endif
+}
+
+void FileWatcher::Watch(const std::string& path, Callback callback)
+{
+    std::string key = GetKey(path);
+
+    auto itWatchedFile = m_watchedFiles.find(key);
+    if (itWatchedFile == m_watchedFiles.end())
+    {
+        WatchedFile watchedFile;
+        watchedFile.path = path;
+        std::error_code error;
+        watchedFile.modifiedTime = std::filesystem::last_write_time(key, error);
+        itWatchedFile = m_watchedFiles.emplace(key, std::move(watchedFile)).first;
+
+#ifdef __linux__
+        WatchDirectory(std::filesystem::path(key).parent_path());
+#endif
+    }
+
+    itWatchedFile->second.callbacks.push_back(std::move(callback));
+}
+
+void FileWatcher::Update()
+{
+    std::vector<std::string> modifiedKeys;
+
+#ifdef __linux__
+    if (m_inotifyDescriptor >= 0)
+    {
+        ReadEvents(modifiedKeys);
+    }
+    else
+#endif
+    {
+        for (const auto& watchedFile : m_watchedFiles)
+        {
+            CheckModified(watchedFile.first, modifiedKeys);
+        }
+    }
+
+    for (const std::string& key : modifiedKeys)
+    {
+        // Copied, because the callbacks can watch more files
+        WatchedFile watchedFile = m_watchedFiles.at(key);
+        for (const Callback& callback : watchedFile.callbacks)
+        {
+            callback(watchedFile.path);
+        }
+    }
+}
+
+std::string FileWatcher::GetKey(const std::filesystem::path& path)
+{
+    return std::filesystem::absolute(path).lexically_normal().generic_string();
+}
+
+void FileWatcher::CheckModified(const std::string& key, std::vector<std::string>& modifiedKeys)
+{
+    // Missing while it is being replaced. The next event, or the next check, will find it
+    std::error_code error;
+    std::filesystem::file_time_type modifiedTime = std::filesystem::last_write_time(key, error);
+    if (error)
+        return;
+
+    WatchedFile& watchedFile = m_watchedFiles.at(key);
+    if (watchedFile.modifiedTime != modifiedTime)
+    {
+        watchedFile.modifiedTime = modifiedTime;
+        if (std::find(modifiedKeys.begin(), modifiedKeys.end(), key) == modifiedKeys.end())
+        {
+            modifiedKeys.push_back(key);
+        }
+    }
+}
+
+#ifdef __linux__
+void FileWatcher::WatchDirectory(const std::filesystem::path& directory)
+{
+    if (m_inotifyDescriptor < 0)
+        return;
+
+    // Adding the same directory again returns the same descriptor
+    int watchDescriptor = inotify_add_watch(m_inotifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (watchDescriptor >= 0)
+    {
+        m_watchedDirectories[watchDescriptor] = directory;
+    }
+    else
+    {
+        std::cout << "ERROR::FILE_WATCHER::WATCH_FAILED\n" << directory.generic_string() << ": " << std::strerror(errno) << std::endl;
+    }
+}
+
+void FileWatcher::ReadEvents(std::vector<std::string>& modifiedKeys)
+{
+    alignas(inotify_event) std::array<char, 4096> buffer;
+    while (true)
+    {
+        ssize_t length = read(m_inotifyDescriptor, buffer.data(), buffer.size());
+        if (length <= 0)
+        {
+            // The descriptor is non-blocking, EAGAIN only means that there are no more events
+            if (length < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                std::cout << "ERROR::FILE_WATCHER::READ_FAILED\n" << std::strerror(errno) << std::endl;
+            }
+            break;
+        }
+
+        for (ssize_t offset = 0; offset < length; )
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            auto itDirectory = m_watchedDirectories.find(event->wd);
+            if (event->len == 0 || itDirectory == m_watchedDirectories.end())
+                continue;
+
+            // Other files in the same directory are ignored
+            std::string key = (itDirectory->second / event->name).generic_string();
+            if (m_watchedFiles.contains(key))
+            {
+                CheckModified(key, modifiedKeys);
+            }
+        }
+    }
+}
+#endif
@@ -0,0 +1,130 @@
+#include <ituGL/asset/MemoryMappedFile.h>
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_fileHandle(nullptr)
+    , m_mappingHandle(nullptr)
+#endif
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& memoryMappedFile) noexcept : MemoryMappedFile()
+{
+    *this = std::move(memoryMappedFile);
+}
+
+MemoryMappedFile& MemoryMappedFile::operator = (MemoryMappedFile&& memoryMappedFile) noexcept
+{
+    std::swap(m_data, memoryMappedFile.m_data);
+    std::swap(m_size, memoryMappedFile.m_size);
+#ifdef _WIN32
+    std::swap(m_fileHandle, memoryMappedFile.m_fileHandle);
+    std::swap(m_mappingHandle, memoryMappedFile.m_mappingHandle);
+#endif
+    return *this;
+}
+
+bool MemoryMappedFile::Open(const char* path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    HANDLE mappingHandle = nullptr;
+    if (GetFileSizeEx(fileHandle, &fileSize) && fileSize.QuadPart > 0)
+    {
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    void* data = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data)
+    {
+        if (mappingHandle)
+        {
+            CloseHandle(mappingHandle);
+        }
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    m_fileHandle = fileHandle;
+    m_mappingHandle = mappingHandle;
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    int fileDescriptor = open(path, O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0)
+        return false;
+
+    struct stat fileStatus;
+    void* data = MAP_FAILED;
+    if (fstat(fileDescriptor, &fileStatus) == 0 && fileStatus.st_size > 0)
+    {
+        data = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    }
+
+    // The mapping keeps the file open
+    close(fileDescriptor);
+    if (data == MAP_FAILED)
+        return false;
+
+    m_size = static_cast<std::size_t>(fileStatus.st_size);
+#endif
+
+    m_data = static_cast<const std::byte*>(data);
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if (!m_data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(m_mappingHandle);
+    CloseHandle(m_fileHandle);
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+#else
+    munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void MemoryMappedFile::Prefetch() const
+{
+    if (!m_data)
+        return;
+
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range = { const_cast<std::byte*>(m_data), m_size };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    madvise(const_cast<std::byte*>(m_data), m_size, MADV_WILLNEED);
+#endif
+}
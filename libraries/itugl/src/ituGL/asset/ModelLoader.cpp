@@ -3,15 +3,157 @@
 #include <ituGL/geometry/VertexFormat.h>
 #include <ituGL/shader/Material.h>
 #include <ituGL/asset/Texture2DLoader.h>
+#include <ituGL/asset/AssetRegistry.h>
+#include <ituGL/asset/MemoryMappedFile.h>
+#include <ituGL/asset/MeshCacheFormat.h>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
+#include <glm/packing.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
+#include <ituGL/utils/ThreadPool.h>
 #include <iostream>
+#include <algorithm>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <array>
 #include <bit>
 
+static const unsigned int s_importFlags =
+    aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType;
+
+// FNV-1a
+static std::uint64_t Hash(std::uint64_t hash, const void* data, std::size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::uint64_t AlignCacheOffset(std::uint64_t offset)
+{
+    return (offset + MeshCacheHeader::DataAlignment - 1) & ~static_cast<std::uint64_t>(MeshCacheHeader::DataAlignment - 1);
+}
+
+// Copy a table of the cache file, checking that it is inside the file. The offset moves to the end of the table
+template<typename T>
+static bool ReadCacheTable(std::span<const std::byte> data, std::uint64_t& offset, std::uint32_t count, std::vector<T>& table)
+{
+    std::uint64_t size = static_cast<std::uint64_t>(count) * sizeof(T);
+    if (offset > data.size() || size > data.size() - offset)
+        return false;
+
+    table.resize(count);
+    std::memcpy(table.data(), data.data() + offset, size);
+    offset += size;
+    return true;
+}
+
+// Map a unit vector to the octahedron, unfolded on a square in [-1, 1]
+static glm::vec2 EncodeOctahedral(glm::vec3 normal)
+{
+    normal /= std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    glm::vec2 encoded(normal.x, normal.y);
+    if (normal.z < 0.0f)
+    {
+        glm::vec2 signs(normal.x >= 0.0f ? 1.0f : -1.0f, normal.y >= 0.0f ? 1.0f : -1.0f);
+        encoded = (1.0f - glm::abs(glm::vec2(encoded.y, encoded.x))) * signs;
+    }
+    return encoded;
+}
+
+static bool IsInsideCache(std::span<const std::byte> data, std::uint64_t offset, std::uint64_t size)
+{
+    return offset <= data.size() && size <= data.size() - offset;
+}
+
+// Enum values read from the cache are checked before casting, an unknown value means the cache is corrupt
+static bool IsValidCacheAttributeType(std::uint16_t type)
+{
+    switch (static_cast<Data::Type>(type))
+    {
+    case Data::Type::Float:
+    case Data::Type::Fixed:
+    case Data::Type::Half:
+    case Data::Type::Double:
+    case Data::Type::Byte:
+    case Data::Type::UByte:
+    case Data::Type::Short:
+    case Data::Type::UShort:
+    case Data::Type::Int:
+    case Data::Type::UInt:
+    case Data::Type::Int2_10_10_10_Rev:
+    case Data::Type::UInt2_10_10_10_Rev:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Imported meshes always have elements, and the ranges are divided by their size
+static bool IsValidCacheElementType(std::uint32_t type)
+{
+    // Stored with 32 bits, but Data::Type has 16. Larger values would be truncated by the cast
+    if (type > 0xFFFF)
+        return false;
+
+    switch (static_cast<Data::Type>(type))
+    {
+    case Data::Type::UByte:
+    case Data::Type::UShort:
+    case Data::Type::UInt:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool IsValidCachePrimitive(std::uint32_t primitive)
+{
+    switch (static_cast<Drawcall::Primitive>(primitive))
+    {
+    case Drawcall::Primitive::Points:
+    case Drawcall::Primitive::Lines:
+    case Drawcall::Primitive::LineStrip:
+    case Drawcall::Primitive::LineLoop:
+    case Drawcall::Primitive::LinesAdjacency:
+    case Drawcall::Primitive::LineStripAdjacency:
+    case Drawcall::Primitive::Triangles:
+    case Drawcall::Primitive::TriangleStrip:
+    case Drawcall::Primitive::TriangleFan:
+    case Drawcall::Primitive::TrianglesAdjacency:
+    case Drawcall::Primitive::TriangleStripAdjacency:
+    case Drawcall::Primitive::Patches:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool IsValidCacheSemantic(std::uint32_t semantic)
+{
+    return semantic <= static_cast<std::uint32_t>(VertexAttribute::Semantic::Color7);
+}
+
 ModelLoader::ModelLoader(std::shared_ptr<Material> referenceMaterial)
     : m_referenceMaterial(referenceMaterial)
     , m_createMaterials(false)
+    , m_normalFormat(NormalFormat::Float)
+    , m_quantizeTexCoords(false)
+    , m_quantizePositions(false)
+    , m_optimizeMeshes(false)
+    , m_assetRegistry(nullptr)
+    , m_geometryHeap(nullptr)
 {
 }
 
@@ -38,6 +180,56 @@ void ModelLoader::SetCreateMaterials(bool createMaterials)
     m_createMaterials = createMaterials;
 }
 
+ModelLoader::NormalFormat ModelLoader::GetNormalFormat() const
+{
+    return m_normalFormat;
+}
+
+void ModelLoader::SetNormalFormat(NormalFormat normalFormat)
+{
+    m_normalFormat = normalFormat;
+}
+
+bool ModelLoader::GetQuantizeTexCoords() const
+{
+    return m_quantizeTexCoords;
+}
+
+void ModelLoader::SetQuantizeTexCoords(bool quantizeTexCoords)
+{
+    m_quantizeTexCoords = quantizeTexCoords;
+}
+
+bool ModelLoader::GetQuantizePositions() const
+{
+    return m_quantizePositions;
+}
+
+void ModelLoader::SetQuantizePositions(bool quantizePositions)
+{
+    m_quantizePositions = quantizePositions;
+}
+
+bool ModelLoader::GetOptimizeMeshes() const
+{
+    return m_optimizeMeshes;
+}
+
+void ModelLoader::SetOptimizeMeshes(bool optimizeMeshes)
+{
+    m_optimizeMeshes = optimizeMeshes;
+}
+
+const std::filesystem::path& ModelLoader::GetCacheDirectory() const
+{
+    return m_cacheDirectory;
+}
+
+void ModelLoader::SetCacheDirectory(const std::filesystem::path& cacheDirectory)
+{
+    m_cacheDirectory = cacheDirectory;
+}
+
 bool ModelLoader::SetMaterialAttribute(VertexAttribute::Semantic semantic, const char* attributeName)
 {
     bool found = false;
@@ -64,138 +256,411 @@ bool ModelLoader::SetMaterialProperty(MaterialProperty materialProperty, const c
 
 Model ModelLoader::Load(const char* path)
 {
-    Model model;
+    m_importedStatistics = MeshOptimizer::VertexCacheStatistics();
+    m_optimizedStatistics = MeshOptimizer::VertexCacheStatistics();
+
+    ModelData modelData;
+    ReadModelData(path, modelData);
+    return GenerateModel(modelData);
+}
+
+std::vector<Model> ModelLoader::Load(std::span<const char* const> paths, ThreadPool& threadPool)
+{
+    m_importedStatistics = MeshOptimizer::VertexCacheStatistics();
+    m_optimizedStatistics = MeshOptimizer::VertexCacheStatistics();
+
+    // Each path is read once, repeated paths share the mesh
+    std::vector<std::string> uniquePaths;
+    std::vector<std::size_t> pathIndices(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        std::string normalizedPath = std::filesystem::path(paths[i]).lexically_normal().generic_string();
+        auto itPath = std::find(uniquePaths.begin(), uniquePaths.end(), normalizedPath);
+        pathIndices[i] = itPath - uniquePaths.begin();
+        if (itPath == uniquePaths.end())
+        {
+            uniquePaths.push_back(normalizedPath);
+        }
+    }
+
+    // Workers push the index of each model read, to upload it while the others are still being read
+    // Models that fail to read push their index too, with the exception to rethrow in this thread
+    std::vector<ModelData> modelData(uniquePaths.size());
+    std::vector<std::exception_ptr> readErrors(uniquePaths.size());
+    std::mutex mutex;
+    std::condition_variable modelRead;
+    std::vector<std::size_t> readModels;
+
+    // The tasks can reference the locals, this function doesn't return until all of them have finished
+    for (std::size_t i = 0; i < uniquePaths.size(); ++i)
+    {
+        threadPool.Submit([this, i, &uniquePaths, &modelData, &readErrors, &mutex, &modelRead, &readModels]()
+            {
+                try
+                {
+                    ReadModelData(uniquePaths[i].c_str(), modelData[i]);
+                }
+                catch (...)
+                {
+                    readErrors[i] = std::current_exception();
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                readModels.push_back(i);
+                modelRead.notify_one();
+            });
+    }
+
+    // Errors are kept until all the tasks are done, the first one is thrown after that
+    std::exception_ptr error;
+    std::vector<Model> uniqueModels(uniquePaths.size());
+    for (std::size_t uploaded = 0; uploaded < uniquePaths.size(); ++uploaded)
+    {
+        std::size_t index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            modelRead.wait(lock, [&]() { return !readModels.empty(); });
+            index = readModels.back();
+            readModels.pop_back();
+        }
+
+        if (!error && readErrors[index])
+        {
+            error = readErrors[index];
+        }
+        if (error)
+        {
+            modelData[index] = ModelData();
+            continue;
+        }
+
+        // Release the collected data as soon as it is in the buffers
+        try
+        {
+            uniqueModels[index] = GenerateModel(modelData[index]);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        modelData[index] = ModelData();
+    }
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+
+    std::vector<Model> models(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        models[i] = uniqueModels[pathIndices[i]];
+    }
+    return models;
+}
+
+void ModelLoader::ReadModelData(const char* path, ModelData& modelData) const
+{
+    modelData.baseFolder = path;
+    modelData.baseFolder.resize(modelData.baseFolder.rfind('/') + 1);
+
+    // Map the cache and upload the data straight from it, if it was written from the same source file
+    std::filesystem::path cachePath;
+    std::uint64_t sourceHash = 0;
+    bool cacheEnabled = !m_cacheDirectory.empty() && ComputeSourceHash(path, sourceHash);
+    if (cacheEnabled)
+    {
+        cachePath = GetCachePath(path);
+        if (modelData.cacheFile.Open(cachePath.string().c_str()) &&
+            ReadCache(modelData.cacheFile.GetData(), sourceHash, modelData.meshes, modelData.materials))
+        {
+            modelData.loaded = true;
+            return;
+        }
+        modelData.cacheFile.Close();
+        modelData.meshes.clear();
+        modelData.materials.clear();
+    }
 
     // Read the file using Assimp importer
     Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(path,
-        aiProcess_CalcTangentSpace | aiProcess_GenNormals | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType);
-
-    m_baseFolder = path;
-    m_baseFolder.resize(m_baseFolder.rfind('/') + 1);
+    const aiScene* scene = importer.ReadFile(path, s_importFlags);
 
     // If the file was loaded, load all the meshes as submeshes
-    if (scene)
+    if (!scene)
+        return;
+
+    // Buffers of the collected data, referenced by the mesh data
+    modelData.buffers.reserve(scene->mNumMeshes * 2);
+    modelData.meshes.resize(scene->mNumMeshes);
+    for (unsigned int meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex)
     {
-        model.SetMesh(std::make_shared<Mesh>());
-        Mesh& mesh = model.GetMesh();
-        for (unsigned int meshIndex = 0; meshIndex < scene->mNumMeshes; ++meshIndex)
+        const aiMesh& mesh = *scene->mMeshes[meshIndex];
+        MeshData& meshData = modelData.meshes[meshIndex];
+
+        // Collect vertex data
+        bool interleaved = true;
+        std::vector<GLubyte>& vertexData = modelData.buffers.emplace_back(CollectVertexData(mesh, meshData.vertexFormat, interleaved,
+            meshData.positionOffset, meshData.positionScale));
+
+        // Collect element data
+        std::vector<GLubyte>& elementData = modelData.buffers.emplace_back(CollectElementData(mesh, meshData.elementType, meshData.primitives, meshData.elementCounts));
+
+        if (m_optimizeMeshes && mesh.mPrimitiveTypes == aiPrimitiveType_TRIANGLE)
+        {
+            std::span<const std::byte> positions(reinterpret_cast<const std::byte*>(mesh.mVertices), mesh.mNumVertices * sizeof(aiVector3D));
+            OptimizeMesh(vertexData, meshData.vertexFormat.GetSize(), elementData, meshData.elementType, positions,
+                modelData.importedStatistics, modelData.optimizedStatistics);
+        }
+
+        meshData.vertexData = vertexData;
+        meshData.elementData = elementData;
+        meshData.materialIndex = mesh.mMaterialIndex;
+    }
+
+    modelData.materials.resize(scene->mNumMaterials);
+    for (unsigned int materialIndex = 0; materialIndex < scene->mNumMaterials; ++materialIndex)
+    {
+        CollectMaterialData(*scene->mMaterials[materialIndex], modelData.materials[materialIndex]);
+    }
+
+    if (cacheEnabled && !WriteCache(cachePath, sourceHash, modelData.meshes, modelData.materials))
+    {
+        std::cout << "ERROR::MODEL::CACHE_WRITE_FAILED\n" << cachePath.string() << std::endl;
+    }
+    modelData.loaded = true;
+}
+
+Model ModelLoader::GenerateModel(const ModelData& modelData)
+{
+    if (!modelData.loaded)
+        return Model();
+
+    m_baseFolder = modelData.baseFolder;
+    m_importedStatistics += modelData.importedStatistics;
+    m_optimizedStatistics += modelData.optimizedStatistics;
+    return GenerateModel(modelData.meshes, modelData.materials);
+}
+
+Model ModelLoader::GenerateModel(std::span<const MeshData> meshes, std::span<const MaterialData> materials)
+{
+    Model model;
+    model.SetMesh(std::make_shared<Mesh>());
+    Mesh& mesh = model.GetMesh();
+    for (const MeshData& meshData : meshes)
+    {
+        GenerateSubmesh(mesh, meshData);
+
+        std::shared_ptr<Material> material = m_referenceMaterial;
+        if (m_createMaterials)
         {
-            aiMesh& meshData = *scene->mMeshes[meshIndex];
-            GenerateSubmesh(mesh, meshData);
+            // Create a new material with the material data
+            material = GenerateMaterial(materials[meshData.materialIndex]);
+        }
 
-            std::shared_ptr<Material> material = m_referenceMaterial;
-            if (m_createMaterials)
+        // Quantized positions need the bounds of their mesh to be scaled back
+        if (material && meshData.vertexFormat.GetAttribute(0).GetType() != Data::Type::Float)
+        {
+            auto itPositionOffset = m_materialPropertyMap.find(MaterialProperty::PositionOffset);
+            auto itPositionScale = m_materialPropertyMap.find(MaterialProperty::PositionScale);
+            if (itPositionOffset != m_materialPropertyMap.end() || itPositionScale != m_materialPropertyMap.end())
             {
-                // Create a new material with the material data
-                material = GenerateMaterial(*scene->mMaterials[meshData.mMaterialIndex]);
+                if (material == m_referenceMaterial)
+                {
+                    material = std::make_shared<Material>(*m_referenceMaterial);
+                }
+                if (itPositionOffset != m_materialPropertyMap.end())
+                {
+                    material->SetUniformValue(itPositionOffset->second, meshData.positionOffset);
+                }
+                if (itPositionScale != m_materialPropertyMap.end())
+                {
+                    material->SetUniformValue(itPositionScale->second, meshData.positionScale);
+                }
             }
-            model.AddMaterial(material);
         }
+        model.AddMaterial(material);
     }
-
     return model;
 }
 
-void ModelLoader::GenerateSubmesh(Mesh& mesh, const aiMesh& meshData)
+void ModelLoader::GenerateSubmesh(Mesh& mesh, const MeshData& meshData)
 {
-    // Collect vertex data
-    VertexFormat vertexFormat;
     bool interleaved = true;
-    std::vector<GLubyte> vertexData = CollectVertexData(meshData, vertexFormat, interleaved);
-    int vboIndex = mesh.AddVertexData<GLubyte>(vertexData);
-
-    // Collect element data
-    Data::Type elementType;
-    std::vector<Drawcall::Primitive> primitives;
-    std::vector<int> elementCounts;
-    std::vector<GLubyte> elementData = CollectElementData(meshData, elementType, primitives, elementCounts);
-    int eboIndex = mesh.AddElementData<GLubyte>(elementData);
+    int heapDataIndex = -1;
+    int vboIndex = -1;
+    int eboIndex = -1;
+    if (m_geometryHeap)
+    {
+        heapDataIndex = mesh.AddHeapData(*m_geometryHeap, meshData.vertexFormat, meshData.vertexData, meshData.elementData,
+            meshData.elementType, m_materialAttributeMap);
+    }
+    else
+    {
+        vboIndex = mesh.AddVertexData<GLubyte>(meshData.vertexData);
+        eboIndex = mesh.AddElementData<GLubyte>(meshData.elementData);
+    }
 
-    // Add submeshes
+    // Add submeshes. Element counts are the end of each range, in bytes
+    int elementSize = Data::GetTypeSize(meshData.elementType);
     int start = 0;
-    assert(primitives.size() == elementCounts.size());
-    for (int i = 0; i < primitives.size(); ++i)
+    assert(meshData.primitives.size() == meshData.elementCounts.size());
+    for (int i = 0; i < meshData.primitives.size(); ++i)
     {
-        Drawcall::Primitive primitive = primitives[i];
-        int end = elementCounts[i];
-        mesh.AddSubmesh(primitive, start, end - start, elementType, eboIndex, vboIndex, vertexFormat.LayoutBegin(static_cast<int>(vertexData.size()), interleaved), vertexFormat.LayoutEnd(), m_materialAttributeMap);
+        Drawcall::Primitive primitive = meshData.primitives[i];
+        int end = meshData.elementCounts[i];
+        if (m_geometryHeap)
+        {
+            mesh.AddHeapSubmesh(heapDataIndex, primitive, start, (end - start) / elementSize);
+        }
+        else
+        {
+            mesh.AddSubmesh(primitive, start, (end - start) / elementSize, meshData.elementType, vboIndex, eboIndex,
+                meshData.vertexFormat.LayoutBegin(static_cast<int>(meshData.vertexData.size()), interleaved), meshData.vertexFormat.LayoutEnd(), m_materialAttributeMap);
+        }
         start = end;
     }
 }
 
-std::shared_ptr<Material> ModelLoader::GenerateMaterial(const aiMaterial& materialData)
+std::shared_ptr<Material> ModelLoader::GenerateMaterial(const MaterialData& materialData)
 {
     std::shared_ptr<Material> material = std::make_shared<Material>(*m_referenceMaterial);
     for (auto& materialPropertyPair : m_materialPropertyMap)
     {
-        aiColor3D color;
-        float value;
         MaterialProperty materialProperty = materialPropertyPair.first;
         ShaderProgram::Location location = materialPropertyPair.second;
+        if ((materialData.propertyMask & (1u << static_cast<unsigned int>(materialProperty))) == 0)
+            continue;
+
         switch (materialProperty)
         {
         case MaterialProperty::AmbientColor:
-            if (materialData.Get(AI_MATKEY_COLOR_AMBIENT, color) == aiReturn_SUCCESS)
-            {
-                material->SetUniformValue(location, glm::vec3(color.r, color.g, color.b));
-            }
+            material->SetUniformValue(location, materialData.ambientColor);
             break;
         case MaterialProperty::DiffuseColor:
-            if (materialData.Get(AI_MATKEY_COLOR_DIFFUSE, color) == aiReturn_SUCCESS)
-            {
-                material->SetUniformValue(location, glm::vec3(color.r, color.g, color.b));
-            }
+            material->SetUniformValue(location, materialData.diffuseColor);
             break;
         case MaterialProperty::SpecularColor:
-            if (materialData.Get(AI_MATKEY_COLOR_SPECULAR, color) == aiReturn_SUCCESS)
-            {
-                material->SetUniformValue(location, glm::vec3(color.r, color.g, color.b));
-            }
+            material->SetUniformValue(location, materialData.specularColor);
             break;
         case MaterialProperty::SpecularExponent:
-            if (materialData.Get(AI_MATKEY_SHININESS, value) == aiReturn_SUCCESS)
-            {
-                material->SetUniformValue(location, value);
-            }
+            material->SetUniformValue(location, materialData.specularExponent);
             break;
         case MaterialProperty::DiffuseTexture:
-            if (materialData.GetTextureCount(aiTextureType_DIFFUSE) > 0)
             {
-                assert(materialData.GetTextureCount(aiTextureType_DIFFUSE) == 1);
-                aiString texturePath;
-                if (materialData.GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == aiReturn_SUCCESS)
+                std::string texturePath = m_baseFolder + materialData.diffuseTexture;
+                if (m_assetRegistry)
+                {
+                    Texture2DLoader textureLoader(TextureObject::FormatRGB, TextureObject::InternalFormatSRGB8);
+                    textureLoader.SetGenerateMipmap(true);
+                    material->SetUniformValue(location, m_assetRegistry->LoadTexture2D(textureLoader, texturePath.c_str()));
+                }
+                else
                 {
-                    texturePath = m_baseFolder + texturePath.C_Str();
-                    material->SetUniformValue(location, Texture2DLoader::LoadTextureShared(texturePath.C_Str(),
+                    material->SetUniformValue(location, Texture2DLoader::LoadTextureShared(texturePath.c_str(),
                         TextureObject::FormatRGB, TextureObject::InternalFormatSRGB8));
                 }
             }
             break;
+        default:
+            // Set for each mesh
+            break;
         }
     }
     return material;
 }
 
+void ModelLoader::CollectMaterialData(const aiMaterial& material, MaterialData& materialData)
+{
+    aiColor3D color;
+    float value;
+    if (material.Get(AI_MATKEY_COLOR_AMBIENT, color) == aiReturn_SUCCESS)
+    {
+        materialData.ambientColor = glm::vec3(color.r, color.g, color.b);
+        materialData.propertyMask |= 1u << static_cast<unsigned int>(MaterialProperty::AmbientColor);
+    }
+    if (material.Get(AI_MATKEY_COLOR_DIFFUSE, color) == aiReturn_SUCCESS)
+    {
+        materialData.diffuseColor = glm::vec3(color.r, color.g, color.b);
+        materialData.propertyMask |= 1u << static_cast<unsigned int>(MaterialProperty::DiffuseColor);
+    }
+    if (material.Get(AI_MATKEY_COLOR_SPECULAR, color) == aiReturn_SUCCESS)
+    {
+        materialData.specularColor = glm::vec3(color.r, color.g, color.b);
+        materialData.propertyMask |= 1u << static_cast<unsigned int>(MaterialProperty::SpecularColor);
+    }
+    if (material.Get(AI_MATKEY_SHININESS, value) == aiReturn_SUCCESS)
+    {
+        materialData.specularExponent = value;
+        materialData.propertyMask |= 1u << static_cast<unsigned int>(MaterialProperty::SpecularExponent);
+    }
+    if (material.GetTextureCount(aiTextureType_DIFFUSE) > 0)
+    {
+        assert(material.GetTextureCount(aiTextureType_DIFFUSE) == 1);
+        aiString texturePath;
+        if (material.GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == aiReturn_SUCCESS)
+        {
+            materialData.diffuseTexture = texturePath.C_Str();
+            materialData.propertyMask |= 1u << static_cast<unsigned int>(MaterialProperty::DiffuseTexture);
+        }
+    }
+}
 
-std::vector<GLubyte> ModelLoader::CollectVertexData(const aiMesh& meshData, VertexFormat& vertexFormat, bool interleaved)
+
+std::vector<GLubyte> ModelLoader::CollectVertexData(const aiMesh& meshData, VertexFormat& vertexFormat, bool interleaved,
+    glm::vec3& positionOffset, glm::vec3& positionScale) const
 {
     vertexFormat.Clear();
 
     // Buid the vertex format with the available vertex data
 
     assert(meshData.HasPositions());
+    if (m_quantizePositions)
+    {
+        // 4 components, so that the next attribute stays aligned
+        vertexFormat.AddVertexAttribute<GLushort>(4, true, VertexAttribute::Semantic::Position);
+
+        glm::vec3 boundsMin(meshData.mVertices[0].x, meshData.mVertices[0].y, meshData.mVertices[0].z);
+        glm::vec3 boundsMax = boundsMin;
+        for (unsigned int i = 1; i < meshData.mNumVertices; ++i)
+        {
+            glm::vec3 position(meshData.mVertices[i].x, meshData.mVertices[i].y, meshData.mVertices[i].z);
+            boundsMin = glm::min(boundsMin, position);
+            boundsMax = glm::max(boundsMax, position);
+        }
+        positionOffset = boundsMin;
+        positionScale = boundsMax - boundsMin;
+    }
+    else
     {
         vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Position);
     }
     if (meshData.HasNormals())
     {
-        vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Normal);
+        switch (m_normalFormat)
+        {
+        case NormalFormat::Float:
+            vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Normal);
+            break;
+        case NormalFormat::Packed:
+            vertexFormat.AddVertexAttribute(Data::Type::Int2_10_10_10_Rev, 4, true, VertexAttribute::Semantic::Normal);
+            break;
+        case NormalFormat::Octahedral:
+            vertexFormat.AddVertexAttribute<GLshort>(2, true, VertexAttribute::Semantic::Normal);
+            break;
+        }
     }
     if (meshData.HasTangentsAndBitangents())
     {
-        vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Tangent);
-        vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Bitangent);
+        if (m_normalFormat == NormalFormat::Float)
+        {
+            vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Tangent);
+            vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Bitangent);
+        }
+        else
+        {
+            vertexFormat.AddVertexAttribute(Data::Type::Int2_10_10_10_Rev, 4, true, VertexAttribute::Semantic::Tangent);
+        }
     }
     unsigned int colorSemantic = static_cast<unsigned int>(VertexAttribute::Semantic::Color0);
     for (unsigned int colorChannel = 0; colorChannel < meshData.GetNumColorChannels(); ++colorChannel)
@@ -205,7 +670,15 @@ std::vector<GLubyte> ModelLoader::CollectVertexData(const aiMesh& meshData, Vert
     unsigned int uvSemantic = static_cast<unsigned int>(VertexAttribute::Semantic::TexCoord0);
     for (unsigned int uvChannel = 0; uvChannel < meshData.GetNumUVChannels(); ++uvChannel)
     {
-        vertexFormat.AddVertexAttribute<float>(meshData.mNumUVComponents[uvChannel], static_cast<VertexAttribute::Semantic>(uvSemantic + uvChannel));
+        VertexAttribute::Semantic semantic = static_cast<VertexAttribute::Semantic>(uvSemantic + uvChannel);
+        if (m_quantizeTexCoords && meshData.mNumUVComponents[uvChannel] == 2)
+        {
+            vertexFormat.AddVertexAttribute(Data::Type::Half, 2, false, semantic);
+        }
+        else
+        {
+            vertexFormat.AddVertexAttribute<float>(meshData.mNumUVComponents[uvChannel], semantic);
+        }
     }
 
     std::vector<GLubyte> vertexData;
@@ -219,10 +692,17 @@ std::vector<GLubyte> ModelLoader::CollectVertexData(const aiMesh& meshData, Vert
         const VertexAttribute& attribute = it->GetAttribute();
         int dstStride = it->GetStride();
         void* dstBuffer = &vertexData[it->GetOffset()];
-        int srcStride = 0;
-        const void* srcBuffer = GetVertexDataPointer(meshData, attribute.GetSemantic(), srcStride);
-        assert(srcBuffer);
-        CopyBuffer(dstBuffer, dstStride, srcBuffer, srcStride, meshData.mNumVertices, attribute.GetSize());
+        if (IsQuantized(attribute))
+        {
+            QuantizeBuffer(dstBuffer, dstStride, meshData, attribute, positionOffset, positionScale);
+        }
+        else
+        {
+            int srcStride = 0;
+            const void* srcBuffer = GetVertexDataPointer(meshData, attribute.GetSemantic(), srcStride);
+            assert(srcBuffer);
+            CopyBuffer(dstBuffer, dstStride, srcBuffer, srcStride, meshData.mNumVertices, attribute.GetSize());
+        }
     }
 
     return vertexData;
@@ -350,6 +830,122 @@ void ModelLoader::CopyBuffer(void* dstBuffer, size_t dstStride, const void* srcB
     }
 }
 
+bool ModelLoader::IsQuantized(const VertexAttribute& attribute)
+{
+    switch (attribute.GetSemantic())
+    {
+    case VertexAttribute::Semantic::Position:
+    case VertexAttribute::Semantic::Normal:
+    case VertexAttribute::Semantic::Tangent:
+    case VertexAttribute::Semantic::TexCoord0:
+    case VertexAttribute::Semantic::TexCoord1:
+    case VertexAttribute::Semantic::TexCoord2:
+    case VertexAttribute::Semantic::TexCoord3:
+    case VertexAttribute::Semantic::TexCoord4:
+    case VertexAttribute::Semantic::TexCoord5:
+    case VertexAttribute::Semantic::TexCoord6:
+    case VertexAttribute::Semantic::TexCoord7:
+        return attribute.GetType() != Data::Type::Float;
+    default:
+        return false;
+    }
+}
+
+void ModelLoader::QuantizeBuffer(void* dstBuffer, size_t dstStride, const aiMesh& meshData, const VertexAttribute& attribute,
+    const glm::vec3& positionOffset, const glm::vec3& positionScale)
+{
+    unsigned char* dstBytes = static_cast<unsigned char*>(dstBuffer);
+    for (unsigned int i = 0; i < meshData.mNumVertices; ++i, dstBytes += dstStride)
+    {
+        switch (attribute.GetSemantic())
+        {
+        case VertexAttribute::Semantic::Position:
+            {
+                // Flat axes have scale 0, any value works
+                const aiVector3D& position = meshData.mVertices[i];
+                glm::vec3 relative = glm::vec3(position.x, position.y, position.z) - positionOffset;
+                relative = glm::vec3(
+                    positionScale.x > 0.0f ? relative.x / positionScale.x : 0.0f,
+                    positionScale.y > 0.0f ? relative.y / positionScale.y : 0.0f,
+                    positionScale.z > 0.0f ? relative.z / positionScale.z : 0.0f);
+                glm::uint64 packed = glm::packUnorm4x16(glm::vec4(relative, 1.0f));
+                memcpy(dstBytes, &packed, sizeof(packed));
+            }
+            break;
+        case VertexAttribute::Semantic::Normal:
+            {
+                const aiVector3D& normal = meshData.mNormals[i];
+                glm::uint32 packed = attribute.GetType() == Data::Type::Short ?
+                    glm::packSnorm2x16(EncodeOctahedral(glm::vec3(normal.x, normal.y, normal.z))) :
+                    glm::packSnorm3x10_1x2(glm::vec4(normal.x, normal.y, normal.z, 0.0f));
+                memcpy(dstBytes, &packed, sizeof(packed));
+            }
+            break;
+        case VertexAttribute::Semantic::Tangent:
+            {
+                // The bitangent is rebuilt in the shader with cross(normal, tangent) * w
+                const aiVector3D& tangent = meshData.mTangents[i];
+                float bitangentSign = 1.0f;
+                if (meshData.HasNormals())
+                {
+                    aiVector3D bitangent = meshData.mNormals[i] ^ tangent;
+                    bitangentSign = bitangent * meshData.mBitangents[i] < 0.0f ? -1.0f : 1.0f;
+                }
+                glm::uint32 packed = glm::packSnorm3x10_1x2(glm::vec4(tangent.x, tangent.y, tangent.z, bitangentSign));
+                memcpy(dstBytes, &packed, sizeof(packed));
+            }
+            break;
+        default:
+            {
+                unsigned int texCoord0 = static_cast<unsigned int>(VertexAttribute::Semantic::TexCoord0);
+                const aiVector3D& texCoord = meshData.mTextureCoords[static_cast<unsigned int>(attribute.GetSemantic()) - texCoord0][i];
+                glm::uint32 packed = glm::packHalf2x16(glm::vec2(texCoord.x, texCoord.y));
+                memcpy(dstBytes, &packed, sizeof(packed));
+            }
+            break;
+        }
+    }
+}
+
+void ModelLoader::OptimizeMesh(std::vector<GLubyte>& vertexData, std::size_t vertexSize, std::vector<GLubyte>& elementData, Data::Type elementType,
+    std::span<const std::byte> positions, MeshOptimizer::VertexCacheStatistics& importedStatistics,
+    MeshOptimizer::VertexCacheStatistics& optimizedStatistics)
+{
+    // The optimizer works with 32-bit indices
+    int elementSize = Data::GetTypeSize(elementType);
+    std::vector<unsigned int> indices(elementData.size() / elementSize);
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+        switch (elementSize)
+        {
+        case 1: indices[i] = elementData[i]; break;
+        case 2: indices[i] = reinterpret_cast<const GLushort*>(elementData.data())[i]; break;
+        case 4: indices[i] = reinterpret_cast<const GLuint*>(elementData.data())[i]; break;
+        }
+    }
+
+    unsigned int vertexCount = static_cast<unsigned int>(vertexData.size() / vertexSize);
+    importedStatistics += MeshOptimizer::AnalyzeVertexCache(indices, vertexCount);
+
+    std::span<std::byte> vertexBytes = std::as_writable_bytes(std::span(vertexData));
+    MeshOptimizer::OptimizeVertexCache(indices, vertexCount);
+    MeshOptimizer::OptimizeOverdraw(indices, positions, sizeof(aiVector3D));
+    vertexCount = MeshOptimizer::OptimizeVertexFetch(indices, vertexBytes, vertexSize);
+    vertexData.resize(vertexCount * vertexSize);
+
+    optimizedStatistics += MeshOptimizer::AnalyzeVertexCache(indices, vertexCount);
+
+    for (std::size_t i = 0; i < indices.size(); ++i)
+    {
+        switch (elementSize)
+        {
+        case 1: elementData[i] = static_cast<GLubyte>(indices[i]); break;
+        case 2: reinterpret_cast<GLushort*>(elementData.data())[i] = static_cast<GLushort>(indices[i]); break;
+        case 4: reinterpret_cast<GLuint*>(elementData.data())[i] = indices[i]; break;
+        }
+    }
+}
+
 Drawcall::Primitive ModelLoader::GetPrimitiveType(int elementCount)
 {
     Drawcall::Primitive primitive = Drawcall::Primitive::Invalid;
@@ -364,3 +960,236 @@ Drawcall::Primitive ModelLoader::GetPrimitiveType(int elementCount)
     }
     return primitive;
 }
+
+std::filesystem::path ModelLoader::GetCachePath(const char* path) const
+{
+    std::string normalizedPath = std::filesystem::path(path).lexically_normal().generic_string();
+    std::uint64_t pathHash = Hash(14695981039346656037ull, normalizedPath.data(), normalizedPath.size());
+
+    std::array<char, 17> fileName;
+    std::snprintf(fileName.data(), fileName.size(), "%016llx", static_cast<unsigned long long>(pathHash));
+    return m_cacheDirectory / (std::string(fileName.data()) + ".mesh");
+}
+
+bool ModelLoader::ComputeSourceHash(const char* path, std::uint64_t& sourceHash) const
+{
+    MemoryMappedFile sourceFile;
+    if (!sourceFile.Open(path))
+        return false;
+
+    // Changing the import settings needs a new cache too
+    std::span<const std::byte> data = sourceFile.GetData();
+    sourceHash = Hash(14695981039346656037ull, &s_importFlags, sizeof(s_importFlags));
+    sourceHash = Hash(sourceHash, &m_optimizeMeshes, sizeof(m_optimizeMeshes));
+    sourceHash = Hash(sourceHash, &m_normalFormat, sizeof(m_normalFormat));
+    sourceHash = Hash(sourceHash, &m_quantizeTexCoords, sizeof(m_quantizeTexCoords));
+    sourceHash = Hash(sourceHash, &m_quantizePositions, sizeof(m_quantizePositions));
+    sourceHash = Hash(sourceHash, data.data(), data.size());
+    return true;
+}
+
+bool ModelLoader::ReadCache(std::span<const std::byte> data, std::uint64_t sourceHash,
+    std::vector<MeshData>& meshes, std::vector<MaterialData>& materials)
+{
+    MeshCacheHeader header;
+    if (data.size() < sizeof(MeshCacheHeader))
+        return false;
+
+    std::memcpy(&header, data.data(), sizeof(MeshCacheHeader));
+    if (header.magic != MeshCacheHeader::Magic || header.version != MeshCacheHeader::CurrentVersion || header.sourceHash != sourceHash)
+        return false;
+
+    std::vector<MeshCacheMesh> cacheMeshes;
+    std::vector<MeshCacheAttribute> cacheAttributes;
+    std::vector<MeshCacheRange> cacheRanges;
+    std::vector<MeshCacheMaterial> cacheMaterials;
+    std::uint64_t offset = sizeof(MeshCacheHeader);
+    if (!ReadCacheTable(data, offset, header.meshCount, cacheMeshes) ||
+        !ReadCacheTable(data, offset, header.attributeCount, cacheAttributes) ||
+        !ReadCacheTable(data, offset, header.rangeCount, cacheRanges) ||
+        !ReadCacheTable(data, offset, header.materialCount, cacheMaterials) ||
+        !IsInsideCache(data, offset, header.stringsSize))
+    {
+        return false;
+    }
+    const char* strings = reinterpret_cast<const char*>(data.data() + offset);
+
+    meshes.resize(header.meshCount);
+    for (std::uint32_t meshIndex = 0; meshIndex < header.meshCount; ++meshIndex)
+    {
+        const MeshCacheMesh& cacheMesh = cacheMeshes[meshIndex];
+        if (cacheMesh.firstAttribute > header.attributeCount || cacheMesh.attributeCount > header.attributeCount - cacheMesh.firstAttribute ||
+            cacheMesh.firstRange > header.rangeCount || cacheMesh.rangeCount > header.rangeCount - cacheMesh.firstRange ||
+            cacheMesh.materialIndex >= header.materialCount ||
+            !IsInsideCache(data, cacheMesh.vertexDataOffset, cacheMesh.vertexDataSize) ||
+            !IsInsideCache(data, cacheMesh.elementDataOffset, cacheMesh.elementDataSize) ||
+            !IsValidCacheElementType(cacheMesh.elementType))
+        {
+            return false;
+        }
+
+        MeshData& meshData = meshes[meshIndex];
+        for (std::uint32_t i = 0; i < cacheMesh.attributeCount; ++i)
+        {
+            const MeshCacheAttribute& attribute = cacheAttributes[cacheMesh.firstAttribute + i];
+            if (!IsValidCacheAttributeType(attribute.type) || !IsValidCacheSemantic(attribute.semantic))
+                return false;
+
+            meshData.vertexFormat.AddVertexAttribute(static_cast<Data::Type>(attribute.type), attribute.components,
+                attribute.normalized != 0, static_cast<VertexAttribute::Semantic>(attribute.semantic));
+        }
+        // Submeshes keep only where each range ends, so the ranges must follow each other from the start of the elements
+        std::uint64_t rangeEnd = 0;
+        for (std::uint32_t i = 0; i < cacheMesh.rangeCount; ++i)
+        {
+            const MeshCacheRange& range = cacheRanges[cacheMesh.firstRange + i];
+            if (!IsValidCachePrimitive(range.primitive) || range.first != rangeEnd)
+                return false;
+
+            rangeEnd = static_cast<std::uint64_t>(range.first) + range.count;
+            if (rangeEnd > cacheMesh.elementDataSize)
+                return false;
+
+            meshData.primitives.push_back(static_cast<Drawcall::Primitive>(range.primitive));
+            meshData.elementCounts.push_back(static_cast<int>(rangeEnd));
+        }
+        meshData.vertexData = std::span<const GLubyte>(reinterpret_cast<const GLubyte*>(data.data() + cacheMesh.vertexDataOffset),
+            static_cast<std::size_t>(cacheMesh.vertexDataSize));
+        meshData.elementType = static_cast<Data::Type>(cacheMesh.elementType);
+        meshData.elementData = std::span<const GLubyte>(reinterpret_cast<const GLubyte*>(data.data() + cacheMesh.elementDataOffset),
+            static_cast<std::size_t>(cacheMesh.elementDataSize));
+        meshData.materialIndex = cacheMesh.materialIndex;
+        meshData.positionOffset = glm::vec3(cacheMesh.positionOffset[0], cacheMesh.positionOffset[1], cacheMesh.positionOffset[2]);
+        meshData.positionScale = glm::vec3(cacheMesh.positionScale[0], cacheMesh.positionScale[1], cacheMesh.positionScale[2]);
+    }
+
+    materials.resize(header.materialCount);
+    for (std::uint32_t materialIndex = 0; materialIndex < header.materialCount; ++materialIndex)
+    {
+        const MeshCacheMaterial& cacheMaterial = cacheMaterials[materialIndex];
+        if (cacheMaterial.diffuseTextureOffset > header.stringsSize ||
+            cacheMaterial.diffuseTextureLength > header.stringsSize - cacheMaterial.diffuseTextureOffset)
+        {
+            return false;
+        }
+
+        MaterialData& materialData = materials[materialIndex];
+        materialData.propertyMask = cacheMaterial.propertyMask;
+        materialData.ambientColor = glm::vec3(cacheMaterial.ambientColor[0], cacheMaterial.ambientColor[1], cacheMaterial.ambientColor[2]);
+        materialData.diffuseColor = glm::vec3(cacheMaterial.diffuseColor[0], cacheMaterial.diffuseColor[1], cacheMaterial.diffuseColor[2]);
+        materialData.specularColor = glm::vec3(cacheMaterial.specularColor[0], cacheMaterial.specularColor[1], cacheMaterial.specularColor[2]);
+        materialData.specularExponent = cacheMaterial.specularExponent;
+        materialData.diffuseTexture.assign(strings + cacheMaterial.diffuseTextureOffset, cacheMaterial.diffuseTextureLength);
+    }
+
+    return true;
+}
+
+bool ModelLoader::WriteCache(const std::filesystem::path& cachePath, std::uint64_t sourceHash,
+    std::span<const MeshData> meshes, std::span<const MaterialData> materials)
+{
+    std::error_code error;
+    std::filesystem::create_directories(cachePath.parent_path(), error);
+
+    MeshCacheHeader header{};
+    header.magic = MeshCacheHeader::Magic;
+    header.version = MeshCacheHeader::CurrentVersion;
+    header.sourceHash = sourceHash;
+    header.meshCount = static_cast<std::uint32_t>(meshes.size());
+    header.materialCount = static_cast<std::uint32_t>(materials.size());
+
+    std::vector<MeshCacheMesh> cacheMeshes(meshes.size());
+    std::vector<MeshCacheAttribute> cacheAttributes;
+    std::vector<MeshCacheRange> cacheRanges;
+    for (int meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+    {
+        const MeshData& meshData = meshes[meshIndex];
+        MeshCacheMesh& cacheMesh = cacheMeshes[meshIndex];
+
+        cacheMesh.firstAttribute = static_cast<std::uint32_t>(cacheAttributes.size());
+        cacheMesh.attributeCount = static_cast<std::uint32_t>(meshData.vertexFormat.GetAttributeCount());
+        for (int i = 0; i < meshData.vertexFormat.GetAttributeCount(); ++i)
+        {
+            VertexAttribute attribute = meshData.vertexFormat.GetAttribute(i);
+            MeshCacheAttribute& cacheAttribute = cacheAttributes.emplace_back();
+            cacheAttribute.type = static_cast<std::uint16_t>(attribute.GetType());
+            cacheAttribute.components = static_cast<std::uint8_t>(attribute.GetComponents());
+            cacheAttribute.normalized = attribute.IsNormalized() ? 1 : 0;
+            cacheAttribute.semantic = static_cast<std::uint32_t>(attribute.GetSemantic());
+        }
+
+        cacheMesh.firstRange = static_cast<std::uint32_t>(cacheRanges.size());
+        cacheMesh.rangeCount = static_cast<std::uint32_t>(meshData.primitives.size());
+        int start = 0;
+        for (int i = 0; i < meshData.primitives.size(); ++i)
+        {
+            MeshCacheRange& cacheRange = cacheRanges.emplace_back();
+            cacheRange.primitive = static_cast<std::uint32_t>(meshData.primitives[i]);
+            cacheRange.first = static_cast<std::uint32_t>(start);
+            cacheRange.count = static_cast<std::uint32_t>(meshData.elementCounts[i] - start);
+            start = meshData.elementCounts[i];
+        }
+
+        cacheMesh.elementType = static_cast<std::uint32_t>(meshData.elementType);
+        cacheMesh.materialIndex = meshData.materialIndex;
+        cacheMesh.positionOffset = { meshData.positionOffset.x, meshData.positionOffset.y, meshData.positionOffset.z };
+        cacheMesh.positionScale = { meshData.positionScale.x, meshData.positionScale.y, meshData.positionScale.z };
+    }
+    header.attributeCount = static_cast<std::uint32_t>(cacheAttributes.size());
+    header.rangeCount = static_cast<std::uint32_t>(cacheRanges.size());
+
+    std::string strings;
+    std::vector<MeshCacheMaterial> cacheMaterials(materials.size());
+    for (int materialIndex = 0; materialIndex < materials.size(); ++materialIndex)
+    {
+        const MaterialData& materialData = materials[materialIndex];
+        MeshCacheMaterial& cacheMaterial = cacheMaterials[materialIndex];
+        cacheMaterial.propertyMask = materialData.propertyMask;
+        cacheMaterial.ambientColor = { materialData.ambientColor.r, materialData.ambientColor.g, materialData.ambientColor.b };
+        cacheMaterial.diffuseColor = { materialData.diffuseColor.r, materialData.diffuseColor.g, materialData.diffuseColor.b };
+        cacheMaterial.specularColor = { materialData.specularColor.r, materialData.specularColor.g, materialData.specularColor.b };
+        cacheMaterial.specularExponent = materialData.specularExponent;
+        cacheMaterial.diffuseTextureOffset = static_cast<std::uint32_t>(strings.size());
+        cacheMaterial.diffuseTextureLength = static_cast<std::uint32_t>(materialData.diffuseTexture.size());
+        strings += materialData.diffuseTexture;
+    }
+    header.stringsSize = static_cast<std::uint32_t>(strings.size());
+
+    // Data goes after the tables, each buffer aligned
+    std::uint64_t dataOffset = sizeof(MeshCacheHeader) + cacheMeshes.size() * sizeof(MeshCacheMesh) +
+        cacheAttributes.size() * sizeof(MeshCacheAttribute) + cacheRanges.size() * sizeof(MeshCacheRange) +
+        cacheMaterials.size() * sizeof(MeshCacheMaterial) + strings.size();
+    for (int meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+    {
+        MeshCacheMesh& cacheMesh = cacheMeshes[meshIndex];
+        cacheMesh.vertexDataOffset = AlignCacheOffset(dataOffset);
+        cacheMesh.vertexDataSize = meshes[meshIndex].vertexData.size();
+        cacheMesh.elementDataOffset = AlignCacheOffset(cacheMesh.vertexDataOffset + cacheMesh.vertexDataSize);
+        cacheMesh.elementDataSize = meshes[meshIndex].elementData.size();
+        dataOffset = cacheMesh.elementDataOffset + cacheMesh.elementDataSize;
+    }
+
+    std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(cacheMeshes.data()), cacheMeshes.size() * sizeof(MeshCacheMesh));
+    file.write(reinterpret_cast<const char*>(cacheAttributes.data()), cacheAttributes.size() * sizeof(MeshCacheAttribute));
+    file.write(reinterpret_cast<const char*>(cacheRanges.data()), cacheRanges.size() * sizeof(MeshCacheRange));
+    file.write(reinterpret_cast<const char*>(cacheMaterials.data()), cacheMaterials.size() * sizeof(MeshCacheMaterial));
+    file.write(strings.data(), strings.size());
+
+    const char padding[MeshCacheHeader::DataAlignment] = {};
+    std::uint64_t offset = static_cast<std::uint64_t>(file.tellp());
+    for (int meshIndex = 0; meshIndex < meshes.size(); ++meshIndex)
+    {
+        const MeshCacheMesh& cacheMesh = cacheMeshes[meshIndex];
+        file.write(padding, cacheMesh.vertexDataOffset - offset);
+        file.write(reinterpret_cast<const char*>(meshes[meshIndex].vertexData.data()), cacheMesh.vertexDataSize);
+        file.write(padding, cacheMesh.elementDataOffset - cacheMesh.vertexDataOffset - cacheMesh.vertexDataSize);
+        file.write(reinterpret_cast<const char*>(meshes[meshIndex].elementData.data()), cacheMesh.elementDataSize);
+        offset = cacheMesh.elementDataOffset + cacheMesh.elementDataSize;
+    }
+    return static_cast<bool>(file);
+}
@@ -1,13 +1,20 @@
 #include <ituGL/asset/ShaderLoader.h>
 
+#include <ituGL/asset/AssetPack.h>
 #include <fstream>
 #include <sstream>
+#include <string_view>
+#include <regex>
 #include <vector>
 #include <array>
 #include <cassert>
 
 #include <iostream>
 
+std::unordered_map<std::string, ShaderLoader::SourceFile> ShaderLoader::s_sourceFiles;
+std::vector<std::string> ShaderLoader::s_sourceFilePaths;
+const AssetPack* ShaderLoader::s_assetPack = nullptr;
+
 ShaderLoader::ShaderLoader(Shader::Type type) : m_type(type)
 {
 }
@@ -24,32 +31,46 @@ bool ShaderLoader::IsValid(std::span<const char*> paths)
 
 Shader ShaderLoader::Load(const char* path)
 {
-    Shader shader(m_type);
-    std::ifstream file(path);
-    assert(file.is_open());
-    std::stringstream stringStream;
-    stringStream << file.rdbuf() << '\0';
-    shader.SetSource(stringStream.str().c_str());
-    Compile(shader);
-    return shader;
+    return Load(std::span<const char*>(&path, 1));
 }
 
 Shader ShaderLoader::Load(std::span<const char*> paths)
+{
+    std::vector<std::string> sources;
+    ReadSources(paths, sources);
+    return LoadSources(sources);
+}
+
+Shader ShaderLoader::LoadSources(std::span<const std::string> sources)
+{
+    Shader shader = LoadSourcesAsync(sources);
+    CheckCompiled(shader);
+    return shader;
+}
+
+Shader ShaderLoader::LoadAsync(std::span<const char*> paths)
+{
+    std::vector<std::string> sources;
+    ReadSources(paths, sources);
+    return LoadSourcesAsync(sources);
+}
+
+Shader ShaderLoader::LoadSourcesAsync(std::span<const std::string> sources)
+{
+    Shader shader = CreateShader(sources);
+    shader.SubmitCompile();
+    return shader;
+}
+
+Shader ShaderLoader::CreateShader(std::span<const std::string> sources) const
 {
     Shader shader(m_type);
-    std::vector<std::stringstream> stringStreams(paths.size());
-    std::vector<std::string> sourceCodeStrings(paths.size());
-    std::vector<const char*> sourceCode(paths.size());
-    for (int i = 0; i < paths.size(); ++i)
+    std::vector<const char*> sourceCode(sources.size());
+    for (int i = 0; i < sources.size(); ++i)
     {
-        std::ifstream file(paths[i]);
-        assert(file.is_open());
-        stringStreams[i] << file.rdbuf() << '\0';
-        sourceCodeStrings[i] = stringStreams[i].str();
-        sourceCode[i] = sourceCodeStrings[i].c_str();
+        sourceCode[i] = sources[i].c_str();
     }
     shader.SetSource(sourceCode);
-    Compile(shader);
     return shader;
 }
 
@@ -73,14 +94,220 @@ bool ShaderLoader::LoadInto(Shader& shader, std::span<const char*> paths)
     return valid;
 }
 
-void ShaderLoader::Compile(Shader& shader)
+void ShaderLoader::SetDefines(std::span<const char* const> defines)
+{
+    m_defines.assign(defines.begin(), defines.end());
+}
+
+void ShaderLoader::ReadSources(std::span<const char*> paths, std::vector<std::string>& sources,
+    std::vector<std::string>* includedFiles) const
+{
+    PreprocessState state;
+    sources.resize(paths.size());
+    for (int i = 0; i < paths.size(); ++i)
+    {
+        sources[i].clear();
+        Preprocess(paths[i], sources[i], state);
+    }
+
+    // Without #version, the defines go first
+    if (!m_defines.empty() && !state.versionFound)
+    {
+        sources.insert(sources.begin(), GetDefinesSource());
+    }
+
+    if (includedFiles)
+    {
+        includedFiles->assign(state.includedFiles.begin(), state.includedFiles.end());
+    }
+}
+
+void ShaderLoader::Preprocess(const std::filesystem::path& path, std::string& output, PreprocessState& state) const
+{
+    std::string normalizedPath = path.lexically_normal().generic_string();
+
+    // Include guard: each file is added only once to the shader
+    if (!state.includedFiles.insert(normalizedPath).second)
+        return;
+
+    const SourceFile* sourceFile = GetSourceFile(normalizedPath);
+    if (!sourceFile)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_FOUND\n" << normalizedPath << std::endl;
+        return;
+    }
+
+    std::string sourceNumber = std::to_string(sourceFile->sourceNumber);
+
+    // #line can't go before #version
+    if (state.versionFound)
+    {
+        output += "#line 1 " + sourceNumber + "\n";
+    }
+
+    std::istringstream stream(sourceFile->source);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(stream, line))
+    {
+        ++lineNumber;
+
+        std::size_t directiveStart = line.find_first_not_of(" \t");
+        std::string_view directive = directiveStart != std::string::npos ? std::string_view(line).substr(directiveStart) : std::string_view();
+
+        if (directive.starts_with("#include"))
+        {
+            std::size_t nameStart = directive.find('"');
+            std::size_t nameEnd = nameStart != std::string_view::npos ? directive.find('"', nameStart + 1) : std::string_view::npos;
+            if (nameEnd == std::string_view::npos)
+            {
+                std::cout << "ERROR::SHADER::INVALID_INCLUDE\n" << normalizedPath << "(" << lineNumber << ")" << std::endl;
+                continue;
+            }
+
+            // Relative to the including file, or to the working directory if not found there
+            std::filesystem::path includePath(directive.substr(nameStart + 1, nameEnd - nameStart - 1));
+            std::filesystem::path relativePath = path.parent_path() / includePath;
+            Preprocess(SourceFileExists(relativePath) ? relativePath : includePath, output, state);
+
+            // Back to the lines of this file
+            output += "#line " + std::to_string(lineNumber + 1) + " " + sourceNumber + "\n";
+        }
+        else if (directive.starts_with("#pragma once"))
+        {
+            // Already handled by the include guard
+            output += '\n';
+        }
+        else
+        {
+            output += line;
+            output += '\n';
+
+            // Defines go right after #version, that must be the first statement
+            if (directive.starts_with("#version") && !state.versionFound)
+            {
+                state.versionFound = true;
+                output += GetDefinesSource();
+                output += "#line " + std::to_string(lineNumber + 1) + " " + sourceNumber + "\n";
+            }
+        }
+    }
+}
+
+std::string ShaderLoader::GetDefinesSource() const
+{
+    std::string defines;
+    for (const std::string& define : m_defines)
+    {
+        defines += "#define " + define + "\n";
+    }
+    return defines;
+}
+
+const ShaderLoader::SourceFile* ShaderLoader::GetSourceFile(const std::string& path)
+{
+    std::error_code error;
+    std::filesystem::file_time_type modifiedTime = std::filesystem::last_write_time(path, error);
+    if (error)
+        return GetPackedSourceFile(path);
+
+    auto itSourceFile = s_sourceFiles.find(path);
+    if (itSourceFile != s_sourceFiles.end() && itSourceFile->second.modifiedTime == modifiedTime)
+    {
+        return &itSourceFile->second;
+    }
+
+    std::ifstream file(path);
+    if (!file.is_open())
+        return nullptr;
+
+    std::stringstream stringStream;
+    stringStream << file.rdbuf();
+
+    if (itSourceFile == s_sourceFiles.end())
+    {
+        SourceFile sourceFile;
+        sourceFile.sourceNumber = static_cast<int>(s_sourceFilePaths.size());
+        s_sourceFilePaths.push_back(path);
+        itSourceFile = s_sourceFiles.emplace(path, std::move(sourceFile)).first;
+    }
+
+    // Modified files keep their source number
+    SourceFile& sourceFile = itSourceFile->second;
+    sourceFile.modifiedTime = modifiedTime;
+    sourceFile.source = stringStream.str();
+    return &sourceFile;
+}
+
+const ShaderLoader::SourceFile* ShaderLoader::GetPackedSourceFile(const std::string& path)
+{
+    const AssetPackEntry* entry = s_assetPack ? s_assetPack->FindEntry(path, AssetPackEntryType::File) : nullptr;
+    if (!entry)
+        return nullptr;
+
+    // Packed files don't change, they are only read the first time
+    auto itSourceFile = s_sourceFiles.find(path);
+    if (itSourceFile == s_sourceFiles.end())
+    {
+        SourceFile sourceFile;
+        sourceFile.sourceNumber = static_cast<int>(s_sourceFilePaths.size());
+        s_sourceFilePaths.push_back(path);
+        itSourceFile = s_sourceFiles.emplace(path, std::move(sourceFile)).first;
+    }
+    else if (itSourceFile->second.modifiedTime == std::filesystem::file_time_type::min())
+    {
+        return &itSourceFile->second;
+    }
+
+    // Also when the file was on disk before, and it was deleted
+    std::span<const std::byte> data = s_assetPack->GetData(*entry);
+    SourceFile& sourceFile = itSourceFile->second;
+    sourceFile.modifiedTime = std::filesystem::file_time_type::min();
+    sourceFile.source.assign(reinterpret_cast<const char*>(data.data()), data.size());
+    return &sourceFile;
+}
+
+bool ShaderLoader::SourceFileExists(const std::filesystem::path& path)
+{
+    return std::filesystem::exists(path) ||
+        (s_assetPack && s_assetPack->FindEntry(path.lexically_normal().generic_string(), AssetPackEntryType::File));
+}
+
+std::string ShaderLoader::ReplaceSourceNumbers(const std::string& errors)
+{
+    // Most drivers start each message with the source number: "0(12)", "0:12(5)" or "ERROR: 0:12"
+    static const std::regex sourceNumberRegex(R"(^((?:ERROR|WARNING): )?(\d+)(?=[:(]\d))");
+
+    std::string result;
+    std::istringstream stream(errors);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        std::smatch match;
+        if (std::regex_search(line, match, sourceNumberRegex))
+        {
+            int sourceNumber = std::stoi(match[2].str());
+            if (sourceNumber < s_sourceFilePaths.size())
+            {
+                line = match[1].str() + s_sourceFilePaths[sourceNumber] + match.suffix().str();
+            }
+        }
+        result += line;
+        result += '\n';
+    }
+    return result;
+}
+
+bool ShaderLoader::CheckCompiled(const Shader& shader)
 {
-    if (!shader.Compile())
+    bool compiled = shader.IsCompiled();
+    if (!compiled)
     {
         std::array<char, 512> infoLog;
         shader.GetCompilationErrors(infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog.data() << std::endl;
+        std::cout << "ERROR::SHADER::COMPILATION_FAILED\n" << ReplaceSourceNumbers(infoLog.data()) << std::endl;
     }
+    return compiled;
 }
 
 Shader ShaderLoader::Load(Shader::Type type, const char* path)
@@ -0,0 +1,147 @@
+#include <ituGL/asset/ShaderPermutationManager.h>
+
+#include <ituGL/asset/ShaderProgramCache.h>
+#include <ituGL/shader/Material.h>
+#include <bit>
+#include <cassert>
+
+ShaderPermutationManager::ShaderPermutationManager(ShaderProgramCache& shaderProgramCache,
+    std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+    const ShaderUniformCollection::NameSet& filteredUniforms)
+    : m_shaderProgramCache(shaderProgramCache)
+    , m_vertexShaderPaths(vertexShaderPaths.begin(), vertexShaderPaths.end())
+    , m_fragmentShaderPaths(fragmentShaderPaths.begin(), fragmentShaderPaths.end())
+    , m_filteredUniforms(filteredUniforms)
+    , m_keyBitCount(0)
+    , m_defaultKey(0)
+{
+}
+
+unsigned int ShaderPermutationManager::AddDefine(const char* name, int maxValue, int defaultValue)
+{
+    assert(maxValue > 0);
+    assert(FindDefine(name) < 0);
+    // Defines must be added before building any variant, or the keys would change
+    assert(m_variants.empty());
+
+    Define define;
+    define.name = name;
+    define.maxValue = maxValue;
+    define.shift = m_keyBitCount;
+    unsigned int bitCount = std::bit_width(static_cast<unsigned int>(maxValue));
+    define.mask = ((1u << bitCount) - 1) << define.shift;
+
+    m_keyBitCount += bitCount;
+    assert(m_keyBitCount <= sizeof(Key) * 8);
+
+    unsigned int defineIndex = static_cast<unsigned int>(m_defines.size());
+    m_defines.push_back(define);
+    SetDefaultValue(defineIndex, defaultValue);
+    return defineIndex;
+}
+
+int ShaderPermutationManager::FindDefine(const char* name) const
+{
+    for (unsigned int i = 0; i < m_defines.size(); ++i)
+    {
+        if (m_defines[i].name == name)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ShaderPermutationManager::SetDefaultValue(unsigned int defineIndex, int value)
+{
+    m_defaultKey = SetDefineValue(m_defaultKey, defineIndex, value);
+}
+
+int ShaderPermutationManager::GetDefineValue(Key key, unsigned int defineIndex) const
+{
+    assert(defineIndex < m_defines.size());
+    const Define& define = m_defines[defineIndex];
+    return static_cast<int>((key & define.mask) >> define.shift);
+}
+
+ShaderPermutationManager::Key ShaderPermutationManager::SetDefineValue(Key key, unsigned int defineIndex, int value) const
+{
+    assert(defineIndex < m_defines.size());
+    const Define& define = m_defines[defineIndex];
+    assert(value >= 0 && value <= define.maxValue);
+    return (key & ~define.mask) | (static_cast<Key>(value) << define.shift);
+}
+
+void ShaderPermutationManager::SetMaterialSetupFunction(MaterialSetupFunction materialSetupFunction)
+{
+    m_materialSetupFunction = materialSetupFunction;
+}
+
+std::shared_ptr<ShaderProgram> ShaderPermutationManager::GetShaderProgram(Key key)
+{
+    Variant& variant = GetVariant(key);
+    if (variant.pending)
+    {
+        m_shaderProgramCache.Finish(*variant.shaderProgram);
+        variant.pending = false;
+    }
+    return variant.shaderProgram;
+}
+
+std::shared_ptr<Material> ShaderPermutationManager::GetMaterial(Key key)
+{
+    std::shared_ptr<ShaderProgram> shaderProgram = GetShaderProgram(key);
+
+    Variant& variant = m_variants[key];
+    if (!variant.material)
+    {
+        variant.material = std::make_shared<Material>(shaderProgram, m_filteredUniforms);
+        if (m_materialSetupFunction)
+        {
+            m_materialSetupFunction(*variant.material, key);
+        }
+    }
+    return variant.material;
+}
+
+void ShaderPermutationManager::Prebuild(Key key)
+{
+    GetVariant(key);
+}
+
+ShaderPermutationManager::Variant& ShaderPermutationManager::GetVariant(Key key)
+{
+    auto itVariant = m_variants.find(key);
+    if (itVariant != m_variants.end())
+    {
+        return itVariant->second;
+    }
+
+    // Each define gets the value from the key
+    std::vector<std::string> defineStrings(m_defines.size());
+    std::vector<const char*> defines(m_defines.size());
+    for (unsigned int i = 0; i < m_defines.size(); ++i)
+    {
+        defineStrings[i] = m_defines[i].name + " " + std::to_string(GetDefineValue(key, i));
+        defines[i] = defineStrings[i].c_str();
+    }
+
+    Variant& variant = m_variants[key];
+    variant.shaderProgram = m_shaderProgramCache.BuildAsync(m_vertexShaderPaths, m_fragmentShaderPaths, defines);
+    variant.pending = true;
+
+    // If the sources are modified, the material is prepared again with the new uniform locations
+    m_shaderProgramCache.AddReloadCallback(*variant.shaderProgram, [this, key]()
+        {
+            Variant& variant = m_variants.at(key);
+            if (variant.material)
+            {
+                variant.material->RefreshUniforms();
+                if (m_materialSetupFunction)
+                {
+                    m_materialSetupFunction(*variant.material, key);
+                }
+            }
+        });
+    return variant;
+}
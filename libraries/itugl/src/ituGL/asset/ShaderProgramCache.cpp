@@ -0,0 +1,358 @@
+#include <ituGL/asset/ShaderProgramCache.h>
+
+#include <ituGL/asset/ShaderLoader.h>
+#include <ituGL/asset/FileWatcher.h>
+#include <fstream>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cassert>
+
+#include <iostream>
+
+// Header at the start of each binary file
+struct ShaderProgramBinaryHeader
+{
+    std::uint32_t magic;
+    std::uint32_t format;
+    std::uint64_t key;
+    std::uint64_t size;
+};
+
+static const std::uint32_t s_binaryMagic = 0x50534755; // "UGSP"
+
+ShaderProgramCache::ShaderProgramCache(const char* directory)
+    : m_directory(directory)
+    , m_enabled(true)
+    , m_driverInitialized(false)
+    , m_driverSupported(false)
+    , m_driverHash(0)
+    , m_hitCount(0)
+    , m_missCount(0)
+    , m_fileWatcher(nullptr)
+{
+}
+
+bool ShaderProgramCache::Build(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+    std::span<const char* const> defines)
+{
+    std::optional<PendingBuild> pendingBuild = Submit(shaderProgram, vertexShaderPaths, fragmentShaderPaths, defines);
+    return !pendingBuild || Complete(shaderProgram, *pendingBuild);
+}
+
+std::shared_ptr<ShaderProgram> ShaderProgramCache::BuildAsync(std::span<const char*> vertexShaderPaths, std::span<const char*> fragmentShaderPaths,
+    std::span<const char* const> defines)
+{
+    auto shaderProgram = std::make_shared<ShaderProgram>();
+    std::vector<std::string> includedFiles;
+    std::optional<PendingBuild> pendingBuild = Submit(*shaderProgram, vertexShaderPaths, fragmentShaderPaths, defines,
+        m_fileWatcher ? &includedFiles : nullptr);
+    if (pendingBuild)
+    {
+        pendingBuild->shaderProgram = shaderProgram;
+        m_pendingBuilds.push_back(std::move(*pendingBuild));
+    }
+
+    if (m_fileWatcher)
+    {
+        AddWatchedProgram(shaderProgram, vertexShaderPaths, fragmentShaderPaths, defines, std::move(includedFiles));
+    }
+    return shaderProgram;
+}
+
+bool ShaderProgramCache::IsReady(const ShaderProgram& shaderProgram) const
+{
+    auto itPendingBuild = std::find_if(m_pendingBuilds.begin(), m_pendingBuilds.end(),
+        [&](const PendingBuild& pendingBuild) { return pendingBuild.shaderProgram.get() == &shaderProgram; });
+    return itPendingBuild == m_pendingBuilds.end() || shaderProgram.IsLinkComplete();
+}
+
+bool ShaderProgramCache::Finish(const ShaderProgram& shaderProgram)
+{
+    auto itPendingBuild = std::find_if(m_pendingBuilds.begin(), m_pendingBuilds.end(),
+        [&](const PendingBuild& pendingBuild) { return pendingBuild.shaderProgram.get() == &shaderProgram; });
+
+    // Loaded from the cache, or already finished
+    if (itPendingBuild == m_pendingBuilds.end())
+    {
+        return shaderProgram.IsLinked();
+    }
+
+    bool linked = Complete(shaderProgram, *itPendingBuild);
+    m_pendingBuilds.erase(itPendingBuild);
+    return linked;
+}
+
+bool ShaderProgramCache::FinishAll()
+{
+    bool linked = true;
+    for (const PendingBuild& pendingBuild : m_pendingBuilds)
+    {
+        linked &= Complete(*pendingBuild.shaderProgram, pendingBuild);
+    }
+    m_pendingBuilds.clear();
+    return linked;
+}
+
+void ShaderProgramCache::SetFileWatcher(FileWatcher* fileWatcher)
+{
+    // Programs built before are not watched
+    m_fileWatcher = fileWatcher;
+    m_watchedFiles.clear();
+}
+
+void ShaderProgramCache::AddReloadCallback(const ShaderProgram& shaderProgram, std::function<void()> callback)
+{
+    for (WatchedProgram& watchedProgram : m_watchedPrograms)
+    {
+        if (watchedProgram.shaderProgram.lock().get() == &shaderProgram)
+        {
+            watchedProgram.reloadCallbacks.push_back(std::move(callback));
+            break;
+        }
+    }
+}
+
+void ShaderProgramCache::AddWatchedProgram(std::shared_ptr<ShaderProgram> shaderProgram, std::span<const char*> vertexShaderPaths,
+    std::span<const char*> fragmentShaderPaths, std::span<const char* const> defines, std::vector<std::string>&& includedFiles)
+{
+    WatchFiles(includedFiles);
+
+    WatchedProgram watchedProgram;
+    watchedProgram.shaderProgram = shaderProgram;
+    watchedProgram.vertexShaderPaths.assign(vertexShaderPaths.begin(), vertexShaderPaths.end());
+    watchedProgram.fragmentShaderPaths.assign(fragmentShaderPaths.begin(), fragmentShaderPaths.end());
+    watchedProgram.defines.assign(defines.begin(), defines.end());
+    watchedProgram.includedFiles = std::move(includedFiles);
+    m_watchedPrograms.push_back(std::move(watchedProgram));
+}
+
+void ShaderProgramCache::WatchFiles(std::span<const std::string> paths)
+{
+    assert(m_fileWatcher);
+    for (const std::string& path : paths)
+    {
+        // One callback per file, for all the programs using it
+        if (m_watchedFiles.insert(path).second)
+        {
+            m_fileWatcher->Watch(path, [this](const std::string& path) { Reload(path); });
+        }
+    }
+}
+
+void ShaderProgramCache::Reload(const std::string& path)
+{
+    // Indices, because the callbacks can build more programs
+    for (std::size_t i = 0; i < m_watchedPrograms.size(); ++i)
+    {
+        std::shared_ptr<ShaderProgram> shaderProgram = m_watchedPrograms[i].shaderProgram.lock();
+        const std::vector<std::string>& programFiles = m_watchedPrograms[i].includedFiles;
+        if (!shaderProgram || std::find(programFiles.begin(), programFiles.end(), path) == programFiles.end())
+            continue;
+
+        auto getPointers = [](const std::vector<std::string>& strings)
+        {
+            std::vector<const char*> pointers;
+            for (const std::string& string : strings)
+            {
+                pointers.push_back(string.c_str());
+            }
+            return pointers;
+        };
+        std::vector<const char*> vertexShaderPaths = getPointers(m_watchedPrograms[i].vertexShaderPaths);
+        std::vector<const char*> fragmentShaderPaths = getPointers(m_watchedPrograms[i].fragmentShaderPaths);
+        std::vector<const char*> defines = getPointers(m_watchedPrograms[i].defines);
+
+        // Built apart, so that the current program is still valid if there are errors
+        ShaderProgram newShaderProgram;
+        std::vector<std::string> includedFiles;
+        std::optional<PendingBuild> pendingBuild = Submit(newShaderProgram, vertexShaderPaths, fragmentShaderPaths, defines, &includedFiles);
+        if (pendingBuild && !Complete(newShaderProgram, *pendingBuild))
+        {
+            std::cout << "ERROR::SHADER::PROGRAM::RELOAD_FAILED\n" << path << std::endl;
+            continue;
+        }
+
+        *shaderProgram = std::move(newShaderProgram);
+
+        // The #include lines could have changed
+        WatchFiles(includedFiles);
+        m_watchedPrograms[i].includedFiles = std::move(includedFiles);
+
+        std::vector<std::function<void()>> reloadCallbacks = m_watchedPrograms[i].reloadCallbacks;
+        for (const std::function<void()>& reloadCallback : reloadCallbacks)
+        {
+            reloadCallback();
+        }
+    }
+}
+
+std::optional<ShaderProgramCache::PendingBuild> ShaderProgramCache::Submit(ShaderProgram& shaderProgram, std::span<const char*> vertexShaderPaths,
+    std::span<const char*> fragmentShaderPaths, std::span<const char* const> defines, std::vector<std::string>* includedFiles)
+{
+    InitializeDriver();
+
+    ShaderLoader vertexShaderLoader(Shader::VertexShader);
+    vertexShaderLoader.SetDefines(defines);
+    std::vector<std::string> vertexSources;
+    vertexShaderLoader.ReadSources(vertexShaderPaths, vertexSources, includedFiles);
+
+    ShaderLoader fragmentShaderLoader(Shader::FragmentShader);
+    fragmentShaderLoader.SetDefines(defines);
+    std::vector<std::string> fragmentSources;
+    std::vector<std::string> fragmentIncludedFiles;
+    fragmentShaderLoader.ReadSources(fragmentShaderPaths, fragmentSources, includedFiles ? &fragmentIncludedFiles : nullptr);
+    if (includedFiles)
+    {
+        includedFiles->insert(includedFiles->end(), fragmentIncludedFiles.begin(), fragmentIncludedFiles.end());
+    }
+
+    // Defines are already inserted in the sources
+    std::uint64_t key = ComputeKey(vertexSources, fragmentSources);
+
+    if (IsEnabled() && LoadBinary(shaderProgram, key))
+    {
+        ++m_hitCount;
+        return std::nullopt;
+    }
+    ++m_missCount;
+
+    // Not in the cache, or rejected by the driver: build from source, without waiting for the results
+    PendingBuild pendingBuild{ nullptr, key,
+        vertexShaderLoader.LoadSourcesAsync(vertexSources),
+        fragmentShaderLoader.LoadSourcesAsync(fragmentSources) };
+
+    shaderProgram.SetBinaryRetrievable(IsEnabled());
+    shaderProgram.SubmitBuild(pendingBuild.vertexShader, pendingBuild.fragmentShader);
+
+    return pendingBuild;
+}
+
+bool ShaderProgramCache::Complete(const ShaderProgram& shaderProgram, const PendingBuild& pendingBuild)
+{
+    // Querying the status waits for the driver to finish
+    bool compiled = ShaderLoader::CheckCompiled(pendingBuild.vertexShader);
+    compiled &= ShaderLoader::CheckCompiled(pendingBuild.fragmentShader);
+
+    if (!compiled || !shaderProgram.IsLinked())
+    {
+        std::array<char, 512> infoLog;
+        shaderProgram.GetLinkingErrors(infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog.data() << std::endl;
+        return false;
+    }
+
+    if (IsEnabled())
+    {
+        SaveBinary(shaderProgram, pendingBuild.key);
+    }
+    return true;
+}
+
+void ShaderProgramCache::InitializeDriver()
+{
+    if (m_driverInitialized)
+        return;
+
+    m_driverInitialized = true;
+
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    m_driverSupported = formatCount > 0;
+
+    // Binaries are only valid for the same driver and version
+    m_driverHash = 14695981039346656037ull;
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        const GLubyte* value = glGetString(name);
+        std::string valueString = value ? reinterpret_cast<const char*>(value) : "";
+        m_driverHash = Hash(m_driverHash, valueString.c_str(), valueString.size() + 1);
+    }
+
+    if (m_driverSupported)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+        m_driverSupported = !error;
+    }
+}
+
+std::uint64_t ShaderProgramCache::ComputeKey(std::span<const std::string> vertexSources, std::span<const std::string> fragmentSources) const
+{
+    std::uint64_t key = m_driverHash;
+    for (std::span<const std::string> sources : { vertexSources, fragmentSources })
+    {
+        // Include the count, so that moving code between stages changes the key
+        std::uint64_t count = sources.size();
+        key = Hash(key, &count, sizeof(count));
+        for (const std::string& source : sources)
+        {
+            key = Hash(key, source.c_str(), source.size() + 1);
+        }
+    }
+    return key;
+}
+
+std::filesystem::path ShaderProgramCache::GetBinaryPath(std::uint64_t key) const
+{
+    std::array<char, 17> fileName;
+    std::snprintf(fileName.data(), fileName.size(), "%016llx", static_cast<unsigned long long>(key));
+    return m_directory / (std::string(fileName.data()) + ".bin");
+}
+
+bool ShaderProgramCache::LoadBinary(ShaderProgram& shaderProgram, std::uint64_t key) const
+{
+    std::ifstream file(GetBinaryPath(key), std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0);
+
+    ShaderProgramBinaryHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    // Different file with the same name (or a different version of the cache)
+    if (header.magic != s_binaryMagic || header.key != key)
+        return false;
+
+    // Truncated or corrupt file. Checked before allocating, the size could be anything
+    if (header.size != static_cast<std::uint64_t>(fileSize) - sizeof(header))
+        return false;
+
+    std::vector<char> binary(header.size);
+    if (!file.read(binary.data(), binary.size()))
+        return false;
+
+    return shaderProgram.LoadBinary(header.format, binary);
+}
+
+void ShaderProgramCache::SaveBinary(const ShaderProgram& shaderProgram, std::uint64_t key) const
+{
+    ShaderProgramBinaryHeader header;
+    GLenum format = 0;
+    std::vector<char> binary;
+    if (!shaderProgram.GetBinary(format, binary))
+        return;
+
+    header.magic = s_binaryMagic;
+    header.format = format;
+    header.key = key;
+    header.size = binary.size();
+
+    std::ofstream file(GetBinaryPath(key), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), binary.size());
+}
+
+std::uint64_t ShaderProgramCache::Hash(std::uint64_t hash, const void* data, std::size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
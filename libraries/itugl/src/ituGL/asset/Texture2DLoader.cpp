@@ -1,16 +1,28 @@
 #include <ituGL/asset/Texture2DLoader.h>
 
+#include <ituGL/asset/FileWatcher.h>
+#include <ituGL/asset/AssetPack.h>
+#include <ituGL/asset/CompressedTexture2DLoader.h>
+#include <ituGL/core/DeviceGL.h>
+#include <algorithm>
+#include <array>
+#include <iostream>
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 Texture2DLoader::Texture2DLoader()
     : m_flipVertical(false)
+    , m_fileWatcher(nullptr)
+    , m_assetPack(nullptr)
 {
 }
 
 Texture2DLoader::Texture2DLoader(TextureObject::Format format, TextureObject::InternalFormat internalFormat)
     : TextureLoader(format, internalFormat)
     , m_flipVertical(false)
+    , m_fileWatcher(nullptr)
+    , m_assetPack(nullptr)
 {
 }
 
@@ -18,44 +30,185 @@ Texture2DObject Texture2DLoader::Load(const char* path)
 {
     Texture2DObject texture2D;
 
-    // Set flip vertical on load if needed
-    stbi_set_flip_vertically_on_load(m_flipVertical ? 1 : 0);
-
-    // Load texture data using stbimage library
-    int componentCount = TextureObject::GetComponentCount(m_format);
-    int width, height, originalComponentCount;
-    unsigned char* data = stbi_load(path, &width, &height, &originalComponentCount, componentCount);
-
     // If data was loaded, copy it to the texture object
-    assert(data);
-    if (data)
+    bool loaded = LoadImage(path, texture2D);
+    assert(loaded);
+    if (loaded)
     {
-        texture2D.Bind();
-        int dataSize = width * height * componentCount;
-        texture2D.SetImage<unsigned char>(0, width, height, m_format, m_internalFormat, std::span(data, dataSize));
-
-        // Generate mipmap if needed
-        if (m_generateMipmap)
-        {
-            texture2D.GenerateMipmap();
-        }
-        else
+        if (!m_generateMipmap)
         {
             texture2D.SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
         }
 
         texture2D.Unbind();
+    }
+    return texture2D;
+}
 
-        // Free loaded data (not needed anymore)
-        stbi_image_free(data);
+std::shared_ptr<Texture2DObject> Texture2DLoader::LoadShared(const char* path)
+{
+    std::shared_ptr<Texture2DObject> texture2D = TextureLoader::LoadShared(path);
+    if (texture2D && m_fileWatcher)
+    {
+        // The loader settings are copied, the texture is not kept alive by the watcher
+        Texture2DLoader loader(m_format, m_internalFormat);
+        loader.SetGenerateMipmap(m_generateMipmap);
+        loader.SetFlipVertical(m_flipVertical);
+        loader.SetAssetPack(m_assetPack);
+        std::weak_ptr<Texture2DObject> weakTexture2D = texture2D;
+        m_fileWatcher->Watch(path, [loader, weakTexture2D](const std::string& path)
+            {
+                if (std::shared_ptr<Texture2DObject> texture2D = weakTexture2D.lock())
+                {
+                    loader.Reload(path.c_str(), *texture2D);
+                }
+            });
     }
     return texture2D;
 }
 
+bool Texture2DLoader::Reload(const char* path, Texture2DObject& texture2D) const
+{
+    bool loaded = LoadImage(path, texture2D);
+    if (loaded)
+    {
+        Texture2DObject::Unbind();
+    }
+    else
+    {
+        std::cout << "ERROR::TEXTURE::RELOAD_FAILED\n" << path << std::endl;
+    }
+    return loaded;
+}
+
+bool Texture2DLoader::LoadImage(const char* path, Texture2DObject& texture2D) const
+{
+    // Baked textures skip decoding and mipmap generation
+    if (IsPacked(path))
+    {
+        return LoadPackedImage(path, texture2D);
+    }
+
+    int componentCount = TextureObject::GetComponentCount(m_format);
+    DecodedImage image = DecodeImage(path, componentCount, m_flipVertical);
+    if (!image.data)
+        return false;
+
+    ReplaceImmutableStorage(texture2D);
+    texture2D.Bind();
+    int dataSize = image.width * image.height * componentCount;
+    std::span<const unsigned char> data(image.data.get(), dataSize);
+    if (DeviceGL::GetInstance().IsTextureStorageSupported() && TextureObject::GetSizedInternalFormat(m_internalFormat) != TextureObject::InternalFormatInvalid)
+    {
+        // All the levels are allocated at once, the mipmaps are filled below
+        GLsizei levelCount = m_generateMipmap ? Texture2DObject::GetMipmapLevelCount(image.width, image.height) : 1;
+        texture2D.SetStorage(levelCount, image.width, image.height, m_internalFormat);
+        texture2D.SetSubImage(0, 0, 0, image.width, image.height, m_format, Data::Type::UByte, std::as_bytes(data));
+    }
+    else
+    {
+        texture2D.SetImage<unsigned char>(0, image.width, image.height, m_format, m_internalFormat, data);
+    }
+
+    // Generate mipmap if needed
+    if (m_generateMipmap)
+    {
+        texture2D.GenerateMipmap();
+    }
+
+    return true;
+}
+
+bool Texture2DLoader::IsPacked(const char* path) const
+{
+    const AssetPackEntry* entry = m_assetPack ? m_assetPack->FindEntry(path, AssetPackEntryType::Texture2D) : nullptr;
+    if (!entry)
+        return false;
+
+    AssetPackTexture2D texture2D;
+    std::vector<std::span<const std::byte>> levels;
+    return m_assetPack->GetTexture2D(*entry, texture2D, levels) &&
+        TextureObject::IsCompressedFormatSupported(static_cast<TextureObject::InternalFormat>(texture2D.internalFormat));
+}
+
+bool Texture2DLoader::LoadPackedImage(const char* path, Texture2DObject& texture2D) const
+{
+    const AssetPackEntry* entry = m_assetPack->FindEntry(path, AssetPackEntryType::Texture2D);
+    AssetPackTexture2D packedTexture2D;
+    CompressedTexture2DLoader::Image image;
+    if (!entry || !m_assetPack->GetTexture2D(*entry, packedTexture2D, image.levels))
+        return false;
+
+    ReplaceImmutableStorage(texture2D);
+
+    // The levels are uploaded straight from the mapped pack
+    image.internalFormat = static_cast<TextureObject::InternalFormat>(packedTexture2D.internalFormat);
+    image.width = static_cast<int>(packedTexture2D.width);
+    image.height = static_cast<int>(packedTexture2D.height);
+    texture2D.Bind();
+    CompressedTexture2DLoader::SetImage(texture2D, image);
+    return true;
+}
+
+void Texture2DLoader::CopySamplingState(const Texture2DObject& source, Texture2DObject& target)
+{
+    std::array<TextureObject::ParameterEnum, 4> parameters = {
+        TextureObject::ParameterEnum::MinFilter, TextureObject::ParameterEnum::MagFilter,
+        TextureObject::ParameterEnum::WrapS, TextureObject::ParameterEnum::WrapT };
+    std::array<GLenum, 4> values;
+    source.Bind();
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        source.GetParameter(parameters[i], values[i]);
+    }
+
+    target.Bind();
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        target.SetParameter(parameters[i], values[i]);
+    }
+
+    target.SetSampler(source.GetSampler());
+}
+
+void Texture2DLoader::ReplaceImmutableStorage(Texture2DObject& texture2D)
+{
+    if (!texture2D.HasImmutableStorage())
+        return;
+
+    // The object keeps its address, only the GL texture is new
+    Texture2DObject newTexture2D;
+    CopySamplingState(texture2D, newTexture2D);
+    texture2D = std::move(newTexture2D);
+}
+
+Texture2DLoader::DecodedImage Texture2DLoader::DecodeImage(const char* path, int componentCount, bool flipVertical)
+{
+    // Load texture data using stbimage library
+    DecodedImage image;
+    int originalComponentCount;
+    image.data = { stbi_load(path, &image.width, &image.height, &originalComponentCount, componentCount), stbi_image_free };
+
+    // The flip option of stbimage is global, so rows are swapped here to allow decoding in several threads
+    if (image.data && flipVertical)
+    {
+        size_t rowSize = static_cast<size_t>(image.width) * componentCount;
+        for (int row = 0; row < image.height / 2; ++row)
+        {
+            unsigned char* top = image.data.get() + row * rowSize;
+            unsigned char* bottom = image.data.get() + (image.height - 1 - row) * rowSize;
+            std::swap_ranges(top, top + rowSize, bottom);
+        }
+    }
+
+    return image;
+}
+
 std::shared_ptr<Texture2DObject> Texture2DLoader::LoadTextureShared(const char* path,
-    TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool generateMipmap)
+    TextureObject::Format format, TextureObject::InternalFormat internalFormat, bool generateMipmap, FileWatcher* fileWatcher)
 {
     Texture2DLoader loader(format, internalFormat);
     loader.SetGenerateMipmap(true);
+    loader.SetFileWatcher(fileWatcher);
     return loader.LoadShared(path);
 }
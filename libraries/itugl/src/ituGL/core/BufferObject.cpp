@@ -3,10 +3,18 @@
 #include <cassert>
 
 // Create the object initially null, get object handle and generate 1 buffer
-BufferObject::BufferObject() : Object(NullHandle)
+BufferObject::BufferObject() : Object(NullHandle), m_size(0)
 {
     Handle& handle = GetHandle();
-    glGenBuffers(1, &handle);
+    if (HasDirectStateAccess())
+    {
+        // Named functions need the object to exist, glGenBuffers only reserves the name until it is bound
+        glCreateBuffers(1, &handle);
+    }
+    else
+    {
+        glGenBuffers(1, &handle);
+    }
 }
 
 // Get object handle and delete 1 buffer
@@ -16,13 +24,15 @@ BufferObject::~BufferObject()
     glDeleteBuffers(1, &handle);
 }
 
-BufferObject::BufferObject(BufferObject&& bufferObject) noexcept : Object(std::move(bufferObject))
+BufferObject::BufferObject(BufferObject&& bufferObject) noexcept : Object(std::move(bufferObject)), m_size(bufferObject.m_size)
 {
+    bufferObject.m_size = 0;
 }
 
 BufferObject& BufferObject::operator = (BufferObject&& bufferObject) noexcept
 {
     Object::operator=(std::move(bufferObject));
+    std::swap(m_size, bufferObject.m_size);
     return *this;
 }
 
@@ -43,23 +53,75 @@ void BufferObject::Unbind(Target target)
 // Get buffer Target and allocate buffer data
 void BufferObject::AllocateData(size_t size, Usage usage)
 {
-    assert(IsBound());
-    Target target = GetTarget();
-    glBufferData(target, size, nullptr, usage);
+    if (HasDirectStateAccess())
+    {
+        glNamedBufferData(GetHandle(), size, nullptr, usage);
+    }
+    else
+    {
+        assert(IsBound());
+        Target target = GetTarget();
+        glBufferData(target, size, nullptr, usage);
+    }
+    m_size = size;
 }
 
 // Get buffer Target and allocate buffer data
 void BufferObject::AllocateData(std::span<const std::byte> data, Usage usage)
 {
-    assert(IsBound());
-    Target target = GetTarget();
-    glBufferData(target, data.size_bytes(), data.data(), usage);
+    if (HasDirectStateAccess())
+    {
+        glNamedBufferData(GetHandle(), data.size_bytes(), data.data(), usage);
+    }
+    else
+    {
+        assert(IsBound());
+        Target target = GetTarget();
+        glBufferData(target, data.size_bytes(), data.data(), usage);
+    }
+    m_size = data.size_bytes();
 }
 
 // Get buffer Target and set buffer subdata
 void BufferObject::UpdateData(std::span<const std::byte> data, size_t offset)
 {
+    if (HasDirectStateAccess())
+    {
+        glNamedBufferSubData(GetHandle(), offset, data.size_bytes(), data.data());
+    }
+    else
+    {
+        assert(IsBound());
+        Target target = GetTarget();
+        glBufferSubData(target, offset, data.size_bytes(), data.data());
+    }
+}
+
+// Get buffer Target and map the range
+std::span<std::byte> BufferObject::MapRange(size_t offset, size_t size, GLbitfield access)
+{
+    void* data = nullptr;
+    if (HasDirectStateAccess())
+    {
+        data = glMapNamedBufferRange(GetHandle(), offset, size, access);
+    }
+    else
+    {
+        assert(IsBound());
+        Target target = GetTarget();
+        data = glMapBufferRange(target, offset, size, access);
+    }
+    return data ? std::span<std::byte>(static_cast<std::byte*>(data), size) : std::span<std::byte>();
+}
+
+// Get buffer Target and unmap it
+bool BufferObject::Unmap()
+{
+    if (HasDirectStateAccess())
+    {
+        return glUnmapNamedBuffer(GetHandle()) == GL_TRUE;
+    }
     assert(IsBound());
     Target target = GetTarget();
-    glBufferSubData(target, offset, data.size_bytes(), data.data());
+    return glUnmapBuffer(target) == GL_TRUE;
 }
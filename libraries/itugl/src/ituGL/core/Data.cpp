@@ -18,3 +18,8 @@ unsigned int Data::GetTypeSize(Type type)
         return 4;
     }
 }
+
+bool Data::IsPackedType(Type type)
+{
+    return type == Type::Int2_10_10_10_Rev || type == Type::UInt2_10_10_10_Rev || type == Type::UInt24_8;
+}
@@ -2,11 +2,14 @@
 
 #include <ituGL/application/Window.h>
 #include <GLFW/glfw3.h>
+#include <cstring>
 #include <cassert>
 
 DeviceGL* DeviceGL::m_instance = nullptr;
 
-DeviceGL::DeviceGL() : m_contextLoaded(false), m_window(nullptr)
+DeviceGL::DeviceGL() : m_contextLoaded(false), m_parallelShaderCompileSupported(false)
+    , m_multiDrawIndirectSupported(false), m_bufferStorageSupported(false)
+    , m_directStateAccessSupported(false), m_textureStorageSupported(false), m_window(nullptr)
 {
     m_instance = this;
 
@@ -35,10 +38,59 @@ void DeviceGL::SetCurrentWindow(Window& window)
     {
         // Set callback to be called when the window is resized
         glfwSetFramebufferSizeCallback(glfwWindow, FrameBufferResized);
+
+        // Let the driver choose how many threads compile shaders
+        using MaxShaderCompilerThreadsFunction = void (APIENTRYP)(GLuint count);
+        MaxShaderCompilerThreadsFunction maxShaderCompilerThreads = nullptr;
+        if (IsExtensionSupported("GL_KHR_parallel_shader_compile"))
+        {
+            maxShaderCompilerThreads = (MaxShaderCompilerThreadsFunction)glfwGetProcAddress("glMaxShaderCompilerThreadsKHR");
+        }
+        else if (IsExtensionSupported("GL_ARB_parallel_shader_compile"))
+        {
+            maxShaderCompilerThreads = (MaxShaderCompilerThreadsFunction)glfwGetProcAddress("glMaxShaderCompilerThreadsARB");
+        }
+        m_parallelShaderCompileSupported = maxShaderCompilerThreads != nullptr;
+        if (maxShaderCompilerThreads)
+        {
+            maxShaderCompilerThreads(0xFFFFFFFF);
+        }
+
+        // Core since GL 4.3, older contexts can still have the extension
+        m_multiDrawIndirectSupported = (GLAD_GL_VERSION_4_3 || IsExtensionSupported("GL_ARB_multi_draw_indirect"))
+            && glad_glMultiDrawElementsIndirect != nullptr;
+
+        // Core since GL 4.4
+        m_bufferStorageSupported = (GLAD_GL_VERSION_4_4 || IsExtensionSupported("GL_ARB_buffer_storage"))
+            && glad_glBufferStorage != nullptr;
+
+        // Core since GL 4.5. The named functions are only loaded with the version, not with the extension
+        m_directStateAccessSupported = GLAD_GL_VERSION_4_5 && glad_glCreateBuffers != nullptr;
+
+        // Core since GL 4.2
+        m_textureStorageSupported = GLAD_GL_VERSION_4_2 && glad_glTexStorage2D != nullptr;
     }
     m_window = &window;
 }
 
+// Check if the context supports an extension
+bool DeviceGL::IsExtensionSupported(const char* extension) const
+{
+    assert(m_contextLoaded);
+
+    GLint extensionCount = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+    for (GLint i = 0; i < extensionCount; ++i)
+    {
+        const GLubyte* name = glGetStringi(GL_EXTENSIONS, i);
+        if (name && std::strcmp(reinterpret_cast<const char*>(name), extension) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 Window& DeviceGL::GetCurrentWindow()
 {
     return *m_window;
@@ -63,9 +115,20 @@ void DeviceGL::FrameBufferResized(GLFWwindow* window, GLsizei width, GLsizei hei
     {
         // Adjust the viewport when the framebuffer is resized
         m_instance->SetViewport(0, 0, width, height);
+
+        // Notify the size dependent resources, like render targets
+        for (const FramebufferResizedCallback& callback : m_instance->m_framebufferResizedCallbacks)
+        {
+            callback(width, height);
+        }
     }
 }
 
+void DeviceGL::AddFramebufferResizedCallback(const FramebufferResizedCallback& callback)
+{
+    m_framebufferResizedCallbacks.push_back(callback);
+}
+
 // Clear the framebuffer with the specified color, depth and stencil
 void DeviceGL::Clear(bool clearColor, const Color& color, bool clearDepth, GLdouble depth, bool clearStencil, GLint stencil)
 {
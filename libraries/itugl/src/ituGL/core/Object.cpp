@@ -1,5 +1,7 @@
 #include <ituGL/core/Object.h>
 
+#include <ituGL/core/DeviceGL.h>
+
 // The constructor only assigns the handle
 Object::Object(Handle handle) : m_handle(handle)
 {
@@ -15,6 +17,12 @@ Object::Object(Object&& object) noexcept : m_handle(object.m_handle)
     object.m_handle = NullHandle;
 }
 
+bool Object::HasDirectStateAccess()
+{
+    const DeviceGL* device = DeviceGL::GetInstancePointer();
+    return device && device->IsDirectStateAccessSupported();
+}
+
 Object& Object::operator = (Object&& object) noexcept
 {
     this->~Object();
@@ -0,0 +1,49 @@
+#include <ituGL/core/QueryObject.h>
+
+#include <cassert>
+
+QueryObject::QueryObject() : Object(NullHandle), m_activeTarget(GL_NONE)
+{
+    Handle& handle = GetHandle();
+    glGenQueries(1, &handle);
+}
+
+QueryObject::~QueryObject()
+{
+    Handle& handle = GetHandle();
+    glDeleteQueries(1, &handle);
+}
+
+void QueryObject::Bind() const
+{
+}
+
+void QueryObject::Begin(Target target)
+{
+    assert(m_activeTarget == GL_NONE);
+    m_activeTarget = target;
+    glBeginQuery(target, GetHandle());
+}
+
+void QueryObject::End()
+{
+    assert(m_activeTarget != GL_NONE);
+    glEndQuery(m_activeTarget);
+    m_activeTarget = GL_NONE;
+}
+
+bool QueryObject::IsResultAvailable() const
+{
+    assert(m_activeTarget == GL_NONE);
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(GetHandle(), GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != GL_FALSE;
+}
+
+GLuint64 QueryObject::GetResult() const
+{
+    assert(m_activeTarget == GL_NONE);
+    GLuint64 result = 0;
+    glGetQueryObjectui64v(GetHandle(), GL_QUERY_RESULT, &result);
+    return result;
+}
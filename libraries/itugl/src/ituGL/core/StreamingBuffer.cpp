@@ -0,0 +1,191 @@
+#include <ituGL/core/StreamingBuffer.h>
+
+#include <ituGL/core/DeviceGL.h>
+#include <iostream>
+#include <cassert>
+
+StreamingBuffer::StreamingBuffer(Target target, size_t frameSize, unsigned int frameCount)
+    : m_target(target), m_frameSize(frameSize), m_frameIndex(0), m_usedSize(0), m_flushedSize(0)
+    , m_fences(frameCount, nullptr), m_waitCount(0)
+{
+    assert(frameSize > 0);
+    assert(frameCount > 0);
+
+    size_t bufferSize = frameSize * frameCount;
+    bool directStateAccess = HasDirectStateAccess();
+    if (!directStateAccess)
+    {
+        Bind();
+    }
+    if (DeviceGL::GetInstance().IsBufferStorageSupported())
+    {
+        // Coherent mapping, the writes are visible to the GPU without flushing them
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        void* data = nullptr;
+        if (directStateAccess)
+        {
+            glNamedBufferStorage(GetHandle(), bufferSize, nullptr, flags);
+            data = glMapNamedBufferRange(GetHandle(), 0, bufferSize, flags);
+        }
+        else
+        {
+            glBufferStorage(m_target, bufferSize, nullptr, flags);
+            data = glMapBufferRange(m_target, 0, bufferSize, flags);
+        }
+        if (data)
+        {
+            m_mappedData = std::span<std::byte>(static_cast<std::byte*>(data), bufferSize);
+        }
+        else
+        {
+            std::cout << "ERROR::STREAMINGBUFFER::MAPPING_FAILED" << std::endl;
+        }
+    }
+    else
+    {
+        AllocateData(bufferSize, StreamDraw);
+    }
+    if (!directStateAccess)
+    {
+        Unbind();
+    }
+
+    // Immutable storage that could not be mapped can still be written on Flush
+    if (!IsPersistent())
+    {
+        m_stagingData.resize(frameSize);
+    }
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+    // Deleting the buffer also unmaps it
+    for (GLsync fence : m_fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+        }
+    }
+}
+
+void StreamingBuffer::Bind() const
+{
+    BufferObject::Bind(m_target);
+}
+
+void StreamingBuffer::Unbind() const
+{
+    BufferObject::Unbind(m_target);
+}
+
+StreamingBuffer::Range StreamingBuffer::Allocate(size_t size, size_t alignment)
+{
+    assert(size > 0);
+    assert(alignment > 0);
+
+    if (m_usedSize == 0)
+    {
+        WaitForCurrentFrame();
+    }
+
+    Range range;
+    size_t alignedOffset = (m_usedSize + alignment - 1) / alignment * alignment;
+    if (alignedOffset + size <= m_frameSize)
+    {
+        size_t frameOffset = m_frameIndex * m_frameSize;
+        range.data = IsPersistent() ? m_mappedData.subspan(frameOffset + alignedOffset, size)
+            : std::span<std::byte>(m_stagingData).subspan(alignedOffset, size);
+        range.offset = frameOffset + alignedOffset;
+        m_usedSize = alignedOffset + size;
+    }
+    return range;
+}
+
+void StreamingBuffer::Flush()
+{
+    if (IsPersistent() || m_flushedSize == m_usedSize)
+    {
+        return;
+    }
+
+    // The region is not used by the GPU anymore, so the driver should not need to wait for it
+    bool directStateAccess = HasDirectStateAccess();
+    if (!directStateAccess)
+    {
+        Bind();
+    }
+    UpdateData(std::span<const std::byte>(m_stagingData).subspan(m_flushedSize, m_usedSize - m_flushedSize),
+        m_frameIndex * m_frameSize + m_flushedSize);
+    if (!directStateAccess)
+    {
+        Unbind();
+    }
+    m_flushedSize = m_usedSize;
+}
+
+void StreamingBuffer::EndFrame()
+{
+    assert(m_flushedSize == m_usedSize || IsPersistent());
+
+    // Regions that were not written don't need a fence, they are still free
+    if (m_usedSize > 0)
+    {
+        assert(!m_fences[m_frameIndex]);
+        m_fences[m_frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    m_frameIndex = (m_frameIndex + 1) % GetFrameCount();
+    m_usedSize = 0;
+    m_flushedSize = 0;
+}
+
+#ifndef NDEBUG
+bool StreamingBuffer::IsBound() const
+{
+    // The target is only known at runtime, so the binding is queried instead of tracked
+    GLenum bindingQuery = GL_NONE;
+    switch (m_target)
+    {
+    case ArrayBuffer:
+        bindingQuery = GL_ARRAY_BUFFER_BINDING;
+        break;
+    case ElementArrayBuffer:
+        bindingQuery = GL_ELEMENT_ARRAY_BUFFER_BINDING;
+        break;
+    case PixelUnpackBuffer:
+        bindingQuery = GL_PIXEL_UNPACK_BUFFER_BINDING;
+        break;
+    case DrawIndirectBuffer:
+        bindingQuery = GL_DRAW_INDIRECT_BUFFER_BINDING;
+        break;
+    }
+    GLint boundHandle = 0;
+    glGetIntegerv(bindingQuery, &boundHandle);
+    return static_cast<Handle>(boundHandle) == GetHandle();
+}
+#endif
+
+void StreamingBuffer::WaitForCurrentFrame()
+{
+    GLsync& fence = m_fences[m_frameIndex];
+    if (!fence)
+    {
+        return;
+    }
+
+    // Only flush the commands the first time, waiting again won't help them reach the GPU
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        ++m_waitCount;
+        do
+        {
+            result = glClientWaitSync(fence, 0, 1000000);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+    assert(result != GL_WAIT_FAILED);
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
@@ -5,7 +5,7 @@
 #include <cassert>
 
 Drawcall::Drawcall()
-    : m_primitive(Primitive::Invalid), m_first(0), m_count(0), m_eboType(Data::Type::None)
+    : m_primitive(Primitive::Invalid), m_first(0), m_count(0), m_eboType(Data::Type::None), m_instancing{}, m_baseVertex(0)
 {
 }
 
@@ -26,7 +26,7 @@ Drawcall::Drawcall(Primitive primitive, GLsizei count, InstancingParam instanced
 }
 
 Drawcall::Drawcall(Primitive primitive, GLsizei count, Data::Type eboType, InstancingParam instanced, GLint first)
-    : m_primitive(primitive), m_first(first), m_count(count), m_eboType(eboType), m_instancing(instanced)
+    : m_primitive(primitive), m_first(first), m_count(count), m_eboType(eboType), m_instancing(instanced), m_baseVertex(0)
 {
     assert(primitive != Primitive::Invalid);
     assert(first >= 0);
@@ -44,22 +44,51 @@ void Drawcall::Draw() const
     {
         // If no EBO is present, use either glDrawArrays or glDrawArraysInstanced
         if (m_instancing.Instanced())
-            glDrawArraysInstanced(primitive, m_first, m_count, m_instancing.GetInstanceCount());
+            glDrawArraysInstanced(primitive, m_baseVertex + m_first, m_count, m_instancing.GetInstanceCount());
         else
-            glDrawArrays(primitive, m_first, m_count);
+            glDrawArrays(primitive, m_baseVertex + m_first, m_count);
     }
     else
     {
-        // If there is an EBO, use either glDrawElements or glDrawElementsInstanced
+        // If there is an EBO, use either glDrawElements or glDrawElementsInstanced, with base vertex if needed
         assert(ElementBufferObject::IsSupportedType(m_eboType));
         const char* basePointer = nullptr; // Actual element pointer is in VAO
+        GLenum eboType = static_cast<GLenum>(m_eboType);
         if (m_instancing.Instanced())
-            glDrawElementsInstanced(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first, m_instancing.GetInstanceCount());
+        {
+            if (m_baseVertex != 0)
+                glDrawElementsInstancedBaseVertex(primitive, m_count, eboType, basePointer + m_first, m_instancing.GetInstanceCount(), m_baseVertex);
+            else
+                glDrawElementsInstanced(primitive, m_count, eboType, basePointer + m_first, m_instancing.GetInstanceCount());
+        }
         else
-            glDrawElements(primitive, m_count, static_cast<GLenum>(m_eboType), basePointer + m_first);
+        {
+            if (m_baseVertex != 0)
+                glDrawElementsBaseVertex(primitive, m_count, eboType, basePointer + m_first, m_baseVertex);
+            else
+                glDrawElements(primitive, m_count, eboType, basePointer + m_first);
+        }
     }
 }
 
+Drawcall::IndirectCommand Drawcall::GetIndirectCommand() const
+{
+    assert(IsValid());
+    assert(m_eboType != Data::Type::None);
+
+    // m_first is the offset in bytes of the first element
+    GLuint typeSize = Data::GetTypeSize(m_eboType);
+    assert(m_first % typeSize == 0);
+
+    IndirectCommand command;
+    command.count = static_cast<GLuint>(m_count);
+    command.instanceCount = m_instancing.Instanced() ? m_instancing.GetInstanceCount() : 1;
+    command.firstIndex = static_cast<GLuint>(m_first) / typeSize;
+    command.baseVertex = m_baseVertex;
+    command.baseInstance = 0;
+    return command;
+}
+
 void Drawcall::SetInstanceCount(GLuint instanceCount)
 {
     m_instancing.SetInstanceCount(instanceCount);
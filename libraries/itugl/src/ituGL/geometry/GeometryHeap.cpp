@@ -0,0 +1,240 @@
+#include <ituGL/geometry/GeometryHeap.h>
+
+#include <algorithm>
+#include <cassert>
+
+GeometryHeap::GeometryHeap(size_t vertexPageSize, size_t elementPageSize)
+    : m_vertexPageSize(vertexPageSize), m_elementPageSize(elementPageSize)
+{
+}
+
+GeometryHeap::Allocation GeometryHeap::Allocate(const VertexFormat& vertexFormat, std::span<const GLubyte> vertexData,
+    std::span<const GLubyte> elementData, Data::Type elementType, const SemanticMap& locations)
+{
+    size_t vertexSize = vertexFormat.GetSize();
+    assert(vertexSize > 0 && !vertexData.empty() && vertexData.size() % vertexSize == 0);
+    size_t vertexCount = vertexData.size() / vertexSize;
+    size_t elementAlignment = elementData.empty() ? 1 : Data::GetTypeSize(elementType);
+    std::string formatKey = GetFormatKey(vertexFormat, locations);
+
+    Allocation allocation;
+    allocation.m_vertexCount = vertexCount;
+    allocation.m_elementSize = elementData.size();
+    allocation.m_elementType = elementData.empty() ? Data::Type::None : elementType;
+
+    // First page of the format with space for both ranges
+    unsigned int pageIndex = 0;
+    for (; pageIndex < GetPageCount(); ++pageIndex)
+    {
+        Page& page = *m_pages[pageIndex];
+        if (page.formatKey == formatKey && AllocateRanges(page, vertexCount, elementData.size(), elementAlignment,
+            allocation.m_vertexOffset, allocation.m_elementOffset))
+        {
+            break;
+        }
+    }
+    if (pageIndex == GetPageCount())
+    {
+        Page& page = AddPage(formatKey, vertexFormat, locations, vertexData.size(), elementData.size());
+        bool allocated = AllocateRanges(page, vertexCount, elementData.size(), elementAlignment,
+            allocation.m_vertexOffset, allocation.m_elementOffset);
+        assert(allocated);
+    }
+    allocation.m_heap = this;
+    allocation.m_pageIndex = pageIndex;
+
+    // Binding the EBO would change the VAO if there is one bound. With direct state access, nothing is bound
+    bool bindBuffers = !Object::HasDirectStateAccess();
+    if (bindBuffers)
+    {
+        VertexArrayObject::Unbind();
+    }
+
+    Page& page = *m_pages[pageIndex];
+    if (bindBuffers)
+    {
+        page.vbo.Bind();
+    }
+    page.vbo.UpdateData(vertexData, allocation.m_vertexOffset * vertexSize);
+
+    if (!elementData.empty())
+    {
+        if (bindBuffers)
+        {
+            page.ebo.Bind();
+        }
+        page.ebo.UpdateData(elementData, allocation.m_elementOffset);
+    }
+
+    if (bindBuffers)
+    {
+        VertexBufferObject::Unbind();
+        ElementBufferObject::Unbind();
+    }
+
+    return allocation;
+}
+
+size_t GeometryHeap::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (const std::unique_ptr<Page>& page : m_pages)
+    {
+        capacity += page->vertexAllocator.GetCapacity() * page->vertexSize + page->elementAllocator.GetCapacity();
+    }
+    return capacity;
+}
+
+size_t GeometryHeap::GetAllocatedSize() const
+{
+    size_t allocatedSize = 0;
+    for (const std::unique_ptr<Page>& page : m_pages)
+    {
+        allocatedSize += (page->vertexAllocator.GetCapacity() - page->vertexAllocator.GetFreeSize()) * page->vertexSize;
+        allocatedSize += page->elementAllocator.GetCapacity() - page->elementAllocator.GetFreeSize();
+    }
+    return allocatedSize;
+}
+
+GeometryHeap::Page& GeometryHeap::AddPage(const std::string& formatKey, const VertexFormat& vertexFormat, const SemanticMap& locations,
+    size_t vertexDataSize, size_t elementDataSize)
+{
+    std::unique_ptr<Page>& page = m_pages.emplace_back(std::make_unique<Page>());
+    page->formatKey = formatKey;
+    page->vertexSize = vertexFormat.GetSize();
+
+    size_t vertexCapacity = std::max(m_vertexPageSize, vertexDataSize) / page->vertexSize;
+    size_t elementCapacity = std::max(m_elementPageSize, elementDataSize);
+    page->vertexAllocator = FreeListAllocator(vertexCapacity);
+    page->elementAllocator = FreeListAllocator(elementCapacity);
+
+    bool bindBuffers = !Object::HasDirectStateAccess();
+    if (bindBuffers)
+    {
+        VertexArrayObject::Unbind();
+        page->vbo.Bind();
+        page->ebo.Bind();
+    }
+    page->vbo.AllocateData(vertexCapacity * page->vertexSize);
+    page->ebo.AllocateData<GLubyte>(elementCapacity);
+
+    // Same attribute setup as the VAOs of Mesh, with all the attributes interleaved in the VBO
+    if (bindBuffers)
+    {
+        page->vao.Bind();
+    }
+    GLuint location = 0;
+    for (auto it = vertexFormat.LayoutBegin(static_cast<int>(vertexCapacity), true); it != vertexFormat.LayoutEnd(); it++)
+    {
+        const VertexAttribute& attribute = it->GetAttribute();
+        auto itLocation = locations.find(attribute.GetSemantic());
+        if (itLocation != locations.end())
+        {
+            location = itLocation->second;
+        }
+        page->vao.SetAttribute(location, attribute, page->vbo, it->GetOffset(), it->GetStride());
+        location += attribute.GetLocationSize();
+    }
+    page->vao.SetElementBuffer(page->ebo);
+
+    if (bindBuffers)
+    {
+        VertexArrayObject::Unbind();
+        VertexBufferObject::Unbind();
+        ElementBufferObject::Unbind();
+    }
+
+    return *page;
+}
+
+bool GeometryHeap::AllocateRanges(Page& page, size_t vertexCount, size_t elementDataSize, size_t elementAlignment,
+    size_t& vertexOffset, size_t& elementOffset)
+{
+    if (!page.vertexAllocator.Allocate(vertexCount, 1, vertexOffset))
+        return false;
+
+    elementOffset = 0;
+    if (elementDataSize > 0 && !page.elementAllocator.Allocate(elementDataSize, elementAlignment, elementOffset))
+    {
+        page.vertexAllocator.Free(vertexOffset, vertexCount);
+        return false;
+    }
+    return true;
+}
+
+void GeometryHeap::Free(const Allocation& allocation)
+{
+    Page& page = *m_pages[allocation.m_pageIndex];
+    page.vertexAllocator.Free(allocation.m_vertexOffset, allocation.m_vertexCount);
+    if (allocation.m_elementSize > 0)
+    {
+        page.elementAllocator.Free(allocation.m_elementOffset, allocation.m_elementSize);
+    }
+}
+
+std::string GeometryHeap::GetFormatKey(const VertexFormat& vertexFormat, const SemanticMap& locations)
+{
+    // The locations are resolved as in the VAO setup, so maps that give the same locations share the pages
+    std::string formatKey;
+    GLuint location = 0;
+    for (int i = 0; i < vertexFormat.GetAttributeCount(); ++i)
+    {
+        VertexAttribute attribute = vertexFormat.GetAttribute(i);
+        auto itLocation = locations.find(attribute.GetSemantic());
+        if (itLocation != locations.end())
+        {
+            location = itLocation->second;
+        }
+        formatKey += std::to_string(static_cast<int>(attribute.GetType())) + ',' + std::to_string(attribute.GetComponents()) +
+            (attribute.IsNormalized() ? ",n@" : ",@") + std::to_string(location) + ';';
+        location += attribute.GetLocationSize();
+    }
+    return formatKey;
+}
+
+GeometryHeap::Allocation::Allocation()
+    : m_heap(nullptr), m_pageIndex(0), m_vertexOffset(0), m_vertexCount(0), m_elementOffset(0), m_elementSize(0)
+    , m_elementType(Data::Type::None)
+{
+}
+
+GeometryHeap::Allocation::~Allocation()
+{
+    if (m_heap)
+    {
+        m_heap->Free(*this);
+    }
+}
+
+GeometryHeap::Allocation::Allocation(Allocation&& allocation) noexcept
+    : m_heap(allocation.m_heap), m_pageIndex(allocation.m_pageIndex)
+    , m_vertexOffset(allocation.m_vertexOffset), m_vertexCount(allocation.m_vertexCount)
+    , m_elementOffset(allocation.m_elementOffset), m_elementSize(allocation.m_elementSize)
+    , m_elementType(allocation.m_elementType)
+{
+    allocation.m_heap = nullptr;
+}
+
+GeometryHeap::Allocation& GeometryHeap::Allocation::operator = (Allocation&& allocation) noexcept
+{
+    std::swap(m_heap, allocation.m_heap);
+    std::swap(m_pageIndex, allocation.m_pageIndex);
+    std::swap(m_vertexOffset, allocation.m_vertexOffset);
+    std::swap(m_vertexCount, allocation.m_vertexCount);
+    std::swap(m_elementOffset, allocation.m_elementOffset);
+    std::swap(m_elementSize, allocation.m_elementSize);
+    std::swap(m_elementType, allocation.m_elementType);
+    return *this;
+}
+
+const VertexArrayObject& GeometryHeap::Allocation::GetVertexArray() const
+{
+    assert(IsValid());
+    return m_heap->m_pages[m_pageIndex]->vao;
+}
+
+size_t GeometryHeap::Allocation::GetVertexDataSize() const
+{
+    assert(IsValid());
+    return m_vertexCount * m_heap->m_pages[m_pageIndex]->vertexSize;
+}
@@ -8,7 +8,10 @@ unsigned int Mesh::AddVertexData(size_t size)
 {
     unsigned int vboIndex = GetVertexBufferCount();
     VertexBufferObject& vbo = m_vbos.emplace_back();
-    vbo.Bind();
+    if (!Object::HasDirectStateAccess())
+    {
+        vbo.Bind();
+    }
     vbo.AllocateData(size);
     return vboIndex;
 }
@@ -41,17 +44,46 @@ unsigned int Mesh::AddSubmesh(unsigned int vaoIndex,
     return AddSubmesh(vaoIndex, Drawcall(primitive, count, eboType, instancing, first));
 }
 
+unsigned int Mesh::AddHeapData(GeometryHeap& heap, const VertexFormat& vertexFormat, std::span<const GLubyte> vertexData,
+    std::span<const GLubyte> elementData, Data::Type elementType, const SemanticMap& locations)
+{
+    unsigned int heapDataIndex = GetHeapDataCount();
+    m_heapData.push_back(heap.Allocate(vertexFormat, vertexData, elementData, elementType, locations));
+    return heapDataIndex;
+}
+
+unsigned int Mesh::AddHeapSubmesh(unsigned int heapDataIndex, Drawcall::Primitive primitive, GLint first, GLsizei count)
+{
+    const GeometryHeap::Allocation& heapData = m_heapData[heapDataIndex];
+    Data::Type elementType = heapData.GetElementType();
+
+    // Elements are offset in the EBO of the heap, and they index from the base vertex
+    Drawcall drawcall(primitive, count, elementType, elementType != Data::Type::None ? heapData.GetElementOffset() + first : first);
+    drawcall.SetBaseVertex(heapData.GetBaseVertex());
+
+    unsigned int submeshIndex = AddSubmesh(0, drawcall);
+    m_submeshes[submeshIndex].heapDataIndex = heapDataIndex;
+    return submeshIndex;
+}
+
+const VertexArrayObject& Mesh::GetSubmeshVertexArray(unsigned int submeshIndex) const
+{
+    const Submesh& submesh = GetSubmesh(submeshIndex);
+    return submesh.heapDataIndex >= 0 ? m_heapData[submesh.heapDataIndex].GetVertexArray() : GetVertexArray(submesh.vaoIndex);
+}
+
 // Bind the VAO and render the drawcall of the submesh
 void Mesh::DrawSubmesh(int submeshIndex) const
 {
     const Submesh& submesh = GetSubmesh(submeshIndex);
-    const VertexArrayObject& vao = GetVertexArray(submesh.vaoIndex);
+    const VertexArrayObject& vao = GetSubmeshVertexArray(submeshIndex);
     vao.Bind();
     submesh.drawcall.Draw();
     //VertexArrayObject::Unbind(); // No need to unbind
 }
 
-void Mesh::SetupVertexAttribute(VertexArrayObject& vao, const VertexAttribute::Layout& attributeLayout, GLuint& location, const SemanticMap& locations, bool instanced)
+void Mesh::SetupVertexAttribute(VertexArrayObject& vao, const VertexBufferObject& vbo, const VertexAttribute::Layout& attributeLayout,
+    GLuint& location, const SemanticMap& locations, bool instanced)
 {
     const VertexAttribute& attribute = attributeLayout.GetAttribute();
 
@@ -61,10 +93,26 @@ void Mesh::SetupVertexAttribute(VertexArrayObject& vao, const VertexAttribute::L
         location = itLocation->second;
     }
 
-    vao.SetAttribute(location, attribute, attributeLayout.GetOffset(), attributeLayout.GetStride(), instanced);
+    vao.SetAttribute(location, attribute, vbo, attributeLayout.GetOffset(), attributeLayout.GetStride(), instanced);
     location += attribute.GetLocationSize();
 }
 
+void Mesh::SetElementBuffer(unsigned int vaoIndex, unsigned int eboIndex)
+{
+    VertexArrayObject& vao = GetVertexArray(vaoIndex);
+    const ElementBufferObject& ebo = GetElementBuffer(eboIndex);
+    if (Object::HasDirectStateAccess())
+    {
+        vao.SetElementBuffer(ebo);
+        return;
+    }
+
+    vao.Bind();
+    vao.SetElementBuffer(ebo);
+    VertexArrayObject::Unbind();
+    ElementBufferObject::Unbind();
+}
+
 void Mesh::SetSubmeshInstanceCount(int submeshIndex, GLuint instanceCount)
 {
     Submesh& submesh = GetSubmesh(submeshIndex);
@@ -0,0 +1,372 @@
+#include <ituGL/geometry/MeshOptimizer.h>
+
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <array>
+#include <cstring>
+#include <cmath>
+#include <cassert>
+
+// Size of the LRU cache simulated by OptimizeVertexCache. Bigger than the real one, so that it still works if it changes
+static const int s_optimizeCacheSize = 32;
+
+// Size of the FIFO cache used to find the clusters in OptimizeOverdraw
+static const unsigned int s_overdrawCacheSize = 16;
+
+// FIFO cache of transformed vertices. A vertex is in the cache if less than cacheSize misses happened since it was added
+struct FifoVertexCache
+{
+    FifoVertexCache(unsigned int vertexCount, unsigned int cacheSize)
+        : timestamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize)
+    {
+    }
+
+    // Returns the number of vertices of the triangle that were not in the cache
+    unsigned int AddTriangle(const unsigned int* triangle)
+    {
+        unsigned int misses = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            unsigned int& timestamp = timestamps[triangle[i]];
+            if (time - timestamp > size)
+            {
+                timestamp = time++;
+                ++misses;
+            }
+        }
+        return misses;
+    }
+
+    // Remove all the vertices from the cache
+    void Clear()
+    {
+        time += size + 1;
+    }
+
+    std::vector<unsigned int> timestamps;
+    unsigned int time;
+    unsigned int size;
+};
+
+// Score of a vertex depending on its position in the cache (-1 if not in the cache) and its triangles not added yet
+// Vertices just used get a lower score than the next ones in the cache, so that the triangles don't form strips
+static float GetVertexScore(int cachePosition, unsigned int remainingTriangles)
+{
+    if (remainingTriangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        score = cachePosition < 3 ? 0.75f :
+            std::pow(1.0f - static_cast<float>(cachePosition - 3) / (s_optimizeCacheSize - 3), 1.5f);
+    }
+
+    // Boost the vertices with few triangles left, so that they are finished and don't need to be transformed again
+    score += 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+    return score;
+}
+
+static glm::vec3 GetPosition(std::span<const std::byte> vertexData, std::size_t vertexStride, unsigned int index)
+{
+    glm::vec3 position;
+    std::memcpy(&position, vertexData.data() + index * vertexStride, sizeof(position));
+    return position;
+}
+
+MeshOptimizer::VertexCacheStatistics& MeshOptimizer::VertexCacheStatistics::operator += (const VertexCacheStatistics& statistics)
+{
+    triangleCount += statistics.triangleCount;
+    vertexCount += statistics.vertexCount;
+    transformedVertexCount += statistics.transformedVertexCount;
+    return *this;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::span<unsigned int> indices, unsigned int vertexCount)
+{
+    assert(indices.size() % 3 == 0);
+    unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+    if (triangleCount == 0)
+        return;
+
+    // Triangles of each vertex. The ones not added yet are kept at the start of each list
+    std::vector<unsigned int> remainingTriangles(vertexCount, 0);
+    for (unsigned int index : indices)
+    {
+        assert(index < vertexCount);
+        ++remainingTriangles[index];
+    }
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    std::partial_sum(remainingTriangles.begin(), remainingTriangles.end(), adjacencyOffsets.begin() + 1);
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> adjacencyCounts(vertexCount, 0);
+        for (unsigned int triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                unsigned int vertex = indices[triangle * 3 + i];
+                adjacency[adjacencyOffsets[vertex] + adjacencyCounts[vertex]++] = triangle;
+            }
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (unsigned int vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        vertexScores[vertex] = GetVertexScore(-1, remainingTriangles[vertex]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> triangleAdded(triangleCount, false);
+    for (unsigned int triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        const unsigned int* triangleIndices = &indices[triangle * 3];
+        triangleScores[triangle] = vertexScores[triangleIndices[0]] + vertexScores[triangleIndices[1]] + vertexScores[triangleIndices[2]];
+    }
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+
+    // The triangle added pushes its vertices to the front, so the cache can hold 3 more vertices for a moment
+    std::array<unsigned int, s_optimizeCacheSize + 3> cache;
+    std::array<unsigned int, s_optimizeCacheSize + 3> nextCache;
+    int cacheCount = 0;
+
+    int bestTriangle = static_cast<int>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+    unsigned int scanTriangle = 0;
+    while (output.size() < indices.size())
+    {
+        // No triangle uses the cached vertices, continue with the first one not added yet
+        if (bestTriangle < 0)
+        {
+            while (triangleAdded[scanTriangle])
+            {
+                ++scanTriangle;
+            }
+            bestTriangle = static_cast<int>(scanTriangle);
+        }
+
+        const unsigned int* triangleIndices = &indices[bestTriangle * 3];
+        output.insert(output.end(), triangleIndices, triangleIndices + 3);
+        triangleAdded[bestTriangle] = true;
+
+        int nextCacheCount = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            unsigned int vertex = triangleIndices[i];
+            nextCache[nextCacheCount++] = vertex;
+
+            // Remove the triangle from the remaining ones of the vertex
+            unsigned int* triangles = &adjacency[adjacencyOffsets[vertex]];
+            unsigned int& remaining = remainingTriangles[vertex];
+            std::swap(*std::find(triangles, triangles + remaining, static_cast<unsigned int>(bestTriangle)), triangles[remaining - 1]);
+            --remaining;
+        }
+        for (int i = 0; i < cacheCount; ++i)
+        {
+            unsigned int vertex = cache[i];
+            if (vertex != triangleIndices[0] && vertex != triangleIndices[1] && vertex != triangleIndices[2])
+            {
+                nextCache[nextCacheCount++] = vertex;
+            }
+        }
+
+        // Vertices pushed out of the cache get their score without cache position
+        for (int i = 0; i < nextCacheCount; ++i)
+        {
+            unsigned int vertex = nextCache[i];
+            cachePositions[vertex] = i < s_optimizeCacheSize ? i : -1;
+            vertexScores[vertex] = GetVertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+        }
+
+        // Only the triangles of the updated vertices change their score, the next one is the best of them
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (int i = 0; i < nextCacheCount; ++i)
+        {
+            unsigned int vertex = nextCache[i];
+            const unsigned int* triangles = &adjacency[adjacencyOffsets[vertex]];
+            for (unsigned int j = 0; j < remainingTriangles[vertex]; ++j)
+            {
+                unsigned int triangle = triangles[j];
+                const unsigned int* indices3 = &indices[triangle * 3];
+                float score = vertexScores[indices3[0]] + vertexScores[indices3[1]] + vertexScores[indices3[2]];
+                triangleScores[triangle] = score;
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = static_cast<int>(triangle);
+                }
+            }
+        }
+
+        cacheCount = std::min(nextCacheCount, s_optimizeCacheSize);
+        std::copy(nextCache.begin(), nextCache.begin() + cacheCount, cache.begin());
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::span<unsigned int> indices, std::span<const std::byte> vertexData, std::size_t vertexStride,
+    float threshold)
+{
+    assert(indices.size() % 3 == 0);
+    unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+    unsigned int vertexCount = static_cast<unsigned int>(vertexData.size() / vertexStride);
+    if (triangleCount == 0)
+        return;
+
+    // Hard boundaries, where a triangle misses all its vertices. Moving those clusters doesn't change the cache misses
+    std::vector<unsigned int> hardBoundaries;
+    FifoVertexCache cache(vertexCount, s_overdrawCacheSize);
+    for (unsigned int triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        if (cache.AddTriangle(&indices[triangle * 3]) == 3 || triangle == 0)
+        {
+            hardBoundaries.push_back(triangle);
+        }
+    }
+    hardBoundaries.push_back(triangleCount);
+
+    // Soft boundaries, splitting the hard clusters where their ACMR so far is good enough
+    std::vector<unsigned int> clusterStarts;
+    for (int hardCluster = 0; hardCluster + 1 < hardBoundaries.size(); ++hardCluster)
+    {
+        unsigned int start = hardBoundaries[hardCluster];
+        unsigned int end = hardBoundaries[hardCluster + 1];
+
+        cache.Clear();
+        unsigned int misses = 0;
+        for (unsigned int triangle = start; triangle < end; ++triangle)
+        {
+            misses += cache.AddTriangle(&indices[triangle * 3]);
+        }
+        float clusterThreshold = threshold * misses / (end - start);
+
+        cache.Clear();
+        unsigned int clusterStart = start;
+        unsigned int clusterMisses = 0;
+        clusterStarts.push_back(start);
+        for (unsigned int triangle = start; triangle + 1 < end; ++triangle)
+        {
+            clusterMisses += cache.AddTriangle(&indices[triangle * 3]);
+            if (static_cast<float>(clusterMisses) / (triangle + 1 - clusterStart) <= clusterThreshold)
+            {
+                clusterStart = triangle + 1;
+                clusterMisses = 0;
+                clusterStarts.push_back(clusterStart);
+                cache.Clear();
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    // Centroid of the mesh, weighted by triangle area
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (unsigned int triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        glm::vec3 p0 = GetPosition(vertexData, vertexStride, indices[triangle * 3 + 0]);
+        glm::vec3 p1 = GetPosition(vertexData, vertexStride, indices[triangle * 3 + 1]);
+        glm::vec3 p2 = GetPosition(vertexData, vertexStride, indices[triangle * 3 + 2]);
+        float area = glm::length(glm::cross(p1 - p0, p2 - p0));
+        meshCentroid += (p0 + p1 + p2) * (area / 3.0f);
+        meshArea += area;
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+    // Clusters further away from the centroid, in the direction they face, are more likely to occlude others
+    unsigned int clusterCount = static_cast<unsigned int>(clusterStarts.size() - 1);
+    std::vector<float> clusterSortKeys(clusterCount);
+    for (unsigned int cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (unsigned int triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle)
+        {
+            glm::vec3 p0 = GetPosition(vertexData, vertexStride, indices[triangle * 3 + 0]);
+            glm::vec3 p1 = GetPosition(vertexData, vertexStride, indices[triangle * 3 + 1]);
+            glm::vec3 p2 = GetPosition(vertexData, vertexStride, indices[triangle * 3 + 2]);
+            glm::vec3 triangleNormal = glm::cross(p1 - p0, p2 - p0);
+            float triangleArea = glm::length(triangleNormal);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += triangleNormal;
+            area += triangleArea;
+        }
+        centroid = area > 0.0f ? centroid / area : centroid;
+        float normalLength = glm::length(normal);
+        clusterSortKeys[cluster] = normalLength > 0.0f ? glm::dot(centroid - meshCentroid, normal / normalLength) : 0.0f;
+    }
+
+    std::vector<unsigned int> clusterOrder(clusterCount);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+        [&](unsigned int a, unsigned int b) { return clusterSortKeys[a] > clusterSortKeys[b]; });
+
+    std::vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (unsigned int cluster : clusterOrder)
+    {
+        output.insert(output.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+unsigned int MeshOptimizer::OptimizeVertexFetch(std::span<unsigned int> indices, std::span<std::byte> vertexData, std::size_t vertexStride)
+{
+    unsigned int vertexCount = static_cast<unsigned int>(vertexData.size() / vertexStride);
+
+    // New index of each vertex, in order of first use
+    const unsigned int unused = ~0u;
+    std::vector<unsigned int> remap(vertexCount, unused);
+    unsigned int usedVertexCount = 0;
+    for (unsigned int& index : indices)
+    {
+        assert(index < vertexCount);
+        if (remap[index] == unused)
+        {
+            remap[index] = usedVertexCount++;
+        }
+        index = remap[index];
+    }
+
+    std::vector<std::byte> sourceData(vertexData.begin(), vertexData.end());
+    for (unsigned int vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        if (remap[vertex] != unused)
+        {
+            std::memcpy(vertexData.data() + remap[vertex] * vertexStride, sourceData.data() + vertex * vertexStride, vertexStride);
+        }
+    }
+    return usedVertexCount;
+}
+
+MeshOptimizer::VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(std::span<const unsigned int> indices, unsigned int vertexCount,
+    unsigned int cacheSize)
+{
+    assert(indices.size() % 3 == 0);
+    VertexCacheStatistics statistics;
+    statistics.triangleCount = static_cast<unsigned int>(indices.size() / 3);
+
+    std::vector<bool> used(vertexCount, false);
+    FifoVertexCache cache(vertexCount, cacheSize);
+    for (unsigned int triangle = 0; triangle < statistics.triangleCount; ++triangle)
+    {
+        statistics.transformedVertexCount += cache.AddTriangle(&indices[triangle * 3]);
+    }
+    for (unsigned int index : indices)
+    {
+        if (!used[index])
+        {
+            used[index] = true;
+            ++statistics.vertexCount;
+        }
+    }
+    return statistics;
+}
@@ -1,11 +1,11 @@
 #include <ituGL/geometry/VertexArrayObject.h>
 
 #include <ituGL/geometry/VertexAttribute.h>
+#include <ituGL/geometry/VertexBufferObject.h>
+#include <ituGL/geometry/ElementBufferObject.h>
 #include <cassert>
 
 #ifndef NDEBUG
-#include <ituGL/geometry/VertexBufferObject.h>   // To assert that there is a VertexBufferObject bound
-
 VertexArrayObject::Handle VertexArrayObject::s_boundHandle = VertexArrayObject::NullHandle;
 #endif
 
@@ -13,7 +13,14 @@ VertexArrayObject::Handle VertexArrayObject::s_boundHandle = VertexArrayObject::
 VertexArrayObject::VertexArrayObject() : Object(NullHandle)
 {
     Handle& handle = GetHandle();
-    glGenVertexArrays(1, &handle);
+    if (HasDirectStateAccess())
+    {
+        glCreateVertexArrays(1, &handle);
+    }
+    else
+    {
+        glGenVertexArrays(1, &handle);
+    }
 }
 
 // Get object handle and delete 1 vertex array
@@ -77,3 +84,44 @@ void VertexArrayObject::SetAttribute(GLuint location, const VertexAttribute& att
     if (instanced)
         glVertexAttribDivisor(location, 1);
 }
+
+void VertexArrayObject::SetAttribute(GLuint location, const VertexAttribute& attribute, const VertexBufferObject& vbo,
+    GLint offset, GLsizei stride, bool instanced)
+{
+    if (!HasDirectStateAccess())
+    {
+        vbo.Bind();
+        SetAttribute(location, attribute, offset, stride, instanced);
+        return;
+    }
+
+    // Each attribute gets its own buffer binding, with the same index as the location
+    // The whole offset goes in the binding, as the relative offset of the format has a small limit
+    Handle handle = GetHandle();
+    GLuint bindingIndex = location;
+    GLsizei bindingStride = stride != 0 ? stride : attribute.GetSize(); // Unlike glVertexAttribPointer, 0 is not tightly packed
+    glVertexArrayVertexBuffer(handle, bindingIndex, vbo.GetHandle(), offset, bindingStride);
+
+    GLint components = attribute.GetComponents();
+    GLenum type = static_cast<GLenum>(attribute.GetType());
+    GLboolean normalized = attribute.IsNormalized() ? GL_TRUE : GL_FALSE;
+    glVertexArrayAttribFormat(handle, location, components, type, normalized, 0);
+    glVertexArrayAttribBinding(handle, location, bindingIndex);
+    glEnableVertexArrayAttrib(handle, location);
+
+    if (instanced)
+        glVertexArrayBindingDivisor(handle, bindingIndex, 1);
+}
+
+void VertexArrayObject::SetElementBuffer(const ElementBufferObject& ebo)
+{
+    if (HasDirectStateAccess())
+    {
+        glVertexArrayElementBuffer(GetHandle(), ebo.GetHandle());
+        return;
+    }
+
+    // The EBO bound while the VAO is bound is stored in the VAO
+    assert(IsBound());
+    ebo.Bind();
+}
@@ -17,12 +17,12 @@ void VertexFormat::AddVertexAttribute(Data::Type type, int components, bool norm
     m_size += attributeSize;
 }
 
-VertexFormat::LayoutIterator VertexFormat::LayoutBegin(int vertexCount, bool interleaved)
+VertexFormat::LayoutIterator VertexFormat::LayoutBegin(int vertexCount, bool interleaved) const
 {
     return LayoutIterator(*this, vertexCount, interleaved);
 }
 
-VertexFormat::LayoutIterator VertexFormat::LayoutEnd()
+VertexFormat::LayoutIterator VertexFormat::LayoutEnd() const
 {
     return LayoutIterator(*this);
 }
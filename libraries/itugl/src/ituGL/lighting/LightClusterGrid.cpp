@@ -0,0 +1,222 @@
+#include <ituGL/lighting/LightClusterGrid.h>
+
+#include <ituGL/lighting/Light.h>
+#include <ituGL/camera/Camera.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/exponential.hpp>
+#include <glm/matrix.hpp>
+#include <algorithm>
+#include <limits>
+#include <future>
+#include <thread>
+#include <cassert>
+
+const int LightClusterGrid::s_lightIndexTextureWidth = 1024;
+
+LightClusterGrid::LightClusterGrid(glm::uvec3 dimensions, unsigned int maxLights)
+    : m_dimensions(dimensions)
+    , m_maxLights(maxLights)
+    , m_lightCount(0)
+    , m_projMatrix(0.0f)
+    , m_depthSliceParams(0.0f)
+{
+    assert(dimensions.x > 0 && dimensions.y > 0 && dimensions.z > 0);
+    assert(maxLights > 0);
+
+    m_clusterData.resize(2 * dimensions.x * dimensions.y * dimensions.z, 0u);
+
+    // Textures are read with texelFetch, no filtering
+    for (Texture2DObject* texture : { &m_lightDataTexture, &m_clusterTexture, &m_lightIndexTexture })
+    {
+        texture->Bind();
+        texture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
+        texture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+    }
+    Texture2DObject::Unbind();
+}
+
+void LightClusterGrid::Build(const Camera& camera, std::span<const Light* const> lights)
+{
+    const glm::mat4& viewMatrix = camera.GetViewMatrix();
+    const glm::mat4& projMatrix = camera.GetProjectionMatrix();
+
+    if (projMatrix != m_projMatrix)
+    {
+        UpdateClusterBounds(projMatrix);
+    }
+
+    // Pack the light data and compute the bounding spheres in view space
+    m_lightCount = std::min(static_cast<unsigned int>(lights.size()), m_maxLights);
+    m_lightData.resize(4 * m_maxLights);
+    m_lightBounds.resize(m_lightCount);
+    for (unsigned int i = 0; i < m_lightCount; ++i)
+    {
+        const Light& light = *lights[i];
+        glm::vec3 position = light.GetPosition(glm::vec3(0.0f));
+        glm::vec4 attenuation = light.GetAttenuation();
+
+        m_lightData[4 * i + 0] = glm::vec4(light.GetColor() * light.GetIntensity(), 0.0f);
+        m_lightData[4 * i + 1] = glm::vec4(position, 1.0f);
+        m_lightData[4 * i + 2] = glm::vec4(light.GetDirection(glm::vec3(0.0f)), 0.0f);
+        m_lightData[4 * i + 3] = attenuation;
+
+        // Lights without distance attenuation affect all the clusters
+        LightBounds& bounds = m_lightBounds[i];
+        bounds.center = glm::vec3(viewMatrix * glm::vec4(position, 1.0f));
+        bounds.radius = attenuation.y > 0 ? attenuation.y : -1.0f;
+    }
+
+    // Split the slices between the available threads. Each one produces its own list of indices
+    unsigned int threadCount = std::max(1u, std::min(std::thread::hardware_concurrency(), m_dimensions.z));
+    std::vector<std::vector<unsigned int>> threadIndices(threadCount);
+    std::vector<std::future<void>> futures;
+    for (unsigned int t = 1; t < threadCount; ++t)
+    {
+        unsigned int sliceBegin = t * m_dimensions.z / threadCount;
+        unsigned int sliceEnd = (t + 1) * m_dimensions.z / threadCount;
+        futures.push_back(std::async(std::launch::async, &LightClusterGrid::AssignLights, this, sliceBegin, sliceEnd, std::ref(threadIndices[t])));
+    }
+    AssignLights(0, m_dimensions.z / threadCount, threadIndices[0]);
+
+    // Merge the lists, moving the cluster offsets of each range to their final position
+    m_lightIndices.swap(threadIndices[0]);
+    unsigned int tileCount = m_dimensions.x * m_dimensions.y;
+    for (unsigned int t = 1; t < threadCount; ++t)
+    {
+        futures[t - 1].wait();
+
+        unsigned int offset = static_cast<unsigned int>(m_lightIndices.size());
+        unsigned int clusterBegin = (t * m_dimensions.z / threadCount) * tileCount;
+        unsigned int clusterEnd = ((t + 1) * m_dimensions.z / threadCount) * tileCount;
+        for (unsigned int cluster = clusterBegin; cluster < clusterEnd; ++cluster)
+        {
+            m_clusterData[2 * cluster] += offset;
+        }
+        m_lightIndices.insert(m_lightIndices.end(), threadIndices[t].begin(), threadIndices[t].end());
+    }
+
+    UpdateTextures();
+}
+
+void LightClusterGrid::UpdateClusterBounds(const glm::mat4& projMatrix)
+{
+    // Clusters are computed for a perspective projection
+    assert(projMatrix[2][3] == -1.0f && projMatrix[3][3] == 0.0f);
+
+    m_projMatrix = projMatrix;
+
+    // Extract near and far distances from the projection matrix
+    float nearDistance = projMatrix[3][2] / (projMatrix[2][2] - 1.0f);
+    float farDistance = projMatrix[3][2] / (projMatrix[2][2] + 1.0f);
+
+    // Slices are distributed exponentially, so that they have similar proportions
+    float logRatio = glm::log(farDistance / nearDistance);
+    m_depthSliceParams.x = m_dimensions.z / logRatio;
+    m_depthSliceParams.y = -m_dimensions.z * glm::log(nearDistance) / logRatio;
+
+    glm::mat4 invProjMatrix = glm::inverse(projMatrix);
+
+    m_clusterBounds.resize(m_dimensions.x * m_dimensions.y * m_dimensions.z);
+
+    for (unsigned int z = 0; z < m_dimensions.z; ++z)
+    {
+        float sliceNear = nearDistance * glm::pow(farDistance / nearDistance, static_cast<float>(z) / m_dimensions.z);
+        float sliceFar = nearDistance * glm::pow(farDistance / nearDistance, static_cast<float>(z + 1) / m_dimensions.z);
+
+        for (unsigned int y = 0; y < m_dimensions.y; ++y)
+        {
+            for (unsigned int x = 0; x < m_dimensions.x; ++x)
+            {
+                ClusterBounds& bounds = m_clusterBounds[(z * m_dimensions.y + y) * m_dimensions.x + x];
+                bounds.min = glm::vec3(std::numeric_limits<float>::max());
+                bounds.max = glm::vec3(std::numeric_limits<float>::lowest());
+
+                // Project the corners of the tile to the far plane and scale them to the slice depths
+                for (unsigned int corner = 0; corner < 4; ++corner)
+                {
+                    glm::vec2 ndc = glm::vec2(x + (corner & 1), y + (corner >> 1)) / glm::vec2(m_dimensions) * 2.0f - 1.0f;
+                    glm::vec4 farPoint = invProjMatrix * glm::vec4(ndc, 1.0f, 1.0f);
+                    glm::vec3 ray = glm::vec3(farPoint) / farPoint.w;
+                    ray /= -ray.z;
+
+                    bounds.min = glm::min(bounds.min, glm::min(ray * sliceNear, ray * sliceFar));
+                    bounds.max = glm::max(bounds.max, glm::max(ray * sliceNear, ray * sliceFar));
+                }
+            }
+        }
+    }
+}
+
+void LightClusterGrid::AssignLights(unsigned int sliceBegin, unsigned int sliceEnd, std::vector<unsigned int>& indices)
+{
+    indices.clear();
+
+    unsigned int tileCount = m_dimensions.x * m_dimensions.y;
+    std::vector<unsigned int> sliceLights;
+
+    for (unsigned int z = sliceBegin; z < sliceEnd; ++z)
+    {
+        // Discard first the lights that don't reach the depth range of the slice
+        const ClusterBounds& firstBounds = m_clusterBounds[z * tileCount];
+        sliceLights.clear();
+        for (unsigned int i = 0; i < m_lightCount; ++i)
+        {
+            const LightBounds& light = m_lightBounds[i];
+            if (light.radius < 0 || (light.center.z - light.radius <= firstBounds.max.z && light.center.z + light.radius >= firstBounds.min.z))
+            {
+                sliceLights.push_back(i);
+            }
+        }
+
+        for (unsigned int tile = 0; tile < tileCount; ++tile)
+        {
+            unsigned int cluster = z * tileCount + tile;
+            const ClusterBounds& bounds = m_clusterBounds[cluster];
+
+            unsigned int offset = static_cast<unsigned int>(indices.size());
+            for (unsigned int lightIndex : sliceLights)
+            {
+                if (Intersects(m_lightBounds[lightIndex], bounds))
+                {
+                    indices.push_back(lightIndex);
+                }
+            }
+
+            // Each thread writes a different range of clusters
+            m_clusterData[2 * cluster + 0] = offset;
+            m_clusterData[2 * cluster + 1] = static_cast<unsigned int>(indices.size()) - offset;
+        }
+    }
+}
+
+void LightClusterGrid::UpdateTextures()
+{
+    m_lightDataTexture.Bind();
+    m_lightDataTexture.SetImage<glm::vec4>(0, 4, m_maxLights, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA32F, m_lightData, Data::Type::Float);
+
+    m_clusterTexture.Bind();
+    m_clusterTexture.SetImage<unsigned int>(0, m_dimensions.x * m_dimensions.y, m_dimensions.z, TextureObject::FormatRGInteger, TextureObject::InternalFormatRG32UI, m_clusterData);
+
+    // Pad the indices to fill complete rows
+    int rows = std::max(1, static_cast<int>((m_lightIndices.size() + s_lightIndexTextureWidth - 1) / s_lightIndexTextureWidth));
+    m_lightIndices.resize(rows * s_lightIndexTextureWidth, 0u);
+
+    m_lightIndexTexture.Bind();
+    m_lightIndexTexture.SetImage<unsigned int>(0, s_lightIndexTextureWidth, rows, TextureObject::FormatRInteger, TextureObject::InternalFormatR32UI, m_lightIndices);
+
+    Texture2DObject::Unbind();
+}
+
+bool LightClusterGrid::Intersects(const LightBounds& light, const ClusterBounds& cluster)
+{
+    if (light.radius < 0)
+    {
+        return true;
+    }
+
+    // Squared distance from the sphere center to the closest point in the box
+    glm::vec3 closestPoint = glm::clamp(light.center, cluster.min, cluster.max);
+    glm::vec3 offset = closestPoint - light.center;
+    return glm::dot(offset, offset) <= light.radius * light.radius;
+}
@@ -2,11 +2,14 @@
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 
-PointLight::PointLight() : m_position(0.0f), m_attenuation(0.0f)
+PointLight::PointLight(bool castShadows) : m_position(0.0f), m_attenuation(0.0f), m_castShadows(castShadows)
 {
-    InitTextures();
-    InitFramebuffers();
-    UpdateLightSpaceMatrices();
+    if (m_castShadows)
+    {
+        InitTextures();
+        InitFramebuffers();
+        UpdateLightSpaceMatrices();
+    }
 }
 
 Light::Type PointLight::GetType() const
@@ -81,7 +84,10 @@ glm::vec3 PointLight::GetPosition(const glm::vec3& fallback) const
 void PointLight::SetPosition(const glm::vec3& position)
 {
     m_position = position;
-    UpdateLightSpaceMatrices();
+    if (m_castShadows)
+    {
+        UpdateLightSpaceMatrices();
+    }
 }
 
 glm::vec4 PointLight::GetAttenuation() const
@@ -106,5 +112,9 @@ glm::ivec2 PointLight::GetDepthTextureResolution() const
 
 const std::span<const Light::LightRenderInfo> PointLight::GetRenderInfo() const
 {
+    if (!m_castShadows)
+    {
+        return std::span<const LightRenderInfo>();
+    }
     return m_lightRenderInfo;
 }
@@ -2,11 +2,14 @@
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 
-SpotLight::SpotLight() : m_position(0.0f), m_direction(1.0f, 0.0f, 0.0f), m_attenuation(0.0f)
+SpotLight::SpotLight(bool castShadows) : m_position(0.0f), m_direction(1.0f, 0.0f, 0.0f), m_attenuation(0.0f), m_castShadows(castShadows)
 {
-    InitTexture();
-    InitFramebuffer();
-    UpdateLightSpaceMatrix();
+    if (m_castShadows)
+    {
+        InitTexture();
+        InitFramebuffer();
+        UpdateLightSpaceMatrix();
+    }
 }
 
 Light::Type SpotLight::GetType() const
@@ -61,7 +64,10 @@ glm::vec3 SpotLight::GetPosition(const glm::vec3& fallback) const
 void SpotLight::SetPosition(const glm::vec3& position)
 {
     m_position = position;
-    UpdateLightSpaceMatrix();
+    if (m_castShadows)
+    {
+        UpdateLightSpaceMatrix();
+    }
 }
 
 glm::vec3 SpotLight::GetDirection(const glm::vec3& fallback) const
@@ -72,7 +78,10 @@ glm::vec3 SpotLight::GetDirection(const glm::vec3& fallback) const
 void SpotLight::SetDirection(const glm::vec3& direction)
 {
     m_direction = direction;
-    UpdateLightSpaceMatrix();
+    if (m_castShadows)
+    {
+        UpdateLightSpaceMatrix();
+    }
 }
 
 glm::vec4 SpotLight::GetAttenuation() const
@@ -119,5 +128,9 @@ glm::ivec2 SpotLight::GetDepthTextureResolution() const
 
 const std::span<const Light::LightRenderInfo> SpotLight::GetRenderInfo() const
 {
+    if (!m_castShadows)
+    {
+        return std::span<const LightRenderInfo>();
+    }
     return std::span{&m_lightRenderInfo, 1};
 }
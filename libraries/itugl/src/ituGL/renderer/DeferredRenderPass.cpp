@@ -3,17 +3,45 @@
 #include <ituGL/renderer/Renderer.h>
 #include <ituGL/geometry/VertexFormat.h>
 #include <ituGL/lighting/Light.h>
+#include <ituGL/lighting/LightClusterGrid.h>
+#include <ituGL/asset/ShaderPermutationManager.h>
 #include <ituGL/camera/Camera.h>
 #include <ituGL/shader/Material.h>
 #include <ituGL/texture/Texture2DObject.h>
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/constants.hpp>
 
-DeferredRenderPass::DeferredRenderPass(std::shared_ptr<Material> material)
-    : m_material(material)
+// Texture units used by the cluster textures, after the ones used by the material
+static const GLint s_clusterTextureUnit = 8;
+
+static constexpr ShaderProgram::NameHash s_copyDepthName = ShaderProgram::HashName("CopyDepth");
+
+// Spot lights wider than this use a sphere, as the cone would be too flat
+static const float s_maxConeAngle = glm::radians(80.0f);
+
+DeferredRenderPass::DeferredRenderPass(std::shared_ptr<Material> material, std::shared_ptr<LightClusterGrid> lightClusterGrid,
+    std::shared_ptr<Material> lightVolumeMaterial, std::shared_ptr<const FramebufferObject> targetFramebuffer)
+    : RenderPass(targetFramebuffer)
+    , m_material(material)
+    , m_shadowMapDefine(-1)
+    , m_lightIndirectDefine(-1)
+    , m_clusteredLightsDefine(-1)
+    , m_shadowMapEnabled(true)
+    , m_lightClusterGrid(lightClusterGrid)
+    , m_lightVolumeMaterial(lightVolumeMaterial)
 {
     InitializeMeshes();
-    m_lightSpaceMatrixLocation = m_material->GetUniformLocation("LightSpaceMatrix");
-    m_lightDepthTextureLocation = m_material->GetUniformLocation("LightDepthTexture");
+}
+
+void DeferredRenderPass::SetPermutations(std::shared_ptr<ShaderPermutationManager> permutations)
+{
+    m_permutations = permutations;
+    if (m_permutations)
+    {
+        m_shadowMapDefine = m_permutations->FindDefine("SHADOW_MAP");
+        m_lightIndirectDefine = m_permutations->FindDefine("LIGHT_INDIRECT");
+        m_clusteredLightsDefine = m_permutations->FindDefine("CLUSTERED_LIGHTS");
+    }
 }
 
 void DeferredRenderPass::Render()
@@ -22,52 +50,401 @@ void DeferredRenderPass::Render()
 
     const Camera& camera = renderer.GetCurrentCamera();
 
-    assert(m_material);
-    m_material->Use();
-    std::shared_ptr<const ShaderProgram> shaderProgram = m_material->GetShaderProgram();
-
     // Our fullscreen triangle is directly in clip coordinates.
     // Use the inverse view proj matrix to cancel view projection from the camera
     glm::mat4 fullscreenMatrix = glm::inverse(camera.GetViewProjectionMatrix());
 
+    // Same area of the render targets used by the G-buffer pass
+    renderer.SetRenderViewport(true);
+
+    // Light volumes are tested against the depth of the scene
+    if (m_lightVolumeMaterial)
+    {
+        CopyDepth();
+    }
+
+    // With clusters, only the lights with shadows need their own pass
+    std::span<const Light* const> lights = renderer.GetLights();
+    if (m_lightClusterGrid)
+    {
+        m_passLights.clear();
+        m_clusteredLights.clear();
+        for (const Light* light : lights)
+        {
+            if (light->GetRenderInfo().empty())
+                m_clusteredLights.push_back(light);
+            else
+                m_passLights.push_back(light);
+        }
+        lights = m_passLights;
+
+        m_lightClusterGrid->Build(camera, m_clusteredLights);
+    }
+
+    const Material* currentMaterial = nullptr;
+    bool cameraChanged = true;
     bool first = true;
     unsigned int lightIndex = 0;
-    const auto& lights = renderer.GetLights();
-    while (renderer.UpdateLights(shaderProgram, lights, lightIndex))
+    while (true)
     {
-        const Light* light = lightIndex <= lights.size() ? lights[lightIndex - 1] : nullptr;
+        // The variant depends on the light, so it must be in use before updating the light uniforms
+        const Light* light = lightIndex < lights.size() ? lights[lightIndex] : nullptr;
+        std::shared_ptr<Material> material = GetPassMaterial(first, light);
+        const MaterialLocations& locations = GetMaterialLocations(*material);
+        if (material.get() != currentMaterial)
+        {
+            UseMaterial(*material, locations, first);
+            currentMaterial = material.get();
+
+            // Each variant is a different program, with its own camera uniforms
+            cameraChanged = true;
+        }
+
+        std::shared_ptr<const ShaderProgram> shaderProgram = material->GetShaderProgram();
+        if (!renderer.UpdateLights(shaderProgram, lights, lightIndex))
+            break;
+
         assert(first || light);
 
-        const Mesh* mesh = &m_fullscreenMesh;
+        // The first pass includes indirect light and must cover the entire screen
         glm::mat4 worldMatrix = fullscreenMatrix;
+        const Mesh* volumeMesh = !first && light && m_lightVolumeMaterial ? GetLightVolume(*light, worldMatrix) : nullptr;
+        const Mesh* mesh = volumeMesh ? volumeMesh : &renderer.GetFullscreenMesh();
 
-        // TODO: select different meshes depending on the type
+        // Lights without shadow maps (or no lights at all) are drawn once
+        auto renderInfo = light ? light->GetRenderInfo() : std::span<const Light::LightRenderInfo>();
+        size_t passCount = std::max<size_t>(renderInfo.size(), 1);
+        for (size_t passIndex = 0; passIndex < passCount; ++passIndex)
+        {
+            if (volumeMesh)
+            {
+                RenderLightVolumeStencil(*volumeMesh, worldMatrix);
+                shaderProgram->Use();
+                SetLightVolumeRenderStates();
+            }
+            else
+            {
+                SetFullscreenRenderStates(first);
+            }
 
-        // Set the render states for the first and additional lights
-        renderer.SetLightingRenderStates(first);
+            // Clustered lights are added only once, in the first pass
+            if (m_lightClusterGrid)
+            {
+                shaderProgram->SetUniform(locations.clusteredLightsEnabled, first ? 1 : 0);
+            }
 
-        auto renderInfo = light->GetRenderInfo();
-        for (const auto& ri : renderInfo)
-        {
-            shaderProgram->SetUniform(m_lightSpaceMatrixLocation, ri.lightSpaceMatrix);
-            shaderProgram->SetTexture(m_lightDepthTextureLocation, 2, ri.depthTextureObject);
+            // Without permutations, shadows are enabled with a uniform
+            bool shadowMap = m_shadowMapEnabled && passIndex < renderInfo.size();
+            shaderProgram->SetUniform(locations.shadowMapEnabled, shadowMap ? 1 : 0);
+            if (shadowMap)
+            {
+                const Light::LightRenderInfo& ri = renderInfo[passIndex];
+                shaderProgram->SetUniform(locations.lightSpaceMatrix, ri.lightSpaceMatrix);
+                shaderProgram->SetTexture(locations.lightDepthTexture, 2, ri.depthTextureObject);
+            }
 
-            renderer.UpdateTransforms(shaderProgram, fullscreenMatrix, first);
+            renderer.UpdateTransforms(shaderProgram, worldMatrix, cameraChanged);
+            cameraChanged = false;
             mesh->DrawSubmesh(0);
             first = false;
         }
     }
+
+    ResetRenderStates();
+}
+
+std::shared_ptr<Material> DeferredRenderPass::GetPassMaterial(bool first, const Light* light) const
+{
+    if (!m_permutations)
+    {
+        assert(m_material);
+        return m_material;
+    }
+
+    ShaderPermutationManager::Key key = m_permutations->GetDefaultKey();
+    if (m_shadowMapDefine >= 0)
+    {
+        bool shadowMap = m_shadowMapEnabled && light && !light->GetRenderInfo().empty();
+        key = m_permutations->SetDefineValue(key, m_shadowMapDefine, shadowMap ? 1 : 0);
+    }
+    if (m_lightIndirectDefine >= 0)
+    {
+        key = m_permutations->SetDefineValue(key, m_lightIndirectDefine, first ? 1 : 0);
+    }
+    if (m_clusteredLightsDefine >= 0)
+    {
+        key = m_permutations->SetDefineValue(key, m_clusteredLightsDefine, first && m_lightClusterGrid ? 1 : 0);
+    }
+    return m_permutations->GetMaterial(key);
+}
+
+const DeferredRenderPass::MaterialLocations& DeferredRenderPass::GetMaterialLocations(const Material& material)
+{
+    // Query again if the program was rebuilt, as the locations can be different
+    Object::Handle shaderProgramHandle = material.GetShaderProgram()->GetHandle();
+    auto itLocations = m_materialLocations.find(&material);
+    if (itLocations != m_materialLocations.end() && itLocations->second.shaderProgramHandle == shaderProgramHandle)
+    {
+        return itLocations->second;
+    }
+
+    MaterialLocations& locations = m_materialLocations[&material];
+    locations.shaderProgramHandle = shaderProgramHandle;
+    locations.shadowMapEnabled = material.GetUniformLocation("ShadowMapEnabled");
+    locations.lightSpaceMatrix = material.GetUniformLocation("LightSpaceMatrix");
+    locations.lightDepthTexture = material.GetUniformLocation("LightDepthTexture");
+    locations.renderScale = material.GetUniformLocation("RenderScale");
+
+    locations.clusteredLightsEnabled = material.GetUniformLocation("ClusteredLightsEnabled");
+    locations.clusterDimensions = material.GetUniformLocation("ClusterDimensions");
+    locations.clusterDepthParams = material.GetUniformLocation("ClusterDepthParams");
+    locations.clusterLightDataTexture = material.GetUniformLocation("ClusterLightDataTexture");
+    locations.clusterTexture = material.GetUniformLocation("ClusterTexture");
+    locations.clusterLightIndexTexture = material.GetUniformLocation("ClusterLightIndexTexture");
+    return locations;
+}
+
+void DeferredRenderPass::UseMaterial(const Material& material, const MaterialLocations& locations, bool first)
+{
+    material.Use();
+    std::shared_ptr<const ShaderProgram> shaderProgram = material.GetShaderProgram();
+    shaderProgram->SetUniform(locations.renderScale, GetRenderer().GetScaledRenderRatio());
+
+    // Only the first pass reads the clusters
+    if (m_lightClusterGrid && first)
+    {
+        SetupClusteredLights(*shaderProgram, locations);
+    }
+}
+
+void DeferredRenderPass::SetupClusteredLights(const ShaderProgram& shaderProgram, const MaterialLocations& locations)
+{
+    shaderProgram.SetUniform(locations.clusterDimensions, glm::ivec3(m_lightClusterGrid->GetDimensions()));
+    shaderProgram.SetUniform(locations.clusterDepthParams, m_lightClusterGrid->GetDepthSliceParams());
+    shaderProgram.SetTexture(locations.clusterLightDataTexture, s_clusterTextureUnit + 0, m_lightClusterGrid->GetLightDataTexture());
+    shaderProgram.SetTexture(locations.clusterTexture, s_clusterTextureUnit + 1, m_lightClusterGrid->GetClusterTexture());
+    shaderProgram.SetTexture(locations.clusterLightIndexTexture, s_clusterTextureUnit + 2, m_lightClusterGrid->GetLightIndexTexture());
+}
+
+void DeferredRenderPass::CopyDepth()
+{
+    Renderer& renderer = GetRenderer();
+    glm::mat4 fullscreenMatrix = glm::inverse(renderer.GetCurrentCamera().GetViewProjectionMatrix());
+
+    m_lightVolumeMaterial->Use();
+    std::shared_ptr<const ShaderProgram> shaderProgram = m_lightVolumeMaterial->GetShaderProgram();
+
+    // Light volumes expect the stencil to be 0
+    renderer.GetDevice().Clear(false, Color(), false, 1.0, true, 0);
+
+    // Only depth is written, always
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthFunc(GL_ALWAYS);
+    glDepthMask(GL_TRUE);
+    renderer.GetDevice().SetFeatureEnabled(GL_STENCIL_TEST, false);
+
+    ShaderProgram::Location copyDepthLocation = m_lightVolumeMaterial->GetUniformLocation(s_copyDepthName);
+    shaderProgram->SetUniform(copyDepthLocation, 1);
+    renderer.UpdateTransforms(shaderProgram, fullscreenMatrix);
+    renderer.GetFullscreenMesh().DrawSubmesh(0);
+    shaderProgram->SetUniform(copyDepthLocation, 0);
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+const Mesh* DeferredRenderPass::GetLightVolume(const Light& light, glm::mat4& worldMatrix) const
+{
+    glm::vec4 attenuation = light.GetAttenuation();
+    glm::vec3 position = light.GetPosition(glm::vec3(0.0f));
+
+    // Range is where the distance attenuation ends. Lights without it affect the entire screen
+    float range = attenuation.y;
+    if (range <= 0.0f)
+    {
+        return nullptr;
+    }
+
+    switch (light.GetType())
+    {
+    case Light::Type::Spot:
+        // Cone with the apex in the light position, oriented along the light direction
+        if (attenuation.w > 0.0f && attenuation.w < s_maxConeAngle)
+        {
+            glm::vec3 axisZ = glm::normalize(light.GetDirection(glm::vec3(0.0f, 0.0f, 1.0f)));
+            glm::vec3 up = std::abs(axisZ.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+            glm::vec3 axisX = glm::normalize(glm::cross(up, axisZ));
+            glm::vec3 axisY = glm::cross(axisZ, axisX);
+            float radius = range * std::tan(attenuation.w);
+            worldMatrix = glm::mat4(glm::vec4(axisX * radius, 0.0f), glm::vec4(axisY * radius, 0.0f), glm::vec4(axisZ * range, 0.0f), glm::vec4(position, 1.0f));
+            return &m_coneMesh;
+        }
+        [[fallthrough]];
+    case Light::Type::Point:
+        worldMatrix = glm::translate(position) * glm::scale(glm::vec3(range));
+        return &m_sphereMesh;
+    default:
+        return nullptr;
+    }
+}
+
+void DeferredRenderPass::RenderLightVolumeStencil(const Mesh& mesh, const glm::mat4& worldMatrix)
+{
+    std::shared_ptr<const ShaderProgram> shaderProgram = m_lightVolumeMaterial->GetShaderProgram();
+    shaderProgram->Use();
+
+    SetLightVolumeStencilRenderStates();
+
+    GetRenderer().UpdateTransforms(shaderProgram, worldMatrix, false);
+    mesh.DrawSubmesh(0);
+}
+
+void DeferredRenderPass::SetFullscreenRenderStates(bool first)
+{
+    DeviceGL& device = GetRenderer().GetDevice();
+
+    // Add the result of additional lights. Depth is kept for the light volumes
+    device.SetFeatureEnabled(GL_BLEND, !first);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glDepthFunc(GL_ALWAYS);
+    glDepthMask(GL_FALSE);
+    device.SetFeatureEnabled(GL_STENCIL_TEST, false);
+    device.SetFeatureEnabled(GL_CULL_FACE, false);
+}
+
+void DeferredRenderPass::SetLightVolumeStencilRenderStates()
+{
+    DeviceGL& device = GetRenderer().GetDevice();
+
+    // Only stencil is written
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_FALSE);
+    device.SetFeatureEnabled(GL_CULL_FACE, false);
+
+    // Pixels with the surface behind the front faces and in front of the back faces end up with a value different from 0
+    device.SetFeatureEnabled(GL_STENCIL_TEST, true);
+    glStencilFunc(GL_ALWAYS, 0, 0xFF);
+    glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+    glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+}
+
+void DeferredRenderPass::SetLightVolumeRenderStates()
+{
+    DeviceGL& device = GetRenderer().GetDevice();
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    device.SetFeatureEnabled(GL_BLEND, true);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    // Back faces, so that the volume is still rendered when the camera is inside
+    glDepthFunc(GL_ALWAYS);
+    device.SetFeatureEnabled(GL_CULL_FACE, true);
+    glCullFace(GL_FRONT);
+
+    // Shade only the marked pixels, clearing the stencil for the next light
+    glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_ZERO);
+}
+
+void DeferredRenderPass::ResetRenderStates()
+{
+    DeviceGL& device = GetRenderer().GetDevice();
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    device.SetFeatureEnabled(GL_BLEND, false);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    device.SetFeatureEnabled(GL_STENCIL_TEST, false);
+    device.SetFeatureEnabled(GL_CULL_FACE, false);
+    glCullFace(GL_BACK);
 }
 
 void DeferredRenderPass::InitializeMeshes()
 {
+    CreateSphereMesh(m_sphereMesh, 16, 8);
+    CreateConeMesh(m_coneMesh, 16);
+}
+
+// Add a triangle with counter-clockwise winding seen from outside, using a point inside the (convex) volume
+static void AddVolumeTriangle(std::vector<unsigned short>& indices, const std::vector<glm::vec3>& vertices,
+    unsigned short i0, unsigned short i1, unsigned short i2, const glm::vec3& innerPoint)
+{
+    glm::vec3 normal = glm::cross(vertices[i1] - vertices[i0], vertices[i2] - vertices[i0]);
+    if (glm::dot(normal, vertices[i0] - innerPoint) < 0.0f)
+    {
+        std::swap(i1, i2);
+    }
+    indices.push_back(i0);
+    indices.push_back(i1);
+    indices.push_back(i2);
+}
+
+void DeferredRenderPass::CreateSphereMesh(Mesh& mesh, unsigned int slices, unsigned int stacks)
+{
+    // Vertices are pushed out so that the faces contain the unit sphere
+    float scale = 1.0f / (std::cos(glm::pi<float>() / slices) * std::cos(glm::pi<float>() / stacks));
+
+    std::vector<glm::vec3> vertices;
+    for (unsigned int j = 0; j <= stacks; ++j)
+    {
+        float phi = glm::pi<float>() * j / stacks;
+        for (unsigned int i = 0; i < slices; ++i)
+        {
+            float theta = glm::two_pi<float>() * i / slices;
+            vertices.emplace_back(std::sin(phi) * std::cos(theta) * scale, std::cos(phi) * scale, std::sin(phi) * std::sin(theta) * scale);
+        }
+    }
+
+    std::vector<unsigned short> indices;
+    for (unsigned int j = 0; j < stacks; ++j)
+    {
+        for (unsigned int i = 0; i < slices; ++i)
+        {
+            unsigned short i00 = static_cast<unsigned short>(j * slices + i);
+            unsigned short i01 = static_cast<unsigned short>(j * slices + (i + 1) % slices);
+            unsigned short i10 = static_cast<unsigned short>((j + 1) * slices + i);
+            unsigned short i11 = static_cast<unsigned short>((j + 1) * slices + (i + 1) % slices);
+
+            // Skip the degenerate triangles at the poles
+            if (j > 0)
+                AddVolumeTriangle(indices, vertices, i00, i01, i10, glm::vec3(0.0f));
+            if (j < stacks - 1)
+                AddVolumeTriangle(indices, vertices, i01, i11, i10, glm::vec3(0.0f));
+        }
+    }
+
     VertexFormat vertexFormat;
     vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Position);
+    mesh.AddSubmesh<glm::vec3, unsigned short, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles, vertices, indices,
+        vertexFormat.LayoutBegin(static_cast<int>(vertices.size()), false), vertexFormat.LayoutEnd());
+}
+
+void DeferredRenderPass::CreateConeMesh(Mesh& mesh, unsigned int segments)
+{
+    // Apex in the origin and base of radius 1 in Z = 1. Base is pushed out to contain the round cone
+    float scale = 1.0f / std::cos(glm::pi<float>() / segments);
 
-    // Large triangle covering the entire screen
-    std::vector<glm::vec3> fullscreenVertices;
-    fullscreenVertices.emplace_back(-1.0f, -1.0f, 0.0f);
-    fullscreenVertices.emplace_back( 3.0f, -1.0f, 0.0f);
-    fullscreenVertices.emplace_back(-1.0f,  3.0f, 0.0f);
-    m_fullscreenMesh.AddSubmesh<glm::vec3, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles, fullscreenVertices, vertexFormat.LayoutBegin(3, false), vertexFormat.LayoutEnd());
+    std::vector<glm::vec3> vertices;
+    vertices.emplace_back(0.0f, 0.0f, 0.0f);
+    vertices.emplace_back(0.0f, 0.0f, 1.0f);
+    for (unsigned int i = 0; i < segments; ++i)
+    {
+        float theta = glm::two_pi<float>() * i / segments;
+        vertices.emplace_back(std::cos(theta) * scale, std::sin(theta) * scale, 1.0f);
+    }
+
+    glm::vec3 innerPoint(0.0f, 0.0f, 0.5f);
+    std::vector<unsigned short> indices;
+    for (unsigned int i = 0; i < segments; ++i)
+    {
+        unsigned short i0 = static_cast<unsigned short>(2 + i);
+        unsigned short i1 = static_cast<unsigned short>(2 + (i + 1) % segments);
+        AddVolumeTriangle(indices, vertices, 0, i0, i1, innerPoint);
+        AddVolumeTriangle(indices, vertices, 1, i0, i1, innerPoint);
+    }
+
+    VertexFormat vertexFormat;
+    vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Position);
+    mesh.AddSubmesh<glm::vec3, unsigned short, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles, vertices, indices,
+        vertexFormat.LayoutBegin(static_cast<int>(vertices.size()), false), vertexFormat.LayoutEnd());
 }
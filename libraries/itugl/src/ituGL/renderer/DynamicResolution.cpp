@@ -0,0 +1,100 @@
+#include <ituGL/renderer/DynamicResolution.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+DynamicResolution::DynamicResolution(float targetFrameTime, float minScale, float maxScale)
+    : m_queryIndex(0)
+    , m_queryActive(false)
+    , m_enabled(true)
+    , m_targetFrameTime(targetFrameTime)
+    , m_minScale(minScale)
+    , m_maxScale(maxScale)
+    , m_scale(maxScale)
+    , m_gpuFrameTime(0.0f)
+{
+    assert(minScale > 0.0f && minScale <= maxScale && maxScale <= 1.0f);
+    m_queryPending.fill(false);
+}
+
+void DynamicResolution::SetScaleRange(float minScale, float maxScale)
+{
+    assert(minScale > 0.0f && minScale <= maxScale && maxScale <= 1.0f);
+    m_minScale = minScale;
+    m_maxScale = maxScale;
+    m_scale = std::clamp(m_scale, minScale, maxScale);
+}
+
+void DynamicResolution::BeginFrame()
+{
+    // If the oldest query is still pending, the GPU is too far behind. Skip the measure instead of waiting
+    if (m_queryPending[m_queryIndex])
+    {
+        if (!m_queries[m_queryIndex].IsResultAvailable())
+        {
+            return;
+        }
+        m_queryPending[m_queryIndex] = false;
+    }
+
+    m_queries[m_queryIndex].Begin(QueryObject::TimeElapsed);
+    m_queryPending[m_queryIndex] = true;
+    m_queryActive = true;
+}
+
+void DynamicResolution::EndFrame()
+{
+    if (m_queryActive)
+    {
+        m_queries[m_queryIndex].End();
+        m_queryIndex = (m_queryIndex + 1) % s_queryCount;
+        m_queryActive = false;
+    }
+
+    // Read the most recent result available, starting from the oldest query
+    bool hasResult = false;
+    GLuint64 elapsed = 0;
+    for (int i = 0; i < s_queryCount; ++i)
+    {
+        int index = (m_queryIndex + i) % s_queryCount;
+        if (m_queryPending[index] && m_queries[index].IsResultAvailable())
+        {
+            elapsed = m_queries[index].GetResult();
+            m_queryPending[index] = false;
+            hasResult = true;
+        }
+    }
+
+    if (hasResult)
+    {
+        m_gpuFrameTime = static_cast<float>(elapsed) * 1e-6f;
+        UpdateScale(m_gpuFrameTime);
+    }
+}
+
+void DynamicResolution::UpdateScale(float gpuFrameTime)
+{
+    if (gpuFrameTime <= 0.0f)
+    {
+        return;
+    }
+
+    // GPU time is mostly proportional to the number of pixels, the square of the scale
+    float targetScale = m_scale * std::sqrt(m_targetFrameTime / gpuFrameTime);
+    targetScale = std::clamp(targetScale, m_minScale, m_maxScale);
+
+    // React fast when over budget, and recover slowly to avoid oscillations
+    float speed = targetScale < m_scale ? 0.5f : 0.05f;
+    float scale = m_scale + (targetScale - m_scale) * speed;
+
+    // Ignore small changes, they are not noticeable and move the sampling pattern
+    if (std::abs(scale - m_scale) > 0.01f)
+    {
+        m_scale = scale;
+    }
+    else if (targetScale == m_minScale || targetScale == m_maxScale)
+    {
+        m_scale = targetScale;
+    }
+}
@@ -23,9 +23,16 @@ void ForwardRenderPass::Render()
     const auto& lights = renderer.GetLights();
     const auto& drawcallCollection = renderer.GetDrawcalls(m_drawcallCollectionIndex);
 
-    // for all drawcalls
-    for (const Renderer::DrawcallInfo& drawcallInfo : drawcallCollection)
+    // for all batches of drawcalls
+    std::span<const Renderer::DrawcallInfo> drawcalls = drawcallCollection;
+    while (!drawcalls.empty())
     {
+        std::span<const Renderer::DrawcallInfo> batch = renderer.GetBatch(drawcalls);
+        drawcalls = drawcalls.subspan(batch.size());
+
+        // The drawcalls of the batch share the material and the world matrix
+        const Renderer::DrawcallInfo& drawcallInfo = batch[0];
+
         // (todo) 07.0: Prepare drawcall states
         renderer.PrepareDrawcall(drawcallInfo);
 
@@ -40,7 +47,7 @@ void ForwardRenderPass::Render()
             renderer.SetLightingRenderStates(first);
 
             // (todo) 07.0: Draw
-            drawcallInfo.drawcall.Draw();
+            renderer.DrawBatch(batch);
 
             first = false;
         }
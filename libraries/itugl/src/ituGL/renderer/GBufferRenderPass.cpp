@@ -5,8 +5,13 @@
 #include <ituGL/geometry/VertexArrayObject.h>
 #include <ituGL/renderer/Renderer.h>
 
-GBufferRenderPass::GBufferRenderPass(int width, int height, int drawcallCollectionIndex)
+GBufferRenderPass::GBufferRenderPass(int width, int height, Layout layout, int drawcallCollectionIndex)
     : m_drawcallCollectionIndex(drawcallCollectionIndex)
+    , m_layout(layout)
+    , m_width(0)
+    , m_height(0)
+    , m_depthPrePassEnabled(false)
+    , m_overdrawCountEnabled(false)
 {
     InitTextures(width, height);
     InitFramebuffer();
@@ -16,7 +21,8 @@ void GBufferRenderPass::InitFramebuffer()
 {
     m_framebuffer.Bind();
 
-    m_framebuffer.SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Depth, *m_depthTexture);
+    // Stencil is used to count overdraw
+    m_framebuffer.SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::DepthStencil, *m_depthTexture);
 
     // (todo) 07.2: Set the albedo texture as color attachment 0
     m_framebuffer.SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *m_albedoTexture);
@@ -25,15 +31,27 @@ void GBufferRenderPass::InitFramebuffer()
     m_framebuffer.SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color1, *m_normalTexture);
     
     // (todo) 07.5: Set the others texture as color attachment 2
-    m_framebuffer.SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color2, *m_specularTexture);
-
-    // (todo) 07.2: Set the draw buffers used by the framebuffer (all attachments except depth)
-    m_framebuffer.SetDrawBuffers(std::array<FramebufferObject::Attachment, 3>(
-        {
-            FramebufferObject::Attachment::Color0,
-            FramebufferObject::Attachment::Color1,
-            FramebufferObject::Attachment::Color2
-        }));
+    if (m_specularTexture)
+    {
+        m_framebuffer.SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color2, *m_specularTexture);
+
+        // (todo) 07.2: Set the draw buffers used by the framebuffer (all attachments except depth)
+        m_framebuffer.SetDrawBuffers(std::array<FramebufferObject::Attachment, 3>(
+            {
+                FramebufferObject::Attachment::Color0,
+                FramebufferObject::Attachment::Color1,
+                FramebufferObject::Attachment::Color2
+            }));
+    }
+    else
+    {
+        // Specular values are packed in the normal texture
+        m_framebuffer.SetDrawBuffers(std::array<FramebufferObject::Attachment, 2>(
+            {
+                FramebufferObject::Attachment::Color0,
+                FramebufferObject::Attachment::Color1
+            }));
+    }
 
     FramebufferObject::Unbind();
 }
@@ -43,30 +61,71 @@ void GBufferRenderPass::InitTextures(int width, int height)
     // (todo) 07.4: Depth: Set the min and magfilter as nearest
     m_depthTexture = std::make_shared<Texture2DObject>();
     m_depthTexture->Bind();
-    m_depthTexture->SetImage(0, width, height, TextureObject::FormatDepth, TextureObject::InternalFormatDepth);
     m_depthTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
     m_depthTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
 
     // (todo) 07.2: Albedo: Bind the newly created texture, set the image, and the min and magfilter as nearest
     m_albedoTexture = std::make_shared<Texture2DObject>();
     m_albedoTexture->Bind();
-    m_albedoTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA8);
     m_albedoTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
     m_albedoTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
 
     // (todo) 07.3: Normal: Bind the newly created texture, set the image and the min and magfilter as nearest
     m_normalTexture = std::make_shared<Texture2DObject>();
     m_normalTexture->Bind();
-    m_normalTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16);
     m_normalTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
     m_normalTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
 
     // (todo) 07.5: Others: Bind the newly created texture, set the image and the min and magfilter as nearest
-    m_specularTexture = std::make_shared<Texture2DObject>();
-    m_specularTexture->Bind();
-    m_specularTexture->SetImage(0, width, height, TextureObject::FormatRGB, TextureObject::InternalFormatRGB8);
-    m_specularTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
-    m_specularTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+    if (m_layout != Layout::PackedNormal8)
+    {
+        m_specularTexture = std::make_shared<Texture2DObject>();
+        m_specularTexture->Bind();
+        m_specularTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
+        m_specularTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+    }
+
+    Resize(width, height);
+}
+
+void GBufferRenderPass::Resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+
+    // Same texture objects, so the framebuffer attachments and the materials using them stay valid
+    m_depthTexture->Bind();
+    m_depthTexture->SetImage(0, width, height, TextureObject::FormatDepthStencil, TextureObject::InternalFormatDepth24Stencil8);
+
+    m_albedoTexture->Bind();
+    m_albedoTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA8);
+
+    m_normalTexture->Bind();
+    switch (m_layout)
+    {
+    case Layout::PackedNormal16:
+        m_normalTexture->SetImage(0, width, height, TextureObject::FormatRG, TextureObject::InternalFormatRG16);
+        break;
+    case Layout::PackedNormal8:
+        m_normalTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA8);
+        break;
+    default:
+        m_normalTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA16);
+        break;
+    }
+
+    if (m_specularTexture)
+    {
+        m_specularTexture->Bind();
+        if (m_layout == Layout::PackedNormal16)
+        {
+            m_specularTexture->SetImage(0, width, height, TextureObject::FormatRG, TextureObject::InternalFormatRG8);
+        }
+        else
+        {
+            m_specularTexture->SetImage(0, width, height, TextureObject::FormatRGB, TextureObject::InternalFormatRGB8);
+        }
+    }
 
     Texture2DObject::Unbind();
 }
@@ -76,28 +135,95 @@ void GBufferRenderPass::Render()
     Renderer& renderer = GetRenderer();
 
     const Camera& camera = renderer.GetCurrentCamera();
-    const auto& lights = renderer.GetLights();
     const auto& drawcallCollection = renderer.GetDrawcalls(m_drawcallCollectionIndex);
+    DeviceGL& device = renderer.GetDevice();
 
     // Bind the framebuffer with the render targets
     m_framebuffer.Bind();
 
-    renderer.GetDevice().Clear(true, Color(0.0f, 0.0f, 0.0f, 0.0f), true, 1.0f);
+    // With dynamic resolution, only part of the render targets is used
+    renderer.SetRenderViewport(true);
+
+    device.Clear(true, Color(0.0f, 0.0f, 0.0f, 0.0f), true, 1.0f, true, 0);
 
-    // for all drawcalls
-    for (const Renderer::DrawcallInfo& drawcallInfo : drawcallCollection)
+    if (m_depthPrePassEnabled)
     {
+        RenderDepthPrePass();
+    }
+
+    // Count in the stencil the fragments that pass the depth test
+    device.SetFeatureEnabled(GL_STENCIL_TEST, m_overdrawCountEnabled);
+    glStencilFunc(GL_ALWAYS, 0, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+
+    // for all batches of drawcalls
+    std::span<const Renderer::DrawcallInfo> drawcalls = drawcallCollection;
+    while (!drawcalls.empty())
+    {
+        std::span<const Renderer::DrawcallInfo> batch = renderer.GetBatch(drawcalls);
+        drawcalls = drawcalls.subspan(batch.size());
+
+        // The drawcalls of the batch share the material and the world matrix
+        const Renderer::DrawcallInfo& drawcallInfo = batch[0];
+
         assert(drawcallInfo.material.GetBlendEquationColor() == Material::BlendEquation::None);
         assert(drawcallInfo.material.GetBlendEquationAlpha() == Material::BlendEquation::None);
         assert(drawcallInfo.material.GetDepthWrite());
 
+        int overrideFlags = m_overdrawCountEnabled ? Material::OverrideStencilTest : Material::NoOverride;
+
+        // Depth is already in the buffer, only the visible fragments are shaded
+        if (m_depthPrePassEnabled && drawcallInfo.material.HasDepthShader())
+        {
+            overrideFlags |= Material::OverrideDepthTest;
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(GL_FALSE);
+        }
+
         // Prepare drawcall (similar to forward)
-        renderer.PrepareDrawcall(drawcallInfo);
+        renderer.PrepareDrawcall(drawcallInfo, overrideFlags);
 
-        // Render drawcall
-        drawcallInfo.drawcall.Draw();
+        // Render all the drawcalls of the batch
+        renderer.DrawBatch(batch);
     }
 
+    // Restore default states
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    device.SetFeatureEnabled(GL_STENCIL_TEST, false);
+
     // Unbind the framebuffer
     FramebufferObject::Unbind();
 }
+
+void GBufferRenderPass::RenderDepthPrePass()
+{
+    Renderer& renderer = GetRenderer();
+
+    const glm::mat4& viewProjMatrix = renderer.GetCurrentCamera().GetViewProjectionMatrix();
+    const auto& drawcallCollection = renderer.GetDrawcalls(m_drawcallCollectionIndex);
+
+    // Only depth, with the position-only shaders of the materials
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+
+    std::span<const Renderer::DrawcallInfo> drawcalls = drawcallCollection;
+    while (!drawcalls.empty())
+    {
+        std::span<const Renderer::DrawcallInfo> batch = renderer.GetBatch(drawcalls);
+        drawcalls = drawcalls.subspan(batch.size());
+
+        const Renderer::DrawcallInfo& drawcallInfo = batch[0];
+        if (!drawcallInfo.material.HasDepthShader())
+            continue;
+
+        const glm::mat4& worldMatrix = renderer.GetWorldMatrix(drawcallInfo.worldMatrixIndex);
+        drawcallInfo.material.UseDepthShader(viewProjMatrix, worldMatrix);
+
+        drawcallInfo.vao.Bind();
+        renderer.DrawBatch(batch);
+    }
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
@@ -47,8 +47,13 @@ void LightRenderPass::Render()
 
 			device.Clear(false, Color(0.0f, 0.0f, 0.0f, 1.0f), true, 1.0f);
 
-			for (const auto& drawcallInfo : drawcallCollection)
+			std::span<const Renderer::DrawcallInfo> drawcalls = drawcallCollection;
+			while (!drawcalls.empty())
 			{
+				std::span<const Renderer::DrawcallInfo> batch = renderer.GetBatch(drawcalls);
+				drawcalls = drawcalls.subspan(batch.size());
+
+				const auto& drawcallInfo = batch[0];
 				if (!drawcallInfo.material.CastsShadows())
 					continue;
 
@@ -62,7 +67,7 @@ void LightRenderPass::Render()
 
 				drawcallInfo.vao.Bind();
 
-				drawcallInfo.drawcall.Draw();
+				renderer.DrawBatch(batch);
 			}
 		}
 	}
@@ -0,0 +1,66 @@
+#include <ituGL/renderer/OverdrawRenderPass.h>
+
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/geometry/Mesh.h>
+#include <ituGL/shader/Material.h>
+#include <ituGL/texture/FramebufferObject.h>
+#include <cassert>
+
+static constexpr ShaderProgram::NameHash s_overdrawCountName = ShaderProgram::HashName("OverdrawCount");
+static constexpr ShaderProgram::NameHash s_maxOverdrawCountName = ShaderProgram::HashName("MaxOverdrawCount");
+
+OverdrawRenderPass::OverdrawRenderPass(std::shared_ptr<Material> material, const FramebufferObject& sourceFramebuffer,
+    std::shared_ptr<const FramebufferObject> targetFramebuffer, int maxOverdrawCount)
+    : RenderPass(targetFramebuffer)
+    , m_material(material)
+    , m_sourceFramebuffer(sourceFramebuffer)
+    , m_maxOverdrawCount(maxOverdrawCount)
+    , m_enabled(false)
+{
+    assert(m_material);
+    assert(maxOverdrawCount > 0 && maxOverdrawCount < 256);
+}
+
+void OverdrawRenderPass::Render()
+{
+    if (!m_enabled)
+        return;
+
+    Renderer& renderer = GetRenderer();
+    DeviceGL& device = renderer.GetDevice();
+
+    int width, height;
+    renderer.GetRenderDimensions(width, height);
+    assert(width > 0 && height > 0);
+
+    // Copy the counts to the stencil of the target, that is still bound for drawing
+    m_sourceFramebuffer.Bind(FramebufferObject::Target::Read);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_STENCIL_BUFFER_BIT, GL_NEAREST);
+
+    renderer.SetRenderViewport(true);
+
+    m_material->Use();
+    std::shared_ptr<const ShaderProgram> shaderProgram = m_material->GetShaderProgram();
+    // Locations can change if the program is rebuilt
+    ShaderProgram::Location overdrawCountLocation = m_material->GetUniformLocation(s_overdrawCountName);
+    shaderProgram->SetUniform(m_material->GetUniformLocation(s_maxOverdrawCountName), m_maxOverdrawCount);
+
+    device.SetFeatureEnabled(GL_BLEND, false);
+    glDepthFunc(GL_ALWAYS);
+    glDepthMask(GL_FALSE);
+    device.SetFeatureEnabled(GL_STENCIL_TEST, true);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+
+    // One fullscreen draw per count, only on the pixels with that count
+    for (int count = 0; count <= m_maxOverdrawCount; ++count)
+    {
+        // Pass if count <= stencil, for the last one
+        glStencilFunc(count < m_maxOverdrawCount ? GL_EQUAL : GL_LEQUAL, count, 0xFF);
+        shaderProgram->SetUniform(overdrawCountLocation, count);
+        renderer.GetFullscreenMesh().DrawSubmesh(0);
+    }
+
+    device.SetFeatureEnabled(GL_STENCIL_TEST, false);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+}
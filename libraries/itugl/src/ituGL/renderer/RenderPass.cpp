@@ -3,7 +3,8 @@
 #include <ituGL/renderer/Renderer.h>
 #include <cassert>
 
-RenderPass::RenderPass() : m_renderer(nullptr)
+RenderPass::RenderPass(std::shared_ptr<const FramebufferObject> targetFramebuffer)
+    : m_renderer(nullptr), m_targetFramebuffer(targetFramebuffer)
 {
 }
 
@@ -6,11 +6,16 @@
 #include <ituGL/geometry/Mesh.h>
 #include <ituGL/geometry/Model.h>
 #include <ituGL/renderer/RenderPass.h>
+#include <ituGL/geometry/VertexFormat.h>
+#include <ituGL/core/StreamingBuffer.h>
+#include <ituGL/texture/FramebufferObject.h>
 #include <span>
 #include <algorithm>
 #include <cassert>
 
 Renderer::Renderer(DeviceGL& device) : m_device(device), m_currentCamera(nullptr), m_drawcallCollections(1)
+    , m_renderWidth(0), m_renderHeight(0), m_renderScale(1.0f), m_batchingEnabled(true)
+    , m_batchCount(0), m_batchedDrawcallCount(0), m_lastBatchCount(0), m_lastBatchedDrawcallCount(0)
 {
 }
 
@@ -30,12 +35,102 @@ void Renderer::Render()
 
     for (auto& pass : m_passes)
     {
+        std::shared_ptr<const FramebufferObject> targetFramebuffer = pass->GetTargetFramebuffer();
+        if (targetFramebuffer)
+        {
+            targetFramebuffer->Bind();
+        }
+        else
+        {
+            FramebufferObject::Unbind();
+        }
+
         pass->Render();
     }
 
+    m_lastBatchCount = m_batchCount;
+    m_lastBatchedDrawcallCount = m_batchedDrawcallCount;
+
+    // The commands written this frame stay untouched until the GPU is done with them
+    if (m_indirectBuffer)
+    {
+        m_indirectBuffer->EndFrame();
+    }
+
     Reset();
 }
 
+void Renderer::GetRenderDimensions(int& width, int& height) const
+{
+    width = m_renderWidth;
+    height = m_renderHeight;
+}
+
+void Renderer::SetRenderDimensions(int width, int height)
+{
+    m_renderWidth = width;
+    m_renderHeight = height;
+}
+
+void Renderer::SetRenderScale(float renderScale)
+{
+    assert(renderScale > 0.0f && renderScale <= 1.0f);
+    m_renderScale = renderScale;
+}
+
+void Renderer::GetScaledRenderDimensions(int& width, int& height) const
+{
+    width = std::max(1, static_cast<int>(m_renderWidth * m_renderScale + 0.5f));
+    height = std::max(1, static_cast<int>(m_renderHeight * m_renderScale + 0.5f));
+}
+
+glm::vec2 Renderer::GetScaledRenderRatio() const
+{
+    if (m_renderWidth <= 0 || m_renderHeight <= 0)
+    {
+        return glm::vec2(1.0f);
+    }
+
+    int width, height;
+    GetScaledRenderDimensions(width, height);
+    return glm::vec2(width, height) / glm::vec2(m_renderWidth, m_renderHeight);
+}
+
+void Renderer::SetRenderViewport(bool scaled)
+{
+    if (m_renderWidth <= 0 || m_renderHeight <= 0)
+    {
+        return;
+    }
+
+    int width = m_renderWidth, height = m_renderHeight;
+    if (scaled)
+    {
+        GetScaledRenderDimensions(width, height);
+    }
+    m_device.SetViewport(0, 0, width, height);
+}
+
+const Mesh& Renderer::GetFullscreenMesh()
+{
+    if (!m_fullscreenMesh)
+    {
+        VertexFormat vertexFormat;
+        vertexFormat.AddVertexAttribute<float>(3, VertexAttribute::Semantic::Position);
+
+        // Large triangle covering the entire screen
+        std::vector<glm::vec3> vertices;
+        vertices.emplace_back(-1.0f, -1.0f, 0.0f);
+        vertices.emplace_back( 3.0f, -1.0f, 0.0f);
+        vertices.emplace_back(-1.0f,  3.0f, 0.0f);
+
+        m_fullscreenMesh = std::make_shared<Mesh>();
+        m_fullscreenMesh->AddSubmesh<glm::vec3, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles, vertices,
+            vertexFormat.LayoutBegin(3, false), vertexFormat.LayoutEnd());
+    }
+    return *m_fullscreenMesh;
+}
+
 const glm::mat4& Renderer::GetWorldMatrix(int worldMatrixIndex) const
 {
     return m_worldMatrices[worldMatrixIndex];
@@ -51,6 +146,9 @@ void Renderer::Reset()
     }
 
     m_currentCamera = nullptr;
+
+    m_batchCount = 0;
+    m_batchedDrawcallCount = 0;
 }
 
 int Renderer::AddRenderPass(std::unique_ptr<RenderPass> renderPass)
@@ -137,14 +235,14 @@ void Renderer::AddModel(const Model& model, const glm::mat4& worldMatrix)
     }
 }
 
-void Renderer::PrepareDrawcall(const DrawcallInfo& drawcallInfo)
+void Renderer::PrepareDrawcall(const DrawcallInfo& drawcallInfo, int overrideFlags)
 {
     std::shared_ptr<const ShaderProgram> shaderProgram = drawcallInfo.material.GetShaderProgram();
 
     // TODO: Room for optimization here, caching current material, current worldMatrixIndex and current VAO
 
     // Setup material
-    drawcallInfo.material.Use();
+    drawcallInfo.material.Use(static_cast<Material::OverrideFlags>(overrideFlags));
 
     // Setup world matrix
     // Setup camera
@@ -154,6 +252,101 @@ void Renderer::PrepareDrawcall(const DrawcallInfo& drawcallInfo)
     drawcallInfo.vao.Bind();
 }
 
+std::span<const Renderer::DrawcallInfo> Renderer::GetBatch(std::span<const DrawcallInfo> drawcalls) const
+{
+    assert(!drawcalls.empty());
+    const DrawcallInfo& first = drawcalls[0];
+
+    // Without elements or with instancing, they are drawn one by one
+    if (!m_batchingEnabled || first.drawcall.GetEboType() == Data::Type::None || first.drawcall.GetInstancing().Instanced())
+    {
+        return drawcalls.first(1);
+    }
+
+    // The world matrix is set once per batch, as the shaders have no way to fetch a different one per draw
+    size_t batchSize = 1;
+    for (; batchSize < drawcalls.size(); ++batchSize)
+    {
+        const DrawcallInfo& drawcallInfo = drawcalls[batchSize];
+        if (&drawcallInfo.material != &first.material
+            || drawcallInfo.worldMatrixIndex != first.worldMatrixIndex
+            || &drawcallInfo.vao != &first.vao
+            || drawcallInfo.drawcall.GetPrimitive() != first.drawcall.GetPrimitive()
+            || drawcallInfo.drawcall.GetEboType() != first.drawcall.GetEboType()
+            || drawcallInfo.drawcall.GetInstancing().Instanced())
+        {
+            break;
+        }
+    }
+    return drawcalls.first(batchSize);
+}
+
+void Renderer::DrawBatch(std::span<const DrawcallInfo> batch)
+{
+    assert(!batch.empty());
+    assert(VertexArrayObject::IsAnyBound());
+
+    ++m_batchCount;
+    m_batchedDrawcallCount += static_cast<unsigned int>(batch.size());
+
+    const Drawcall& firstDrawcall = batch[0].drawcall;
+    if (batch.size() == 1)
+    {
+        firstDrawcall.Draw();
+        return;
+    }
+
+    GLenum primitive = static_cast<GLenum>(firstDrawcall.GetPrimitive());
+    GLenum eboType = static_cast<GLenum>(firstDrawcall.GetEboType());
+    GLsizei drawCount = static_cast<GLsizei>(batch.size());
+
+    size_t commandsOffset = 0;
+    if (m_device.IsMultiDrawIndirectSupported() && WriteIndirectCommands(batch, commandsOffset))
+    {
+        // Offset of the commands in the bound indirect buffer
+        const char* basePointer = nullptr;
+        m_indirectBuffer->Bind();
+        glMultiDrawElementsIndirect(primitive, eboType, basePointer + commandsOffset, drawCount, 0);
+        m_indirectBuffer->Unbind();
+    }
+    else
+    {
+        m_batchCounts.clear();
+        m_batchIndices.clear();
+        m_batchBaseVertices.clear();
+        for (const DrawcallInfo& drawcallInfo : batch)
+        {
+            const char* basePointer = nullptr; // Actual element pointer is in VAO
+            m_batchCounts.push_back(drawcallInfo.drawcall.GetCount());
+            m_batchIndices.push_back(basePointer + drawcallInfo.drawcall.GetFirst());
+            m_batchBaseVertices.push_back(drawcallInfo.drawcall.GetBaseVertex());
+        }
+        glMultiDrawElementsBaseVertex(primitive, m_batchCounts.data(), eboType, m_batchIndices.data(), drawCount, m_batchBaseVertices.data());
+    }
+}
+
+bool Renderer::WriteIndirectCommands(std::span<const DrawcallInfo> batch, size_t& offset)
+{
+    if (!m_indirectBuffer)
+    {
+        // Room for a few thousand commands per frame, the batches that don't fit are drawn without them
+        m_indirectBuffer = std::make_shared<StreamingBuffer>(BufferObject::DrawIndirectBuffer, 64 * 1024);
+    }
+
+    m_indirectCommands.clear();
+    for (const DrawcallInfo& drawcallInfo : batch)
+    {
+        m_indirectCommands.push_back(drawcallInfo.drawcall.GetIndirectCommand());
+    }
+
+    if (!m_indirectBuffer->Write(std::span<const Drawcall::IndirectCommand>(m_indirectCommands), offset))
+    {
+        return false;
+    }
+    m_indirectBuffer->Flush();
+    return true;
+}
+
 void Renderer::SetLightingRenderStates(bool firstPass)
 {
     // Set the render states for the first and additional lights
@@ -0,0 +1,37 @@
+#include <ituGL/renderer/UpscaleRenderPass.h>
+
+#include <ituGL/renderer/Renderer.h>
+#include <ituGL/geometry/Mesh.h>
+#include <ituGL/shader/Material.h>
+#include <cassert>
+
+static constexpr ShaderProgram::NameHash s_renderScaleName = ShaderProgram::HashName("RenderScale");
+
+UpscaleRenderPass::UpscaleRenderPass(std::shared_ptr<Material> material, std::shared_ptr<const FramebufferObject> targetFramebuffer)
+    : RenderPass(targetFramebuffer)
+    , m_material(material)
+{
+    assert(m_material);
+}
+
+void UpscaleRenderPass::Render()
+{
+    Renderer& renderer = GetRenderer();
+
+    // Output covers the full render dimensions
+    renderer.SetRenderViewport(false);
+
+    m_material->Use();
+    std::shared_ptr<const ShaderProgram> shaderProgram = m_material->GetShaderProgram();
+    // Found on each render, so that it stays valid if the program is rebuilt
+    shaderProgram->SetUniform(m_material->GetUniformLocation(s_renderScaleName), renderer.GetScaledRenderRatio());
+
+    // No depth needed, the result replaces the content of the target
+    glDepthFunc(GL_ALWAYS);
+    glDepthMask(GL_FALSE);
+
+    renderer.GetFullscreenMesh().DrawSubmesh(0);
+
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+}
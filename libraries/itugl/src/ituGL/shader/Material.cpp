@@ -190,6 +190,24 @@ bool Material::CastsShadows() const
     return m_shadowShaderSetupFunction != nullptr;
 }
 
+void Material::SetDepthShader(
+    std::shared_ptr<ShaderProgram> depthShaderProgram, DepthShaderSetupFunction setupFunction)
+{
+    m_depthShaderProgram = depthShaderProgram;
+    m_depthShaderSetupFunction = setupFunction;
+}
+
+void Material::UseDepthShader(const glm::mat4& viewProjMatrix, const glm::mat4& worldMatrix) const
+{
+    m_depthShaderProgram->Use();
+    m_depthShaderSetupFunction(*m_depthShaderProgram, viewProjMatrix, worldMatrix);
+}
+
+bool Material::HasDepthShader() const
+{
+    return m_depthShaderSetupFunction != nullptr;
+}
+
 void Material::Use(OverrideFlags overrideFlags) const
 {
     assert(m_shaderProgram);
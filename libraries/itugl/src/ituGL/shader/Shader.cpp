@@ -1,5 +1,6 @@
 #include <ituGL/shader/Shader.h>
 
+#include <ituGL/core/DeviceGL.h>
 #include <cassert>
 
 Shader::Shader(Type type) : Object(NullHandle)
@@ -55,11 +56,31 @@ void Shader::SetSource(std::span<const char*> source)
 
 // Compile the shader source code
 bool Shader::Compile()
+{
+    SubmitCompile();
+    return IsCompiled();
+}
+
+// Start compiling the shader source code, without checking the result
+void Shader::SubmitCompile()
 {
     assert(IsValid());
 
     glCompileShader(GetHandle());
-    return IsCompiled();
+}
+
+// Check if the compilation has finished, without waiting for it
+bool Shader::IsCompileComplete() const
+{
+    assert(IsValid());
+
+    GLint complete = GL_TRUE;
+    const DeviceGL* device = DeviceGL::GetInstancePointer();
+    if (device && device->IsParallelShaderCompileSupported())
+    {
+        glGetShaderiv(GetHandle(), GL_COMPLETION_STATUS_KHR, &complete);
+    }
+    return complete;
 }
 
 // Check if the shader has been successfully compiled
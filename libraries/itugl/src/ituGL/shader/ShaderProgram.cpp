@@ -1,14 +1,19 @@
 #include <ituGL/shader/ShaderProgram.h>
 
 #include <ituGL/shader/Shader.h>
+#include <ituGL/core/DeviceGL.h>
 #include <ituGL/texture/TextureObject.h>
+#include <ituGL/texture/SamplerObject.h>
+#include <algorithm>
+#include <cstring>
+#include <array>
 #include <cassert>
 
 #ifndef NDEBUG
 ShaderProgram::Handle ShaderProgram::s_usedHandle = ShaderProgram::NullHandle;
 #endif
 
-ShaderProgram::ShaderProgram() : Object(NullHandle)
+ShaderProgram::ShaderProgram() : Object(NullHandle), m_uniformsReflected(false)
 {
     Handle& handle = GetHandle();
     handle = glCreateProgram();
@@ -25,12 +30,29 @@ ShaderProgram::~ShaderProgram()
 }
 
 ShaderProgram::ShaderProgram(ShaderProgram&& shaderProgram) noexcept : Object(std::move(shaderProgram))
+    , m_uniforms(std::move(shaderProgram.m_uniforms))
+    , m_uniformsReflected(shaderProgram.m_uniformsReflected)
 {
+    shaderProgram.m_uniformsReflected = false;
 }
 
 ShaderProgram& ShaderProgram::operator = (ShaderProgram&& shaderProgram) noexcept
 {
-    Object::operator=(std::move(shaderProgram));
+    // Not using Object::operator=, that destroys the members of this class too
+    if (this != &shaderProgram)
+    {
+        Handle& handle = GetHandle();
+        if (handle != NullHandle)
+        {
+            glDeleteProgram(handle);
+        }
+        handle = shaderProgram.GetHandle();
+        shaderProgram.GetHandle() = NullHandle;
+
+        m_uniforms = std::move(shaderProgram.m_uniforms);
+        m_uniformsReflected = shaderProgram.m_uniformsReflected;
+        shaderProgram.m_uniformsReflected = false;
+    }
     return *this;
 }
 
@@ -53,6 +75,39 @@ bool ShaderProgram::Build(const Shader& computeShader)
 bool ShaderProgram::Build(const Shader& vertexShader, const Shader& fragmentShader,
     const Shader* tesselationControlShader, const Shader* tesselationEvaluationShader,
     const Shader* geometryShader)
+{
+    AttachShaders(vertexShader, fragmentShader, tesselationControlShader, tesselationEvaluationShader, geometryShader);
+    return Link();
+}
+
+// Attach and link vertex and fragment shaders, without checking the result
+void ShaderProgram::SubmitBuild(const Shader& vertexShader, const Shader& fragmentShader)
+{
+    AttachShaders(vertexShader, fragmentShader, nullptr, nullptr, nullptr);
+
+    assert(IsValid());
+    glLinkProgram(GetHandle());
+    m_uniformsReflected = false;
+}
+
+// Check if the linking has finished, without waiting for it
+bool ShaderProgram::IsLinkComplete() const
+{
+    assert(IsValid());
+
+    GLint complete = GL_TRUE;
+    const DeviceGL* device = DeviceGL::GetInstancePointer();
+    if (device && device->IsParallelShaderCompileSupported())
+    {
+        glGetProgramiv(GetHandle(), GL_COMPLETION_STATUS_KHR, &complete);
+    }
+    return complete;
+}
+
+// Attach all shaders provided for the rasterization pipeline
+void ShaderProgram::AttachShaders(const Shader& vertexShader, const Shader& fragmentShader,
+    const Shader* tesselationControlShader, const Shader* tesselationEvaluationShader,
+    const Shader* geometryShader)
 {
     assert(vertexShader.IsType(Shader::VertexShader));
     AttachShader(vertexShader);
@@ -78,8 +133,6 @@ bool ShaderProgram::Build(const Shader& vertexShader, const Shader& fragmentShad
         assert(geometryShader->IsType(Shader::GeometryShader));
         AttachShader(*geometryShader);
     }
-
-    return Link();
 }
 
 // Attach a shader to be linked
@@ -88,7 +141,7 @@ void ShaderProgram::AttachShader(const Shader& shader)
     assert(IsValid());
     assert(!IsLinked());
     assert(shader.IsValid());
-    assert(shader.IsCompiled());
+    // Compile status is not checked, it would wait for shaders compiling in the background
     glAttachShader(GetHandle(), shader.GetHandle());
 }
 
@@ -97,6 +150,7 @@ bool ShaderProgram::Link()
 {
     assert(IsValid());
     glLinkProgram(GetHandle());
+    m_uniformsReflected = false;
     return IsLinked();
 }
 
@@ -110,6 +164,52 @@ bool ShaderProgram::IsLinked() const
     return success;
 }
 
+// Allow getting the binary of the program once it is linked. Must be set before Build
+void ShaderProgram::SetBinaryRetrievable(bool retrievable)
+{
+    assert(IsValid());
+    glProgramParameteri(GetHandle(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, retrievable ? GL_TRUE : GL_FALSE);
+}
+
+// Get the binary of a linked program. The format is specific to the driver
+bool ShaderProgram::GetBinary(GLenum& format, std::vector<char>& binary) const
+{
+    assert(IsValid());
+    assert(IsLinked());
+
+    GLint length = 0;
+    glGetProgramiv(GetHandle(), GL_PROGRAM_BINARY_LENGTH, &length);
+    binary.resize(length);
+    if (length > 0)
+    {
+        glGetProgramBinary(GetHandle(), length, &length, &format, binary.data());
+        binary.resize(length);
+    }
+    return length > 0;
+}
+
+// Get the size of the binary without waiting for a pending link
+size_t ShaderProgram::GetBinarySize() const
+{
+    assert(IsValid());
+
+    GLint length = 0;
+    if (IsLinkComplete() && IsLinked())
+    {
+        glGetProgramiv(GetHandle(), GL_PROGRAM_BINARY_LENGTH, &length);
+    }
+    return static_cast<size_t>(length);
+}
+
+// Link the program from a binary returned by GetBinary, instead of building it from shaders
+bool ShaderProgram::LoadBinary(GLenum format, std::span<const char> binary)
+{
+    assert(IsValid());
+    glProgramBinary(GetHandle(), format, binary.data(), static_cast<GLsizei>(binary.size()));
+    m_uniformsReflected = false;
+    return IsLinked();
+}
+
 // Get a string with linking error messages
 // The max length of the string returned is determined by the capacity of the span
 void ShaderProgram::GetLinkingErrors(std::span<char> errors) const
@@ -141,9 +241,74 @@ ShaderProgram::Location ShaderProgram::GetAttributeLocation(const char* name) co
 // Find a uniform location by name
 ShaderProgram::Location ShaderProgram::GetUniformLocation(const char* name) const
 {
+    const UniformInfo* uniform = FindUniform(HashUniformName(name));
+    if (uniform)
+    {
+        return uniform->location;
+    }
+
+    // Array elements other than the first are not in the table
+    return std::strchr(name, '[') ? glGetUniformLocation(GetHandle(), name) : -1;
+}
+
+// Find a uniform location by the hash of its name. -1 if the uniform doesn't exist
+ShaderProgram::Location ShaderProgram::GetUniformLocation(NameHash nameHash) const
+{
+    const UniformInfo* uniform = FindUniform(nameHash);
+    return uniform ? uniform->location : -1;
+}
+
+// Find a uniform by the hash of its name. Null if the uniform doesn't exist
+const ShaderProgram::UniformInfo* ShaderProgram::FindUniform(NameHash nameHash) const
+{
+    ReflectUniforms();
+    auto itUniform = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), nameHash,
+        [](const UniformInfo& uniform, NameHash nameHash) { return uniform.nameHash < nameHash; });
+    return itUniform != m_uniforms.end() && itUniform->nameHash == nameHash ? &*itUniform : nullptr;
+}
+
+// Get all the uniforms, sorted by name hash
+std::span<const ShaderProgram::UniformInfo> ShaderProgram::GetUniforms() const
+{
+    ReflectUniforms();
+    return m_uniforms;
+}
+
+// Build the table of uniforms, if it is not built yet for the current link
+void ShaderProgram::ReflectUniforms() const
+{
+    if (m_uniformsReflected)
+        return;
+
     assert(IsValid());
     assert(IsLinked());
-    return glGetUniformLocation(GetHandle(), name);
+    m_uniformsReflected = true;
+
+    unsigned int uniformCount = GetUniformCount();
+    m_uniforms.clear();
+    m_uniforms.reserve(uniformCount);
+    for (unsigned int i = 0; i < uniformCount; ++i)
+    {
+        std::array<char, 256> name;
+        UniformInfo uniform;
+        GetUniformInfo(i, uniform.size, uniform.type, name);
+
+        GLuint index = i;
+        glGetActiveUniformsiv(GetHandle(), 1, &index, GL_UNIFORM_OFFSET, &uniform.offset);
+
+        // Members of uniform blocks don't have a location
+        uniform.location = glGetUniformLocation(GetHandle(), name.data());
+
+        uniform.nameHash = HashUniformName(name.data());
+        m_uniforms.push_back(uniform);
+    }
+
+    std::sort(m_uniforms.begin(), m_uniforms.end(),
+        [](const UniformInfo& a, const UniformInfo& b) { return a.nameHash < b.nameHash; });
+
+    // Names in a program are few, a collision would need a different hash function
+    assert(std::adjacent_find(m_uniforms.begin(), m_uniforms.end(),
+        [](const UniformInfo& a, const UniformInfo& b) { return a.nameHash == b.nameHash; }) == m_uniforms.end());
 }
 
 // Get how many uniforms exist in this shader program
@@ -399,5 +564,16 @@ void ShaderProgram::SetTexture(Location location, GLint textureUnit, const Textu
     assert(IsUsed());
     TextureObject::SetActiveTexture(textureUnit);
     texture.Bind();
+
+    // The unit keeps the last sampler bound, so it is unbound for textures that use their own parameters
+    if (const std::shared_ptr<const SamplerObject>& sampler = texture.GetSampler())
+    {
+        sampler->Bind(static_cast<GLuint>(textureUnit));
+    }
+    else
+    {
+        SamplerObject::Unbind(static_cast<GLuint>(textureUnit));
+    }
+
     SetUniform(location, textureUnit);
 }
@@ -1,5 +1,6 @@
 #include <ituGL/shader/ShaderUniformCollection.h>
 #include <cassert>
+#include <algorithm>
 #include <array>
 
 ShaderUniformCollection::ShaderUniformCollection() : m_shaderProgram(nullptr)
@@ -21,11 +22,67 @@ std::shared_ptr<const ShaderProgram> ShaderUniformCollection::GetShaderProgram()
     return m_shaderProgram;
 }
 
+template<typename T>
+static void CopyDataValues(std::vector<T>& values, int index, const std::vector<T>& previousValues, int previousIndex, int size)
+{
+    std::copy_n(previousValues.begin() + previousIndex, size, values.begin() + index);
+}
+
 void ShaderUniformCollection::ChangeShader(std::shared_ptr<ShaderProgram> shaderProgram, const NameSet& filteredUniforms)
 {
+    std::vector<DataUniform> previousDataUniforms = std::move(m_dataUniforms);
+    std::vector<TextureUniform> previousTextureUniforms = std::move(m_textureUniforms);
+    std::vector<int> previousIntDataValues = std::move(m_intDataValues);
+    std::vector<unsigned int> previousUIntDataValues = std::move(m_uintDataValues);
+    std::vector<float> previousFloatDataValues = std::move(m_floatDataValues);
+    std::vector<double> previousDoubleDataValues = std::move(m_doubleDataValues);
+
     Reset();
     m_shaderProgram = shaderProgram;
     ExtractUniforms(filteredUniforms);
+
+    // Copy the previous values. Arrays that changed size keep the common elements
+    for (const DataUniform& previousUniform : previousDataUniforms)
+    {
+        auto itUniform = std::find_if(m_dataUniforms.begin(), m_dataUniforms.end(),
+            [&](const DataUniform& uniform) { return uniform.nameHash == previousUniform.nameHash; });
+        if (itUniform == m_dataUniforms.end() || itUniform->type != previousUniform.type || itUniform->dimension != previousUniform.dimension)
+            continue;
+
+        int size = std::min(GetDataUniformSize(*itUniform), GetDataUniformSize(previousUniform));
+        switch (itUniform->type)
+        {
+        case Data::Type::Int:
+            CopyDataValues(m_intDataValues, itUniform->index, previousIntDataValues, previousUniform.index, size);
+            break;
+        case Data::Type::UInt:
+            CopyDataValues(m_uintDataValues, itUniform->index, previousUIntDataValues, previousUniform.index, size);
+            break;
+        case Data::Type::Float:
+            CopyDataValues(m_floatDataValues, itUniform->index, previousFloatDataValues, previousUniform.index, size);
+            break;
+        case Data::Type::Double:
+            CopyDataValues(m_doubleDataValues, itUniform->index, previousDoubleDataValues, previousUniform.index, size);
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (const TextureUniform& previousUniform : previousTextureUniforms)
+    {
+        auto itUniform = std::find_if(m_textureUniforms.begin(), m_textureUniforms.end(),
+            [&](const TextureUniform& uniform) { return uniform.nameHash == previousUniform.nameHash; });
+        if (itUniform != m_textureUniforms.end() && itUniform->target == previousUniform.target)
+        {
+            itUniform->texture = previousUniform.texture;
+        }
+    }
+}
+
+void ShaderUniformCollection::RefreshUniforms()
+{
+    ChangeShader(m_shaderProgram, m_filteredUniforms);
 }
 
 ShaderProgram::Location ShaderUniformCollection::GetAttributeLocation(const char* name) const
@@ -38,6 +95,11 @@ ShaderProgram::Location ShaderUniformCollection::GetUniformLocation(const char*
     return m_shaderProgram->GetUniformLocation(name);
 }
 
+ShaderProgram::Location ShaderUniformCollection::GetUniformLocation(ShaderProgram::NameHash nameHash) const
+{
+    return m_shaderProgram->GetUniformLocation(nameHash);
+}
+
 ShaderUniformCollection::DataUniform& ShaderUniformCollection::GetDataUniform(ShaderProgram::Location location)
 {
     return const_cast<DataUniform&>(const_cast<const ShaderUniformCollection*>(this)->GetDataUniform(location));
@@ -45,10 +107,10 @@ ShaderUniformCollection::DataUniform& ShaderUniformCollection::GetDataUniform(Sh
 
 const ShaderUniformCollection::DataUniform& ShaderUniformCollection::GetDataUniform(ShaderProgram::Location location) const
 {
-    int uniformIndex = m_locationDataIndex.at(location);
-    const DataUniform& uniform = m_dataUniforms[uniformIndex];
-    assert(uniform.location == location);
-    return uniform;
+    auto itUniform = std::lower_bound(m_dataUniforms.begin(), m_dataUniforms.end(), location,
+        [](const DataUniform& uniform, ShaderProgram::Location location) { return uniform.location < location; });
+    assert(itUniform != m_dataUniforms.end() && itUniform->location == location);
+    return *itUniform;
 }
 
 ShaderUniformCollection::TextureUniform& ShaderUniformCollection::GetTextureUniform(ShaderProgram::Location location)
@@ -58,10 +120,10 @@ ShaderUniformCollection::TextureUniform& ShaderUniformCollection::GetTextureUnif
 
 const ShaderUniformCollection::TextureUniform& ShaderUniformCollection::GetTextureUniform(ShaderProgram::Location location) const
 {
-    int uniformIndex = m_locationTextureIndex.at(location);
-    const TextureUniform& uniform = m_textureUniforms[uniformIndex];
-    assert(uniform.location == location);
-    return uniform;
+    auto itUniform = std::lower_bound(m_textureUniforms.begin(), m_textureUniforms.end(), location,
+        [](const TextureUniform& uniform, ShaderProgram::Location location) { return uniform.location < location; });
+    assert(itUniform != m_textureUniforms.end() && itUniform->location == location);
+    return *itUniform;
 }
 
 void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
@@ -70,43 +132,46 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
 
     ShaderProgram& shaderProgram = *m_shaderProgram;
 
-    unsigned int uniformCount = shaderProgram.GetUniformCount();
+    m_filteredUniforms = filteredUniforms;
 
-    // Loop over all the uniforms
-    for (unsigned int i = 0; i < uniformCount; ++i)
+    // Names are compared by hash, like in the table of the program
+    std::vector<ShaderProgram::NameHash> filteredHashes;
+    for (const std::string& name : filteredUniforms)
     {
-        // Get the information of uniform in position i
-        int size;
-        GLenum glType;
-        char uniformName[256];
-        shaderProgram.GetUniformInfo(i, size, glType, std::span(uniformName, sizeof(uniformName)));
+        filteredHashes.push_back(ShaderProgram::HashUniformName(name));
+    }
 
+    // Loop over all the uniforms, already reflected by the program
+    for (const ShaderProgram::UniformInfo& uniformInfo : shaderProgram.GetUniforms())
+    {
         // If the named is in the filtered list, skip
-        if (filteredUniforms.contains(uniformName))
+        if (std::find(filteredHashes.begin(), filteredHashes.end(), uniformInfo.nameHash) != filteredHashes.end())
             continue;
 
-        // Get the uniform location
-        ShaderProgram::Location location = GetUniformLocation(uniformName);
-        assert(location >= 0);
+        // Uniforms in blocks are not stored
+        if (uniformInfo.location < 0)
+            continue;
 
         Data::Type type;
         UniformDimension dimension;
         TextureObject::Target target;
-        if (IsDataUniform(glType, type, dimension))
+        if (IsDataUniform(uniformInfo.type, type, dimension))
         {
             // If it is a data property, store as data
             DataUniform uniform;
-            uniform.location = location;
+            uniform.nameHash = uniformInfo.nameHash;
+            uniform.location = uniformInfo.location;
             uniform.type = type;
             uniform.dimension = dimension;
-            uniform.count = size;
+            uniform.count = uniformInfo.size;
             AddUniform(uniform);
         }
-        else if (IsTextureUniform(glType, target))
+        else if (IsTextureUniform(uniformInfo.type, target))
         {
             // If it is a texture property, store as property
             TextureUniform uniform;
-            uniform.location = location;
+            uniform.nameHash = uniformInfo.nameHash;
+            uniform.location = uniformInfo.location;
             uniform.target = target;
             AddUniform(uniform);
         }
@@ -116,6 +181,12 @@ void ShaderUniformCollection::ExtractUniforms(const NameSet& filteredUniforms)
             assert(false);
         }
     }
+
+    // Sorted to find them by location with a binary search
+    std::sort(m_dataUniforms.begin(), m_dataUniforms.end(),
+        [](const DataUniform& a, const DataUniform& b) { return a.location < b.location; });
+    std::sort(m_textureUniforms.begin(), m_textureUniforms.end(),
+        [](const TextureUniform& a, const TextureUniform& b) { return a.location < b.location; });
 }
 
 bool ShaderUniformCollection::IsDataUniform(GLenum glType, Data::Type& type, UniformDimension& dimension)
@@ -233,6 +304,8 @@ bool ShaderUniformCollection::IsTextureUniform(GLenum glType, TextureObject::Tar
         target = TextureObject::Target::Texture1DArray;
         break;
     case GL_SAMPLER_2D:
+    case GL_INT_SAMPLER_2D:
+    case GL_UNSIGNED_INT_SAMPLER_2D:
         target = TextureObject::Target::Texture2D;
         break;
     case GL_SAMPLER_2D_ARRAY:
@@ -282,7 +355,6 @@ void ShaderUniformCollection::AddUniform(const DataUniform& uniform)
 
 void ShaderUniformCollection::AddUniform(const TextureUniform& uniform)
 {
-    m_locationTextureIndex.insert(std::make_pair(uniform.location, static_cast<int>(m_textureUniforms.size())));
     m_textureUniforms.push_back(uniform);
 }
 
@@ -441,8 +513,6 @@ void ShaderUniformCollection::Reset()
     m_shaderProgram = nullptr;
     m_dataUniforms.clear();
     m_textureUniforms.clear();
-    m_locationDataIndex.clear();
-    m_locationTextureIndex.clear();
     m_intDataValues.clear();
     m_uintDataValues.clear();
     m_floatDataValues.clear();
@@ -6,7 +6,14 @@
 FramebufferObject::FramebufferObject() : Object(NullHandle)
 {
     Handle& handle = GetHandle();
-    glGenFramebuffers(1, &handle);
+    if (HasDirectStateAccess())
+    {
+        glCreateFramebuffers(1, &handle);
+    }
+    else
+    {
+        glGenFramebuffers(1, &handle);
+    }
 }
 
 FramebufferObject::~FramebufferObject()
@@ -39,16 +46,33 @@ void FramebufferObject::Unbind(Target target)
 
 void FramebufferObject::SetTexture(Target target, Attachment attachment, const Texture2DObject& texture, int level)
 {
+    if (HasDirectStateAccess())
+    {
+        glNamedFramebufferTexture(GetHandle(), static_cast<GLenum>(attachment), texture.GetHandle(), level);
+        return;
+    }
     glFramebufferTexture2D(static_cast<GLenum>(target), static_cast<GLenum>(attachment), texture.GetTarget(), texture.GetHandle(), level);
 }
 
 void FramebufferObject::SetDrawBuffers(std::span<const Attachment> attachments)
 {
-    glDrawBuffers(attachments.size(), reinterpret_cast<const GLenum*>(attachments.data()));
+    const GLenum* buffers = reinterpret_cast<const GLenum*>(attachments.data());
+    if (HasDirectStateAccess())
+    {
+        glNamedFramebufferDrawBuffers(GetHandle(), static_cast<GLsizei>(attachments.size()), buffers);
+        return;
+    }
+    glDrawBuffers(static_cast<GLsizei>(attachments.size()), buffers);
 }
 
 void FramebufferObject::DisableColorRendering()
 {
+    if (HasDirectStateAccess())
+    {
+        glNamedFramebufferDrawBuffer(GetHandle(), GL_NONE);
+        glNamedFramebufferReadBuffer(GetHandle(), GL_NONE);
+        return;
+    }
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
 }
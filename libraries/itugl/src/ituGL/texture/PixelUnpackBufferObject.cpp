@@ -0,0 +1,6 @@
+#include <ituGL/texture/PixelUnpackBufferObject.h>
+
+PixelUnpackBufferObject::PixelUnpackBufferObject()
+{
+    // Nothing to do here, it is done by the base class
+}
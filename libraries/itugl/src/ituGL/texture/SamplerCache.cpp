@@ -0,0 +1,53 @@
+#include <ituGL/texture/SamplerCache.h>
+
+#include <algorithm>
+
+SamplerCache::SamplerCache() : m_maxAnisotropy(1.0f)
+{
+}
+
+std::shared_ptr<const SamplerObject> SamplerCache::GetSampler(const Desc& desc)
+{
+    auto itSampler = std::find_if(m_samplers.begin(), m_samplers.end(), [&](const auto& samplerPair) { return samplerPair.first == desc; });
+    if (itSampler != m_samplers.end())
+    {
+        return itSampler->second;
+    }
+
+    std::shared_ptr<SamplerObject> sampler = std::make_shared<SamplerObject>();
+    sampler->SetParameter(TextureObject::ParameterEnum::MinFilter, desc.minFilter);
+    sampler->SetParameter(TextureObject::ParameterEnum::MagFilter, desc.magFilter);
+    sampler->SetParameter(TextureObject::ParameterEnum::WrapS, desc.wrapS);
+    sampler->SetParameter(TextureObject::ParameterEnum::WrapT, desc.wrapT);
+    sampler->SetParameter(TextureObject::ParameterEnum::WrapR, desc.wrapR);
+    sampler->SetParameter(TextureObject::ParameterColor::BorderColor, desc.borderColor);
+    if (UsesAnisotropy(desc))
+    {
+        sampler->SetMaxAnisotropy(m_maxAnisotropy);
+    }
+
+    m_samplers.emplace_back(desc, sampler);
+    return sampler;
+}
+
+void SamplerCache::SetMaxAnisotropy(GLfloat maxAnisotropy)
+{
+    m_maxAnisotropy = std::clamp(maxAnisotropy, 1.0f, SamplerObject::GetMaxSupportedAnisotropy());
+    for (auto& samplerPair : m_samplers)
+    {
+        if (UsesAnisotropy(samplerPair.first))
+        {
+            samplerPair.second->SetMaxAnisotropy(m_maxAnisotropy);
+        }
+    }
+}
+
+void SamplerCache::Clear()
+{
+    m_samplers.clear();
+}
+
+bool SamplerCache::UsesAnisotropy(const Desc& desc)
+{
+    return desc.minFilter == GL_LINEAR_MIPMAP_LINEAR || desc.minFilter == GL_LINEAR_MIPMAP_NEAREST;
+}
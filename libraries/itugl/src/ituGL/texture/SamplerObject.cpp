@@ -0,0 +1,92 @@
+#include <ituGL/texture/SamplerObject.h>
+
+#include <ituGL/core/DeviceGL.h>
+#include <algorithm>
+#include <cassert>
+
+SamplerObject::SamplerObject() : Object(NullHandle)
+{
+    // Unlike other objects, generated samplers exist before they are bound
+    Handle& handle = GetHandle();
+    glGenSamplers(1, &handle);
+}
+
+SamplerObject::~SamplerObject()
+{
+    Handle& handle = GetHandle();
+    glDeleteSamplers(1, &handle);
+}
+
+void SamplerObject::Bind() const
+{
+}
+
+void SamplerObject::Bind(GLuint textureUnit) const
+{
+    glBindSampler(textureUnit, GetHandle());
+}
+
+void SamplerObject::Unbind(GLuint textureUnit)
+{
+    glBindSampler(textureUnit, NullHandle);
+}
+
+void SamplerObject::GetParameter(TextureObject::ParameterFloat pname, GLfloat& param) const
+{
+    glGetSamplerParameterfv(GetHandle(), static_cast<GLenum>(pname), &param);
+}
+
+void SamplerObject::SetParameter(TextureObject::ParameterFloat pname, GLfloat param)
+{
+    glSamplerParameterf(GetHandle(), static_cast<GLenum>(pname), param);
+}
+
+void SamplerObject::GetParameter(TextureObject::ParameterEnum pname, GLenum& param) const
+{
+    glGetSamplerParameterIuiv(GetHandle(), static_cast<GLenum>(pname), &param);
+}
+
+void SamplerObject::SetParameter(TextureObject::ParameterEnum pname, GLenum param)
+{
+    // Swizzle and depth stencil mode are not sampler state
+    assert(pname != TextureObject::ParameterEnum::SwizzleRed && pname != TextureObject::ParameterEnum::SwizzleGreen &&
+        pname != TextureObject::ParameterEnum::SwizzleBlue && pname != TextureObject::ParameterEnum::SwizzleAlpha &&
+        pname != TextureObject::ParameterEnum::DepthStencilMode);
+    glSamplerParameteri(GetHandle(), static_cast<GLenum>(pname), param);
+}
+
+void SamplerObject::GetParameter(TextureObject::ParameterColor pname, std::span<GLfloat, 4> params) const
+{
+    glGetSamplerParameterfv(GetHandle(), static_cast<GLenum>(pname), params.data());
+}
+
+void SamplerObject::SetParameter(TextureObject::ParameterColor pname, std::span<const GLfloat, 4> params)
+{
+    glSamplerParameterfv(GetHandle(), static_cast<GLenum>(pname), params.data());
+}
+
+void SamplerObject::SetMaxAnisotropy(GLfloat maxAnisotropy)
+{
+    GLfloat maxSupportedAnisotropy = GetMaxSupportedAnisotropy();
+    if (maxSupportedAnisotropy > 1.0f)
+    {
+        glSamplerParameterf(GetHandle(), GL_TEXTURE_MAX_ANISOTROPY, std::clamp(maxAnisotropy, 1.0f, maxSupportedAnisotropy));
+    }
+}
+
+GLfloat SamplerObject::GetMaxSupportedAnisotropy()
+{
+    // Core since OpenGL 4.6, the extensions use the same enums
+    static GLfloat s_maxSupportedAnisotropy = []()
+    {
+        GLfloat maxAnisotropy = 1.0f;
+        const DeviceGL& device = DeviceGL::GetInstance();
+        if (GLAD_GL_VERSION_4_6 || device.IsExtensionSupported("GL_ARB_texture_filter_anisotropic") ||
+            device.IsExtensionSupported("GL_EXT_texture_filter_anisotropic"))
+        {
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy);
+        }
+        return maxAnisotropy;
+    }();
+    return s_maxSupportedAnisotropy;
+}
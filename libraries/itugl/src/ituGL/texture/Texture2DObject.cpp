@@ -1,15 +1,62 @@
 #include <ituGL/texture/Texture2DObject.h>
 
+#include <ituGL/texture/PixelUnpackBufferObject.h>
+#include <ituGL/core/DeviceGL.h>
+#include <algorithm>
+#include <bit>
 #include <cassert>
 
-Texture2DObject::Texture2DObject()
+Texture2DObject::Texture2DObject() : m_storageLevelCount(0)
 {
 }
 
+Texture2DObject::Texture2DObject(Texture2DObject&& texture2D) noexcept : TextureObjectBase(std::move(texture2D))
+    , m_storageLevelCount(texture2D.m_storageLevelCount)
+{
+    texture2D.m_storageLevelCount = 0;
+}
+
+Texture2DObject& Texture2DObject::operator = (Texture2DObject&& texture2D) noexcept
+{
+    if (this != &texture2D)
+    {
+        TextureObjectBase::operator=(std::move(texture2D));
+        m_storageLevelCount = texture2D.m_storageLevelCount;
+        texture2D.m_storageLevelCount = 0;
+    }
+    return *this;
+}
+
+void Texture2DObject::SetStorage(GLsizei levelCount, GLsizei width, GLsizei height, InternalFormat internalFormat)
+{
+    assert(DeviceGL::GetInstance().IsTextureStorageSupported());
+    assert(!HasImmutableStorage());
+    assert(levelCount > 0 && levelCount <= GetMipmapLevelCount(width, height));
+    internalFormat = GetSizedInternalFormat(internalFormat);
+    assert(internalFormat != InternalFormatInvalid);
+    if (HasDirectStateAccess())
+    {
+        glTextureStorage2D(GetHandle(), levelCount, internalFormat, width, height);
+    }
+    else
+    {
+        assert(IsBound());
+        glTexStorage2D(GetTarget(), levelCount, internalFormat, width, height);
+    }
+    m_storageLevelCount = levelCount;
+}
+
+GLsizei Texture2DObject::GetMipmapLevelCount(GLsizei width, GLsizei height)
+{
+    unsigned int size = static_cast<unsigned int>(std::max({ width, height, 1 }));
+    return static_cast<GLsizei>(std::bit_width(size));
+}
+
 template <>
 void Texture2DObject::SetImage<std::byte>(GLint level, GLsizei width, GLsizei height, Format format, InternalFormat internalFormat, std::span<const std::byte> data, Data::Type type)
 {
     assert(IsBound());
+    assert(!HasImmutableStorage());
     assert(data.empty() || type != Data::Type::None);
     assert(IsValidFormat(format, internalFormat));
     assert(data.empty() || data.size_bytes() == width * height * GetDataComponentCount(internalFormat) * Data::GetTypeSize(type));
@@ -18,5 +65,58 @@ void Texture2DObject::SetImage<std::byte>(GLint level, GLsizei width, GLsizei he
 
 void Texture2DObject::SetImage(GLint level, GLsizei width, GLsizei height, Format format, InternalFormat internalFormat)
 {
-    SetImage<float>(level, width, height, format, internalFormat, std::span<float>());
+    // Even without data, depth stencil formats require a packed type
+    Data::Type type = format == FormatDepthStencil ? Data::Type::UInt24_8 : Data::Type::Float;
+    SetImage<float>(level, width, height, format, internalFormat, std::span<float>(), type);
+}
+
+void Texture2DObject::SetCompressedImage(GLint level, GLsizei width, GLsizei height, InternalFormat internalFormat, std::span<const std::byte> data)
+{
+    assert(IsBound());
+    assert(!HasImmutableStorage());
+    assert(IsBlockCompressed(internalFormat));
+    assert(data.size_bytes() == GetCompressedImageSize(internalFormat, width, height));
+    glCompressedTexImage2D(GetTarget(), level, internalFormat, width, height, 0, static_cast<GLsizei>(data.size_bytes()), data.data());
+}
+
+void Texture2DObject::SetSubImage(GLint level, GLint x, GLint y, GLsizei width, GLsizei height, Format format, Data::Type type, size_t bufferOffset)
+{
+    assert(PixelUnpackBufferObject::IsAnyBound());
+    // With a pixel unpack buffer bound, the data pointer is an offset in the buffer
+    const void* pointer = reinterpret_cast<const void*>(bufferOffset);
+    if (HasDirectStateAccess())
+    {
+        glTextureSubImage2D(GetHandle(), level, x, y, width, height, format, static_cast<GLenum>(type), pointer);
+        return;
+    }
+    assert(IsBound());
+    glTexSubImage2D(GetTarget(), level, x, y, width, height, format, static_cast<GLenum>(type), pointer);
+}
+
+void Texture2DObject::SetSubImage(GLint level, GLint x, GLint y, GLsizei width, GLsizei height, Format format, Data::Type type, std::span<const std::byte> data)
+{
+    assert(!PixelUnpackBufferObject::IsAnyBound());
+    assert(data.size_bytes() >= static_cast<size_t>(width) * height * GetComponentCount(format) * Data::GetTypeSize(type));
+    if (HasDirectStateAccess())
+    {
+        glTextureSubImage2D(GetHandle(), level, x, y, width, height, format, static_cast<GLenum>(type), data.data());
+        return;
+    }
+    assert(IsBound());
+    glTexSubImage2D(GetTarget(), level, x, y, width, height, format, static_cast<GLenum>(type), data.data());
+}
+
+void Texture2DObject::SetCompressedSubImage(GLint level, GLint x, GLint y, GLsizei width, GLsizei height, InternalFormat internalFormat, std::span<const std::byte> data)
+{
+    assert(IsBlockCompressed(internalFormat));
+    assert(x % 4 == 0 && y % 4 == 0);
+    assert(data.size_bytes() == GetCompressedImageSize(internalFormat, width, height));
+    GLsizei dataSize = static_cast<GLsizei>(data.size_bytes());
+    if (HasDirectStateAccess())
+    {
+        glCompressedTextureSubImage2D(GetHandle(), level, x, y, width, height, internalFormat, dataSize, data.data());
+        return;
+    }
+    assert(IsBound());
+    glCompressedTexSubImage2D(GetTarget(), level, x, y, width, height, internalFormat, dataSize, data.data());
 }
@@ -1,11 +1,21 @@
 #include <ituGL/texture/TextureObject.h>
 
+#include <ituGL/core/DeviceGL.h>
+#include <algorithm>
 #include <cassert>
 
-TextureObject::TextureObject() : Object(NullHandle)
+TextureObject::TextureObject(Target target) : Object(NullHandle)
 {
     Handle& handle = GetHandle();
-    glGenTextures(1, &handle);
+    if (HasDirectStateAccess())
+    {
+        // The texture is created with its target, so it can be edited before binding it
+        glCreateTextures(target, 1, &handle);
+    }
+    else
+    {
+        glGenTextures(1, &handle);
+    }
 }
 
 TextureObject::~TextureObject()
@@ -14,6 +24,28 @@ TextureObject::~TextureObject()
     glDeleteTextures(1, &handle);
 }
 
+TextureObject::TextureObject(TextureObject&& texture) noexcept : Object(std::move(texture)), m_sampler(std::move(texture.m_sampler))
+{
+}
+
+TextureObject& TextureObject::operator = (TextureObject&& texture) noexcept
+{
+    // Not using Object::operator=, the destructor it calls would also destroy the sampler of this texture
+    if (this != &texture)
+    {
+        Handle& handle = GetHandle();
+        if (handle != NullHandle)
+        {
+            glDeleteTextures(1, &handle);
+        }
+        handle = texture.GetHandle();
+        texture.GetHandle() = NullHandle;
+
+        m_sampler = std::move(texture.m_sampler);
+    }
+    return *this;
+}
+
 #ifndef NDEBUG
 GLint TextureObject::GetActiveTexture()
 {
@@ -42,70 +74,173 @@ void TextureObject::Unbind(Target target)
 
 void TextureObject::GenerateMipmap()
 {
+    if (HasDirectStateAccess())
+    {
+        glGenerateTextureMipmap(GetHandle());
+        return;
+    }
     assert(IsBound());
     glGenerateMipmap(GetTarget());
 }
 
 void TextureObject::GetParameter(ParameterFloat pname, GLfloat& param) const
 {
+    if (HasDirectStateAccess())
+    {
+        glGetTextureParameterfv(GetHandle(), static_cast<GLenum>(pname), &param);
+        return;
+    }
     assert(IsBound());
     glGetTexParameterfv(GetTarget(), static_cast<GLenum>(pname), &param);
 }
 
 void TextureObject::SetParameter(ParameterFloat pname, GLfloat param)
 {
+    if (HasDirectStateAccess())
+    {
+        glTextureParameterf(GetHandle(), static_cast<GLenum>(pname), param);
+        return;
+    }
     assert(IsBound());
     glTexParameterf(GetTarget(), static_cast<GLenum>(pname), param);
 }
 
 void TextureObject::GetParameter(ParameterInt pname, GLint& param) const
 {
+    if (HasDirectStateAccess())
+    {
+        glGetTextureParameteriv(GetHandle(), static_cast<GLenum>(pname), &param);
+        return;
+    }
     assert(IsBound());
     glGetTexParameteriv(GetTarget(), static_cast<GLenum>(pname), &param);
 }
 
 void TextureObject::SetParameter(ParameterInt pname, GLint param)
 {
+    if (HasDirectStateAccess())
+    {
+        glTextureParameteri(GetHandle(), static_cast<GLenum>(pname), param);
+        return;
+    }
     assert(IsBound());
     glTexParameteri(GetTarget(), static_cast<GLenum>(pname), param);
 }
 
 void TextureObject::GetParameter(ParameterEnum pname, GLenum& param) const
 {
+    if (HasDirectStateAccess())
+    {
+        glGetTextureParameterIuiv(GetHandle(), static_cast<GLenum>(pname), &param);
+        return;
+    }
     assert(IsBound());
     glGetTexParameterIuiv(GetTarget(), static_cast<GLenum>(pname), &param);
 }
 
 void TextureObject::SetParameter(ParameterEnum pname, GLenum param)
 {
+    if (HasDirectStateAccess())
+    {
+        glTextureParameteri(GetHandle(), static_cast<GLenum>(pname), param);
+        return;
+    }
     assert(IsBound());
     glTexParameteri(GetTarget(), static_cast<GLenum>(pname), param);
 }
 
 void TextureObject::GetParameter(ParameterEnumVector pname, std::span<GLenum> params) const
 {
+    if (HasDirectStateAccess())
+    {
+        glGetTextureParameterIuiv(GetHandle(), static_cast<GLenum>(pname), params.data());
+        return;
+    }
     assert(IsBound());
     glGetTexParameterIuiv(GetTarget(), static_cast<GLenum>(pname), params.data());
 }
 
 void TextureObject::SetParameter(ParameterEnumVector pname, std::span<const GLenum> params)
 {
+    if (HasDirectStateAccess())
+    {
+        glTextureParameterIuiv(GetHandle(), static_cast<GLenum>(pname), params.data());
+        return;
+    }
     assert(IsBound());
     glTexParameterIuiv(GetTarget(), static_cast<GLenum>(pname), params.data());
 }
 
 void TextureObject::GetParameter(ParameterColor pname, std::span<GLfloat, 4> params) const
 {
+    if (HasDirectStateAccess())
+    {
+        glGetTextureParameterfv(GetHandle(), static_cast<GLenum>(pname), params.data());
+        return;
+    }
     assert(IsBound());
     glGetTexParameterfv(GetTarget(), static_cast<GLenum>(pname), params.data());
 }
 
 void TextureObject::SetParameter(ParameterColor pname, std::span<const GLfloat, 4> params)
 {
+    if (HasDirectStateAccess())
+    {
+        glTextureParameterfv(GetHandle(), static_cast<GLenum>(pname), params.data());
+        return;
+    }
     assert(IsBound());
     glTexParameterfv(GetTarget(), static_cast<GLenum>(pname), params.data());
 }
 
+size_t TextureObject::GetMemorySize() const
+{
+    assert(IsBound());
+
+    // Cubemap levels are queried on each face
+    Target target = GetTarget();
+    GLenum levelTarget = target == TextureCubemap ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : static_cast<GLenum>(target);
+    int faceCount = target == TextureCubemap ? 6 : 1;
+
+    size_t size = 0;
+    for (GLint level = 0; ; ++level)
+    {
+        GLint width = 0, height = 0, depth = 0;
+        glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_WIDTH, &width);
+        if (width == 0)
+            break;
+
+        GLint compressed = GL_FALSE;
+        glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_COMPRESSED, &compressed);
+
+        size_t levelSize = 0;
+        if (compressed)
+        {
+            GLint compressedSize = 0;
+            glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressedSize);
+            levelSize = compressedSize;
+        }
+        else
+        {
+            glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_HEIGHT, &height);
+            glGetTexLevelParameteriv(levelTarget, level, GL_TEXTURE_DEPTH, &depth);
+
+            const GLenum componentSizes[] = { GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE,
+                GL_TEXTURE_ALPHA_SIZE, GL_TEXTURE_DEPTH_SIZE, GL_TEXTURE_STENCIL_SIZE };
+            size_t texelBits = 0;
+            for (GLenum componentSize : componentSizes)
+            {
+                GLint bits = 0;
+                glGetTexLevelParameteriv(levelTarget, level, componentSize, &bits);
+                texelBits += bits;
+            }
+            levelSize = static_cast<size_t>(width) * std::max(height, 1) * std::max(depth, 1) * texelBits / 8;
+        }
+        size += levelSize * faceCount;
+    }
+    return size;
+}
+
 #ifndef NDEBUG
 bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
 {
@@ -120,6 +255,8 @@ bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
     case InternalFormatR32F:
     case InternalFormatRCompressed:
         return format == FormatR;
+    case InternalFormatR32UI:
+        return format == FormatRInteger;
     case InternalFormatRG:
     case InternalFormatRG8:
     case InternalFormatRG16:
@@ -129,6 +266,8 @@ bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
     case InternalFormatRG32F:
     case InternalFormatRGCompressed:
         return format == FormatRG;
+    case InternalFormatRG32UI:
+        return format == FormatRGInteger;
     case InternalFormatRGB:
     case InternalFormatRGB8:
     case InternalFormatRGB16:
@@ -141,6 +280,8 @@ bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
     case InternalFormatSRGBCompressed:
     case InternalFormatR11G11B10:
         return format == FormatRGB || format == FormatBGR;
+    case InternalFormatRGB32UI:
+        return format == FormatRGBInteger;
     case InternalFormatRGBA:
     case InternalFormatRGBA8:
     case InternalFormatRGBA16:
@@ -153,6 +294,19 @@ bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
     case InternalFormatSRGBACompressed:
     case InternalFormatRGB10A2:
         return format == FormatRGBA || format == FormatBGRA;
+    case InternalFormatBC4:
+        return format == FormatR;
+    case InternalFormatBC5:
+        return format == FormatRG;
+    case InternalFormatBC1:
+    case InternalFormatBC1SRGB:
+    case InternalFormatBC3:
+    case InternalFormatBC3SRGB:
+    case InternalFormatBC7:
+    case InternalFormatBC7SRGB:
+        return format == FormatRGBA;
+    case InternalFormatRGBA32UI:
+        return format == FormatRGBAInteger;
     case InternalFormatDepth:
     case InternalFormatDepth16:
     case InternalFormatDepth24:
@@ -168,22 +322,27 @@ bool TextureObject::IsValidFormat(Format format, InternalFormat internalFormat)
         return false;
     }
 }
+#endif
 
 int TextureObject::GetComponentCount(Format format)
 {
     switch (format)
     {
     case FormatR:
+    case FormatRInteger:
     case FormatDepth:
         return 1;
     case FormatRG:
+    case FormatRGInteger:
     case FormatDepthStencil:
         return 2;
     case FormatRGB:
     case FormatBGR:
+    case FormatRGBInteger:
         return 3;
     case FormatRGBA:
     case FormatBGRA:
+    case FormatRGBAInteger:
         return 4;
     default:
         //Unknown format
@@ -202,7 +361,9 @@ int TextureObject::GetDataComponentCount(InternalFormat internalFormat)
     case InternalFormatR16SNorm:
     case InternalFormatR16F:
     case InternalFormatR32F:
+    case InternalFormatR32UI:
     case InternalFormatRCompressed:
+    case InternalFormatBC4:
     case InternalFormatR11G11B10:
     case InternalFormatRGB10A2:
     case InternalFormatDepth:
@@ -220,7 +381,9 @@ int TextureObject::GetDataComponentCount(InternalFormat internalFormat)
     case InternalFormatRG16SNorm:
     case InternalFormatRG16F:
     case InternalFormatRG32F:
+    case InternalFormatRG32UI:
     case InternalFormatRGCompressed:
+    case InternalFormatBC5:
         return 2;
     case InternalFormatRGB:
     case InternalFormatRGB8:
@@ -229,6 +392,7 @@ int TextureObject::GetDataComponentCount(InternalFormat internalFormat)
     case InternalFormatRGB16SNorm:
     case InternalFormatRGB16F:
     case InternalFormatRGB32F:
+    case InternalFormatRGB32UI:
     case InternalFormatSRGB8:
     case InternalFormatRGBCompressed:
     case InternalFormatSRGBCompressed:
@@ -240,13 +404,117 @@ int TextureObject::GetDataComponentCount(InternalFormat internalFormat)
     case InternalFormatRGBA16SNorm:
     case InternalFormatRGBA16F:
     case InternalFormatRGBA32F:
+    case InternalFormatRGBA32UI:
     case InternalFormatSRGBA8:
     case InternalFormatRGBACompressed:
     case InternalFormatSRGBACompressed:
+    case InternalFormatBC1:
+    case InternalFormatBC1SRGB:
+    case InternalFormatBC3:
+    case InternalFormatBC3SRGB:
+    case InternalFormatBC7:
+    case InternalFormatBC7SRGB:
         return 4;
     default:
         //Unknown format
         return 0;
     }
 }
-#endif
+
+TextureObject::InternalFormat TextureObject::GetSizedInternalFormat(InternalFormat internalFormat)
+{
+    switch (internalFormat)
+    {
+    case InternalFormatR:
+        return InternalFormatR8;
+    case InternalFormatRG:
+        return InternalFormatRG8;
+    case InternalFormatRGB:
+        return InternalFormatRGB8;
+    case InternalFormatRGBA:
+        return InternalFormatRGBA8;
+    case InternalFormatDepth:
+        return InternalFormatDepth24;
+    case InternalFormatDepthStencil:
+        return InternalFormatDepth24Stencil8;
+    case InternalFormatRCompressed:
+    case InternalFormatRGCompressed:
+    case InternalFormatRGBCompressed:
+    case InternalFormatRGBACompressed:
+    case InternalFormatSRGBCompressed:
+    case InternalFormatSRGBACompressed:
+        return InternalFormatInvalid;
+    default:
+        return internalFormat;
+    }
+}
+
+bool TextureObject::IsBlockCompressed(InternalFormat internalFormat)
+{
+    switch (internalFormat)
+    {
+    case InternalFormatBC1:
+    case InternalFormatBC1SRGB:
+    case InternalFormatBC3:
+    case InternalFormatBC3SRGB:
+    case InternalFormatBC4:
+    case InternalFormatBC5:
+    case InternalFormatBC7:
+    case InternalFormatBC7SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+size_t TextureObject::GetCompressedImageSize(InternalFormat internalFormat, GLsizei width, GLsizei height)
+{
+    assert(IsBlockCompressed(internalFormat));
+
+    // BC1 and BC4 use 8 bytes per block, the others 16
+    size_t blockSize = internalFormat == InternalFormatBC1 || internalFormat == InternalFormatBC1SRGB || internalFormat == InternalFormatBC4 ? 8 : 16;
+    size_t blocksX = (std::max(width, 1) + 3) / 4;
+    size_t blocksY = (std::max(height, 1) + 3) / 4;
+    return blocksX * blocksY * blockSize;
+}
+
+bool TextureObject::IsCompressedFormatSupported(InternalFormat internalFormat)
+{
+    // GL_COMPRESSED_TEXTURE_FORMATS can't be used, it leaves out the formats that are not for general-purpose use
+    switch (internalFormat)
+    {
+    case InternalFormatRCompressed:
+    case InternalFormatRGCompressed:
+    case InternalFormatRGBCompressed:
+    case InternalFormatRGBACompressed:
+    case InternalFormatSRGBCompressed:
+    case InternalFormatSRGBACompressed:
+    case InternalFormatBC4:
+    case InternalFormatBC5:
+        // Core since OpenGL 3.0
+        return true;
+    case InternalFormatBC1:
+    case InternalFormatBC1SRGB:
+    case InternalFormatBC3:
+    case InternalFormatBC3SRGB:
+    {
+        static bool s_supported = DeviceGL::GetInstance().IsExtensionSupported("GL_EXT_texture_compression_s3tc");
+        return s_supported;
+    }
+    case InternalFormatBC7:
+    case InternalFormatBC7SRGB:
+    {
+        // Core since OpenGL 4.2
+        static bool s_supported = []()
+        {
+            GLint majorVersion = 0, minorVersion = 0;
+            glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+            glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+            return majorVersion * 10 + minorVersion >= 42 || DeviceGL::GetInstance().IsExtensionSupported("GL_ARB_texture_compression_bptc");
+        }();
+        return s_supported;
+    }
+    default:
+        return false;
+    }
+}
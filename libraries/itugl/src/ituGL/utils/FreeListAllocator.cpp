@@ -0,0 +1,75 @@
+#include <ituGL/utils/FreeListAllocator.h>
+
+#include <iterator>
+#include <cassert>
+
+FreeListAllocator::FreeListAllocator(std::size_t capacity) : m_capacity(capacity), m_freeSize(capacity)
+{
+    if (capacity > 0)
+    {
+        m_freeRanges.emplace(0, capacity);
+    }
+}
+
+bool FreeListAllocator::Allocate(std::size_t size, std::size_t alignment, std::size_t& offset)
+{
+    assert(size > 0);
+    assert(alignment > 0);
+
+    for (auto itRange = m_freeRanges.begin(); itRange != m_freeRanges.end(); ++itRange)
+    {
+        std::size_t rangeOffset = itRange->first;
+        std::size_t rangeSize = itRange->second;
+        std::size_t alignedOffset = (rangeOffset + alignment - 1) / alignment * alignment;
+        std::size_t padding = alignedOffset - rangeOffset;
+        if (padding + size > rangeSize)
+            continue;
+
+        // The padding before and the rest after stay free
+        m_freeRanges.erase(itRange);
+        if (padding > 0)
+        {
+            m_freeRanges.emplace(rangeOffset, padding);
+        }
+        std::size_t remainingSize = rangeSize - padding - size;
+        if (remainingSize > 0)
+        {
+            m_freeRanges.emplace(alignedOffset + size, remainingSize);
+        }
+
+        m_freeSize -= size;
+        offset = alignedOffset;
+        return true;
+    }
+    return false;
+}
+
+void FreeListAllocator::Free(std::size_t offset, std::size_t size)
+{
+    assert(size > 0);
+    assert(offset + size <= m_capacity);
+    m_freeSize += size;
+
+    // Merge with the next range, if it starts at the end of this one
+    auto itNext = m_freeRanges.lower_bound(offset);
+    assert(itNext == m_freeRanges.end() || offset + size <= itNext->first);
+    if (itNext != m_freeRanges.end() && offset + size == itNext->first)
+    {
+        size += itNext->second;
+        itNext = m_freeRanges.erase(itNext);
+    }
+
+    // Merge with the previous range, if it ends at the start of this one
+    if (itNext != m_freeRanges.begin())
+    {
+        auto itPrevious = std::prev(itNext);
+        assert(itPrevious->first + itPrevious->second <= offset);
+        if (itPrevious->first + itPrevious->second == offset)
+        {
+            itPrevious->second += size;
+            return;
+        }
+    }
+
+    m_freeRanges.emplace_hint(itNext, offset, size);
+}
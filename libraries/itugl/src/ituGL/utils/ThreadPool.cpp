@@ -0,0 +1,75 @@
+#include <ituGL/utils/ThreadPool.h>
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threadCount) : m_runningTaskCount(0), m_stopping(false)
+{
+    if (threadCount == 0)
+    {
+        // hardware_concurrency can return 0 if unknown
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    m_threads.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+// Pending tasks are discarded, running tasks are finished before joining
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_tasks = {};
+    }
+    m_taskAvailable.notify_all();
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(std::move(task));
+    }
+    m_taskAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tasksFinished.wait(lock, [this]() { return m_tasks.empty() && m_runningTaskCount == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_taskAvailable.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+        if (m_stopping)
+            break;
+
+        Task task = std::move(m_tasks.front());
+        m_tasks.pop();
+        ++m_runningTaskCount;
+
+        // The lock is only held to access the queue
+        lock.unlock();
+        task();
+        lock.lock();
+
+        --m_runningTaskCount;
+        if (m_tasks.empty() && m_runningTaskCount == 0)
+        {
+            m_tasksFinished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,345 @@
+#include "BlockCompressor.h"
+
+#include <ituGL/texture/TextureObject.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// Writes values into a 128-bit block, starting from the least significant bit
+class BitWriter
+{
+public:
+    BitWriter() : m_bits{ 0, 0 }, m_position(0) {}
+
+    void Write(std::uint32_t value, int bitCount)
+    {
+        for (int i = 0; i < bitCount; ++i, ++m_position)
+        {
+            m_bits[m_position / 64] |= static_cast<std::uint64_t>((value >> i) & 1) << (m_position % 64);
+        }
+    }
+
+    void CopyTo(std::byte* output) const { std::memcpy(output, m_bits.data(), sizeof(m_bits)); }
+
+private:
+    std::array<std::uint64_t, 2> m_bits;
+    int m_position;
+};
+
+// Direction of the largest variation of the colors, found with power iteration on the covariance matrix
+// The channels with zero weight are ignored
+static glm::vec4 GetPrincipalAxis(const std::array<glm::vec4, 16>& colors, const glm::vec4& weights, glm::vec4& mean)
+{
+    mean = glm::vec4(0.0f);
+    glm::vec4 min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest());
+    for (const glm::vec4& color : colors)
+    {
+        mean += color * weights;
+        min = glm::min(min, color * weights);
+        max = glm::max(max, color * weights);
+    }
+    mean /= 16.0f;
+
+    glm::mat4 covariance(0.0f);
+    for (const glm::vec4& color : colors)
+    {
+        glm::vec4 offset = color * weights - mean;
+        covariance += glm::outerProduct(offset, offset);
+    }
+
+    // Start with the diagonal of the bounding box, that is usually close
+    glm::vec4 axis = max - min;
+    if (glm::dot(axis, axis) < 1e-6f)
+        return glm::vec4(0.0f);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        glm::vec4 nextAxis = covariance * axis;
+        float length = glm::length(nextAxis);
+        if (length < 1e-6f)
+            break;
+        axis = nextAxis / length;
+    }
+    return glm::normalize(axis);
+}
+
+// Colors at both ends of the principal axis
+static void GetEndpoints(const std::array<glm::vec4, 16>& colors, const glm::vec4& weights, glm::vec4& endpoint0, glm::vec4& endpoint1)
+{
+    glm::vec4 mean;
+    glm::vec4 axis = GetPrincipalAxis(colors, weights, mean);
+
+    float minProjection = 0.0f, maxProjection = 0.0f;
+    for (const glm::vec4& color : colors)
+    {
+        float projection = glm::dot(color * weights - mean, axis);
+        minProjection = std::min(minProjection, projection);
+        maxProjection = std::max(maxProjection, projection);
+    }
+    endpoint0 = glm::clamp(mean + axis * minProjection, 0.0f, 255.0f);
+    endpoint1 = glm::clamp(mean + axis * maxProjection, 0.0f, 255.0f);
+}
+
+static std::array<glm::vec4, 16> GetColors(const BlockCompressor::Block& block)
+{
+    std::array<glm::vec4, 16> colors;
+    for (int i = 0; i < 16; ++i)
+    {
+        colors[i] = glm::vec4(block[i]);
+    }
+    return colors;
+}
+
+// Index of the palette entry closest to the color, and its squared error
+template<std::size_t N>
+static int FindClosest(const glm::vec4& color, const std::array<glm::vec4, N>& palette, float& error)
+{
+    int closest = 0;
+    error = std::numeric_limits<float>::max();
+    for (int i = 0; i < N; ++i)
+    {
+        glm::vec4 difference = color - palette[i];
+        float distance = glm::dot(difference, difference);
+        if (distance < error)
+        {
+            error = distance;
+            closest = i;
+        }
+    }
+    return closest;
+}
+
+std::size_t BlockCompressor::GetBlockSize(Format format)
+{
+    return format == Format::BC1 || format == Format::BC4 ? 8 : 16;
+}
+
+std::uint32_t BlockCompressor::GetInternalFormat(Format format)
+{
+    switch (format)
+    {
+    case Format::BC1: return TextureObject::InternalFormatBC1;
+    case Format::BC4: return TextureObject::InternalFormatBC4;
+    case Format::BC5: return TextureObject::InternalFormatBC5;
+    case Format::BC7: return TextureObject::InternalFormatBC7;
+    default: return TextureObject::InternalFormatInvalid;
+    }
+}
+
+void BlockCompressor::Compress(Format format, const Block& block, std::byte* output)
+{
+    switch (format)
+    {
+    case Format::BC1:
+        CompressBC1(block, output);
+        break;
+    case Format::BC4:
+        CompressBC4(block, 0, output);
+        break;
+    case Format::BC5:
+        CompressBC4(block, 0, output);
+        CompressBC4(block, 1, output + 8);
+        break;
+    case Format::BC7:
+        CompressBC7(block, output);
+        break;
+    }
+}
+
+// Endpoints in RGB565, and 2-bit indices to the 4 colors interpolated between them
+void BlockCompressor::CompressBC1(const Block& block, std::byte* output)
+{
+    std::array<glm::vec4, 16> colors = GetColors(block);
+    glm::vec4 rgbWeights(1.0f, 1.0f, 1.0f, 0.0f);
+    for (glm::vec4& color : colors)
+    {
+        color *= rgbWeights;
+    }
+
+    glm::vec4 endpoint0, endpoint1;
+    GetEndpoints(colors, rgbWeights, endpoint0, endpoint1);
+
+    auto pack565 = [](const glm::vec4& color)
+    {
+        glm::uvec3 quantized = glm::uvec3(glm::round(glm::vec3(color) * glm::vec3(31.0f, 63.0f, 31.0f) / 255.0f));
+        return static_cast<std::uint16_t>(quantized.r << 11 | quantized.g << 5 | quantized.b);
+    };
+    auto unpack565 = [](std::uint16_t color)
+    {
+        glm::uvec3 quantized(color >> 11, (color >> 5) & 63, color & 31);
+        return glm::vec4((quantized.r << 3) | (quantized.r >> 2), (quantized.g << 2) | (quantized.g >> 4), (quantized.b << 3) | (quantized.b >> 2), 0.0f);
+    };
+
+    // The first color must be the greater, to select the mode with 4 opaque colors
+    std::uint16_t color0 = pack565(endpoint1);
+    std::uint16_t color1 = pack565(endpoint0);
+    if (color0 < color1)
+    {
+        std::swap(color0, color1);
+    }
+
+    std::uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        std::array<glm::vec4, 4> palette;
+        palette[0] = unpack565(color0);
+        palette[1] = unpack565(color1);
+        palette[2] = (2.0f * palette[0] + palette[1]) / 3.0f;
+        palette[3] = (palette[0] + 2.0f * palette[1]) / 3.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float error;
+            indices |= FindClosest(colors[i], palette, error) << (2 * i);
+        }
+    }
+
+    std::memcpy(output, &color0, 2);
+    std::memcpy(output + 2, &color1, 2);
+    std::memcpy(output + 4, &indices, 4);
+}
+
+// Endpoints in 8 bits, and 3-bit indices to the 8 values interpolated between them
+void BlockCompressor::CompressBC4(const Block& block, int channel, std::byte* output)
+{
+    int min = 255, max = 0;
+    for (const glm::u8vec4& texel : block)
+    {
+        min = std::min(min, static_cast<int>(texel[channel]));
+        max = std::max(max, static_cast<int>(texel[channel]));
+    }
+
+    // With red0 > red1, index 0 is red0, index 1 is red1, and indices 2 to 7 go from red0 to red1
+    // If all the values are the same, index 0 is used for all of them
+    std::uint64_t indices = 0;
+    if (max > min)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            int step = (2 * 7 * (block[i][channel] - min) + (max - min)) / (2 * (max - min));
+            std::uint64_t index = step == 7 ? 0 : step == 0 ? 1 : 8 - step;
+            indices |= index << (3 * i);
+        }
+    }
+
+    output[0] = static_cast<std::byte>(max);
+    output[1] = static_cast<std::byte>(min);
+    for (int i = 0; i < 6; ++i)
+    {
+        output[2 + i] = static_cast<std::byte>((indices >> (8 * i)) & 0xFF);
+    }
+}
+
+// Mode 6: RGBA endpoints with 7 bits plus a shared low bit per endpoint, and 4-bit indices
+void BlockCompressor::CompressBC7(const Block& block, std::byte* output)
+{
+    static const std::array<int, 16> weights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    std::array<glm::vec4, 16> colors = GetColors(block);
+
+    // Quantize the endpoint with the low bit that fits best
+    auto quantizeEndpoint = [](const glm::vec4& endpoint, glm::ivec4& quantized, int& lowBit)
+    {
+        float bestError = std::numeric_limits<float>::max();
+        for (int bit = 0; bit < 2; ++bit)
+        {
+            glm::ivec4 candidate = glm::clamp(glm::ivec4(glm::round((endpoint - float(bit)) / 2.0f)), 0, 127);
+            glm::vec4 difference = glm::vec4(candidate * 2 + bit) - endpoint;
+            float error = glm::dot(difference, difference);
+            if (error < bestError)
+            {
+                bestError = error;
+                quantized = candidate;
+                lowBit = bit;
+            }
+        }
+    };
+
+    struct Encoding
+    {
+        std::array<glm::ivec4, 2> endpoints;
+        std::array<int, 2> lowBits;
+        std::array<int, 16> indices;
+        float error;
+    };
+
+    // Quantize the endpoints and find the closest index for each texel
+    auto encode = [&](const glm::vec4& endpoint0, const glm::vec4& endpoint1, Encoding& encoding)
+    {
+        quantizeEndpoint(endpoint0, encoding.endpoints[0], encoding.lowBits[0]);
+        quantizeEndpoint(endpoint1, encoding.endpoints[1], encoding.lowBits[1]);
+
+        glm::ivec4 value0 = encoding.endpoints[0] * 2 + encoding.lowBits[0];
+        glm::ivec4 value1 = encoding.endpoints[1] * 2 + encoding.lowBits[1];
+        std::array<glm::vec4, 16> palette;
+        for (int i = 0; i < 16; ++i)
+        {
+            palette[i] = glm::vec4(((64 - weights[i]) * value0 + weights[i] * value1 + 32) >> 6);
+        }
+
+        encoding.error = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float error;
+            encoding.indices[i] = FindClosest(colors[i], palette, error);
+            encoding.error += error;
+        }
+    };
+
+    glm::vec4 endpoint0, endpoint1;
+    GetEndpoints(colors, glm::vec4(1.0f), endpoint0, endpoint1);
+
+    Encoding encoding;
+    encode(endpoint0, endpoint1, encoding);
+
+    // One least squares pass: the endpoints that fit best the weights selected by the indices
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    glm::vec4 sum0(0.0f), sum1(0.0f);
+    for (int i = 0; i < 16; ++i)
+    {
+        float t = weights[encoding.indices[i]] / 64.0f;
+        a += (1.0f - t) * (1.0f - t);
+        b += (1.0f - t) * t;
+        c += t * t;
+        sum0 += (1.0f - t) * colors[i];
+        sum1 += t * colors[i];
+    }
+    float determinant = a * c - b * b;
+    if (std::abs(determinant) > 1e-6f)
+    {
+        glm::vec4 refined0 = glm::clamp((c * sum0 - b * sum1) / determinant, 0.0f, 255.0f);
+        glm::vec4 refined1 = glm::clamp((a * sum1 - b * sum0) / determinant, 0.0f, 255.0f);
+        Encoding refinedEncoding;
+        encode(refined0, refined1, refinedEncoding);
+        if (refinedEncoding.error < encoding.error)
+        {
+            encoding = refinedEncoding;
+        }
+    }
+
+    // The first index is stored with 3 bits, so its highest bit must be 0. Swapping the endpoints inverts the indices
+    if (encoding.indices[0] >= 8)
+    {
+        std::swap(encoding.endpoints[0], encoding.endpoints[1]);
+        std::swap(encoding.lowBits[0], encoding.lowBits[1]);
+        for (int& index : encoding.indices)
+        {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer;
+    writer.Write(1 << 6, 7);
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        writer.Write(encoding.endpoints[0][channel], 7);
+        writer.Write(encoding.endpoints[1][channel], 7);
+    }
+    writer.Write(encoding.lowBits[0], 1);
+    writer.Write(encoding.lowBits[1], 1);
+    for (int i = 0; i < 16; ++i)
+    {
+        writer.Write(encoding.indices[i], i == 0 ? 3 : 4);
+    }
+    writer.CopyTo(output);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/vec4.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// CPU encoders for the block compressed texture formats
+// Each block holds 4x4 texels, row by row. Blocks on the right and bottom edges repeat the last texels
+class BlockCompressor
+{
+public:
+    enum class Format
+    {
+        // RGB, 4 bits per texel. Alpha is ignored
+        BC1,
+        // R, 4 bits per texel
+        BC4,
+        // RG, 8 bits per texel. Two BC4 blocks, meant for normal maps
+        BC5,
+        // RGBA, 8 bits per texel. Only mode 6 is used: one subset with 4-bit indices
+        BC7,
+    };
+
+    using Block = std::array<glm::u8vec4, 16>;
+
+public:
+    // Size in bytes of a compressed block
+    static std::size_t GetBlockSize(Format format);
+
+    // Value of TextureObject::InternalFormat for the format
+    static std::uint32_t GetInternalFormat(Format format);
+
+    // Compress the block into GetBlockSize(format) bytes
+    static void Compress(Format format, const Block& block, std::byte* output);
+
+private:
+    static void CompressBC1(const Block& block, std::byte* output);
+    static void CompressBC4(const Block& block, int channel, std::byte* output);
+    static void CompressBC7(const Block& block, std::byte* output);
+};
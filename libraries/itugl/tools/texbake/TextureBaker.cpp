@@ -0,0 +1,182 @@
+#include "TextureBaker.h"
+
+#include <ituGL/asset/AssetPackWriter.h>
+#include <ituGL/utils/ThreadPool.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// Blocks compressed by each task. Enough to keep the tasks longer than the cost of scheduling them
+static const int s_blocksPerTask = 4096;
+
+TextureBaker::TextureBaker(ThreadPool& threadPool) : m_threadPool(threadPool)
+{
+}
+
+void TextureBaker::AddImage(const std::string& path, const Settings& settings)
+{
+    Texture texture;
+    texture.path = path;
+    texture.settings = settings;
+    m_textures.push_back(std::move(texture));
+}
+
+bool TextureBaker::Bake(AssetPackWriter& writer)
+{
+    // Decode and filter each image in its own task
+    std::atomic<bool> decoded = true;
+    for (Texture& texture : m_textures)
+    {
+        m_threadPool.Submit([&texture, &decoded]()
+            {
+                if (!DecodeLevels(texture))
+                {
+                    decoded = false;
+                }
+            });
+    }
+    m_threadPool.Wait();
+
+    if (!decoded)
+        return false;
+
+    // Compress all the levels together, split in ranges of block rows, so that big levels use all the threads
+    for (Texture& texture : m_textures)
+    {
+        texture.compressedLevels.resize(texture.levels.size());
+        std::size_t blockSize = BlockCompressor::GetBlockSize(texture.settings.format);
+        for (int level = 0; level < texture.levels.size(); ++level)
+        {
+            const Image& image = texture.levels[level];
+            int blocksX = (image.width + 3) / 4;
+            int blocksY = (image.height + 3) / 4;
+            std::vector<std::byte>& output = texture.compressedLevels[level];
+            output.resize(static_cast<std::size_t>(blocksX) * blocksY * blockSize);
+
+            int blockRowsPerTask = std::max(s_blocksPerTask / blocksX, 1);
+            for (int blockRow = 0; blockRow < blocksY; blockRow += blockRowsPerTask)
+            {
+                int blockRowCount = std::min(blockRowsPerTask, blocksY - blockRow);
+                BlockCompressor::Format format = texture.settings.format;
+                m_threadPool.Submit([&image, format, blockRow, blockRowCount, &output]()
+                    {
+                        CompressBlockRows(image, format, blockRow, blockRowCount, output);
+                    });
+            }
+        }
+    }
+    m_threadPool.Wait();
+
+    bool added = true;
+    for (Texture& texture : m_textures)
+    {
+        const Image& image = texture.levels.front();
+        std::uint32_t internalFormat = BlockCompressor::GetInternalFormat(texture.settings.format);
+        if (!writer.AddTexture2D(texture.path, internalFormat, image.width, image.height, texture.compressedLevels))
+        {
+            std::cout << "ERROR::TEXBAKE::DUPLICATED_ENTRY\n" << texture.path << std::endl;
+            added = false;
+        }
+
+        // The levels are not needed anymore, the writer keeps a copy
+        texture.levels.clear();
+        texture.compressedLevels.clear();
+    }
+    return added;
+}
+
+bool TextureBaker::DecodeLevels(Texture& texture)
+{
+    Image image;
+    int componentCount;
+    stbi_uc* data = stbi_load(texture.path.c_str(), &image.width, &image.height, &componentCount, 4);
+    if (!data)
+    {
+        std::cout << "ERROR::TEXBAKE::IMAGE_NOT_LOADED\n" << texture.path << std::endl;
+        return false;
+    }
+
+    // The global flip option of stb_image can't be used from several threads
+    image.texels.resize(static_cast<std::size_t>(image.width) * image.height);
+    for (int y = 0; y < image.height; ++y)
+    {
+        int sourceRow = texture.settings.flipVertical ? image.height - 1 - y : y;
+        const glm::u8vec4* sourceTexels = reinterpret_cast<const glm::u8vec4*>(data) + static_cast<std::size_t>(sourceRow) * image.width;
+        std::copy(sourceTexels, sourceTexels + image.width, image.texels.begin() + static_cast<std::size_t>(y) * image.width);
+    }
+    stbi_image_free(data);
+
+    texture.levels.push_back(std::move(image));
+    while (texture.settings.generateMipmap && (texture.levels.back().width > 1 || texture.levels.back().height > 1))
+    {
+        Image nextLevel = Downsample(texture.levels.back(), texture.settings.normalMap);
+        texture.levels.push_back(std::move(nextLevel));
+    }
+    return true;
+}
+
+TextureBaker::Image TextureBaker::Downsample(const Image& image, bool normalMap)
+{
+    Image result;
+    result.width = std::max(image.width / 2, 1);
+    result.height = std::max(image.height / 2, 1);
+    result.texels.resize(static_cast<std::size_t>(result.width) * result.height);
+
+    for (int y = 0; y < result.height; ++y)
+    {
+        for (int x = 0; x < result.width; ++x)
+        {
+            // Texels past the edge of odd sizes are clamped
+            glm::vec4 sum(0.0f);
+            for (int offsetY = 0; offsetY < 2; ++offsetY)
+            {
+                for (int offsetX = 0; offsetX < 2; ++offsetX)
+                {
+                    int sourceX = std::min(2 * x + offsetX, image.width - 1);
+                    int sourceY = std::min(2 * y + offsetY, image.height - 1);
+                    sum += glm::vec4(image.texels[static_cast<std::size_t>(sourceY) * image.width + sourceX]);
+                }
+            }
+            glm::vec4 average = sum / 4.0f;
+
+            if (normalMap)
+            {
+                glm::vec3 normal = glm::vec3(average) / 127.5f - 1.0f;
+                float length = glm::length(normal);
+                normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+                average = glm::vec4((normal + 1.0f) * 127.5f, average.a);
+            }
+
+            result.texels[static_cast<std::size_t>(y) * result.width + x] = glm::u8vec4(glm::clamp(glm::round(average), 0.0f, 255.0f));
+        }
+    }
+    return result;
+}
+
+void TextureBaker::CompressBlockRows(const Image& image, BlockCompressor::Format format, int firstBlockRow, int blockRowCount,
+    std::vector<std::byte>& output)
+{
+    int blocksX = (image.width + 3) / 4;
+    std::size_t blockSize = BlockCompressor::GetBlockSize(format);
+
+    BlockCompressor::Block block;
+    for (int blockY = firstBlockRow; blockY < firstBlockRow + blockRowCount; ++blockY)
+    {
+        for (int blockX = 0; blockX < blocksX; ++blockX)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                int x = std::min(blockX * 4 + i % 4, image.width - 1);
+                int y = std::min(blockY * 4 + i / 4, image.height - 1);
+                block[i] = image.texels[static_cast<std::size_t>(y) * image.width + x];
+            }
+
+            std::size_t blockIndex = static_cast<std::size_t>(blockY) * blocksX + blockX;
+            BlockCompressor::Compress(format, block, output.data() + blockIndex * blockSize);
+        }
+    }
+}
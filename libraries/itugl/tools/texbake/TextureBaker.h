@@ -0,0 +1,71 @@
+#pragma once
+
+#include "BlockCompressor.h"
+#include <string>
+#include <vector>
+
+class ThreadPool;
+class AssetPackWriter;
+
+// Converts images into block compressed textures with their full mip chain, ready to be uploaded
+// Images are decoded, filtered and compressed in the threads of the pool
+class TextureBaker
+{
+public:
+    struct Settings
+    {
+        BlockCompressor::Format format = BlockCompressor::Format::BC7;
+
+        // Same meaning as Texture2DLoader::SetFlipVertical
+        bool flipVertical = false;
+
+        // Normals are renormalized when the mip levels are filtered
+        bool normalMap = false;
+
+        bool generateMipmap = true;
+    };
+
+public:
+    TextureBaker(ThreadPool& threadPool);
+
+    // Add an image to be baked with the settings
+    void AddImage(const std::string& path, const Settings& settings);
+
+    // Bake all the images and add them to the pack, named by their path. Returns false if any of them failed
+    bool Bake(AssetPackWriter& writer);
+
+private:
+    // Uncompressed RGBA image
+    struct Image
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<glm::u8vec4> texels;
+    };
+
+    struct Texture
+    {
+        std::string path;
+        Settings settings;
+
+        // Images of the mip levels, the first one is the source
+        std::vector<Image> levels;
+
+        std::vector<std::vector<std::byte>> compressedLevels;
+    };
+
+    // Read the image and generate the levels below it
+    static bool DecodeLevels(Texture& texture);
+
+    // Filter the image to half its size, averaging 2x2 texels
+    static Image Downsample(const Image& image, bool normalMap);
+
+    // Compress a range of block rows of the level
+    static void CompressBlockRows(const Image& image, BlockCompressor::Format format, int firstBlockRow, int blockRowCount,
+        std::vector<std::byte>& output);
+
+private:
+    ThreadPool& m_threadPool;
+
+    std::vector<Texture> m_textures;
+};
@@ -0,0 +1,128 @@
+#include "TextureBaker.h"
+
+#include <ituGL/asset/AssetPackWriter.h>
+#include <ituGL/utils/ThreadPool.h>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+// itugl-texbake: bakes images into block compressed textures with mipmaps, stored in an asset pack
+// The entries are named with the normalized paths of the images, so they can be found with the same paths used to load
+// them. Options apply to the images that follow them. Other files, like shaders, can be stored as they are
+
+static void PrintUsage()
+{
+    std::cout <<
+        "Usage: itugl-texbake -o <pack> [options] <image>...\n"
+        "Options, for the images that follow them:\n"
+        "  --format bc1|bc4|bc5|bc7   Block compressed format (default bc7)\n"
+        "  --flip, --no-flip          Flip the images vertically (default no-flip)\n"
+        "  --normal-map, --color      Renormalize the mipmaps of normal maps (default color)\n"
+        "  --mipmap, --no-mipmap      Generate the mip chain (default mipmap)\n"
+        "General options:\n"
+        "  -j <threads>               Worker threads (default: hardware threads - 1)\n"
+        "  --file <path>              Store the file without changes\n";
+}
+
+static bool ParseFormat(const char* name, BlockCompressor::Format& format)
+{
+    if (std::strcmp(name, "bc1") == 0) format = BlockCompressor::Format::BC1;
+    else if (std::strcmp(name, "bc4") == 0) format = BlockCompressor::Format::BC4;
+    else if (std::strcmp(name, "bc5") == 0) format = BlockCompressor::Format::BC5;
+    else if (std::strcmp(name, "bc7") == 0) format = BlockCompressor::Format::BC7;
+    else return false;
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* outputPath = nullptr;
+    unsigned int threadCount = 0;
+    TextureBaker::Settings settings;
+    std::vector<std::pair<std::string, TextureBaker::Settings>> images;
+    std::vector<std::string> files;
+
+    auto normalizePath = [](const char* path) { return std::filesystem::path(path).lexically_normal().generic_string(); };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "-o" && hasValue)
+        {
+            outputPath = argv[++i];
+        }
+        else if (argument == "-j" && hasValue)
+        {
+            threadCount = static_cast<unsigned int>(std::stoul(argv[++i]));
+        }
+        else if (argument == "--format" && hasValue)
+        {
+            if (!ParseFormat(argv[++i], settings.format))
+            {
+                std::cout << "Unknown format: " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (argument == "--file" && hasValue)
+        {
+            files.push_back(normalizePath(argv[++i]));
+        }
+        else if (argument == "--flip") settings.flipVertical = true;
+        else if (argument == "--no-flip") settings.flipVertical = false;
+        else if (argument == "--normal-map") settings.normalMap = true;
+        else if (argument == "--color") settings.normalMap = false;
+        else if (argument == "--mipmap") settings.generateMipmap = true;
+        else if (argument == "--no-mipmap") settings.generateMipmap = false;
+        else if (argument.starts_with("-"))
+        {
+            PrintUsage();
+            return argument == "-h" || argument == "--help" ? 0 : 1;
+        }
+        else
+        {
+            images.emplace_back(normalizePath(argv[i]), settings);
+        }
+    }
+
+    if (!outputPath || (images.empty() && files.empty()))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    ThreadPool threadPool(threadCount);
+    TextureBaker textureBaker(threadPool);
+    for (const auto& [path, imageSettings] : images)
+    {
+        textureBaker.AddImage(path, imageSettings);
+    }
+
+    AssetPackWriter writer;
+    if (!textureBaker.Bake(writer))
+        return 1;
+
+    for (const std::string& file : files)
+    {
+        if (!writer.AddFile(file))
+        {
+            std::cout << "ERROR::TEXBAKE::FILE_NOT_ADDED\n" << file << std::endl;
+            return 1;
+        }
+    }
+
+    if (!writer.Write(outputPath))
+    {
+        std::cout << "ERROR::TEXBAKE::PACK_NOT_WRITTEN\n" << outputPath << std::endl;
+        return 1;
+    }
+
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - startTime;
+    std::cout << "Baked " << images.size() << " images and " << files.size() << " files into " << outputPath << " in " << duration.count()
+        << " s, using " << threadPool.GetThreadCount() << " threads" << std::endl;
+    return 0;
+}
@@ -1,16 +1,24 @@
 #include "GrassApplication.h"
-#include <ituGL/asset/Texture2DLoader.h>
-#include <ituGL/asset/ShaderLoader.h>
 #include <ituGL/geometry/VertexFormat.h>
 #include <glm/gtx/transform.hpp>
 #include <ituGL/utils/RandomReal.h>
 #include <ituGL/renderer/GBufferRenderPass.h>
 #include <ituGL/renderer/DeferredRenderPass.h>
+#include <ituGL/renderer/UpscaleRenderPass.h>
+#include <ituGL/renderer/OverdrawRenderPass.h>
 #include <ituGL/lighting/Light.h>
+#include <ituGL/lighting/LightClusterGrid.h>
 #include <imgui.h>
 #include <ituGL/asset/ModelLoader.h>
 #include <ituGL/renderer/LightRenderPass.h>
+#include <ituGL/asset/ShaderPermutationManager.h>
+#include <ituGL/asset/CompressedTexture2DLoader.h>
+#include <ituGL/asset/ShaderLoader.h>
 #include <iostream>
+#include <string>
+#include <array>
+#include <algorithm>
+#include <filesystem>
 
 #define STB_PERLIN_IMPLEMENTATION
 #include <stb_perlin.h>
@@ -24,7 +32,9 @@ namespace proj
         m_planeGridConversion(
             m_gridPoints.x / m_planeSize.x, m_gridPoints.y / m_planeSize.z),
         m_generatedGrassStraws(1'000'000),
-        m_renderer(GetDevice())
+        m_renderer(GetDevice()),
+        m_textureLoader(m_threadPool),
+        m_shaderProgramCache("shadercache")
     {
     }
 
@@ -38,6 +48,18 @@ namespace proj
 
         m_heights = CreateHeights(m_gridPoints, glm::ivec2(0));
 
+        // Programs and textures are reloaded when their files are modified
+        m_shaderProgramCache.SetFileWatcher(&m_fileWatcher);
+        m_textureLoader.SetFileWatcher(&m_fileWatcher);
+        m_textureLoader.SetGenerateMipmap(true);
+
+        // Textures in the pack are uploaded straight from the mapped file, without decoding
+        if (std::filesystem::exists("assets.pack") && m_assetPack.Open("assets.pack"))
+        {
+            m_textureLoader.SetAssetPack(&m_assetPack);
+            ShaderLoader::SetAssetPack(&m_assetPack);
+        }
+
         InitializeCamera();
 
         InitializeDeferredMaterials();
@@ -50,6 +72,8 @@ namespace proj
         m_light.SetPosition(glm::vec3(-10.0f));
         m_light.SetIntensity(m_settings.lightIntensity);
 
+        InitializePointLights();
+
         InitializeRenderer();
 
         auto& device = GetDevice();
@@ -61,6 +85,10 @@ namespace proj
     {
         Application::Update();
 
+        m_fileWatcher.Update();
+
+        m_textureLoader.Update();
+
         UpdateInput();
 
         m_renderer.AddModel(m_groundModel, glm::scale(static_cast<glm::vec3>(m_planeSize)));
@@ -74,6 +102,11 @@ namespace proj
 
         m_renderer.AddLight(&m_light);
 
+        for (uint32_t i = 0; i < m_settings.pointLights; ++i)
+        {
+            m_renderer.AddLight(m_pointLights[i].get());
+        }
+
         m_renderer.SetCurrentCamera(m_camera);
     }
 
@@ -81,40 +114,84 @@ namespace proj
     {
         Application::Render();
 
-        GetDevice().Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), true, 1.0f);
+        // Stencil is used by the light volumes in the deferred pass
+        GetDevice().Clear(true, Color(0.0f, 0.0f, 0.0f, 1.0f), true, 1.0f, true, 0);
+
+        // Scale measured on previous frames, the GPU time of this one is not known yet
+        m_dynamicResolution.SetEnabled(m_settings.dynamicResolution);
+        m_dynamicResolution.SetTargetFrameTime(m_settings.targetFrameTime);
+        m_renderer.SetRenderScale(m_dynamicResolution.GetScale());
 
+        m_dynamicResolution.BeginFrame();
         m_renderer.Render();
+        m_dynamicResolution.EndFrame();
 
         RenderGUI();
     }
 
     void GrassApplication::Cleanup()
     {
+        ShaderLoader::SetAssetPack(nullptr);
+        m_assetRegistry.Clear();
+        m_samplerCache.Clear();
+
         Application::Cleanup();
     }
 
     void GrassApplication::InitializeGround()
     {
-        auto albedoTexture = Texture2DLoader::LoadTextureShared("textures/mud_forest_diff_4k.jpg", TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA, true);
-        albedoTexture->Bind();
-        albedoTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR_MIPMAP_LINEAR);
-        albedoTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
-        albedoTexture->GenerateMipmap();
-        albedoTexture->Unbind();
-
-        auto normalTexture = Texture2DLoader::LoadTextureShared("textures/mud_forest_nor_gl_4k.jpg", TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA, false);
-
-        auto specularTexture = Texture2DLoader::LoadTextureShared("textures/mud_forest_arm_4k.jpg", TextureObject::FormatRGB, TextureObject::InternalFormatRGB, false);
+        std::vector<const char*> vertexShaderPaths{ "shaders/ground.vert" };
+        std::vector<const char*> fragmentShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/ground.frag"
+        };
+        std::string gbufferLayoutDefine = "GBUFFER_LAYOUT " + std::to_string(static_cast<int>(m_gbufferLayout));
+        std::array<const char*, 1> defines{ gbufferLayoutDefine.c_str() };
+        auto shaderProgram = m_assetRegistry.LoadShaderProgram(m_shaderProgramCache, vertexShaderPaths, fragmentShaderPaths, defines);
+
+        std::vector<const char*> shadowVertexShaderPaths{ "shaders/shadow.vert" };
+        std::vector<const char*> shadowFragmentShaderPaths{ "shaders/shadow.frag" };
+        auto shadowShaderProgram = m_assetRegistry.LoadShaderProgram(m_shaderProgramCache, shadowVertexShaderPaths, shadowFragmentShaderPaths);
+
+        // Position-only program for the depth pre-pass, with the same transform as ground.vert
+        std::vector<const char*> depthVertexShaderPaths{ "shaders/depth.vert" };
+        auto depthShaderProgram = m_assetRegistry.LoadShaderProgram(m_shaderProgramCache, depthVertexShaderPaths, shadowFragmentShaderPaths);
+
+        // Textures are placeholders until their images are uploaded. Filters set now are kept
+        m_textureLoader.SetFlipVertical(false);
+        m_textureLoader.SetFormat(TextureObject::FormatRGBA);
+        m_textureLoader.SetInternalFormat(TextureObject::InternalFormatRGBA);
+        m_textureLoader.SetPlaceholderColor(glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+        auto albedoTexture = m_assetRegistry.LoadTexture2D(m_textureLoader, "textures/mud_forest_diff_4k.jpg");
+
+        // Trilinear filtering with repeat, the default of the cache. The sampler is kept when the image is uploaded
+        albedoTexture->SetSampler(m_samplerCache.GetSampler(SamplerCache::Desc()));
+
+        // BC5 normal map if it was compressed offline, with a quarter of the memory. Otherwise, a flat normal until it loads
+        std::shared_ptr<Texture2DObject> normalTexture;
+        CompressedTexture2DLoader compressedTextureLoader;
+        const char* compressedNormalPath = "textures/mud_forest_nor_gl_4k.dds";
+        if (std::filesystem::exists(compressedNormalPath) && TextureObject::IsCompressedFormatSupported(TextureObject::InternalFormatBC5))
+        {
+            normalTexture = m_assetRegistry.LoadTexture2D(compressedTextureLoader, compressedNormalPath);
+        }
+        else
+        {
+            m_textureLoader.SetPlaceholderColor(glm::vec4(0.5f, 0.5f, 1.0f, 1.0f));
+            normalTexture = m_assetRegistry.LoadTexture2D(m_textureLoader, "textures/mud_forest_nor_gl_4k.jpg");
+        }
 
-        auto vertexShader = ShaderLoader::Load(Shader::VertexShader, "shaders/ground.vert");
-        auto fragmentShader = ShaderLoader::Load(Shader::FragmentShader, "shaders/ground.frag");
-        auto shaderProgram = std::make_shared<ShaderProgram>();
-        shaderProgram->Build(vertexShader, fragmentShader);
+        // No occlusion, rough, not metallic
+        m_textureLoader.SetFormat(TextureObject::FormatRGB);
+        m_textureLoader.SetInternalFormat(TextureObject::InternalFormatRGB);
+        m_textureLoader.SetPlaceholderColor(glm::vec4(1.0f, 1.0f, 0.0f, 1.0f));
+        auto specularTexture = m_assetRegistry.LoadTexture2D(m_textureLoader, "textures/mud_forest_arm_4k.jpg");
 
-        auto shadowVertexShader = ShaderLoader::Load(Shader::VertexShader, "shaders/shadow.vert");
-        auto shadowFragmentShader = ShaderLoader::Load(Shader::FragmentShader, "shaders/shadow.frag");
-        auto shadowShaderProgram = std::make_shared<ShaderProgram>();
-        shadowShaderProgram->Build(shadowVertexShader, shadowFragmentShader);
+        // Programs compile while the images decode
+        m_shaderProgramCache.Finish(*shaderProgram);
+        m_shaderProgramCache.Finish(*shadowShaderProgram);
+        m_shaderProgramCache.Finish(*depthShaderProgram);
 
         ShaderUniformCollection::NameSet filteredUniforms;
         filteredUniforms.insert("WorldMatrix");
@@ -128,73 +205,114 @@ namespace proj
         material->SetUniformValue("NormalsTexture", normalTexture);
         material->SetUniformValue("SpecularTexture", specularTexture);
 
-        auto lightSpaceMatrixShadowLocation = shadowShaderProgram->GetUniformLocation("LightSpaceMatrix");
-        auto worldMatrixShadowLocation = shadowShaderProgram->GetUniformLocation("WorldMatrix");
-        
-        material->SetShadowShader(shadowShaderProgram,
-            [=](const ShaderProgram& shaderProgram, const Light& light, const glm::mat4& lightSpaceMatrix, const glm::mat4& worldMatrix)
-            {
-                shaderProgram.SetUniform(lightSpaceMatrixShadowLocation, lightSpaceMatrix);
-                
-                shaderProgram.SetUniform(worldMatrixShadowLocation, worldMatrix);
-            });
+        // The setup is done again if the programs are rebuilt, because the locations can change
+        auto setupShadowShader = [=]()
+        {
+            auto lightSpaceMatrixShadowLocation = shadowShaderProgram->GetUniformLocation("LightSpaceMatrix");
+            auto worldMatrixShadowLocation = shadowShaderProgram->GetUniformLocation("WorldMatrix");
+
+            material->SetShadowShader(shadowShaderProgram,
+                [=](const ShaderProgram& shaderProgram, const Light& light, const glm::mat4& lightSpaceMatrix, const glm::mat4& worldMatrix)
+                {
+                    shaderProgram.SetUniform(lightSpaceMatrixShadowLocation, lightSpaceMatrix);
 
-        auto worldMatrixLocation = shaderProgram->GetUniformLocation("WorldMatrix");
-        auto worldViewMatrixLocation = shaderProgram->GetUniformLocation("WorldViewMatrix");
-        auto worldViewProjMatrixLocation = shaderProgram->GetUniformLocation("WorldViewProjMatrix");
-        auto ambientOcclusionLocation = shaderProgram->GetUniformLocation("AmbientOcclusion");
+                    shaderProgram.SetUniform(worldMatrixShadowLocation, worldMatrix);
+                });
+        };
+        setupShadowShader();
+        m_shaderProgramCache.AddReloadCallback(*shadowShaderProgram, setupShadowShader);
+
+        // WorldViewProjMatrix is computed like in the main program, so that the depth matches exactly
+        auto setupDepthShader = [=]()
+        {
+            auto worldViewProjMatrixDepthLocation = depthShaderProgram->GetUniformLocation("WorldViewProjMatrix");
 
-        m_renderer.RegisterShaderProgram(shaderProgram,
-            [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
+            material->SetDepthShader(depthShaderProgram,
+                [=](const ShaderProgram& shaderProgram, const glm::mat4& viewProjMatrix, const glm::mat4& worldMatrix)
+                {
+                    shaderProgram.SetUniform(worldViewProjMatrixDepthLocation, viewProjMatrix * worldMatrix);
+                });
+        };
+        setupDepthShader();
+        m_shaderProgramCache.AddReloadCallback(*depthShaderProgram, setupDepthShader);
+
+        auto registerShaderProgram = [=]()
+        {
+            auto worldMatrixLocation = shaderProgram->GetUniformLocation("WorldMatrix");
+            auto worldViewMatrixLocation = shaderProgram->GetUniformLocation("WorldViewMatrix");
+            auto worldViewProjMatrixLocation = shaderProgram->GetUniformLocation("WorldViewProjMatrix");
+            auto ambientOcclusionLocation = shaderProgram->GetUniformLocation("AmbientOcclusion");
+
+            m_renderer.RegisterShaderProgram(shaderProgram,
+                [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
+                {
+                    shaderProgram.SetUniform(worldMatrixLocation, worldMatrix);
+                    shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
+                    shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+                    shaderProgram.SetUniform(ambientOcclusionLocation, m_settings.ambientOcclusion);
+                },
+                nullptr);
+        };
+        registerShaderProgram();
+        m_shaderProgramCache.AddReloadCallback(*shaderProgram, [=]()
             {
-                shaderProgram.SetUniform(worldMatrixLocation, worldMatrix);
-                shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
-                shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
-                shaderProgram.SetUniform(ambientOcclusionLocation, m_settings.ambientOcclusion);
-            },
-            nullptr);
+                material->RefreshUniforms();
+                registerShaderProgram();
+            });
 
         auto groundMesh = std::make_shared<Mesh>();
-        CreateTerrainMesh(*groundMesh, m_heights);
+        CreateTerrainMesh(*groundMesh, m_geometryHeap, m_heights, m_terrainGridStatistics, m_terrainStatistics);
         m_groundModel = Model(groundMesh);
         m_groundModel.AddMaterial(material);
     }
 
     void GrassApplication::InitializeGrass()
     {
-        Texture2DLoader textureLoader(TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA);
-        textureLoader.SetFlipVertical(true);
-        auto albedoTexture = textureLoader.LoadShared("textures/Grass16.jpg");
-        albedoTexture->Bind();
-        albedoTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR_MIPMAP_LINEAR);
-        albedoTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
-        albedoTexture->GenerateMipmap();
-        albedoTexture->Unbind();
-
-        auto ambientOcclusionTexture = Texture2DLoader::LoadTextureShared("textures/GrassAmbientOcclusion16.jpg", TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA, false);
-        auto roughnessTexture = Texture2DLoader::LoadTextureShared("textures/GrassRoughness16.jpg", TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA, false);
-
         std::vector<const char*> vertexShaderPaths
         {
             "shaders/version330.glsl",
-            "shaders/grass/grassVertices.glsl",
             "shaders/grass/grass.vert"
         };
-        auto vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
-        auto fragmentShader = ShaderLoader::Load(Shader::FragmentShader, "shaders/grass/grass.frag");
-        auto shaderProgram = std::make_shared<ShaderProgram>();
-        shaderProgram->Build(vertexShader, fragmentShader);
+        std::vector<const char*> fragmentShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/grass/grass.frag"
+        };
+        std::string gbufferLayoutDefine = "GBUFFER_LAYOUT " + std::to_string(static_cast<int>(m_gbufferLayout));
+        std::array<const char*, 1> defines{ gbufferLayoutDefine.c_str() };
+        auto shaderProgram = m_assetRegistry.LoadShaderProgram(m_shaderProgramCache, vertexShaderPaths, fragmentShaderPaths, defines);
 
         std::vector<const char*> shadowVertexShaderPaths
         {
             "shaders/version330.glsl",
-            "shaders/grass/grassVertices.glsl",
             "shaders/grass/grassShadow.vert"
         };
-        auto shadowVertexShader = ShaderLoader(Shader::VertexShader).Load(shadowVertexShaderPaths);
-        auto shadowFragmentShader = ShaderLoader::Load(Shader::FragmentShader, "shaders/shadow.frag");
-        auto shadowShaderProgram = std::make_shared<ShaderProgram>();
-        shadowShaderProgram->Build(shadowVertexShader, shadowFragmentShader);
+        std::vector<const char*> shadowFragmentShaderPaths{ "shaders/shadow.frag" };
+        auto shadowShaderProgram = m_assetRegistry.LoadShaderProgram(m_shaderProgramCache, shadowVertexShaderPaths, shadowFragmentShaderPaths);
+
+        std::vector<const char*> depthVertexShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/grass/grassDepth.vert"
+        };
+        auto depthShaderProgram = m_assetRegistry.LoadShaderProgram(m_shaderProgramCache, depthVertexShaderPaths, shadowFragmentShaderPaths);
+
+        m_textureLoader.SetFlipVertical(true);
+        m_textureLoader.SetFormat(TextureObject::FormatRGBA);
+        m_textureLoader.SetInternalFormat(TextureObject::InternalFormatRGBA);
+        m_textureLoader.SetPlaceholderColor(glm::vec4(0.5f, 0.5f, 0.5f, 1.0f));
+        auto albedoTexture = m_assetRegistry.LoadTexture2D(m_textureLoader, "textures/Grass16.jpg");
+        albedoTexture->SetSampler(m_samplerCache.GetSampler(SamplerCache::Desc()));
+
+        m_textureLoader.SetFlipVertical(false);
+        m_textureLoader.SetPlaceholderColor(glm::vec4(1.0f));
+        auto ambientOcclusionTexture = m_assetRegistry.LoadTexture2D(m_textureLoader, "textures/GrassAmbientOcclusion16.jpg");
+        auto roughnessTexture = m_assetRegistry.LoadTexture2D(m_textureLoader, "textures/GrassRoughness16.jpg");
+
+        // Programs compile while the images decode
+        m_shaderProgramCache.Finish(*shaderProgram);
+        m_shaderProgramCache.Finish(*shadowShaderProgram);
+        m_shaderProgramCache.Finish(*depthShaderProgram);
 
         ShaderUniformCollection::NameSet filteredUniforms;
         filteredUniforms.insert("WorldMatrix");
@@ -210,42 +328,77 @@ namespace proj
         material->SetUniformValue("AmbientOcclusionTexture", ambientOcclusionTexture);
         material->SetUniformValue("RoughnessTexture", roughnessTexture);
 
-        auto lightSpaceMatrixShadowLocation = shadowShaderProgram->GetUniformLocation("LightSpaceMatrix");
-        auto worldMatrixShadowLocation = shadowShaderProgram->GetUniformLocation("WorldMatrix");
-        auto currentTimeShadowLocation = shadowShaderProgram->GetUniformLocation("CurrentTime");
-        auto windDirectionShadowLocation = shadowShaderProgram->GetUniformLocation("WindDirection");
-        auto windSpeedShadowLocation = shadowShaderProgram->GetUniformLocation("WindSpeed");
+        // Repeated on reload, like the ground
+        auto setupShadowShader = [=]()
+        {
+            auto lightSpaceMatrixShadowLocation = shadowShaderProgram->GetUniformLocation("LightSpaceMatrix");
+            auto worldMatrixShadowLocation = shadowShaderProgram->GetUniformLocation("WorldMatrix");
+            auto currentTimeShadowLocation = shadowShaderProgram->GetUniformLocation("CurrentTime");
+            auto windDirectionShadowLocation = shadowShaderProgram->GetUniformLocation("WindDirection");
+            auto windSpeedShadowLocation = shadowShaderProgram->GetUniformLocation("WindSpeed");
+
+            material->SetShadowShader(shadowShaderProgram,
+                [=](const ShaderProgram& shaderProgram, const Light& light, const glm::mat4& lightSpaceMatrix, const glm::mat4& worldMatrix)
+                {
+                    shaderProgram.SetUniform(lightSpaceMatrixShadowLocation, lightSpaceMatrix);
+                    shaderProgram.SetUniform(worldMatrixShadowLocation, worldMatrix);
+                    shaderProgram.SetUniform(currentTimeShadowLocation, GetCurrentTime());
+                    shaderProgram.SetUniform(windDirectionShadowLocation, m_settings.windDirection);
+                    shaderProgram.SetUniform(windSpeedShadowLocation, m_settings.windSpeed);
+                });
+        };
+        setupShadowShader();
+        m_shaderProgramCache.AddReloadCallback(*shadowShaderProgram, setupShadowShader);
 
-        material->SetShadowShader(shadowShaderProgram,
-            [=](const ShaderProgram& shaderProgram, const Light& light, const glm::mat4& lightSpaceMatrix, const glm::mat4& worldMatrix)
-            {
-                shaderProgram.SetUniform(lightSpaceMatrixShadowLocation, lightSpaceMatrix);
-                shaderProgram.SetUniform(worldMatrixShadowLocation, worldMatrix);
-                shaderProgram.SetUniform(currentTimeShadowLocation, GetCurrentTime());
-                shaderProgram.SetUniform(windDirectionShadowLocation, m_settings.windDirection);
-                shaderProgram.SetUniform(windSpeedShadowLocation, m_settings.windSpeed);
-            });
+        // Depth pre-pass, with the same transform and wind as grass.vert
+        auto setupDepthShader = [=]()
+        {
+            auto worldViewProjMatrixDepthLocation = depthShaderProgram->GetUniformLocation("WorldViewProjMatrix");
+            auto currentTimeDepthLocation = depthShaderProgram->GetUniformLocation("CurrentTime");
+            auto windDirectionDepthLocation = depthShaderProgram->GetUniformLocation("WindDirection");
+            auto windSpeedDepthLocation = depthShaderProgram->GetUniformLocation("WindSpeed");
 
-        auto worldMatrixLocation = shaderProgram->GetUniformLocation("WorldMatrix");
-        auto worldViewMatrixLocation = shaderProgram->GetUniformLocation("WorldViewMatrix");
-        auto worldViewProjMatrixLocation = shaderProgram->GetUniformLocation("WorldViewProjMatrix");
-        auto currentTimeLocation = shaderProgram->GetUniformLocation("CurrentTime");
-        auto windDirectionLocation = shaderProgram->GetUniformLocation("WindDirection");
-        auto windSpeedLocation = shaderProgram->GetUniformLocation("WindSpeed");
-        auto ambientOcclusionLocation = shaderProgram->GetUniformLocation("AmbientOcclusion");
+            material->SetDepthShader(depthShaderProgram,
+                [=](const ShaderProgram& shaderProgram, const glm::mat4& viewProjMatrix, const glm::mat4& worldMatrix)
+                {
+                    shaderProgram.SetUniform(worldViewProjMatrixDepthLocation, viewProjMatrix * worldMatrix);
+                    shaderProgram.SetUniform(currentTimeDepthLocation, GetCurrentTime());
+                    shaderProgram.SetUniform(windDirectionDepthLocation, m_settings.windDirection);
+                    shaderProgram.SetUniform(windSpeedDepthLocation, m_settings.windSpeed);
+                });
+        };
+        setupDepthShader();
+        m_shaderProgramCache.AddReloadCallback(*depthShaderProgram, setupDepthShader);
 
-        m_renderer.RegisterShaderProgram(shaderProgram,
-            [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
+        auto registerShaderProgram = [=]()
+        {
+            auto worldMatrixLocation = shaderProgram->GetUniformLocation("WorldMatrix");
+            auto worldViewMatrixLocation = shaderProgram->GetUniformLocation("WorldViewMatrix");
+            auto worldViewProjMatrixLocation = shaderProgram->GetUniformLocation("WorldViewProjMatrix");
+            auto currentTimeLocation = shaderProgram->GetUniformLocation("CurrentTime");
+            auto windDirectionLocation = shaderProgram->GetUniformLocation("WindDirection");
+            auto windSpeedLocation = shaderProgram->GetUniformLocation("WindSpeed");
+            auto ambientOcclusionLocation = shaderProgram->GetUniformLocation("AmbientOcclusion");
+
+            m_renderer.RegisterShaderProgram(shaderProgram,
+                [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
+                {
+                    shaderProgram.SetUniform(worldMatrixLocation, worldMatrix);
+                    shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
+                    shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+                    shaderProgram.SetUniform(currentTimeLocation, GetCurrentTime());
+                    shaderProgram.SetUniform(windDirectionLocation, m_settings.windDirection);
+                    shaderProgram.SetUniform(windSpeedLocation, m_settings.windSpeed);
+                    shaderProgram.SetUniform(ambientOcclusionLocation, m_settings.ambientOcclusion);
+                },
+                nullptr);
+        };
+        registerShaderProgram();
+        m_shaderProgramCache.AddReloadCallback(*shaderProgram, [=]()
             {
-                shaderProgram.SetUniform(worldMatrixLocation, worldMatrix);
-                shaderProgram.SetUniform(worldViewMatrixLocation, camera.GetViewMatrix() * worldMatrix);
-                shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
-                shaderProgram.SetUniform(currentTimeLocation, GetCurrentTime());
-                shaderProgram.SetUniform(windDirectionLocation, m_settings.windDirection);
-                shaderProgram.SetUniform(windSpeedLocation, m_settings.windSpeed);
-                shaderProgram.SetUniform(ambientOcclusionLocation, m_settings.ambientOcclusion);
-            },
-            nullptr);
+                material->RefreshUniforms();
+                registerShaderProgram();
+            });
 
         auto grassMesh = std::make_shared<Mesh>();
         CreateGrassMesh(*grassMesh, m_heights, m_grassSubmeshIndex);
@@ -264,53 +417,186 @@ namespace proj
 
     void GrassApplication::InitializeDeferredMaterials()
     {
+        // Submit all the programs first, so that the driver can compile them in parallel
+        std::vector<const char*> deferredVertexShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/deferred.vert"
+        };
+        std::vector<const char*> deferredFragmentShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/deferred.frag"
+        };
+
+        ShaderUniformCollection::NameSet deferredFilteredUniforms;
+        deferredFilteredUniforms.insert("InvProjMatrix");
+        deferredFilteredUniforms.insert("WorldViewProjMatrix");
+        deferredFilteredUniforms.insert("CameraPosition");
+        deferredFilteredUniforms.insert("ShadowMapEnabled");
+        deferredFilteredUniforms.insert("SkyColor");
+        deferredFilteredUniforms.insert("ClusteredLightsEnabled");
+        deferredFilteredUniforms.insert("ClusterDimensions");
+        deferredFilteredUniforms.insert("ClusterDepthParams");
+        deferredFilteredUniforms.insert("ClusterLightDataTexture");
+        deferredFilteredUniforms.insert("ClusterTexture");
+        deferredFilteredUniforms.insert("ClusterLightIndexTexture");
+        deferredFilteredUniforms.insert("RenderScale");
+
+        // The deferred pass picks the variant for each light, see DeferredRenderPass::SetPermutations
+        m_deferredPermutations = std::make_shared<ShaderPermutationManager>(m_shaderProgramCache,
+            deferredVertexShaderPaths, deferredFragmentShaderPaths, deferredFilteredUniforms);
+        unsigned int shadowMapDefine = m_deferredPermutations->AddDefine("SHADOW_MAP");
+        m_deferredPermutations->AddDefine("LIGHT_INDIRECT");
+        m_deferredPermutations->AddDefine("CLUSTERED_LIGHTS");
+        m_deferredPermutations->AddDefine("SHADOW_PCF_RADIUS", 3, m_settings.shadowPCFRadius);
+        m_deferredPermutations->AddDefine("GBUFFER_LAYOUT", 2, static_cast<int>(m_gbufferLayout));
+
+        // First pass with the directional light, with and without shadows
+        ShaderPermutationManager::Key firstPassKey = m_deferredPermutations->GetDefaultKey();
+        firstPassKey = m_deferredPermutations->SetDefineValue(firstPassKey, m_deferredPermutations->FindDefine("LIGHT_INDIRECT"), 1);
+        firstPassKey = m_deferredPermutations->SetDefineValue(firstPassKey, m_deferredPermutations->FindDefine("CLUSTERED_LIGHTS"), 1);
+        m_deferredPermutations->Prebuild(m_deferredPermutations->SetDefineValue(firstPassKey, shadowMapDefine, 1));
+        m_deferredPermutations->Prebuild(firstPassKey);
+
+        std::vector<const char*> lightVolumeVertexShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/lightvolume.vert"
+        };
+        std::vector<const char*> lightVolumeFragmentShaderPaths
         {
-            std::vector<const char*> vertexShaderPaths;
-            vertexShaderPaths.push_back("shaders/version330.glsl");
-            vertexShaderPaths.push_back("shaders/deferred.vert");
-            Shader vertexShader = ShaderLoader(Shader::VertexShader).Load(vertexShaderPaths);
+            "shaders/version330.glsl",
+            "shaders/lightvolume.frag"
+        };
+        auto lightVolumeShaderProgram = m_assetRegistry.LoadShaderProgram(m_shaderProgramCache, lightVolumeVertexShaderPaths, lightVolumeFragmentShaderPaths);
 
-            std::vector<const char*> fragmentShaderPaths;
-            fragmentShaderPaths.push_back("shaders/version330.glsl");
-            fragmentShaderPaths.push_back("shaders/utils.glsl");
-            fragmentShaderPaths.push_back("shaders/lambert-ggx.glsl");
-            fragmentShaderPaths.push_back("shaders/lighting.glsl");
-            fragmentShaderPaths.push_back("shaders/deferred.frag");
-            Shader fragmentShader = ShaderLoader(Shader::FragmentShader).Load(fragmentShaderPaths);
+        std::vector<const char*> upscaleVertexShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/fullscreen.vert"
+        };
+        std::vector<const char*> upscaleFragmentShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/upscale.frag"
+        };
+        auto upscaleShaderProgram = m_assetRegistry.LoadShaderProgram(m_shaderProgramCache, upscaleVertexShaderPaths, upscaleFragmentShaderPaths);
 
-            auto shaderProgramPtr = std::make_shared<ShaderProgram>();
-            shaderProgramPtr->Build(vertexShader, fragmentShader);
+        std::vector<const char*> overdrawVertexShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/fullscreen.vert"
+        };
+        std::vector<const char*> overdrawFragmentShaderPaths
+        {
+            "shaders/version330.glsl",
+            "shaders/overdraw.frag"
+        };
+        auto overdrawShaderProgram = m_assetRegistry.LoadShaderProgram(m_shaderProgramCache, overdrawVertexShaderPaths, overdrawFragmentShaderPaths);
+
+        m_deferredPermutations->SetMaterialSetupFunction([=](Material& material, ShaderPermutationManager::Key)
+            {
+                std::shared_ptr<ShaderProgram> shaderProgramPtr = material.GetShaderProgram();
+
+                auto invViewMatrixLocation = shaderProgramPtr->GetUniformLocation("InvViewMatrix");
+                auto invProjMatrixLocation = shaderProgramPtr->GetUniformLocation("InvProjMatrix");
+                auto cameraPositionLocation = shaderProgramPtr->GetUniformLocation("CameraPosition");
+                auto worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
+                auto skyColorLocation = shaderProgramPtr->GetUniformLocation("SkyColor");
+
+                m_renderer.RegisterShaderProgram(shaderProgramPtr,
+                    [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
+                    {
+                        if (cameraChanged)
+                        {
+                            shaderProgram.SetUniform(invViewMatrixLocation, glm::inverse(camera.GetViewMatrix()));
+                            shaderProgram.SetUniform(invProjMatrixLocation, glm::inverse(camera.GetProjectionMatrix()));
+                            shaderProgram.SetUniform(cameraPositionLocation, m_cameraPosition);
+                        }
+                        shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+                        shaderProgram.SetUniform(skyColorLocation, m_settings.skyColor);
+                    },
+                    GetUpdateLightsFunction(shaderProgramPtr));
+
+                // Variants are created while rendering, when the G-buffer already exists
+                material.SetUniformValue("DepthTexture", m_gbufferRenderPass->GetDepthTexture());
+                material.SetUniformValue("AlbedoTexture", m_gbufferRenderPass->GetAlbedoTexture());
+                material.SetUniformValue("NormalTexture", m_gbufferRenderPass->GetNormalTexture());
+                material.SetUniformValue("SpecularTexture", m_gbufferRenderPass->GetSpecularTexture());
+            });
+        {
+            auto shaderProgramPtr = lightVolumeShaderProgram;
+            m_shaderProgramCache.Finish(*shaderProgramPtr);
 
             ShaderUniformCollection::NameSet filteredUniforms;
-            filteredUniforms.insert("InvProjMatrix");
             filteredUniforms.insert("WorldViewProjMatrix");
-            filteredUniforms.insert("CameraPosition");
-            filteredUniforms.insert("WorldViewProjMatrix");
-            filteredUniforms.insert("ShadowMapEnabled");
-            filteredUniforms.insert("SkyColor");
+            filteredUniforms.insert("CopyDepth");
 
-            auto invViewMatrixLocation = shaderProgramPtr->GetUniformLocation("InvViewMatrix");
-            auto invProjMatrixLocation = shaderProgramPtr->GetUniformLocation("InvProjMatrix");
-            auto cameraPositionLocation = shaderProgramPtr->GetUniformLocation("CameraPosition");
-            auto worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
-            auto shadowMapEnabledLocation = shaderProgramPtr->GetUniformLocation("ShadowMapEnabled");
-            auto skyColorLocation = shaderProgramPtr->GetUniformLocation("SkyColor");
+            auto registerShaderProgram = [=]()
+            {
+                auto worldViewProjMatrixLocation = shaderProgramPtr->GetUniformLocation("WorldViewProjMatrix");
 
-            m_renderer.RegisterShaderProgram(shaderProgramPtr,
-                [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
-                {
-                    if (cameraChanged)
+                m_renderer.RegisterShaderProgram(shaderProgramPtr,
+                    [=](const ShaderProgram& shaderProgram, const glm::mat4& worldMatrix, const Camera& camera, bool cameraChanged)
                     {
-                        shaderProgram.SetUniform(invViewMatrixLocation, glm::inverse(camera.GetViewMatrix()));
-                        shaderProgram.SetUniform(invProjMatrixLocation, glm::inverse(camera.GetProjectionMatrix()));
-                        shaderProgram.SetUniform(cameraPositionLocation, m_cameraPosition);
-                    }
-                    shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
-                    shaderProgram.SetUniform(shadowMapEnabledLocation, static_cast<int>(m_settings.shadowMapEnabled));
-                    shaderProgram.SetUniform(skyColorLocation, m_settings.skyColor);
-                },
-                GetUpdateLightsFunction(shaderProgramPtr));
-            m_deferredMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+                        shaderProgram.SetUniform(worldViewProjMatrixLocation, camera.GetViewProjectionMatrix() * worldMatrix);
+                    },
+                    nullptr);
+            };
+            registerShaderProgram();
+            m_lightVolumeMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+            m_shaderProgramCache.AddReloadCallback(*shaderProgramPtr, [=]()
+                {
+                    m_lightVolumeMaterial->RefreshUniforms();
+                    registerShaderProgram();
+                });
+        }
+        {
+            auto shaderProgramPtr = upscaleShaderProgram;
+            m_shaderProgramCache.Finish(*shaderProgramPtr);
+
+            ShaderUniformCollection::NameSet filteredUniforms;
+            filteredUniforms.insert("RenderScale");
+
+            m_upscaleMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+            m_shaderProgramCache.AddReloadCallback(*shaderProgramPtr, [=]() { m_upscaleMaterial->RefreshUniforms(); });
+        }
+        {
+            auto shaderProgramPtr = overdrawShaderProgram;
+            m_shaderProgramCache.Finish(*shaderProgramPtr);
+
+            ShaderUniformCollection::NameSet filteredUniforms;
+            filteredUniforms.insert("OverdrawCount");
+            filteredUniforms.insert("MaxOverdrawCount");
+
+            m_overdrawMaterial = std::make_shared<Material>(shaderProgramPtr, filteredUniforms);
+            m_shaderProgramCache.AddReloadCallback(*shaderProgramPtr, [=]() { m_overdrawMaterial->RefreshUniforms(); });
+        }
+    }
+
+    void GrassApplication::InitializePointLights()
+    {
+        RandomReal randomX(0.0f, static_cast<float>(m_planeSize.x));
+        RandomReal randomZ(0.0f, static_cast<float>(m_planeSize.z));
+        RandomReal randomColor(0.2f, 1.0f);
+        RandomReal randomRange(0.5f, 1.5f);
+        for (uint32_t i = 0; i < m_maxPointLights; i++)
+        {
+            float x = randomX.Get();
+            float z = randomZ.Get();
+            unsigned int xi = std::min(static_cast<unsigned int>(x * m_planeGridConversion.x), m_gridPoints.x - 1);
+            unsigned int zi = std::min(static_cast<unsigned int>(z * m_planeGridConversion.y), m_gridPoints.y - 1);
+            float y = m_heights[xi + zi * m_gridPoints.x] * m_planeSize.y + 0.5f;
+
+            // No shadows, so they can be shaded in the clustered pass
+            auto light = std::make_unique<PointLight>(false);
+            light->SetPosition(glm::vec3(x, y, z));
+            light->SetColor(glm::vec3(randomColor.Get(), randomColor.Get(), randomColor.Get()));
+            light->SetIntensity(1.0f);
+            float range = randomRange.Get();
+            light->SetDistanceAttenuation(glm::vec2(range * 0.25f, range));
+            m_pointLights.push_back(std::move(light));
         }
     }
 
@@ -353,11 +639,58 @@ namespace proj
         ImGui::SliderFloat("Camera sensitivity", &m_settings.cameraSensitivity, 0.01f, 1.0f);
 
         ImGui::Checkbox("Shadowmap enabled", &m_settings.shadowMapEnabled);
+        ImGui::SliderInt("Shadow PCF radius", &m_settings.shadowPCFRadius, 0, 3);
+
+        int pointLights = static_cast<int>(m_settings.pointLights);
+        ImGui::SliderInt("Point lights", &pointLights, 0, m_maxPointLights);
+        m_settings.pointLights = static_cast<uint32_t>(pointLights);
+
+        ImGui::Checkbox("Dynamic resolution", &m_settings.dynamicResolution);
+        ImGui::SliderFloat("Target GPU time (ms)", &m_settings.targetFrameTime, 4.0f, 33.0f);
+        ImGui::Text("GPU time: %.2f ms, render scale: %.2f", m_dynamicResolution.GetGPUFrameTime(), m_dynamicResolution.GetScale());
+
+        ImGui::Text("Terrain ACMR: %.3f (grid %.3f), ATVR: %.3f (grid %.3f)",
+            m_terrainStatistics.GetACMR(), m_terrainGridStatistics.GetACMR(), m_terrainStatistics.GetATVR(), m_terrainGridStatistics.GetATVR());
+
+        // Memory is only queried while the header is open, it binds every texture
+        if (ImGui::CollapsingHeader("Assets"))
+        {
+            const char* assetTypeNames[] = { "Textures", "Shader programs", "Models" };
+            for (int i = 0; i < static_cast<int>(AssetRegistry::AssetType::Count); ++i)
+            {
+                AssetRegistry::MemoryUsage memoryUsage = m_assetRegistry.GetMemoryUsage(static_cast<AssetRegistry::AssetType>(i));
+                ImGui::Text("%s: %u, %.2f MB", assetTypeNames[i], memoryUsage.assetCount, memoryUsage.size / (1024.0f * 1024.0f));
+            }
+            ImGui::Text("Shared loads: %u of %u", m_assetRegistry.GetHitCount(), m_assetRegistry.GetHitCount() + m_assetRegistry.GetMissCount());
+            if (ImGui::Button("Evict unused assets"))
+                m_assetRegistry.EvictUnused();
+        }
+
+        ImGui::Checkbox("Depth pre-pass", &m_settings.depthPrePass);
+        ImGui::Checkbox("Overdraw view", &m_settings.overdrawView);
+        ImGui::Checkbox("Batch drawcalls", &m_settings.batchDrawcalls);
+        ImGui::Text("Batches: %u for %u drawcalls%s", m_renderer.GetBatchCount(), m_renderer.GetBatchedDrawcallCount(),
+            GetDevice().IsMultiDrawIndirectSupported() ? " (indirect)" : "");
+
+        // Without anisotropic filtering the limit is 1, and the slider is hidden
+        float maxSupportedAnisotropy = SamplerObject::GetMaxSupportedAnisotropy();
+        m_settings.maxAnisotropy = std::clamp(m_settings.maxAnisotropy, 1.0f, maxSupportedAnisotropy);
+        if (maxSupportedAnisotropy > 1.0f)
+            ImGui::SliderFloat("Max anisotropy", &m_settings.maxAnisotropy, 1.0f, maxSupportedAnisotropy);
+        ImGui::Text("Samplers: %u", m_samplerCache.GetSamplerCount());
 
         if (ImGui::Button("Reset settings"))
             m_settings = m_defaultSettings;
 
         m_lightRenderPass->SetShadowMapEnabled(m_settings.shadowMapEnabled);
+        m_deferredRenderPass->SetShadowMapEnabled(m_settings.shadowMapEnabled);
+        m_deferredPermutations->SetDefaultValue(m_deferredPermutations->FindDefine("SHADOW_PCF_RADIUS"), m_settings.shadowPCFRadius);
+        m_gbufferRenderPass->SetDepthPrePassEnabled(m_settings.depthPrePass);
+        m_gbufferRenderPass->SetOverdrawCountEnabled(m_settings.overdrawView);
+        m_overdrawRenderPass->SetEnabled(m_settings.overdrawView);
+        m_renderer.SetBatchingEnabled(m_settings.batchDrawcalls);
+        if (m_settings.maxAnisotropy != m_samplerCache.GetMaxAnisotropy())
+            m_samplerCache.SetMaxAnisotropy(m_settings.maxAnisotropy);
 
         m_imGui.EndFrame();
     }
@@ -401,17 +734,80 @@ namespace proj
     {
         int width, height;
         GetMainWindow().GetDimensions(width, height);
-        auto gbufferRenderpass = std::make_unique<GBufferRenderPass>(width, height);
+        auto gbufferRenderpass = std::make_unique<GBufferRenderPass>(width, height, m_gbufferLayout);
+        m_gbufferRenderPass = gbufferRenderpass.get();
 
-        m_deferredMaterial->SetUniformValue("DepthTexture", gbufferRenderpass->GetDepthTexture());
-        m_deferredMaterial->SetUniformValue("AlbedoTexture", gbufferRenderpass->GetAlbedoTexture());
-        m_deferredMaterial->SetUniformValue("NormalTexture", gbufferRenderpass->GetNormalTexture());
-        m_deferredMaterial->SetUniformValue("SpecularTexture", gbufferRenderpass->GetSpecularTexture());
+        m_lightVolumeMaterial->SetUniformValue("DepthTexture", gbufferRenderpass->GetDepthTexture());
         auto lightRenderPass = std::make_unique<LightRenderPass>();
         m_lightRenderPass = lightRenderPass.get();
         m_renderer.AddRenderPass(std::move(lightRenderPass));
         m_renderer.AddRenderPass(std::move(gbufferRenderpass));
-        m_renderer.AddRenderPass(std::make_unique<DeferredRenderPass>(m_deferredMaterial));
+        auto lightClusterGrid = std::make_shared<LightClusterGrid>(glm::uvec3(16, 9, 24), m_maxPointLights);
+
+        // G-buffer and lighting use part of the render targets, depending on the dynamic resolution scale
+        InitializeLightingTarget(width, height);
+        m_renderer.SetRenderDimensions(width, height);
+        auto deferredRenderPass = std::make_unique<DeferredRenderPass>(nullptr, lightClusterGrid, m_lightVolumeMaterial, m_lightingFramebuffer);
+        deferredRenderPass->SetPermutations(m_deferredPermutations);
+        m_deferredRenderPass = deferredRenderPass.get();
+        m_renderer.AddRenderPass(std::move(deferredRenderPass));
+
+        // Replaces the lighting result when enabled
+        auto overdrawRenderPass = std::make_unique<OverdrawRenderPass>(m_overdrawMaterial, m_gbufferRenderPass->GetFramebuffer(), m_lightingFramebuffer);
+        m_overdrawRenderPass = overdrawRenderPass.get();
+        m_renderer.AddRenderPass(std::move(overdrawRenderPass));
+
+        m_upscaleMaterial->SetUniformValue("SourceTexture", m_lightingTexture);
+        m_renderer.AddRenderPass(std::make_unique<UpscaleRenderPass>(m_upscaleMaterial));
+
+        GetDevice().AddFramebufferResizedCallback([this](GLsizei width, GLsizei height) { ResizeRenderTargets(width, height); });
+    }
+
+    void GrassApplication::InitializeLightingTarget(int width, int height)
+    {
+        // Bilinear filter for the upscale
+        m_lightingTexture = std::make_shared<Texture2DObject>();
+        m_lightingTexture->Bind();
+        m_lightingTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA8);
+        m_lightingTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_LINEAR);
+        m_lightingTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_LINEAR);
+        m_lightingTexture->SetParameter(TextureObject::ParameterEnum::WrapS, GL_CLAMP_TO_EDGE);
+        m_lightingTexture->SetParameter(TextureObject::ParameterEnum::WrapT, GL_CLAMP_TO_EDGE);
+
+        // Depth and stencil for the light volumes
+        m_lightingDepthTexture = std::make_shared<Texture2DObject>();
+        m_lightingDepthTexture->Bind();
+        m_lightingDepthTexture->SetImage(0, width, height, TextureObject::FormatDepthStencil, TextureObject::InternalFormatDepth24Stencil8);
+        m_lightingDepthTexture->SetParameter(TextureObject::ParameterEnum::MinFilter, GL_NEAREST);
+        m_lightingDepthTexture->SetParameter(TextureObject::ParameterEnum::MagFilter, GL_NEAREST);
+        Texture2DObject::Unbind();
+
+        // With direct state access, the attachments are set without binding the framebuffer
+        bool bindFramebuffer = !GetDevice().IsDirectStateAccessSupported();
+        m_lightingFramebuffer = std::make_shared<FramebufferObject>();
+        if (bindFramebuffer)
+            m_lightingFramebuffer->Bind();
+        m_lightingFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::Color0, *m_lightingTexture);
+        m_lightingFramebuffer->SetTexture(FramebufferObject::Target::Draw, FramebufferObject::Attachment::DepthStencil, *m_lightingDepthTexture);
+        if (bindFramebuffer)
+            FramebufferObject::Unbind();
+    }
+
+    void GrassApplication::ResizeRenderTargets(int width, int height)
+    {
+        // Minimized window
+        if (width <= 0 || height <= 0)
+            return;
+
+        m_gbufferRenderPass->Resize(width, height);
+
+        m_lightingTexture->Bind();
+        m_lightingTexture->SetImage(0, width, height, TextureObject::FormatRGBA, TextureObject::InternalFormatRGBA8);
+        m_lightingDepthTexture->Bind();
+        m_lightingDepthTexture->SetImage(0, width, height, TextureObject::FormatDepthStencil, TextureObject::InternalFormatDepth24Stencil8);
+        Texture2DObject::Unbind();
+
+        m_renderer.SetRenderDimensions(width, height);
     }
 
     void GrassApplication::UpdateInput()
@@ -553,7 +949,8 @@ namespace proj
         return { tangent, bitangent };
     }
 
-    void GrassApplication::CreateTerrainMesh(Mesh& mesh, const std::vector<float>& heights) const
+    void GrassApplication::CreateTerrainMesh(Mesh& mesh, GeometryHeap& geometryHeap, const std::vector<float>& heights,
+        MeshOptimizer::VertexCacheStatistics& gridStatistics, MeshOptimizer::VertexCacheStatistics& optimizedStatistics) const
     {
         // Define the vertex structure
         struct Vertex
@@ -682,8 +1079,20 @@ namespace proj
             }
         }
 
-        mesh.AddSubmesh<Vertex, unsigned int, VertexFormat::LayoutIterator>(Drawcall::Primitive::Triangles, vertices, indices,
-            vertexFormat.LayoutBegin(static_cast<int>(vertices.size()), true /* interleaved */), vertexFormat.LayoutEnd());
+        // Rows of quads reuse few vertices from the previous row, reorder the triangles to transform fewer vertices
+        unsigned int vertexCount = static_cast<unsigned int>(vertices.size());
+        gridStatistics = MeshOptimizer::AnalyzeVertexCache(indices, vertexCount);
+        MeshOptimizer::OptimizeVertexCache(indices, vertexCount);
+        MeshOptimizer::OptimizeOverdraw(indices, std::as_bytes(std::span(vertices)), sizeof(Vertex));
+        vertexCount = MeshOptimizer::OptimizeVertexFetch(indices, std::as_writable_bytes(std::span(vertices)), sizeof(Vertex));
+        vertices.resize(vertexCount);
+        optimizedStatistics = MeshOptimizer::AnalyzeVertexCache(indices, vertexCount);
+
+        // The terrain takes a range of the geometry heap instead of its own buffers and VAO
+        std::span<const GLubyte> vertexData(reinterpret_cast<const GLubyte*>(vertices.data()), vertices.size() * sizeof(Vertex));
+        std::span<const GLubyte> elementData(reinterpret_cast<const GLubyte*>(indices.data()), indices.size() * sizeof(unsigned int));
+        unsigned int heapDataIndex = mesh.AddHeapData(geometryHeap, vertexFormat, vertexData, elementData, Data::Type::UInt);
+        mesh.AddHeapSubmesh(heapDataIndex, Drawcall::Primitive::Triangles, 0, static_cast<GLsizei>(indices.size()));
     }
 
     void GrassApplication::CreateGrassMesh(Mesh& mesh, const std::vector<float>& heights, uint32_t& grassSubmeshIndex) const
@@ -6,14 +6,30 @@
 #include <ituGL/shader/Material.h>
 #include <ituGL/texture/Texture2DObject.h>
 #include <ituGL/geometry/Model.h>
+#include <ituGL/geometry/MeshOptimizer.h>
+#include <ituGL/geometry/GeometryHeap.h>
 #include <ituGL/renderer/Renderer.h>
+#include <ituGL/renderer/GBufferRenderPass.h>
+#include <ituGL/renderer/DynamicResolution.h>
+#include <ituGL/texture/FramebufferObject.h>
 #include <ituGL/lighting/PointLight.h>
 #include <ituGL/lighting/SpotLight.h>
 #include <ituGL/lighting/DirectionalLight.h>
 #include <ituGL/utils/DearImGui.h>
+#include <ituGL/asset/ShaderProgramCache.h>
+#include <ituGL/asset/FileWatcher.h>
+#include <ituGL/asset/AsyncTexture2DLoader.h>
+#include <ituGL/asset/AssetPack.h>
+#include <ituGL/asset/AssetRegistry.h>
+#include <ituGL/texture/SamplerCache.h>
+#include <ituGL/utils/ThreadPool.h>
 #include <vector>
+#include <memory>
 
 class LightRenderPass;
+class DeferredRenderPass;
+class ShaderPermutationManager;
+class OverdrawRenderPass;
 
 namespace proj
 {
@@ -39,6 +55,17 @@ namespace proj
             float cameraSensitivity = 0.25f;
 
             bool shadowMapEnabled = true;
+            int shadowPCFRadius = 1;
+
+            uint32_t pointLights = 0;
+
+            bool dynamicResolution = true;
+            float targetFrameTime = 16.0f;
+
+            bool depthPrePass = true;
+            bool overdrawView = false;
+            bool batchDrawcalls = true;
+            float maxAnisotropy = 8.0f;
         };
     public:
         GrassApplication();
@@ -52,19 +79,26 @@ namespace proj
         void InitializeGrass();
         void InitializeCamera();
         void InitializeDeferredMaterials();
+        void InitializePointLights();
         void RenderGUI();
         Renderer::UpdateLightsFunction GetUpdateLightsFunction(
             std::shared_ptr<ShaderProgram> shaderProgram);
         void InitializeRenderer();
+        void InitializeLightingTarget(int width, int height);
+        void ResizeRenderTargets(int width, int height);
         void UpdateInput();
         std::vector<float> CreateHeights(
             glm::uvec2 gridPoints, glm::ivec2 coords) const;
         void CreateTerrainMesh(
-            Mesh& mesh, const std::vector<float>& heights) const;
+            Mesh& mesh, GeometryHeap& geometryHeap, const std::vector<float>& heights,
+            MeshOptimizer::VertexCacheStatistics& gridStatistics, MeshOptimizer::VertexCacheStatistics& optimizedStatistics) const;
         void CreateGrassMesh(Mesh& mesh, const std::vector<float>& heights, uint32_t& grassSubmeshIndex) const;
 
         Camera m_camera;
         glm::vec3 m_cameraPosition = glm::vec3(0.0f, 2.5f, 0.0f);
+
+        // Shared buffers of the static meshes, declared before the models so it outlives them
+        GeometryHeap m_geometryHeap;
         Model m_groundModel;
         Model m_grassModel;
         float m_cameraYaw = 45.0f;
@@ -79,13 +113,54 @@ namespace proj
         Settings m_defaultSettings = m_settings;
         uint32_t m_grassSubmeshIndex;
         std::vector<float> m_heights;
+
+        // Vertex shader invocations of the terrain, in grid order and optimized
+        MeshOptimizer::VertexCacheStatistics m_terrainGridStatistics;
+        MeshOptimizer::VertexCacheStatistics m_terrainStatistics;
         std::shared_ptr<Material> m_gbufferMaterial;
-        std::shared_ptr<Material> m_deferredMaterial;
+        GBufferRenderPass::Layout m_gbufferLayout = GBufferRenderPass::Layout::PackedNormal16;
+        std::shared_ptr<ShaderPermutationManager> m_deferredPermutations;
+        std::shared_ptr<Material> m_lightVolumeMaterial;
+        std::shared_ptr<Material> m_upscaleMaterial;
+        std::shared_ptr<Material> m_overdrawMaterial;
         Renderer m_renderer;
+
+        // Modified shaders and textures are reloaded without restarting
+        FileWatcher m_fileWatcher;
+
+        // Baked textures and shaders, used instead of the source files when present
+        AssetPack m_assetPack;
+
+        // Images are decoded in the worker threads and uploaded over several frames, showing placeholders meanwhile
+        ThreadPool m_threadPool;
+        AsyncTexture2DLoader m_textureLoader;
+
+        // Program binaries stored on disk, to skip compiling the shaders on the next runs
+        ShaderProgramCache m_shaderProgramCache;
+
+        // Textures and programs loaded once and shared by all the materials that use them
+        AssetRegistry m_assetRegistry;
+
+        // Samplers shared by the material textures, so the anisotropy is changed for all of them at once
+        SamplerCache m_samplerCache;
         LightRenderPass* m_lightRenderPass = nullptr;
+        DeferredRenderPass* m_deferredRenderPass = nullptr;
+        GBufferRenderPass* m_gbufferRenderPass = nullptr;
+        OverdrawRenderPass* m_overdrawRenderPass = nullptr;
+
+        // Scaled output of the deferred pass, upscaled to the backbuffer
+        std::shared_ptr<Texture2DObject> m_lightingTexture;
+        std::shared_ptr<Texture2DObject> m_lightingDepthTexture;
+        std::shared_ptr<FramebufferObject> m_lightingFramebuffer;
+
+        DynamicResolution m_dynamicResolution;
 
         DirectionalLight m_light;
 
+        // Lights without shadows, shaded with the light clusters
+        std::vector<std::unique_ptr<PointLight>> m_pointLights;
+        uint32_t m_maxPointLights = 1024;
+
         bool m_keyFPressed = false;
         bool m_firstMouseMove = true;
 
@@ -1,3 +1,4 @@
+#include "utils.glsl"
 
 uniform vec3 AmbientColor;
 
@@ -0,0 +1,45 @@
+#include "lighting.glsl"
+
+// The uniform is only a fallback for shaders built without the define
+#ifndef CLUSTERED_LIGHTS
+uniform bool ClusteredLightsEnabled;
+#define CLUSTERED_LIGHTS ClusteredLightsEnabled
+#endif
+
+uniform ivec3 ClusterDimensions;
+uniform vec2 ClusterDepthParams;
+uniform sampler2D ClusterLightDataTexture;
+uniform usampler2D ClusterTexture;
+uniform usampler2D ClusterLightIndexTexture;
+
+// Get the cluster that contains a fragment, from its screen coordinates and its distance to the camera plane
+ivec3 GetCluster(vec2 screenCoord, float viewDepth)
+{
+	ivec2 tile = ivec2(screenCoord * vec2(ClusterDimensions.xy));
+	int slice = int(log(viewDepth) * ClusterDepthParams.x + ClusterDepthParams.y);
+	return clamp(ivec3(tile, slice), ivec3(0), ClusterDimensions - ivec3(1));
+}
+
+// Add the contribution of all the lights assigned to the cluster of the fragment
+vec3 ComputeClusteredLighting(vec3 position, vec3 viewPosition, vec2 screenCoord, SurfaceData data, vec3 viewDir)
+{
+	ivec3 cluster = GetCluster(screenCoord, -viewPosition.z);
+	uvec2 range = texelFetch(ClusterTexture, ivec2(cluster.y * ClusterDimensions.x + cluster.x, cluster.z), 0).rg;
+
+	int indexTextureWidth = textureSize(ClusterLightIndexTexture, 0).x;
+
+	vec3 light = vec3(0.0f);
+	for (int i = int(range.x); i < int(range.x + range.y); ++i)
+	{
+		int lightIndex = int(texelFetch(ClusterLightIndexTexture, ivec2(i % indexTextureWidth, i / indexTextureWidth), 0).r);
+
+		// Each light is stored in one row: color, position, direction and attenuation
+		vec3 lightColor = texelFetch(ClusterLightDataTexture, ivec2(0, lightIndex), 0).rgb;
+		vec3 lightPosition = texelFetch(ClusterLightDataTexture, ivec2(1, lightIndex), 0).xyz;
+		vec3 lightDirection = texelFetch(ClusterLightDataTexture, ivec2(2, lightIndex), 0).xyz;
+		vec4 lightAttenuation = texelFetch(ClusterLightDataTexture, ivec2(3, lightIndex), 0);
+
+		light += ComputeLight(data, viewDir, position, lightColor, lightPosition, lightDirection, lightAttenuation);
+	}
+	return light;
+}
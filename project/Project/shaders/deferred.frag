@@ -1,5 +1,8 @@
-//Inputs
-in vec2 TexCoord;
+#include "utils.glsl"
+#include "gbuffer.glsl"
+#include "lambert-ggx.glsl"
+#include "lighting.glsl"
+#include "clustered.glsl"
 
 //Outputs
 out vec4 FragColor;
@@ -14,7 +17,20 @@ uniform mat4 InvProjMatrix;
 uniform vec3 CameraPosition;
 uniform sampler2D LightDepthTexture;
 uniform mat4 LightSpaceMatrix;
+
+// Constant when the shader is built as a permutation, so the shadow code is removed when disabled
+#ifndef SHADOW_MAP
 uniform bool ShadowMapEnabled;
+#define SHADOW_MAP ShadowMapEnabled
+#endif
+
+// Shadow samples in each direction from the center, for percentage closer filtering
+#ifndef SHADOW_PCF_RADIUS
+#define SHADOW_PCF_RADIUS 1
+#endif
+
+// Fraction of the G-buffer used, with dynamic resolution
+uniform vec2 RenderScale;
 
 float CalculateShadow(vec3 fragPosition, vec3 normalVector, vec3 lightVector)
 {
@@ -34,48 +50,75 @@ float CalculateShadow(vec3 fragPosition, vec3 normalVector, vec3 lightVector)
 	
 	float shadow = 0.0f;
 	vec2 texelSize = 1.0f / textureSize(LightDepthTexture, 0);
-	for (int x = -1; x <= 1; x++)
-		for (int y = -1; y <= 1; y++)
+	for (int x = -SHADOW_PCF_RADIUS; x <= SHADOW_PCF_RADIUS; x++)
+		for (int y = -SHADOW_PCF_RADIUS; y <= SHADOW_PCF_RADIUS; y++)
 		{
 			float depth = texture(LightDepthTexture, projectionCoords.xy + vec2(x, y) * texelSize).r;
 			shadow += currentDepth - shadowBias > depth ? 1.0f : 0.0f;
 		}
-	shadow /= 9.0f;
+	shadow /= float((2 * SHADOW_PCF_RADIUS + 1) * (2 * SHADOW_PCF_RADIUS + 1));
 	return shadow;
 }
 
+// Read the surface values from the G-buffer. Returns false if there is no surface (sky)
+bool ReadGBuffer(vec2 texCoord, out SurfaceData data, out bool ignoreSpecularIndirect)
+{
+	vec4 albedo = texture(AlbedoTexture, texCoord);
+	vec4 normalTextureSample = texture(NormalTexture, texCoord);
+	data.albedo = albedo.rgb;
+
+	if (GBUFFER_LAYOUT == GBufferLayoutStandard)
+	{
+		ignoreSpecularIndirect = normalTextureSample.w > 0.0f;
+		data.normal = normalize(normalTextureSample.xyz * 2.0f - 1.0f);
+
+		vec3 arm = texture(SpecularTexture, texCoord).xyz;
+		data.ambientOcclusion = arm.x;
+		data.roughness = arm.y;
+		data.metalness = arm.z;
+		return albedo.a != 0.0f;
+	}
+
+	data.normal = DecodeOctahedral(normalTextureSample.xy);
+	data.ambientOcclusion = albedo.a;
+
+	vec2 specular = GBUFFER_LAYOUT == GBufferLayoutPackedNormal16 ? texture(SpecularTexture, texCoord).xy : normalTextureSample.zw;
+	data.roughness = specular.x;
+	data.metalness = UnpackUnorm8Flag(specular.y, ignoreSpecularIndirect);
+
+	// Alpha is used by the ambient occlusion, empty pixels keep the cleared depth
+	return texture(DepthTexture, texCoord).r < 1.0f;
+}
+
 void main()
 {
-	vec3 fragPosition = (InvViewMatrix * vec4(ReconstructViewPosition(DepthTexture, TexCoord, InvProjMatrix), 1.0f)).xyz;
+	// Texture coordinates from the pixel position, the same for fullscreen passes and light volumes
+	// Screen coordinates cover only the scaled part of the G-buffer
+	vec2 TexCoord = gl_FragCoord.xy / vec2(textureSize(DepthTexture, 0));
+	vec2 screenCoord = TexCoord / RenderScale;
+
+	vec3 viewPosition = ReconstructViewPosition(DepthTexture, TexCoord, screenCoord, InvProjMatrix);
+	vec3 fragPosition = (InvViewMatrix * vec4(viewPosition, 1.0f)).xyz;
 	vec3 viewVector = normalize(CameraPosition - fragPosition);
 
-	vec4 albedoColorA = texture(AlbedoTexture, TexCoord);
-	if (albedoColorA.a == 0.0f)
+	SurfaceData data;
+	bool ignoreSpecularIndirect;
+	if (!ReadGBuffer(TexCoord, data, ignoreSpecularIndirect))
 	{
 		FragColor = vec4(SkyColor, 1.0f);
 		return;
 	}
-	vec3 albedoColor = albedoColorA.rgb;
 
-	vec4 normalTextureSample = texture(NormalTexture, TexCoord);
-	bool ignoreSpecularIndirect = normalTextureSample.w > 0.0f;
-	vec3 normal = normalize(normalTextureSample.xyz * 2.0f - 1.0f);
-	
 	vec3 lightVector = -LightDirection;
 
-	vec3 arm = texture(SpecularTexture, TexCoord).xyz;
-
-	SurfaceData data;
-	data.normal = normal;
-	data.albedo = albedoColor;
-	data.ambientOcclusion = arm.x;
-	data.roughness = arm.y;
-	data.metalness = arm.z;
-
 	float shadow = 0.0f;
-	if (ShadowMapEnabled)
-		shadow = CalculateShadow(fragPosition, normal, lightVector);
+	if (bool(SHADOW_MAP))
+		shadow = CalculateShadow(fragPosition, data.normal, lightVector);
 	vec3 fragColor = ComputeLighting(fragPosition, data, viewVector, shadow, ignoreSpecularIndirect);
 
+	// Lights without shadows, all of them in the same pass
+	if (bool(CLUSTERED_LIGHTS))
+		fragColor += ComputeClusteredLighting(fragPosition, viewPosition, screenCoord, data, viewVector);
+
 	FragColor = vec4(fragColor, 1.0f);
 }
@@ -0,0 +1,10 @@
+#version 330 core
+
+#include "transform.glsl"
+
+layout (location = 0) in vec3 VertexPosition;
+
+void main()
+{
+	gl_Position = GetClipPosition(VertexPosition);
+}
@@ -0,0 +1,14 @@
+//Inputs
+layout (location = 0) in vec3 VertexPosition;
+
+//Outputs
+out vec2 TexCoord;
+
+void main()
+{
+	// Vertices are already in clip coordinates
+	gl_Position = vec4(VertexPosition.xy, 0.0, 1.0);
+
+	// texture coordinates
+	TexCoord = VertexPosition.xy * 0.5f + 0.5f;
+}
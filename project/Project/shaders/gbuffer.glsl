@@ -0,0 +1,41 @@
+#include "utils.glsl"
+
+// Must match GBufferRenderPass::Layout
+const int GBufferLayoutStandard = 0;
+const int GBufferLayoutPackedNormal16 = 1;
+const int GBufferLayoutPackedNormal8 = 2;
+
+// Define GBUFFER_LAYOUT to specialize the shader, instead of reading the layout from a uniform
+#ifndef GBUFFER_LAYOUT
+uniform int GBufferLayout;
+#define GBUFFER_LAYOUT GBufferLayout
+#endif
+
+// Pack the surface values for the render targets, with the layout of the G-buffer
+void PackGBuffer(vec4 albedo, vec3 normal, float ambientOcclusion, float roughness, float metalness, bool ignoreSpecularIndirect,
+	out vec4 FragAlbedo, out vec4 FragNormal, out vec4 FragSpecular)
+{
+	if (GBUFFER_LAYOUT == GBufferLayoutStandard)
+	{
+		FragAlbedo = albedo;
+		FragNormal = vec4(normal * 0.5f + 0.5f, ignoreSpecularIndirect ? 1.0f : 0.0f);
+		FragSpecular = vec4(ambientOcclusion, roughness, metalness, 0.0f);
+	}
+	else
+	{
+		// Sky is detected with the depth, so alpha can store the ambient occlusion
+		FragAlbedo = vec4(albedo.rgb, ambientOcclusion);
+		vec2 encodedNormal = EncodeOctahedral(normal);
+		vec2 specular = vec2(roughness, PackUnorm8Flag(metalness, ignoreSpecularIndirect));
+		if (GBUFFER_LAYOUT == GBufferLayoutPackedNormal16)
+		{
+			FragNormal = vec4(encodedNormal, 0.0f, 0.0f);
+			FragSpecular = vec4(specular, 0.0f, 0.0f);
+		}
+		else
+		{
+			FragNormal = vec4(encodedNormal, specular);
+			FragSpecular = vec4(0.0f);
+		}
+	}
+}
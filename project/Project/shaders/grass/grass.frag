@@ -1,11 +1,11 @@
-#version 330 core
+#include "../gbuffer.glsl"
 
 in vec3 Normal;
 in vec2 TexCoord;
 
-out vec4 FragAlbedo;
-out vec4 FragNormal;
-out vec3 FragSpecular;
+layout (location = 0) out vec4 FragAlbedo;
+layout (location = 1) out vec4 FragNormal;
+layout (location = 2) out vec4 FragSpecular;
 
 uniform sampler2D AlbedoTexture;
 uniform sampler2D AmbientOcclusionTexture;
@@ -15,10 +15,12 @@ uniform float AmbientOcclusion;
 
 void main()
 {
-	FragAlbedo = texture(AlbedoTexture, TexCoord);
-	FragNormal = vec4(normalize(Normal) * 0.5f + 0.5f, 1.0f);
-	FragSpecular = vec3(
+	PackGBuffer(
+		texture(AlbedoTexture, TexCoord),
+		normalize(Normal),
 		AmbientOcclusion * texture(AmbientOcclusionTexture, TexCoord).x,
 		texture(RoughnessTexture, TexCoord).x,
-		0.0f);
+		0.0f,
+		true,
+		FragAlbedo, FragNormal, FragSpecular);
 }
@@ -1,3 +1,6 @@
+#include "grassVertices.glsl"
+#include "../transform.glsl"
+
 layout (location = 0) in vec3 VertexPosition;
 layout (location = 1) in vec2 VertexTexCoord;
 layout (location = 2) in vec3 InstanceOffset;
@@ -6,7 +9,6 @@ layout (location = 4) in float InstanceHeightMultiplier;
 
 uniform mat4 WorldMatrix;
 uniform mat4 WorldViewMatrix;
-uniform mat4 WorldViewProjMatrix;
 
 out vec3 Normal;
 out vec2 TexCoord;
@@ -25,5 +27,5 @@ void main()
 
 	vec3 position = calculateVertexPosition(instanceData);
 	
-	gl_Position = WorldViewProjMatrix * vec4(position, 1.0f);
+	gl_Position = GetClipPosition(position);
 }
@@ -0,0 +1,20 @@
+#include "grassVertices.glsl"
+#include "../transform.glsl"
+
+layout (location = 0) in vec3 VertexPosition;
+layout (location = 2) in vec3 InstanceOffset;
+layout (location = 3) in float InstanceRotation;
+layout (location = 4) in float InstanceHeightMultiplier;
+
+void main()
+{
+	InstanceData instanceData;
+	instanceData.vertexPosition = VertexPosition;
+	instanceData.instanceOffset = InstanceOffset;
+	instanceData.instanceRotation = InstanceRotation;
+	instanceData.instanceHeightMultiplier = InstanceHeightMultiplier;
+
+	vec3 position = calculateVertexPosition(instanceData);
+
+	gl_Position = GetClipPosition(position);
+}
@@ -1,3 +1,5 @@
+#include "grassVertices.glsl"
+
 layout (location = 0) in vec3 VertexPosition;
 layout (location = 1) in vec2 VertexTexCoord;
 layout (location = 2) in vec3 InstanceOffset;
@@ -1,11 +1,11 @@
-#version 330 core
+#include "gbuffer.glsl"
 
 in vec2 TexCoord;
 in mat3 TBN;
 
-out vec4 FragAlbedo;
-out vec4 FragNormal;
-out vec3 FragSpecular;
+layout (location = 0) out vec4 FragAlbedo;
+layout (location = 1) out vec4 FragNormal;
+layout (location = 2) out vec4 FragSpecular;
 
 uniform sampler2D AlbedoTexture;
 uniform sampler2D NormalsTexture;
@@ -15,15 +15,15 @@ uniform float AmbientOcclusion;
 
 void main()
 {
-	FragAlbedo = texture(AlbedoTexture, TexCoord);
+	vec4 albedo = texture(AlbedoTexture, TexCoord);
 
-
-	vec3 normal = texture(NormalsTexture, TexCoord).xyz;
-	normal = normal * 2.0f - 1.0f;
-	normal = normalize(TBN * normal);
-	FragNormal = vec4(normalize(normal) * 0.5f + 0.5f, 0.0f);
+	// Z is reconstructed, so that two channel formats like BC5 can be used
+	vec2 normalMap = texture(NormalsTexture, TexCoord).xy * 2.0f - 1.0f;
+	vec3 normal = normalize(TBN * GetImplicitNormal(normalMap));
 
 	vec3 specular = texture(SpecularTexture, TexCoord).xyz;
 	specular.x *= AmbientOcclusion;
-	FragSpecular = specular;
+
+	PackGBuffer(albedo, normal, specular.x, specular.y, specular.z, false,
+		FragAlbedo, FragNormal, FragSpecular);
 }
@@ -1,5 +1,7 @@
 #version 330 core
 
+#include "transform.glsl"
+
 layout (location = 0) in vec3 VertexPosition;
 layout (location = 1) in vec3 VertexNormal;
 layout (location = 2) in vec2 VertexTexCoord;
@@ -11,7 +13,6 @@ out mat3 TBN;
 
 uniform mat4 WorldMatrix;
 uniform mat4 WorldViewMatrix;
-uniform mat4 WorldViewProjMatrix;
 
 void main()
 {
@@ -21,5 +22,5 @@ void main()
 	TBN = mat3(t, b, n);
 
 	TexCoord = VertexTexCoord;
-	gl_Position = WorldViewProjMatrix * vec4(VertexPosition, 1.0f);
+	gl_Position = GetClipPosition(VertexPosition);
 }
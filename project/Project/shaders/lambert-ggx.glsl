@@ -1,3 +1,4 @@
+#include "utils.glsl"
 
 //uniform samplerCube EnvironmentTexture;
 //uniform float EnvironmentMaxLod;
@@ -1,59 +1,73 @@
+// Requires the BRDF functions and SurfaceData (lambert-ggx.glsl or blinn-phong.glsl) to be included first
+#include "utils.glsl"
 
+// Indirect light is only added by one of the passes. Permutations set it with a define
+#ifndef LIGHT_INDIRECT
 uniform bool LightIndirect;
+#define LIGHT_INDIRECT LightIndirect
+#endif
+
 uniform vec3 LightColor;
 uniform vec3 LightPosition;
 uniform vec3 LightDirection;
 uniform vec4 LightAttenuation;
 
-float ComputeDistanceAttenuation(vec3 position)
+float ComputeDistanceAttenuation(vec3 position, vec3 lightPosition, vec4 lightAttenuation)
 {
-	// Compute distance attenuation, reading the range from LightAttenuation.x (fade start) and LightAttenuation.y (fade end)
-	return smoothstep(LightAttenuation.y, LightAttenuation.x, distance(position, LightPosition));
+	// Compute distance attenuation, reading the range from lightAttenuation.x (fade start) and lightAttenuation.y (fade end)
+	return smoothstep(lightAttenuation.y, lightAttenuation.x, distance(position, lightPosition));
 }
 
-float ComputeAngularAttenuation(vec3 lightDir)
+float ComputeAngularAttenuation(vec3 lightDir, vec3 lightDirection, vec4 lightAttenuation)
 {
-	float angle = acos(dot(LightDirection, lightDir));
-	vec2 attAngle = LightAttenuation.zw;
+	// lightDir points towards the light, opposite to the light direction
+	float angle = acos(dot(-lightDirection, lightDir));
+	vec2 attAngle = lightAttenuation.zw;
 	return smoothstep(attAngle.y, attAngle.x, angle);
 }
 
-float ComputeAttenuation(vec3 position, vec3 lightDir)
+float ComputeAttenuation(vec3 position, vec3 lightDir, vec3 lightPosition, vec3 lightDirection, vec4 lightAttenuation)
 {
 	float attenuation = 1.0f;
-	if (LightAttenuation.y > 0)
+	if (lightAttenuation.y > 0)
 	{
-		attenuation *= ComputeDistanceAttenuation(position);
+		attenuation *= ComputeDistanceAttenuation(position, lightPosition, lightAttenuation);
 	}
-	if (LightAttenuation.w > 0)
+	if (lightAttenuation.w > 0)
 	{
-		attenuation *= ComputeAngularAttenuation(lightDir);
+		attenuation *= ComputeAngularAttenuation(lightDir, lightDirection, lightAttenuation);
 	}
 	return attenuation;
 }
 
-vec3 ComputeLightDirection(vec3 position)
+vec3 ComputeLightDirection(vec3 position, vec3 lightPosition, vec3 lightDirection, vec4 lightAttenuation)
 {
-	return LightAttenuation.y >= 0 ? GetDirection(position, LightPosition) : -LightDirection;
+	return lightAttenuation.y >= 0 ? GetDirection(position, lightPosition) : -lightDirection;
 }
 
-vec3 ComputeLight(SurfaceData data, vec3 viewDir, vec3 position)
+// Compute the contribution of a light with the given parameters, instead of the light uniforms
+vec3 ComputeLight(SurfaceData data, vec3 viewDir, vec3 position, vec3 lightColor, vec3 lightPosition, vec3 lightDirection, vec4 lightAttenuation)
 {
-	vec3 lightDir = ComputeLightDirection(position);
+	vec3 lightDir = ComputeLightDirection(position, lightPosition, lightDirection, lightAttenuation);
 
 	vec3 diffuse = ComputeDiffuseLighting(data, lightDir);
 	vec3 specular = ComputeSpecularLighting(data, lightDir, viewDir);
 	vec3 light = CombineLighting(diffuse, specular, data, lightDir, viewDir);
 
-	float attenuation = ComputeAttenuation(position, lightDir);
-	return light * LightColor * attenuation;
+	float attenuation = ComputeAttenuation(position, lightDir, lightPosition, lightDirection, lightAttenuation);
+	return light * lightColor * attenuation;
+}
+
+vec3 ComputeLight(SurfaceData data, vec3 viewDir, vec3 position)
+{
+	return ComputeLight(data, viewDir, position, LightColor, LightPosition, LightDirection, LightAttenuation);
 }
 
 vec3 ComputeLighting(vec3 position, SurfaceData data, vec3 viewDir, bool indirect, float shadow, bool ignoreSpecularIndirect)
 {
 	vec3 light = (1.0f - shadow) * ComputeLight(data, viewDir, position);
 	
-	if (indirect && LightIndirect)
+	if (indirect && bool(LIGHT_INDIRECT))
 	{
 		vec3 diffuseIndirect = ComputeDiffuseIndirectLighting(data);
 		if (ignoreSpecularIndirect)
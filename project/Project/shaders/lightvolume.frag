@@ -0,0 +1,9 @@
+//Uniforms
+uniform sampler2D DepthTexture;
+uniform bool CopyDepth;
+
+void main()
+{
+	// Copy the G-buffer depth with a fullscreen pass, or write the depth of the light volume
+	gl_FragDepth = CopyDepth ? texelFetch(DepthTexture, ivec2(gl_FragCoord.xy), 0).r : gl_FragCoord.z;
+}
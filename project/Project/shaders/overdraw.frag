@@ -0,0 +1,22 @@
+//Outputs
+out vec4 FragColor;
+
+//Uniforms
+uniform int OverdrawCount;
+uniform int MaxOverdrawCount;
+
+void main()
+{
+	// Heat map: black for no fragments, then blue, green, yellow and red for the max count
+	if (OverdrawCount == 0)
+	{
+		FragColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		return;
+	}
+
+	float t = float(OverdrawCount - 1) / float(max(MaxOverdrawCount - 1, 1));
+	vec3 color = t < 0.5f
+		? mix(vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 1.0f, 0.0f), t * 2.0f)
+		: mix(vec3(1.0f, 1.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f), t * 2.0f - 1.0f);
+	FragColor = vec4(color, 1.0f);
+}
@@ -0,0 +1,10 @@
+// Clip space position of the vertex shaders that are also drawn in the depth pre-pass
+// The main pass tests depth with EQUAL, so both passes must compute it with the same uniform and expression
+uniform mat4 WorldViewProjMatrix;
+
+invariant gl_Position;
+
+vec4 GetClipPosition(vec3 position)
+{
+	return WorldViewProjMatrix * vec4(position, 1.0f);
+}
@@ -0,0 +1,22 @@
+//Inputs
+in vec2 TexCoord;
+
+//Outputs
+out vec4 FragColor;
+
+//Uniforms
+uniform sampler2D SourceTexture;
+
+// Fraction of the source texture that was rendered, with dynamic resolution
+uniform vec2 RenderScale;
+
+void main()
+{
+	vec2 texCoord = TexCoord * RenderScale;
+
+	// Bilinear filter, keeping the footprint inside the rendered area to avoid reading stale pixels
+	vec2 halfTexel = 0.5f / vec2(textureSize(SourceTexture, 0));
+	texCoord = clamp(texCoord, halfTexel, RenderScale - halfTexel);
+
+	FragColor = vec4(texture(SourceTexture, texCoord).rgb, 1.0f);
+}
@@ -32,7 +32,8 @@ float DotAbs(vec3 v1, vec3 v2)
 //
 vec3 GetImplicitNormal(vec2 normal)
 {
-	float z = sqrt(1.0f - normal.x * normal.x - normal.y * normal.y);
+	// Compression can leave the length slightly above 1
+	float z = sqrt(max(1.0f - normal.x * normal.x - normal.y * normal.y, 0.0f));
 	return vec3(normal, z);
 }
 
@@ -64,11 +65,57 @@ vec3 SampleNormalMap(sampler2D normalTexture, vec2 texCoord, vec3 normal, vec3 t
 }
 
 //
-vec3 ReconstructViewPosition(sampler2D depthTexture, vec2 texCoord, mat4 invProjMatrix)
+vec3 ReconstructViewPosition(sampler2D depthTexture, vec2 texCoord, vec2 screenCoord, mat4 invProjMatrix)
 {
-	// Reconstruct the position, using the screen texture coordinates and the depth
+	// Reconstruct the position, using the screen coordinates and the depth
 	float depth = texture(depthTexture, texCoord).r;
-	vec3 clipPosition = vec3(texCoord, depth) * 2.0f - vec3(1.0f);
+	vec3 clipPosition = vec3(screenCoord, depth) * 2.0f - vec3(1.0f);
 	vec4 viewPosition = invProjMatrix * vec4(clipPosition, 1.0f);
 	return viewPosition.xyz / viewPosition.w;
 }
+
+//
+vec3 ReconstructViewPosition(sampler2D depthTexture, vec2 texCoord, mat4 invProjMatrix)
+{
+	return ReconstructViewPosition(depthTexture, texCoord, texCoord, invProjMatrix);
+}
+
+
+//
+vec2 SignNotZero(vec2 v)
+{
+	return vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+// Encode a unit vector with the octahedral mapping, in the [0, 1] range
+vec2 EncodeOctahedral(vec3 normal)
+{
+	normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+	vec2 encoded = normal.z >= 0.0f ? normal.xy : (1.0f - abs(normal.yx)) * SignNotZero(normal.xy);
+	return encoded * 0.5f + 0.5f;
+}
+
+// Decode a unit vector encoded with EncodeOctahedral
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	encoded = encoded * 2.0f - 1.0f;
+	vec3 normal = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	float t = max(-normal.z, 0.0f);
+	normal.xy -= t * SignNotZero(normal.xy);
+	return normalize(normal);
+}
+
+// Pack a [0, 1] value with 7 bits and a flag in the lowest bit of an 8 bits unorm channel
+float PackUnorm8Flag(float value, bool flag)
+{
+	return (round(clamp(value, 0.0f, 1.0f) * 127.0f) * 2.0f + (flag ? 1.0f : 0.0f)) / 255.0f;
+}
+
+// Unpack a value packed with PackUnorm8Flag
+float UnpackUnorm8Flag(float packed, out bool flag)
+{
+	float bits = round(packed * 255.0f);
+	float value = floor(bits * 0.5f);
+	flag = bits - value * 2.0f > 0.5f;
+	return value / 127.0f;
+}